@@ -28,6 +28,7 @@ from __future__ import unicode_literals, division, print_function
 import platform
 
 import csbuild
+import json
 import os
 import re
 
@@ -36,10 +37,17 @@ from csbuild.tools.linkers.linker_base import LinkerBase
 from csbuild.tools.common.tool_traits import HasDebugLevel
 from csbuild._utils import ordered_set, response_file, shared_globals
 
+from n64_stack_analyzer import AnalyzeProgram, ComputeStackUsage
 from n64_tool_base import N64BaseTool
 
 DebugLevel = HasDebugLevel.DebugLevel
 
+# Must match the value in engine/ultra_box/debug/stack.h.
+_STACK_GUARD_SIZE = 16
+
+# Size given to each thread stack until the program has been linked once and its stack usage is known.
+_DEFAULT_STACK_SIZE = 8 * 1024
+
 class N64Linker(N64BaseTool, LinkerBase):
 	"""
 	N64 linker tool implementation for compiled c/c++ and asm.
@@ -59,6 +67,78 @@ class N64Linker(N64BaseTool, LinkerBase):
 		N64BaseTool.__init__(self, projectSettings)
 		LinkerBase.__init__(self, projectSettings)
 
+		self._n64Overlays = projectSettings.get("n64Overlays", [])
+		self._n64ThreadStacks = projectSettings.get("n64ThreadStacks", [])
+		self._n64StackCallTargets = projectSettings.get("n64StackCallTargets", [])
+		self._n64StackMargin = projectSettings.get("n64StackMargin", 256)
+
+	####################################################################################################################
+	### Static makefile methods
+	####################################################################################################################
+
+	@staticmethod
+	def AddN64Overlay(name, *sourceFiles, region="default"):
+		"""
+		Add a named code overlay built from the given source files.
+		Overlay source files must use the '.ovl' suffix in their name (e.g. 'menu.ovl.c') so the linker script can keep
+		them out of the resident sections. All overlays added to the same region share the same RAM address range.
+
+		:param name: Name of the overlay; this must be a valid C identifier.
+		:type name: str
+
+		:param sourceFiles: Source file names (or wildcard patterns of file names) whose code and data belong to the overlay.
+		:type sourceFiles: str
+
+		:param region: Name of the RAM region the overlay is loaded into.
+		:type region: str
+		"""
+		csbuild.currentPlan.ExtendList("n64Overlays", [(region, name, tuple(sourceFiles))])
+
+	@staticmethod
+	def AddN64ThreadStack(name, *entryPoints, aliases=(), extraSize=0):
+		"""
+		Add a thread stack to be sized from the worst-case stack usage of its entry points. The linker script gets the
+		symbols '_<name>_stack_start' and '_<name>_stack_end' for it, plus the same for each alias. Entry points sharing
+		a stack must never run at the same time (e.g., the boot code and the first thread started once it's done).
+
+		:param name: Name of the stack; this must be a valid C identifier.
+		:type name: str
+
+		:param entryPoints: Names of the functions run on the stack.
+		:type entryPoints: str
+
+		:param aliases: Other names the same stack is known by.
+		:type aliases: tuple[str]
+
+		:param extraSize: Bytes reserved on top of the analyzed usage, for calls the analyzer can't follow.
+		:type extraSize: int
+		"""
+		csbuild.currentPlan.ExtendList("n64ThreadStacks", [(name, tuple(entryPoints), tuple(aliases), extraSize)])
+
+	@staticmethod
+	def AddN64StackCallTargets(caller, *callees):
+		"""
+		Tell the stack analyzer which functions a function calls through pointers. Calls through pointers can't be
+		followed in the compiled code, so without this the analyzer only warns about them.
+
+		:param caller: Name of the function making the calls.
+		:type caller: str
+
+		:param callees: Names of the functions that may be called.
+		:type callees: str
+		"""
+		csbuild.currentPlan.ExtendList("n64StackCallTargets", [(caller, tuple(callees))])
+
+	@staticmethod
+	def SetN64StackMargin(margin):
+		"""
+		Set the number of bytes added to the analyzed usage of every thread stack.
+
+		:param margin: Safety margin in bytes.
+		:type margin: int
+		"""
+		csbuild.currentPlan.SetValue("n64StackMargin", margin)
+
 	def _getOutputFiles(self, project):
 		assert project.projectType != csbuild.ProjectType.SharedLibrary, "N64 does not support shared libraries"
 
@@ -82,6 +162,7 @@ class N64Linker(N64BaseTool, LinkerBase):
 				+ self._getCustomArgs() \
 				+ self._getLinkerScriptArgs(project, inputFiles) \
 				+ self._getOutputFileArgs(project) \
+				+ self._getMapFileArgs(project) \
 				+ self._getInputFileArgs(inputFiles) \
 				+ self._getLibraryPathArgs() \
 				+ self._getStartGroupArgs() \
@@ -196,6 +277,18 @@ class N64Linker(N64BaseTool, LinkerBase):
 
 		return ret
 
+	def Run(self, inputProject, inputFiles):
+		outputFiles = LinkerBase.Run(self, inputProject, inputFiles)
+
+		# Stack sizes come from the linked program, so each link uses the sizes found by the one before it. The code
+		# doesn't depend on them, so relinking once whenever they change is always enough.
+		if inputProject.projectType == csbuild.ProjectType.Application and self._n64ThreadStacks:
+			if self._updateThreadStackSizes(inputProject, inputFiles, outputFiles[0]):
+				log.Linker("Relinking {} with updated thread stack sizes...", os.path.basename(outputFiles[0]))
+				outputFiles = LinkerBase.Run(self, inputProject, inputFiles)
+
+		return outputFiles
+
 	def _getOutputExtension(self, projectType):
 		# These are extensions of the files that can be output from the linker or librarian.
 		# The library extensions should represent the file types that can actually linked against.
@@ -227,9 +320,209 @@ class N64Linker(N64BaseTool, LinkerBase):
 		if len(linkerScriptFiles) > 1:
 			log.Warn(f"Project '{project.name}' contains more than one linker script; using the first one found: {linkerScriptFiles[0]}")
 
-		args = ["-T", linkerScriptFiles[0]]
+		# The overlay and stack scripts are always generated, even when empty, so project linker scripts can include them
+		# unconditionally.
+		overlayScriptDirPath = project.intermediateDir
+		self._writeOverlayLinkerScript(os.path.join(overlayScriptDirPath, "overlays.ld"))
+		self._writeStackLinkerScript(os.path.join(overlayScriptDirPath, "stacks.ld"), self._readThreadStackSizes(project))
+
+		args = [
+			"-T", linkerScriptFiles[0],
+			f"-L{overlayScriptDirPath}",
+		]
 		return args
 
+	def _writeOverlayLinkerScript(self, filePath):
+		regions = {}
+		for region, name, sourceFiles in self._n64Overlays:
+			regions.setdefault(region, []).append((name, sourceFiles))
+
+		def _inputSections(sourceFiles, sectionNames, keep=False):
+			# Object files are named after their source files, so match on those with any leading path.
+			fmt = "\tKEEP(*{}.o({}))" if keep else "\t*{}.o({})"
+			return [fmt.format(os.path.splitext(os.path.basename(f))[0], sectionNames) for f in sourceFiles]
+
+		lines = [
+			"/* Generated by the N64 linker tool; do not edit. */",
+			"",
+		]
+
+		lastSection = None
+
+		for region, overlays in regions.items():
+			# Each region starts in ROM directly after the previous one, or after the resident code for the first region.
+			romStart = f"LOADADDR({lastSection}) + SIZEOF({lastSection})" if lastSection else "_ovl_rom_start"
+
+			lines.extend([
+				f"/* Overlay region: {region} */",
+				f"OVERLAY ALIGN(16) : NOCROSSREFS AT({romStart})",
+				"{",
+			])
+
+			for name, sourceFiles in overlays:
+				lines.extend([
+					f"\t.ovl_{name}",
+					"\t{",
+					f"\t\t_ovl_{name}_ram_start = .;",
+				])
+				lines.extend("\t" + line for line in _inputSections(sourceFiles, ".text .text.* .rodata .rodata.* .data .data.*"))
+				lines.extend([
+					"\t\t. = ALIGN(4);",
+					f"\t\t_ovl_{name}_init_start = .;",
+				])
+				lines.extend("\t" + line for line in _inputSections(sourceFiles, ".ubx_ovl_init", keep=True))
+				lines.extend([
+					f"\t\t_ovl_{name}_init_end = .;",
+					"\t\t. = ALIGN(16);",
+					f"\t\t_ovl_{name}_bss_start = .;",
+					"\t}",
+				])
+
+				lastSection = f".ovl_{name}"
+
+			lines.extend([
+				"} >ram",
+				"",
+			])
+
+			# The BSS of each overlay follows its own code and data in RAM, but it's kept out of the loadable sections
+			# above so the ROM never has to store its zeros.
+			for name, sourceFiles in overlays:
+				lines.extend([
+					f".ovl_{name}.bss _ovl_{name}_bss_start (NOLOAD) :",
+					"{",
+				])
+				lines.extend(_inputSections(sourceFiles, ".bss .bss.* COMMON .scommon .scommon.*"))
+				lines.extend([
+					"\t. = ALIGN(16);",
+					f"\t_ovl_{name}_ram_end = .;",
+					"} >ram",
+					"",
+				])
+
+			# Move the RAM region past the largest overlay so whatever comes next doesn't overlap any of them. The
+			# section only exists to do that, and assigning to '.' keeps the linker from discarding it for being empty.
+			ramEnd = f"_ovl_{overlays[0][0]}_ram_end"
+			for name, _ in overlays[1:]:
+				ramEnd = f"MAX({ramEnd}, _ovl_{name}_ram_end)"
+
+			lines.extend([
+				f".ovl_region_{region}_end {ramEnd} (NOLOAD) :",
+				"{",
+				"\t. = .;",
+				"} >ram",
+				"",
+			])
+
+			for name, _ in overlays:
+				lines.extend([
+					f"_ovl_{name}_rom_start = LOADADDR(.ovl_{name});",
+					f"_ovl_{name}_rom_end = LOADADDR(.ovl_{name}) + SIZEOF(.ovl_{name});",
+				])
+
+			lines.append("")
+
+		self._writeGeneratedFile(filePath, "\n".join(lines))
+
+	def _writeStackLinkerScript(self, filePath, stackSizes):
+		lines = [
+			"/* Generated by the N64 linker tool; do not edit. */",
+			"",
+		]
+
+		if self._n64ThreadStacks:
+			lines.extend([
+				".stack (NOLOAD) : ALIGN(16)",
+				"{",
+			])
+
+			# Each stack grows down from its end toward the guard words at its start.
+			for name, entryPoints, aliases, _ in self._n64ThreadStacks:
+				lines.extend([
+					f"\t/* {name}: {', '.join(entryPoints)} */",
+					f"\t_{name}_stack_start = .;",
+					f"\t. += {_STACK_GUARD_SIZE} + {stackSizes.get(name, _DEFAULT_STACK_SIZE)};",
+					f"\t_{name}_stack_end = .;",
+				])
+
+				for alias in aliases:
+					lines.extend([
+						f"\t_{alias}_stack_start = _{name}_stack_start;",
+						f"\t_{alias}_stack_end = _{name}_stack_end;",
+					])
+
+				lines.append("")
+
+			lines.extend([
+				"\t. = ALIGN(16);",
+				"} >ram",
+				"",
+			])
+
+		self._writeGeneratedFile(filePath, "\n".join(lines))
+
+	def _readThreadStackSizes(self, project):
+		filePath = os.path.join(project.intermediateDir, "stacks.json")
+		if not os.access(filePath, os.F_OK):
+			return {}
+
+		with open(filePath, "r") as f:
+			return json.load(f)
+
+	def _updateThreadStackSizes(self, project, inputFiles, elfFilePath):
+		# The compiler writes its '.su' files next to the object files, so look in every intermediate directory the
+		# program was built from.
+		stackUsageDirs = { os.path.dirname(f.filename) for f in inputFiles if f.filename.endswith(".o") }
+		stackUsageDirs.update(dependency.intermediateDir for dependency in project.dependencies)
+
+		functions = AnalyzeProgram(elfFilePath, sorted(stackUsageDirs), self._n64StackCallTargets)
+
+		previousSizes = self._readThreadStackSizes(project)
+		stackSizes = {}
+
+		for name, entryPoints, _, extraSize in self._n64ThreadStacks:
+			report = ComputeStackUsage(functions, name, entryPoints)
+
+			if report.missingEntryPoints:
+				log.Warn(f"Stack '{name}' entry points not found in the program: {', '.join(report.missingEntryPoints)}")
+
+			if len(report.missingEntryPoints) == len(entryPoints):
+				stackSizes[name] = _DEFAULT_STACK_SIZE
+				continue
+
+			if report.recursiveFunctions:
+				log.Warn(f"Stack '{name}' usage is unbounded due to recursion in: {', '.join(sorted(report.recursiveFunctions))}")
+
+			if report.dynamicFunctions:
+				log.Warn(f"Stack '{name}' usage is unbounded due to dynamic allocation in: {', '.join(sorted(report.dynamicFunctions))}")
+
+			if report.indirectCallers and not extraSize:
+				log.Warn(f"Stack '{name}' does not include calls through pointers in: {', '.join(sorted(report.indirectCallers))}")
+
+			# Keep the stacks a multiple of 16 bytes so the next one stays aligned.
+			stackSizes[name] = (report.size + self._n64StackMargin + extraSize + 15) & ~15
+
+			log.Info("Stack '{}' uses up to {} bytes, reserving {}: {}", name, report.size, stackSizes[name], " -> ".join(report.path))
+
+		if stackSizes == previousSizes:
+			return False
+
+		self._writeGeneratedFile(os.path.join(project.intermediateDir, "stacks.json"), json.dumps(stackSizes, indent="\t", sort_keys=True))
+		return True
+
+	def _writeGeneratedFile(self, filePath, content):
+		# Only touch the file when its content changes to avoid needlessly relinking.
+		if os.access(filePath, os.F_OK):
+			with open(filePath, "r") as f:
+				if f.read() == content:
+					return
+
+		if not os.access(os.path.dirname(filePath), os.F_OK):
+			os.makedirs(os.path.dirname(filePath))
+
+		with open(filePath, "w") as f:
+			f.write(content)
+
 	def _getCustomArgs(self):
 		return self._linkerFlags
 
@@ -259,6 +552,11 @@ class N64Linker(N64BaseTool, LinkerBase):
 			return [outFile]
 		return ["-o", outFile]
 
+	def _getMapFileArgs(self, project):
+		# The map is written next to the ELF so the ROM builder can attribute ROM and RDRAM usage from it.
+		outFile = self._getOutputFiles(project)[0]
+		return [f"-Wl,-Map={os.path.splitext(outFile)[0]}.map"]
+
 	def _getInputFileArgs(self, inputFiles):
 		args = [f.filename for f in inputFiles if f.filename.endswith(".o")]
 		return args
@@ -29,6 +29,7 @@ import platform
 
 import csbuild
 import os
+import struct
 import warnings
 
 from csbuild import commands, log
@@ -43,6 +44,113 @@ _THIS_PATH = os.path.abspath(os.path.dirname(__file__))
 
 warnings.filterwarnings("ignore")
 
+# Must match the values in engine/ultra_box/lowlevel/boot.h.
+_BOOT_COMPRESSED_MAGIC = 0x5542585A
+_BOOT_HEADER_SIZE = 0x10
+
+def _readElfSymbols(filePath, names):
+	"""
+	Read the values of the requested symbols from a 32-bit big-endian ELF file.
+	"""
+	with open(filePath, "rb") as f:
+		data = f.read()
+
+	assert data[:4] == b"\x7fELF" and data[4] == 1 and data[5] == 2, f"Not a 32-bit big-endian ELF file: {filePath}"
+
+	sectionHeaderOffset, = struct.unpack_from(">I", data, 0x20)
+	sectionHeaderSize, sectionHeaderCount = struct.unpack_from(">HH", data, 0x2E)
+
+	sections = [
+		struct.unpack_from(">IIIIIIIIII", data, sectionHeaderOffset + (i * sectionHeaderSize))
+		for i in range(sectionHeaderCount)
+	]
+
+	symbols = {}
+
+	for _, sectionType, _, _, offset, size, link, _, _, entrySize in sections:
+		# Only interested in the symbol table (SHT_SYMTAB).
+		if sectionType != 2:
+			continue
+
+		stringTableOffset = sections[link][4]
+
+		for entryOffset in range(offset, offset + size, entrySize):
+			nameOffset, value = struct.unpack_from(">II", data, entryOffset)
+			nameStart = stringTableOffset + nameOffset
+			name = data[nameStart:data.index(b"\0", nameStart)].decode("ascii", "replace")
+
+			if name in names:
+				symbols[name] = value
+
+	return symbols
+
+def _compressLzss(data):
+	"""
+	Compress data with the LZSS variant understood by the engine's first-stage loader.
+	"""
+	windowSize = 0x1000
+	minLength = 3
+	maxLength = 0x12
+	maxChainLength = 16
+
+	output = bytearray()
+	chains = {}
+
+	dataLength = len(data)
+	position = 0
+
+	while position < dataLength:
+		flagsIndex = len(output)
+		output.append(0)
+
+		for bit in range(8):
+			if position >= dataLength:
+				break
+
+			bestLength = 0
+			bestDistance = 0
+
+			key = bytes(data[position:position + minLength])
+			candidates = chains.get(key, [])
+
+			if len(key) == minLength:
+				for candidate in reversed(candidates):
+					distance = position - candidate
+					if distance > windowSize:
+						break
+
+					length = minLength
+					limit = min(maxLength, dataLength - position)
+					while length < limit and data[candidate + length] == data[position + length]:
+						length += 1
+
+					if length > bestLength:
+						bestLength = length
+						bestDistance = distance
+						if length == limit:
+							break
+
+			if bestLength >= minLength:
+				output.append((bestDistance - 1) >> 4)
+				output.append((((bestDistance - 1) & 0xF) << 4) | (bestLength - minLength))
+				advance = bestLength
+			else:
+				output[flagsIndex] |= 1 << bit
+				output.append(data[position])
+				advance = 1
+
+			# Record every position covered by this item so later matches can refer back to them.
+			for i in range(position, min(position + advance, dataLength - minLength + 1)):
+				chain = chains.setdefault(bytes(data[i:i + minLength]), [])
+				chain.append(i)
+				if len(chain) > maxChainLength:
+					del chain[0]
+
+			position += advance
+
+	return bytes(output)
+
+
 class N64RomBuilder(N64BaseTool):
 	"""
 	Tool that converts a raw N64 ELF to a padded N64 ROM with a valid header, checksum, and bootcode.
@@ -65,6 +173,9 @@ class N64RomBuilder(N64BaseTool):
 		self._n64GameCode = projectSettings.get("n64GameCode", None)
 		self._n64RomVersion = projectSettings.get("n64RomVersion", 0)
 		self._n64BootCodeId = projectSettings.get("n64BootCodeId", 6102)
+		self._n64CompressCode = projectSettings.get("n64CompressCode", False)
+		self._n64MemoryBudgets = projectSettings.get("n64MemoryBudgets", [])
+		self._n64MemoryBaseline = projectSettings.get("n64MemoryBaseline", None)
 		self._n64BootCodeFile = None
 
 		exeFileExt = ".exe" if platform.system() == "Windows" else ""
@@ -72,6 +183,9 @@ class N64RomBuilder(N64BaseTool):
 		self._maskRom64ExePath = os.path.abspath(f"{_THIS_PATH}/../output/tool/release/maskrom64{exeFileExt}")
 		assert os.access(self._maskRom64ExePath, os.F_OK), f"Cannot find the MaskRom64 tool at: {self._maskRom64ExePath}"
 
+		self._ubxMapExePath = os.path.abspath(f"{_THIS_PATH}/../output/tool/release/ubxmap{exeFileExt}")
+		assert os.access(self._ubxMapExePath, os.F_OK), f"Cannot find the UbxMap tool at: {self._ubxMapExePath}"
+
 	####################################################################################################################
 	### Static makefile methods
 	####################################################################################################################
@@ -123,10 +237,107 @@ class N64RomBuilder(N64BaseTool):
 		"""
 		csbuild.currentPlan.SetValue("n64BootCodeId", id)
 
+	@staticmethod
+	@TypeChecked(compress=bool)
+	def SetN64CompressCode(compress):
+		"""
+		Set whether the code segment loaded by the engine's first-stage loader should be compressed in the output ROM.
+		This reduces the amount of data transferred from the cartridge at boot. The layout of the ROM is unaffected.
+
+		:param compress: Enable code compression.
+		:type compress: bool
+		"""
+		csbuild.currentPlan.SetValue("n64CompressCode", compress)
+
+	@staticmethod
+	def AddN64MemoryBudget(region, size, name=None):
+		"""
+		Add a limit on the memory used by the program, checked against its linker map whenever the ROM is built.
+		The build fails when the limit is exceeded.
+
+		:param region: Memory being limited, either "rom" or "rdram".
+		:type region: str
+
+		:param size: Maximum number of bytes that may be used.
+		:type size: int
+
+		:param name: Optional section, library, or object file to limit rather than the whole program.
+		:type name: str or None
+		"""
+		assert region in ("rom", "rdram"), f"Invalid N64 memory budget region: \"{region}\""
+		csbuild.currentPlan.ExtendList("n64MemoryBudgets", [(region, size, name)])
+
+	@staticmethod
+	@TypeChecked(elfFilePath=str)
+	def SetN64MemoryBaseline(elfFilePath):
+		"""
+		Set an ELF file from an earlier build to compare the memory used by the program against.
+		Its linker map must be next to it with the same name and a '.map' extension.
+
+		:param elfFilePath: Path to the baseline ELF file.
+		:type elfFilePath: str
+		"""
+		csbuild.currentPlan.SetValue("n64MemoryBaseline", elfFilePath)
+
 	################################################################################
 	### Internal methods
 	################################################################################
 
+	def _compressCodeSegment(self, elfFilePath, romFilePath):
+		symbols = _readElfSymbols(elfFilePath, {"_text_rom_start", "_text_rom_end"})
+		if len(symbols) != 2:
+			log.Warn("Cannot compress the code segment since the linker script does not define its ROM bounds")
+			return
+
+		payloadStart = symbols["_text_rom_start"] + _BOOT_HEADER_SIZE
+		payloadEnd = symbols["_text_rom_end"]
+
+		with open(romFilePath, "rb") as f:
+			rom = bytearray(f.read())
+
+		payload = bytes(rom[payloadStart:payloadEnd])
+		compressed = _compressLzss(payload)
+
+		# The compressed data must fit in the space of the original segment so nothing after it in the ROM moves.
+		if len(compressed) >= len(payload):
+			log.Warn("Code segment does not benefit from compression; leaving it uncompressed")
+			return
+
+		header = struct.pack(">IIII", _BOOT_COMPRESSED_MAGIC, len(payload), len(compressed), 0)
+		padding = bytes(len(payload) - len(compressed))
+
+		rom[payloadStart - _BOOT_HEADER_SIZE:payloadEnd] = header + compressed + padding
+
+		with open(romFilePath, "wb") as f:
+			f.write(rom)
+
+		log.Info("Compressed code segment from {} to {} bytes", len(payload), len(compressed))
+
+	def _checkMemoryUsage(self, inputProject, inputFile, romFilePath):
+		mapFilePath = "{}.map".format(os.path.splitext(inputFile.filename)[0])
+		if not os.access(mapFilePath, os.F_OK):
+			log.Warn("Cannot check memory usage since there is no linker map for {}", os.path.basename(inputFile.filename))
+			return
+
+		ubxMapCmd = [
+			self._ubxMapExePath,
+			inputFile.filename,
+			"-m", mapFilePath,
+			"-o", "{}.map.json".format(os.path.splitext(romFilePath)[0]),
+			"-q",
+		]
+
+		for region, size, name in self._n64MemoryBudgets:
+			ubxMapCmd.extend(["-B", f"{region}:{name}={size}" if name else f"{region}={size}"])
+
+		if self._n64MemoryBaseline:
+			ubxMapCmd.extend(["--baseline", os.path.abspath(self._n64MemoryBaseline)])
+
+		# The report is written even when a budget has been exceeded, so it can be looked at after the build fails.
+		returncode, _, _ = commands.Run(ubxMapCmd, cwd=inputProject.outputDir)
+		if returncode != 0:
+			raise csbuild.BuildFailureException(inputProject, inputFile)
+
 	def _getOutputFile(self, project, inputFile):
 		inputFileExtSplit = os.path.splitext(os.path.basename(inputFile.filename))
 		outputFilePath = os.path.join(
@@ -195,6 +406,9 @@ class N64RomBuilder(N64BaseTool):
 		if returncode != 0:
 			raise csbuild.BuildFailureException(inputProject, inputFile)
 
+		if self._n64CompressCode:
+			self._compressCodeSegment(inputFile.filename, outputFilePath)
+
 		log.Build(
 			"Masking {} ({}-{}-{})...",
 			os.path.basename(outputFilePath),
@@ -224,4 +438,6 @@ class N64RomBuilder(N64BaseTool):
 		if returncode != 0:
 			raise csbuild.BuildFailureException(inputProject, inputFile)
 
+		self._checkMemoryUsage(inputProject, inputFile, outputFilePath)
+
 		return tuple({ outputFilePath })
@@ -0,0 +1,398 @@
+#
+# Copyright (c) 2023, Zoe J. Bare
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+# documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+# and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all copies or substantial portions
+# of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+# TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+# CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+#
+
+"""
+.. module:: n64_stack_analyzer
+	:synopsis: Static worst-case stack usage analysis of linked N64 programs.
+
+.. moduleauthor:: Zoe Bare
+"""
+
+from __future__ import unicode_literals, division, print_function
+
+import bisect
+import os
+import struct
+
+# ELF constants.
+_SHT_PROGBITS = 1
+_SHT_SYMTAB = 2
+_SHF_EXECINSTR = 0x4
+_STT_NOTYPE = 0
+_STT_FUNC = 2
+_SHN_UNDEF = 0
+
+# MIPS register numbers.
+_REG_AT = 1
+_REG_SP = 29
+
+# Number of instructions searched from the start of a function for the stack frame allocation.
+_PROLOGUE_LENGTH = 32
+
+class Function(object):
+	"""
+	Code symbol in the linked program along with everything the analyzer learned about it.
+	"""
+	def __init__(self, name, address, size, sectionIndex):
+		self.name = name
+		self.address = address
+		self.size = size
+		self.sectionIndex = sectionIndex
+
+		self.frameSize = 0
+		self.callees = set()
+
+		# Set when the function calls through a pointer the analyzer can't follow.
+		self.hasIndirectCalls = False
+
+		# Set when the compiler reported a frame size that depends on run-time values (alloca or VLAs).
+		self.hasDynamicFrame = False
+
+class StackReport(object):
+	"""
+	Worst-case stack usage of one thread stack.
+	"""
+	def __init__(self, name):
+		self.name = name
+		self.size = 0
+		self.path = []
+		self.missingEntryPoints = []
+		self.indirectCallers = set()
+		self.dynamicFunctions = set()
+		self.recursiveFunctions = set()
+
+def _readElf(filePath):
+	with open(filePath, "rb") as f:
+		data = f.read()
+
+	assert data[:4] == b"\x7fELF" and data[4] == 1 and data[5] == 2, f"Not a 32-bit big-endian ELF file: {filePath}"
+
+	sectionHeaderOffset, = struct.unpack_from(">I", data, 0x20)
+	sectionHeaderSize, sectionHeaderCount = struct.unpack_from(">HH", data, 0x2E)
+
+	# (name, type, flags, addr, offset, size, link, info, addralign, entsize)
+	sections = [
+		struct.unpack_from(">IIIIIIIIII", data, sectionHeaderOffset + (i * sectionHeaderSize))
+		for i in range(sectionHeaderCount)
+	]
+
+	return data, sections
+
+def _readFunctions(data, sections):
+	"""
+	Gather the code symbols from the symbol table. Hand-written assembly rarely marks its labels as functions or gives
+	them a size, so global labels in code sections are included as well and sized up to the next symbol.
+	"""
+	codeSections = {
+		index
+		for index, (_, sectionType, flags, _, _, _, _, _, _, _) in enumerate(sections)
+		if sectionType == _SHT_PROGBITS and (flags & _SHF_EXECINSTR)
+	}
+
+	functions = {}
+
+	for _, sectionType, _, _, offset, size, link, _, _, entrySize in sections:
+		if sectionType != _SHT_SYMTAB:
+			continue
+
+		stringTableOffset = sections[link][4]
+
+		for entryOffset in range(offset, offset + size, entrySize):
+			nameOffset, value, symbolSize, info, _, sectionIndex = struct.unpack_from(">IIIBBH", data, entryOffset)
+			symbolType = info & 0xF
+
+			if sectionIndex == _SHN_UNDEF or sectionIndex not in codeSections:
+				continue
+
+			if symbolType != _STT_FUNC and (symbolType != _STT_NOTYPE or (info >> 4) == 0):
+				continue
+
+			nameStart = stringTableOffset + nameOffset
+			name = data[nameStart:data.index(b"\0", nameStart)].decode("ascii", "replace")
+
+			if not name:
+				continue
+
+			key = (sectionIndex, value)
+			existing = functions.get(key)
+
+			# Prefer the properly typed symbol when an assembly label aliases a function.
+			if existing is None or (symbolType == _STT_FUNC and existing.size == 0):
+				functions[key] = Function(name, value, symbolSize, sectionIndex)
+
+	functionsBySection = {}
+	for function in functions.values():
+		functionsBySection.setdefault(function.sectionIndex, []).append(function)
+
+	for sectionIndex, sectionFunctions in functionsBySection.items():
+		sectionFunctions.sort(key=lambda function: function.address)
+
+		sectionEnd = sections[sectionIndex][3] + sections[sectionIndex][5]
+
+		for i, function in enumerate(sectionFunctions):
+			if function.size == 0:
+				nextAddress = sectionFunctions[i + 1].address if i + 1 < len(sectionFunctions) else sectionEnd
+				function.size = nextAddress - function.address
+
+	return functionsBySection
+
+def _readStackUsageFiles(directories):
+	"""
+	Read the frame sizes GCC reports with -fstack-usage. Each line of a '.su' file looks like:
+		path/to/file.c:123:6:FunctionName	48	static
+	"""
+	usage = {}
+
+	for directory in directories:
+		for rootPath, _, fileNames in os.walk(directory):
+			for fileName in fileNames:
+				if not fileName.endswith(".su"):
+					continue
+
+				with open(os.path.join(rootPath, fileName), "r") as f:
+					for line in f:
+						fields = line.rstrip("\n").split("\t")
+						if len(fields) < 3:
+							continue
+
+						name = fields[0].rsplit(":", 1)[-1]
+						size = int(fields[1])
+						dynamic = fields[2].startswith("dynamic") and "bounded" not in fields[2]
+
+						# Static functions in different files can share a name, so keep the worst of them.
+						previousSize, previousDynamic = usage.get(name, (0, False))
+						usage[name] = (max(size, previousSize), dynamic or previousDynamic)
+
+	return usage
+
+def _signExtend16(value):
+	return value - 0x10000 if value & 0x8000 else value
+
+def _analyzeFunction(function, data, section, resolveTargets):
+	_, _, _, sectionAddress, sectionOffset, _, _, _, _, _ = section
+
+	start = sectionOffset + (function.address - sectionAddress)
+	count = function.size // 4
+
+	# Constants loaded into registers, for frames too large to allocate with a single immediate.
+	registers = {}
+
+	for i in range(count):
+		instruction, = struct.unpack_from(">I", data, start + (i * 4))
+		address = function.address + (i * 4)
+
+		opcode = instruction >> 26
+		rs = (instruction >> 21) & 0x1F
+		rt = (instruction >> 16) & 0x1F
+		rd = (instruction >> 11) & 0x1F
+		immediate = instruction & 0xFFFF
+
+		if i < _PROLOGUE_LENGTH and function.frameSize == 0:
+			if opcode in (0x09, 0x19) and rs == _REG_SP and rt == _REG_SP and (immediate & 0x8000):
+				# addiu/daddiu $sp, $sp, -N
+				function.frameSize = -_signExtend16(immediate)
+
+			elif opcode == 0x0F:
+				# lui
+				registers[rt] = immediate << 16
+
+			elif opcode == 0x0D and rs in registers:
+				# ori
+				registers[rt] = registers[rs] | immediate
+
+			elif opcode == 0x09 and rs in registers:
+				# addiu
+				registers[rt] = (registers[rs] + _signExtend16(immediate)) & 0xFFFFFFFF
+
+			elif opcode == 0x00 and (instruction & 0x3F) in (0x23, 0x2F) and rs == _REG_SP and rd == _REG_SP and rt in registers:
+				# subu/dsubu $sp, $sp, $reg
+				function.frameSize = registers[rt]
+
+		if opcode == 0x03:
+			# jal
+			target = ((address + 4) & 0xF0000000) | ((instruction & 0x03FFFFFF) << 2)
+			function.callees.update(resolveTargets(function, target))
+
+		elif opcode == 0x02:
+			# j; only a call when it leaves the function, which is how tail calls are compiled.
+			target = ((address + 4) & 0xF0000000) | ((instruction & 0x03FFFFFF) << 2)
+			if not function.address <= target < function.address + function.size:
+				function.callees.update(resolveTargets(function, target))
+
+		elif opcode == 0x01 and rt in (0x10, 0x11, 0x12, 0x13):
+			# bltzal/bgezal and their "likely" variants
+			target = (address + 4 + (_signExtend16(immediate) << 2)) & 0xFFFFFFFF
+			if not function.address <= target < function.address + function.size:
+				function.callees.update(resolveTargets(function, target))
+
+		elif opcode == 0x00 and (instruction & 0x3F) == 0x09:
+			# jalr
+			function.hasIndirectCalls = True
+
+def AnalyzeProgram(elfFilePath, stackUsageDirectories=(), extraCallTargets=()):
+	"""
+	Build the call graph of a linked program and the stack frame size of each of its functions.
+
+	Frame sizes come from the stack allocation in each function's prologue, raised to the size reported by the
+	compiler's '.su' files where those are available. Calls are found from the 'jal' instructions and the jumps that
+	leave a function. Calls through function pointers can't be followed and are flagged on the caller instead, unless
+	their targets are supplied in 'extraCallTargets'.
+
+	:param elfFilePath: Path to the linked ELF file.
+	:type elfFilePath: str
+
+	:param stackUsageDirectories: Directories searched recursively for '.su' files.
+	:type stackUsageDirectories: list[str]
+
+	:param extraCallTargets: (caller, callees) pairs of calls the analyzer can't see on its own.
+	:type extraCallTargets: list[tuple[str, tuple[str]]]
+
+	:return: Analyzed functions mapped by name.
+	:rtype: dict[str, list[Function]]
+	"""
+	data, sections = _readElf(elfFilePath)
+	functionsBySection = _readFunctions(data, sections)
+	stackUsage = _readStackUsageFiles(stackUsageDirectories)
+
+	# Overlays share RAM addresses, so a call target may resolve to a function in several sections. Calls within an
+	# overlay prefer their own section; everything else gets every candidate to stay on the safe side.
+	sectionStarts = {
+		sectionIndex: [function.address for function in sectionFunctions]
+		for sectionIndex, sectionFunctions in functionsBySection.items()
+	}
+
+	def _findInSection(sectionIndex, target):
+		sectionFunctions = functionsBySection[sectionIndex]
+		index = bisect.bisect_right(sectionStarts[sectionIndex], target) - 1
+		if index >= 0:
+			function = sectionFunctions[index]
+			if function.address <= target < function.address + function.size:
+				return function
+		return None
+
+	def _resolveTargets(caller, target):
+		local = _findInSection(caller.sectionIndex, target)
+		if local:
+			return [local]
+
+		matches = []
+		for sectionIndex in functionsBySection:
+			function = _findInSection(sectionIndex, target)
+			if function:
+				matches.append(function)
+		return matches
+
+	functionsByName = {}
+
+	for sectionIndex, sectionFunctions in functionsBySection.items():
+		for function in sectionFunctions:
+			_analyzeFunction(function, data, sections[sectionIndex], _resolveTargets)
+
+			if function.name in stackUsage:
+				reportedSize, dynamic = stackUsage[function.name]
+				function.frameSize = max(function.frameSize, reportedSize)
+				function.hasDynamicFrame = dynamic
+
+			functionsByName.setdefault(function.name, []).append(function)
+
+	for caller, callees in extraCallTargets:
+		for callerFunction in functionsByName.get(caller, []):
+			for callee in callees:
+				callerFunction.callees.update(functionsByName.get(callee, []))
+
+			# The listed targets account for the calls through pointers.
+			callerFunction.hasIndirectCalls = False
+
+	return functionsByName
+
+def ComputeStackUsage(functionsByName, name, entryPoints):
+	"""
+	Find the deepest call chain from any of the entry points of a thread stack. Entry points share the stack, so they
+	must never be running at the same time (e.g., the boot code and the thread started once it's done).
+
+	:param functionsByName: Functions returned by AnalyzeProgram().
+	:type functionsByName: dict[str, list[Function]]
+
+	:param name: Name of the thread stack.
+	:type name: str
+
+	:param entryPoints: Names of the functions run on the stack.
+	:type entryPoints: list[str]
+
+	:return: Worst-case stack usage of the thread stack.
+	:rtype: StackReport
+	"""
+	report = StackReport(name)
+
+	# Worst-case usage and deepest callee, memoized per function.
+	worst = {}
+	active = set()
+
+	def _visit(function):
+		key = id(function)
+		if key in worst:
+			return worst[key][0]
+
+		if function.hasIndirectCalls:
+			report.indirectCallers.add(function.name)
+
+		if function.hasDynamicFrame:
+			report.dynamicFunctions.add(function.name)
+
+		active.add(key)
+
+		deepestSize = 0
+		deepestCallee = None
+
+		for callee in function.callees:
+			if id(callee) in active:
+				# Recursion has no static bound; it's reported and the cycle is counted once.
+				report.recursiveFunctions.add(callee.name)
+				continue
+
+			size = _visit(callee)
+			if size > deepestSize:
+				deepestSize = size
+				deepestCallee = callee
+
+		active.discard(key)
+
+		total = function.frameSize + deepestSize
+		worst[key] = (total, deepestCallee)
+		return total
+
+	deepestEntry = None
+
+	for entryPoint in entryPoints:
+		candidates = functionsByName.get(entryPoint)
+		if not candidates:
+			report.missingEntryPoints.append(entryPoint)
+			continue
+
+		for function in candidates:
+			size = _visit(function)
+			if deepestEntry is None or size > report.size:
+				report.size = size
+				deepestEntry = function
+
+	function = deepestEntry
+	while function:
+		report.path.append(f"{function.name} ({function.frameSize})")
+		function = worst[id(function)][1]
+
+	return report
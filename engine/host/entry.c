@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static u8* _UbxHostLoadRom(const char* const filePath, u32* const pOutSize)
+{
+	FILE* const pFile = fopen(filePath, "rb");
+
+	if(!pFile)
+	{
+		return NULL;
+	}
+
+	fseek(pFile, 0, SEEK_END);
+
+	const long fileSize = ftell(pFile);
+
+	fseek(pFile, 0, SEEK_SET);
+
+	u8* const pData = (fileSize > 0) ? (u8*) malloc((size_t) fileSize) : NULL;
+
+	if(pData && fread(pData, 1, (size_t) fileSize, pFile) != (size_t) fileSize)
+	{
+		free(pData);
+		fclose(pFile);
+
+		return NULL;
+	}
+
+	fclose(pFile);
+
+	(*pOutSize) = (u32) fileSize;
+
+	return pData;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+	UbxHostSetDefaults();
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "--rom") == 0 && i + 1 < argc)
+		{
+			const char* const romPath = argv[++i];
+
+			gUbxHost.pRomImage = _UbxHostLoadRom(romPath, &gUbxHost.romSize);
+
+			if(!gUbxHost.pRomImage)
+			{
+				fprintf(stderr, "Failed to load ROM image: %s\n", romPath);
+				return EXIT_FAILURE;
+			}
+		}
+		else if(strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+		{
+			gUbxHost.runSeconds = (u32) strtoul(argv[++i], NULL, 10);
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [--rom <path>] [--seconds <count>]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	UbxHostRun();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "host.h"
+
+#include <gu.h>
+
+#include <math.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_HOST_DEG_TO_RAD (3.14159265358979323846f / 180.0f)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostScaleMtxF(float mf[4][4], const float scale)
+{
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; ++j)
+		{
+			mf[i][j] *= scale;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guMtxIdentF(float mf[4][4])
+{
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; ++j)
+		{
+			mf[i][j] = (i == j) ? 1.0f : 0.0f;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guMtxF2L(float mf[4][4], Mtx* const pMtx)
+{
+	/* The fixed point matrix stores the integer halves of every element first, followed by the fractional halves. */
+	u32* pInt = (u32*) pMtx;
+	u32* pFrac = pInt + 8;
+
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; j += 2)
+		{
+			const u32 e1 = (u32) FTOFIX32(mf[i][j]);
+			const u32 e2 = (u32) FTOFIX32(mf[i][j + 1]);
+
+			*(pInt++) = (e1 & 0xFFFF0000) | (e2 >> 16);
+			*(pFrac++) = (e1 << 16) | (e2 & 0xFFFF);
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guMtxIdent(Mtx* const pMtx)
+{
+	float mf[4][4];
+
+	guMtxIdentF(mf);
+	guMtxF2L(mf, pMtx);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guMtxCatF(float mf[4][4], float nf[4][4], float res[4][4])
+{
+	float temp[4][4];
+
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; ++j)
+		{
+			temp[i][j] = (mf[i][0] * nf[0][j]) + (mf[i][1] * nf[1][j]) + (mf[i][2] * nf[2][j]) + (mf[i][3] * nf[3][j]);
+		}
+	}
+
+	/* Copy through a temporary so the output may alias either input. */
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; ++j)
+		{
+			res[i][j] = temp[i][j];
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guTranslateF(float mf[4][4], const float x, const float y, const float z)
+{
+	guMtxIdentF(mf);
+
+	mf[3][0] = x;
+	mf[3][1] = y;
+	mf[3][2] = z;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guScaleF(float mf[4][4], const float x, const float y, const float z)
+{
+	guMtxIdentF(mf);
+
+	mf[0][0] = x;
+	mf[1][1] = y;
+	mf[2][2] = z;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guRotateF(float mf[4][4], const float angle, float x, float y, float z)
+{
+	const float length = sqrtf((x * x) + (y * y) + (z * z));
+
+	if(length > 0.0f)
+	{
+		x /= length;
+		y /= length;
+		z /= length;
+	}
+
+	const float radians = angle * UBX_HOST_DEG_TO_RAD;
+	const float sine = sinf(radians);
+	const float cosine = cosf(radians);
+	const float t = 1.0f - cosine;
+	const float ab = x * y * t;
+	const float bc = y * z * t;
+	const float ca = z * x * t;
+
+	guMtxIdentF(mf);
+
+	mf[0][0] = (x * x) + (cosine * (1.0f - (x * x)));
+	mf[2][1] = bc - (x * sine);
+	mf[1][2] = bc + (x * sine);
+
+	mf[1][1] = (y * y) + (cosine * (1.0f - (y * y)));
+	mf[2][0] = ca + (y * sine);
+	mf[0][2] = ca - (y * sine);
+
+	mf[2][2] = (z * z) + (cosine * (1.0f - (z * z)));
+	mf[1][0] = ab - (z * sine);
+	mf[0][1] = ab + (z * sine);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guLookAtF(
+	float mf[4][4],
+	const float xEye,
+	const float yEye,
+	const float zEye,
+	const float xAt,
+	const float yAt,
+	const float zAt,
+	float xUp,
+	float yUp,
+	float zUp)
+{
+	float xLook = xAt - xEye;
+	float yLook = yAt - yEye;
+	float zLook = zAt - zEye;
+	float length = -1.0f / sqrtf((xLook * xLook) + (yLook * yLook) + (zLook * zLook));
+
+	xLook *= length;
+	yLook *= length;
+	zLook *= length;
+
+	float xRight = (yUp * zLook) - (zUp * yLook);
+	float yRight = (zUp * xLook) - (xUp * zLook);
+	float zRight = (xUp * yLook) - (yUp * xLook);
+
+	length = 1.0f / sqrtf((xRight * xRight) + (yRight * yRight) + (zRight * zRight));
+
+	xRight *= length;
+	yRight *= length;
+	zRight *= length;
+
+	xUp = (yLook * zRight) - (zLook * yRight);
+	yUp = (zLook * xRight) - (xLook * zRight);
+	zUp = (xLook * yRight) - (yLook * xRight);
+
+	length = 1.0f / sqrtf((xUp * xUp) + (yUp * yUp) + (zUp * zUp));
+
+	xUp *= length;
+	yUp *= length;
+	zUp *= length;
+
+	mf[0][0] = xRight;
+	mf[1][0] = yRight;
+	mf[2][0] = zRight;
+	mf[3][0] = -((xEye * xRight) + (yEye * yRight) + (zEye * zRight));
+
+	mf[0][1] = xUp;
+	mf[1][1] = yUp;
+	mf[2][1] = zUp;
+	mf[3][1] = -((xEye * xUp) + (yEye * yUp) + (zEye * zUp));
+
+	mf[0][2] = xLook;
+	mf[1][2] = yLook;
+	mf[2][2] = zLook;
+	mf[3][2] = -((xEye * xLook) + (yEye * yLook) + (zEye * zLook));
+
+	mf[0][3] = 0.0f;
+	mf[1][3] = 0.0f;
+	mf[2][3] = 0.0f;
+	mf[3][3] = 1.0f;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guPerspectiveF(
+	float mf[4][4],
+	u16* const pPerspNorm,
+	const float fovy,
+	const float aspect,
+	const float nearPlane,
+	const float farPlane,
+	const float scale)
+{
+	const float halfFov = fovy * UBX_HOST_DEG_TO_RAD * 0.5f;
+	const float cotangent = cosf(halfFov) / sinf(halfFov);
+
+	guMtxIdentF(mf);
+
+	mf[0][0] = cotangent / aspect;
+	mf[1][1] = cotangent;
+	mf[2][2] = (nearPlane + farPlane) / (nearPlane - farPlane);
+	mf[2][3] = -1.0f;
+	mf[3][2] = (2.0f * nearPlane * farPlane) / (nearPlane - farPlane);
+	mf[3][3] = 0.0f;
+
+	_UbxHostScaleMtxF(mf, scale);
+
+	if(pPerspNorm)
+	{
+		if(nearPlane + farPlane <= 2.0f)
+		{
+			(*pPerspNorm) = 0xFFFF;
+		}
+		else
+		{
+			const u32 norm = (u32) ((2.0f * 65536.0f) / (nearPlane + farPlane));
+
+			(*pPerspNorm) = (norm > 0) ? (u16) norm : 1;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guPerspective(
+	Mtx* const pMtx,
+	u16* const pPerspNorm,
+	const float fovy,
+	const float aspect,
+	const float nearPlane,
+	const float farPlane,
+	const float scale)
+{
+	float mf[4][4];
+
+	guPerspectiveF(mf, pPerspNorm, fovy, aspect, nearPlane, farPlane, scale);
+	guMtxF2L(mf, pMtx);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guOrthoF(
+	float mf[4][4],
+	const float left,
+	const float right,
+	const float bottom,
+	const float top,
+	const float nearPlane,
+	const float farPlane,
+	const float scale)
+{
+	guMtxIdentF(mf);
+
+	mf[0][0] = 2.0f / (right - left);
+	mf[1][1] = 2.0f / (top - bottom);
+	mf[2][2] = -2.0f / (farPlane - nearPlane);
+	mf[3][0] = -(right + left) / (right - left);
+	mf[3][1] = -(top + bottom) / (top - bottom);
+	mf[3][2] = -(farPlane + nearPlane) / (farPlane - nearPlane);
+	mf[3][3] = 1.0f;
+
+	_UbxHostScaleMtxF(mf, scale);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void guOrtho(
+	Mtx* const pMtx,
+	const float left,
+	const float right,
+	const float bottom,
+	const float top,
+	const float nearPlane,
+	const float farPlane,
+	const float scale)
+{
+	float mf[4][4];
+
+	guOrthoF(mf, left, right, bottom, top, nearPlane, farPlane, scale);
+	guMtxF2L(mf, pMtx);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../ultra_box/lowlevel/env.h"
+
+#include <os_cont.h>
+#include <os_message.h>
+#include <os_thread.h>
+#include <sptask.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_HOST_MAX_THREADS 16
+#define UBX_HOST_EEPROM_SIZE 2048
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Simulated cost model for RCP tasks in CPU counter cycles. A graphics task costs a flat amount plus an amount for
+ * every 64-bit command in its top-level display list; the RDP finishes some time after the RSP does. */
+typedef struct _UbxHostRcpCost
+{
+	u32 gfxBaseCount;
+	u32 gfxCommandCount;
+	u32 rdpTailCount;
+	u32 audioBaseCount;
+} UbxHostRcpCost;
+
+typedef struct _UbxHostData
+{
+	UbxHostRcpCost rcpCost;
+
+	/* Cartridge ROM image read by PI DMAs; reads past the end of it return zeroes. */
+	const u8* pRomImage;
+	u32 romSize;
+
+	/* Exit the process after this many seconds; zero runs forever. */
+	u32 runSeconds;
+
+	/* Input reported for each controller port. Only ports whose bit is set in the pattern are connected. */
+	OSContPad pad[MAXCONTROLLERS];
+	u8 contPattern;
+
+	s32 eepromType;
+	u8 eeprom[UBX_HOST_EEPROM_SIZE];
+
+	/* Hardware state written through the libultra stand-in, kept for inspection by tests. */
+	void* pCurrentFrameBuffer;
+	void* pNextFrameBuffer;
+	f32 viXScale;
+	f32 viYScale;
+	u32 retraceCount;
+	u32 gfxTaskCount;
+	u32 audioTaskCount;
+	u32 yieldCount;
+} UbxHostData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxHostData gUbxHost;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void UbxHostSetDefaults();
+
+/* Run the engine's boot code on the host. This never returns; the process exits once gUbxHost.runSeconds have
+ * passed, or when UbxHostExit() is called. */
+extern __attribute__((noreturn)) void UbxHostRun();
+
+extern __attribute__((noreturn)) void UbxHostExit(int code);
+
+/* Stand-ins for the RCP registers read and written through IO_READ() and IO_WRITE(). */
+extern u32 UbxHostIoRead(u32 addr);
+extern void UbxHostIoWrite(u32 addr, u32 value);
+
+/* Internal to the stand-in. Every libultra thread runs on its own host thread, but only one of them is ever allowed
+ * to run at a time, which keeps the single-CPU priority scheduling that the engine relies on. */
+extern void _UbxHostLock();
+extern void _UbxHostUnlock();
+extern void _UbxHostPostEventLocked(OSEvent event);
+extern void _UbxHostPostMesgLocked(OSMesgQueue* pQueue, OSMesg msg);
+extern void _UbxHostCheckPreemptLocked();
+extern u64 _UbxHostGetTime();
+extern void _UbxHostWaitHardwareLocked(u64 count);
+extern void _UbxHostWakeHardwareLocked();
+extern void _UbxHostStartHardware();
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
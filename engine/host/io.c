@@ -0,0 +1,472 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "host.h"
+
+#include <os.h>
+#include <rcp.h>
+
+#include <stdint.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Number of entries in the libultra VI mode table. */
+#define UBX_HOST_VI_MODE_COUNT 56
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Stack bounds handed out by the linker script on hardware. Host threads have their own stacks, so the tops are only
+ * ever passed through to osCreateThread() and the bottoms only ever hold the guard words of debug builds. */
+u8 _boot_stack_start[16];
+u8 _main_stack_start[16];
+u8 _idle_stack_start[16];
+u8 _loader_stack_start[16];
+u8 _job_stack_start[16];
+u8 _event_stack_start[16];
+u8 _sched_stack_start[16];
+u8 _audio_stack_start[16];
+u8 _trace_stack_start[16];
+u8 _serial_stack_start[16];
+u8 _boot_stack_end[16];
+u8 _main_stack_end[16];
+u8 _idle_stack_end[16];
+u8 _loader_stack_end[16];
+u8 _job_stack_end[16];
+u8 _event_stack_end[16];
+u8 _sched_stack_end[16];
+u8 _audio_stack_end[16];
+u8 _trace_stack_end[16];
+u8 _serial_stack_end[16];
+
+/* The simulated RSP never runs any micro-code, so these only need to exist for the tasks to point at. */
+long long int rspbootTextStart[1], rspbootTextEnd[1];
+long long int gspF3DEX2_xbusTextStart[1], gspF3DEX2_xbusTextEnd[1];
+long long int gspF3DEX2_xbusDataStart[1], gspF3DEX2_xbusDataEnd[1];
+long long int gspF3DEX2_fifoTextStart[1], gspF3DEX2_fifoTextEnd[1];
+long long int gspF3DEX2_fifoDataStart[1], gspF3DEX2_fifoDataEnd[1];
+long long int aspMainTextStart[1], aspMainTextEnd[1];
+long long int aspMainDataStart[1], aspMainDataEnd[1];
+
+OSViMode osViModeTable[UBX_HOST_VI_MODE_COUNT];
+
+u32 osTvType = OS_TV_NTSC;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static OSPiHandle gHostCartRom = { .type = DEVICE_TYPE_CART, .baseAddress = PHYS_TO_K1(PI_DOM1_ADDR2) };
+static OSPiHandle gHostLeoDisk = { .type = DEVICE_TYPE_64DD };
+static OSPiHandle gHostDriveRom = { .type = DEVICE_TYPE_BULK };
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void __osInitialize_common()
+{
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void __osInitialize_isv()
+{
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* The host has no cache to keep coherent with the RCP. */
+void osInvalDCache(void* const pAddr, const s32 size)
+{
+	(void) pAddr;
+	(void) size;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osInvalICache(void* const pAddr, const s32 size)
+{
+	(void) pAddr;
+	(void) size;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osWritebackDCache(void* const pAddr, const s32 size)
+{
+	(void) pAddr;
+	(void) size;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osWritebackDCacheAll()
+{
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u32 osVirtualToPhysical(void* const pAddr)
+{
+	return (u32) (uintptr_t) pAddr;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void* osPhysicalToVirtual(const u32 addr)
+{
+	return (void*) (uintptr_t) addr;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+OSPiHandle* osCartRomInit()
+{
+	return &gHostCartRom;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+OSPiHandle* osLeoDiskInit()
+{
+	return &gHostLeoDisk;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+OSPiHandle* osDriveRomInit()
+{
+	return &gHostDriveRom;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osCreatePiManager(const OSPri priority, OSMesgQueue* const pCmdQueue, OSMesg* const pCmdBuffer, const s32 cmdMsgCount)
+{
+	(void) priority;
+	(void) pCmdQueue;
+	(void) pCmdBuffer;
+	(void) cmdMsgCount;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostReadRom(OSPiHandle* const pHandle, void* const pDest, const u32 devAddr, const u32 size)
+{
+	u8* const pOut = (u8*) pDest;
+	u32 copySize = 0;
+
+	/* Only the cartridge is backed by anything; the disk drive and its ROM read back as zeroes. */
+	if(pHandle == &gHostCartRom && gUbxHost.pRomImage && devAddr < gUbxHost.romSize)
+	{
+		copySize = gUbxHost.romSize - devAddr;
+		copySize = (copySize < size) ? copySize : size;
+
+		memcpy(pOut, gUbxHost.pRomImage + devAddr, copySize);
+	}
+
+	memset(pOut + copySize, 0, size - copySize);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osEPiStartDma(OSPiHandle* const pHandle, OSIoMesg* const pIoMsg, const s32 direction)
+{
+	_UbxHostLock();
+
+	/* ROM can't be written, so writes are simply dropped. The transfer completes right away either way. */
+	if(direction == OS_READ)
+	{
+		_UbxHostReadRom(pHandle, pIoMsg->dramAddr, pIoMsg->devAddr, pIoMsg->size);
+	}
+
+	pIoMsg->piHandle = pHandle;
+
+	_UbxHostPostMesgLocked(pIoMsg->hdr.retQueue, (OSMesg) pIoMsg);
+	_UbxHostUnlock();
+
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osPiStartDma(
+	OSIoMesg* const pIoMsg,
+	const s32 priority,
+	const s32 direction,
+	const u32 devAddr,
+	void* const pDramAddr,
+	const u32 size,
+	OSMesgQueue* const pRetQueue)
+{
+	pIoMsg->hdr.pri = (u8) priority;
+	pIoMsg->hdr.retQueue = pRetQueue;
+	pIoMsg->dramAddr = pDramAddr;
+	pIoMsg->devAddr = devAddr;
+	pIoMsg->size = size;
+
+	return osEPiStartDma(&gHostCartRom, pIoMsg, direction);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostGetContStatus(OSContStatus* const pStatus)
+{
+	for(u32 i = 0; i < MAXCONTROLLERS; ++i)
+	{
+		const u8 connected = (gUbxHost.contPattern >> i) & 0x1;
+
+		pStatus[i].type = connected ? CONT_TYPE_NORMAL : 0;
+		pStatus[i].status = 0;
+		pStatus[i].errno = connected ? 0 : CONT_NO_RESPONSE_ERROR;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Serial transfers finish right away, signaling the SI event just like the hardware does once they are done. */
+static void _UbxHostFinishSerial()
+{
+	_UbxHostLock();
+	_UbxHostPostEventLocked(OS_EVENT_SI);
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osContInit(OSMesgQueue* const pQueue, u8* const pPattern, OSContStatus* const pStatus)
+{
+	(void) pQueue;
+
+	*pPattern = gUbxHost.contPattern;
+	_UbxHostGetContStatus(pStatus);
+
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osContStartQuery(OSMesgQueue* const pQueue)
+{
+	(void) pQueue;
+
+	_UbxHostFinishSerial();
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osContGetQuery(OSContStatus* const pStatus)
+{
+	_UbxHostGetContStatus(pStatus);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osContStartReadData(OSMesgQueue* const pQueue)
+{
+	(void) pQueue;
+
+	_UbxHostFinishSerial();
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osContGetReadData(OSContPad* const pPad)
+{
+	_UbxHostLock();
+
+	for(u32 i = 0; i < MAXCONTROLLERS; ++i)
+	{
+		pPad[i] = gUbxHost.pad[i];
+		pPad[i].errno = ((gUbxHost.contPattern >> i) & 0x1) ? 0 : CONT_NO_RESPONSE_ERROR;
+	}
+
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osEepromProbe(OSMesgQueue* const pQueue)
+{
+	(void) pQueue;
+
+	return gUbxHost.eepromType;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static s32 _UbxHostEepromAccess(const u8 address, u8* const pBuffer, const int size, const u8 write)
+{
+	const u32 maxSize = (gUbxHost.eepromType == EEPROM_TYPE_16K) ? UBX_HOST_EEPROM_SIZE : (UBX_HOST_EEPROM_SIZE / 4);
+	const u32 offset = (u32) address * EEPROM_BLOCK_SIZE;
+
+	if(gUbxHost.eepromType == 0 || size < 0 || offset + (u32) size > maxSize)
+	{
+		return -1;
+	}
+
+	_UbxHostLock();
+
+	if(write)
+	{
+		memcpy(gUbxHost.eeprom + offset, pBuffer, (size_t) size);
+	}
+	else
+	{
+		memcpy(pBuffer, gUbxHost.eeprom + offset, (size_t) size);
+	}
+
+	_UbxHostUnlock();
+
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osEepromRead(OSMesgQueue* const pQueue, const u8 address, u8* const pBuffer)
+{
+	(void) pQueue;
+
+	return _UbxHostEepromAccess(address, pBuffer, EEPROM_BLOCK_SIZE, 0);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osEepromWrite(OSMesgQueue* const pQueue, const u8 address, u8* const pBuffer)
+{
+	(void) pQueue;
+
+	return _UbxHostEepromAccess(address, pBuffer, EEPROM_BLOCK_SIZE, 1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osEepromLongRead(OSMesgQueue* const pQueue, const u8 address, u8* const pBuffer, const int size)
+{
+	(void) pQueue;
+
+	return _UbxHostEepromAccess(address, pBuffer, size, 0);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osEepromLongWrite(OSMesgQueue* const pQueue, const u8 address, u8* const pBuffer, const int size)
+{
+	(void) pQueue;
+
+	return _UbxHostEepromAccess(address, pBuffer, size, 1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Nothing is ever plugged into the controllers, so every accessory call reports a missing pak. */
+s32 osPfsInitPak(OSMesgQueue* const pQueue, OSPfs* const pPfs, const int channel)
+{
+	(void) pQueue;
+	(void) pPfs;
+	(void) channel;
+
+	return PFS_ERR_NOPACK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osPfsReadWriteFile(OSPfs* const pPfs, const s32 fileNo, const u8 flag, const int offset, const int size, u8* const pData)
+{
+	(void) pPfs;
+	(void) fileNo;
+	(void) flag;
+	(void) offset;
+	(void) size;
+	(void) pData;
+
+	return PFS_ERR_NOPACK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osMotorInit(OSMesgQueue* const pQueue, OSPfs* const pPfs, const int channel)
+{
+	(void) pQueue;
+	(void) pPfs;
+	(void) channel;
+
+	return PFS_ERR_NOPACK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef osMotorStart
+s32 __osMotorAccess(OSPfs* const pPfs, const s32 flag)
+{
+	(void) pPfs;
+	(void) flag;
+
+	return PFS_ERR_NOPACK;
+}
+
+#else
+s32 osMotorStart(OSPfs* const pPfs)
+{
+	(void) pPfs;
+
+	return PFS_ERR_NOPACK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osMotorStop(OSPfs* const pPfs)
+{
+	(void) pPfs;
+
+	return PFS_ERR_NOPACK;
+}
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* The AI plays back instantly, so its buffers are always empty. */
+s32 osAiSetFrequency(const u32 frequency)
+{
+	return (s32) frequency;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osAiSetNextBuffer(void* const pBuffer, const u32 size)
+{
+	(void) pBuffer;
+	(void) size;
+
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u32 osAiGetLength()
+{
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u32 osAiGetStatus()
+{
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "host.h"
+
+#include <libaudio.h>
+
+#include <stdint.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_HOST_AL_HEAP_ALIGN 16
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void alHeapInit(ALHeap* const pHeap, u8* const pBase, const s32 length)
+{
+	const u32 padding = (u32) ((UBX_HOST_AL_HEAP_ALIGN - ((uintptr_t) pBase & (UBX_HOST_AL_HEAP_ALIGN - 1))) & (UBX_HOST_AL_HEAP_ALIGN - 1));
+
+	pHeap->base = pBase;
+	pHeap->cur = pBase + padding;
+	pHeap->len = length - (s32) padding;
+	pHeap->count = 0;
+
+	memset(pHeap->cur, 0, (size_t) pHeap->len);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void* alHeapDBAlloc(u8* const pFile, const s32 line, ALHeap* const pHeap, const s32 count, const s32 size)
+{
+	(void) pFile;
+	(void) line;
+
+	const s32 allocSize = ((count * size) + (UBX_HOST_AL_HEAP_ALIGN - 1)) & ~(UBX_HOST_AL_HEAP_ALIGN - 1);
+
+	if(pHeap->cur + allocSize > pHeap->base + pHeap->len)
+	{
+		return NULL;
+	}
+
+	u8* const pOut = pHeap->cur;
+
+	pHeap->cur += allocSize;
+	pHeap->count++;
+
+	return pOut;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* There's no synthesizer on the host; audio frames still produce a task so the scheduler sees the same traffic. */
+void alInit(ALGlobals* const pGlobals, ALSynConfig* const pConfig)
+{
+	(void) pGlobals;
+	(void) pConfig;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void alClose(ALGlobals* const pGlobals)
+{
+	(void) pGlobals;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+Acmd* alAudioFrame(Acmd* const pCmdList, s32* const pCmdLength, s16* const pOutput, const s32 sampleCount)
+{
+	/* The AI plays back instantly, so the output is just silence. */
+	memset(pOutput, 0, (size_t) sampleCount * 2 * sizeof(s16));
+	memset(pCmdList, 0, sizeof(Acmd));
+
+	(*pCmdLength) = 1;
+
+	return pCmdList + 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,735 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "host.h"
+
+#include <os.h>
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_HOST_EVENT_COUNT (OS_EVENT_PRENMI + 1)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxHostThread
+{
+	OSThread* pThread;
+
+	void (*entry)(void*);
+	void* pArg;
+
+	/* Queue this thread is blocked on, either waiting for a message or for room to send one. */
+	OSMesgQueue* pWaitQueue;
+
+	/* Order in which threads of the same priority became runnable. */
+	u32 readyOrder;
+
+	pthread_t handle;
+	pthread_cond_t cond;
+
+	u8 started;
+} UbxHostThread;
+
+typedef struct _UbxHostOs
+{
+	pthread_mutex_t lock;
+
+	/* Signaled whenever a message is posted, for code that blocks outside of any libultra thread. */
+	pthread_cond_t postCond;
+
+	/* Signaled when new work is handed to the simulated hardware; this one waits on the monotonic clock. */
+	pthread_cond_t hardwareCond;
+
+	UbxHostThread thread[UBX_HOST_MAX_THREADS];
+	UbxHostThread* pRunning;
+
+	OSMesgQueue* pEventQueue[UBX_HOST_EVENT_COUNT];
+	OSMesg eventMsg[UBX_HOST_EVENT_COUNT];
+
+	struct timespec startTime;
+	OSTime timeOffset;
+
+	OSIntMask intMask;
+
+	u32 threadCount;
+	u32 readyOrder;
+
+	u8 preemptPending;
+} UbxHostOs;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern __attribute__((noreturn)) void boot();
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxHostData gUbxHost;
+
+static UbxHostOs gHostOs =
+{
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.postCond = PTHREAD_COND_INITIALIZER,
+	.intMask = OS_IM_ALL,
+};
+
+static __thread UbxHostThread* gHostSelf = NULL;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxHostLock()
+{
+	pthread_mutex_lock(&gHostOs.lock);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxHostUnlock()
+{
+	pthread_mutex_unlock(&gHostOs.lock);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UbxHostThread* _UbxHostFindThread(OSThread* const pThread)
+{
+	for(u32 i = 0; i < gHostOs.threadCount; ++i)
+	{
+		if(gHostOs.thread[i].pThread == pThread)
+		{
+			return &gHostOs.thread[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UbxHostThread* _UbxHostPickThreadLocked()
+{
+	UbxHostThread* pBest = NULL;
+
+	for(u32 i = 0; i < gHostOs.threadCount; ++i)
+	{
+		UbxHostThread* const pCandidate = &gHostOs.thread[i];
+		const OSThread* const pThread = pCandidate->pThread;
+
+		/* Idle threads only exist to give the CPU something to spin on. The host can idle on its own, so they are
+		 * never scheduled, which also keeps them from burning a host core. */
+		if(pThread->priority == OS_PRIORITY_IDLE
+			|| (pThread->state != OS_STATE_RUNNABLE && pThread->state != OS_STATE_RUNNING))
+		{
+			continue;
+		}
+
+		if(!pBest || pThread->priority > pBest->pThread->priority)
+		{
+			pBest = pCandidate;
+		}
+		else if(pThread->priority == pBest->pThread->priority)
+		{
+			/* There is no time slicing, so the running thread keeps the CPU over others of the same priority. */
+			if(pBest->pThread->state != OS_STATE_RUNNING
+				&& (pThread->state == OS_STATE_RUNNING || pCandidate->readyOrder < pBest->readyOrder))
+			{
+				pBest = pCandidate;
+			}
+		}
+	}
+
+	return pBest;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostSwitchLocked(UbxHostThread* const pSelf)
+{
+	UbxHostThread* const pNext = _UbxHostPickThreadLocked();
+
+	gHostOs.preemptPending = 0;
+
+	if(pNext != gHostOs.pRunning)
+	{
+		UbxHostThread* const pPrev = gHostOs.pRunning;
+
+		if(pPrev && pPrev->pThread->state == OS_STATE_RUNNING)
+		{
+			pPrev->pThread->state = OS_STATE_RUNNABLE;
+		}
+
+		gHostOs.pRunning = pNext;
+
+		if(pNext)
+		{
+			pNext->pThread->state = OS_STATE_RUNNING;
+			pthread_cond_signal(&pNext->cond);
+		}
+	}
+
+	if(pSelf)
+	{
+		while(gHostOs.pRunning != pSelf)
+		{
+			pthread_cond_wait(&pSelf->cond, &gHostOs.lock);
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostMakeRunnableLocked(UbxHostThread* const pHostThread)
+{
+	pHostThread->pThread->state = OS_STATE_RUNNABLE;
+	pHostThread->pWaitQueue = NULL;
+	pHostThread->readyOrder = ++gHostOs.readyOrder;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Let the highest priority thread run after other threads may have been made runnable. */
+static void _UbxHostRescheduleLocked()
+{
+	if(gHostSelf)
+	{
+		_UbxHostSwitchLocked(gHostSelf);
+	}
+	else if(!gHostOs.pRunning)
+	{
+		_UbxHostSwitchLocked(NULL);
+	}
+	else if(_UbxHostPickThreadLocked() != gHostOs.pRunning)
+	{
+		/* Host threads can't be interrupted, so the running thread gives up the CPU on its next call into libultra. */
+		gHostOs.preemptPending = 1;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxHostCheckPreemptLocked()
+{
+	if(gHostSelf && gHostOs.preemptPending && gHostOs.intMask != OS_IM_NONE)
+	{
+		_UbxHostSwitchLocked(gHostSelf);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostWakeQueueLocked(OSMesgQueue* const pQueue)
+{
+	for(u32 i = 0; i < gHostOs.threadCount; ++i)
+	{
+		UbxHostThread* const pHostThread = &gHostOs.thread[i];
+
+		if(pHostThread->pWaitQueue == pQueue && pHostThread->pThread->state == OS_STATE_WAITING)
+		{
+			_UbxHostMakeRunnableLocked(pHostThread);
+		}
+	}
+
+	pthread_cond_broadcast(&gHostOs.postCond);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostWaitLocked(OSMesgQueue* const pQueue)
+{
+	if(gHostSelf)
+	{
+		gHostSelf->pThread->state = OS_STATE_WAITING;
+		gHostSelf->pWaitQueue = pQueue;
+
+		_UbxHostSwitchLocked(gHostSelf);
+	}
+	else
+	{
+		pthread_cond_wait(&gHostOs.postCond, &gHostOs.lock);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostPushMesgLocked(OSMesgQueue* const pQueue, const OSMesg msg, const u8 jam)
+{
+	if(jam)
+	{
+		pQueue->first = (pQueue->first + pQueue->msgCount - 1) % pQueue->msgCount;
+		pQueue->msg[pQueue->first] = msg;
+	}
+	else
+	{
+		pQueue->msg[(pQueue->first + pQueue->validCount) % pQueue->msgCount] = msg;
+	}
+
+	++pQueue->validCount;
+
+	_UbxHostWakeQueueLocked(pQueue);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxHostPostMesgLocked(OSMesgQueue* const pQueue, const OSMesg msg)
+{
+	/* Like an interrupt handler, the hardware drops the message when the queue is full. */
+	if(pQueue && pQueue->validCount < pQueue->msgCount)
+	{
+		_UbxHostPushMesgLocked(pQueue, msg, 0);
+		_UbxHostRescheduleLocked();
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxHostPostEventLocked(const OSEvent event)
+{
+	if(event < UBX_HOST_EVENT_COUNT)
+	{
+		_UbxHostPostMesgLocked(gHostOs.pEventQueue[event], gHostOs.eventMsg[event]);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u64 _UbxHostGetTime()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	const u64 sec = (u64) (now.tv_sec - gHostOs.startTime.tv_sec);
+	const s64 nsec = (s64) now.tv_nsec - (s64) gHostOs.startTime.tv_nsec;
+
+	return (sec * OS_CPU_COUNTER) + (u64) ((nsec * (s64) OS_CPU_COUNTER) / 1000000000LL) + gHostOs.timeOffset;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void* _UbxHostThreadEntry(void* const pParam)
+{
+	UbxHostThread* const pSelf = (UbxHostThread*) pParam;
+
+	gHostSelf = pSelf;
+
+	_UbxHostLock();
+	while(gHostOs.pRunning != pSelf)
+	{
+		pthread_cond_wait(&pSelf->cond, &gHostOs.lock);
+	}
+	_UbxHostUnlock();
+
+	pSelf->entry(pSelf->pArg);
+
+	/* Returning from the entry point stops the thread for good. */
+	_UbxHostLock();
+	pSelf->pThread->state = OS_STATE_STOPPED;
+	_UbxHostSwitchLocked(NULL);
+	_UbxHostUnlock();
+
+	return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxHostWaitHardwareLocked(const u64 count)
+{
+	const u64 waitNsec = OS_CYCLES_TO_NSEC(count);
+
+	struct timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+	deadline.tv_sec += (time_t) (waitNsec / 1000000000ULL);
+	deadline.tv_nsec += (long) (waitNsec % 1000000000ULL);
+
+	if(deadline.tv_nsec >= 1000000000L)
+	{
+		++deadline.tv_sec;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	pthread_cond_timedwait(&gHostOs.hardwareCond, &gHostOs.lock, &deadline);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxHostWakeHardwareLocked()
+{
+	pthread_cond_signal(&gHostOs.hardwareCond);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxHostSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxHost, 0, sizeof(gUbxHost));
+
+	/* Rough costs of the template's workloads so frames spend a plausible amount of time waiting on the RCP. */
+	gUbxHost.rcpCost.gfxBaseCount = OS_USEC_TO_CYCLES(500);
+	gUbxHost.rcpCost.gfxCommandCount = OS_NSEC_TO_CYCLES(800);
+	gUbxHost.rcpCost.rdpTailCount = OS_USEC_TO_CYCLES(1000);
+	gUbxHost.rcpCost.audioBaseCount = OS_USEC_TO_CYCLES(800);
+
+	/* A single standard controller sitting at rest, and a 4 Kbit EEPROM. */
+	gUbxHost.contPattern = 0x1;
+	gUbxHost.eepromType = EEPROM_TYPE_4K;
+
+	gUbxHost.viXScale = 1.0f;
+	gUbxHost.viYScale = 1.0f;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxHostRun()
+{
+	pthread_condattr_t condAttr;
+	pthread_condattr_init(&condAttr);
+	pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+	pthread_cond_init(&gHostOs.hardwareCond, &condAttr);
+	pthread_condattr_destroy(&condAttr);
+
+	clock_gettime(CLOCK_MONOTONIC, &gHostOs.startTime);
+
+	_UbxHostStartHardware();
+
+	/* The boot code runs outside of any thread just like it does on hardware; it never returns since starting the
+	 * first thread hands the CPU over to it for good. */
+	boot();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxHostExit(const int code)
+{
+	fflush(stdout);
+	fflush(stderr);
+
+	_Exit(code);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osCreateThread(OSThread* const pThread, const OSId id, void (*entry)(void*), void* const pArg, void* const pStack, const OSPri priority)
+{
+	(void) pStack;
+
+	_UbxHostLock();
+
+	UbxHostThread* pHostThread = _UbxHostFindThread(pThread);
+
+	if(!pHostThread)
+	{
+		if(gHostOs.threadCount >= UBX_HOST_MAX_THREADS)
+		{
+			fprintf(stderr, "[host] Too many threads; raise UBX_HOST_MAX_THREADS\n");
+			UbxHostExit(EXIT_FAILURE);
+		}
+
+		pHostThread = &gHostOs.thread[gHostOs.threadCount++];
+		pthread_cond_init(&pHostThread->cond, NULL);
+	}
+
+	memset(pThread, 0, sizeof(OSThread));
+
+	pThread->id = id;
+	pThread->priority = priority;
+	pThread->state = OS_STATE_STOPPED;
+
+	pHostThread->pThread = pThread;
+	pHostThread->entry = entry;
+	pHostThread->pArg = pArg;
+
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osStartThread(OSThread* const pThread)
+{
+	_UbxHostLock();
+
+	UbxHostThread* const pHostThread = _UbxHostFindThread(pThread);
+
+	if(pHostThread && pThread->state == OS_STATE_STOPPED)
+	{
+		_UbxHostMakeRunnableLocked(pHostThread);
+
+		if(!pHostThread->started)
+		{
+			pthread_attr_t attr;
+			pthread_attr_init(&attr);
+			pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+			pHostThread->started = 1;
+			pthread_create(&pHostThread->handle, &attr, _UbxHostThreadEntry, pHostThread);
+
+			pthread_attr_destroy(&attr);
+		}
+	}
+
+	_UbxHostRescheduleLocked();
+
+	if(!gHostSelf)
+	{
+		/* This is the boot code starting its first thread, which it never gets the CPU back from. */
+		for(;;)
+		{
+			pthread_cond_wait(&gHostOs.postCond, &gHostOs.lock);
+		}
+	}
+
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osStopThread(OSThread* pThread)
+{
+	_UbxHostLock();
+
+	if(!pThread && gHostSelf)
+	{
+		pThread = gHostSelf->pThread;
+	}
+
+	if(pThread)
+	{
+		pThread->state = OS_STATE_STOPPED;
+	}
+
+	_UbxHostRescheduleLocked();
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osYieldThread()
+{
+	_UbxHostLock();
+
+	if(gHostSelf)
+	{
+		_UbxHostMakeRunnableLocked(gHostSelf);
+		_UbxHostSwitchLocked(gHostSelf);
+	}
+
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+OSId osGetThreadId(OSThread* const pThread)
+{
+	if(pThread)
+	{
+		return pThread->id;
+	}
+
+	return gHostSelf ? gHostSelf->pThread->id : 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+OSPri osGetThreadPri(OSThread* const pThread)
+{
+	if(pThread)
+	{
+		return pThread->priority;
+	}
+
+	return gHostSelf ? gHostSelf->pThread->priority : 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osSetThreadPri(OSThread* pThread, const OSPri priority)
+{
+	_UbxHostLock();
+
+	if(!pThread && gHostSelf)
+	{
+		pThread = gHostSelf->pThread;
+	}
+
+	if(pThread)
+	{
+		pThread->priority = priority;
+	}
+
+	/* A thread dropping itself to the idle priority never gets the CPU back (see _UbxHostPickThreadLocked()). */
+	_UbxHostRescheduleLocked();
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osCreateMesgQueue(OSMesgQueue* const pQueue, OSMesg* const pMsg, const s32 msgCount)
+{
+	pQueue->mtqueue = NULL;
+	pQueue->fullqueue = NULL;
+	pQueue->validCount = 0;
+	pQueue->first = 0;
+	pQueue->msgCount = msgCount;
+	pQueue->msg = pMsg;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static s32 _UbxHostSendMesg(OSMesgQueue* const pQueue, const OSMesg msg, const s32 flag, const u8 jam)
+{
+	_UbxHostLock();
+	_UbxHostCheckPreemptLocked();
+
+	while(pQueue->validCount >= pQueue->msgCount)
+	{
+		if(flag == OS_MESG_NOBLOCK)
+		{
+			_UbxHostUnlock();
+			return -1;
+		}
+
+		_UbxHostWaitLocked(pQueue);
+	}
+
+	_UbxHostPushMesgLocked(pQueue, msg, jam);
+	_UbxHostRescheduleLocked();
+	_UbxHostUnlock();
+
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osSendMesg(OSMesgQueue* const pQueue, const OSMesg msg, const s32 flag)
+{
+	return _UbxHostSendMesg(pQueue, msg, flag, 0);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osJamMesg(OSMesgQueue* const pQueue, const OSMesg msg, const s32 flag)
+{
+	return _UbxHostSendMesg(pQueue, msg, flag, 1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+s32 osRecvMesg(OSMesgQueue* const pQueue, OSMesg* const pMsg, const s32 flag)
+{
+	_UbxHostLock();
+	_UbxHostCheckPreemptLocked();
+
+	while(pQueue->validCount == 0)
+	{
+		if(flag == OS_MESG_NOBLOCK)
+		{
+			_UbxHostUnlock();
+			return -1;
+		}
+
+		_UbxHostWaitLocked(pQueue);
+	}
+
+	if(pMsg)
+	{
+		*pMsg = pQueue->msg[pQueue->first];
+	}
+
+	pQueue->first = (pQueue->first + 1) % pQueue->msgCount;
+	--pQueue->validCount;
+
+	/* Let any thread blocked on sending to the full queue try again. */
+	_UbxHostWakeQueueLocked(pQueue);
+	_UbxHostRescheduleLocked();
+	_UbxHostUnlock();
+
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osSetEventMesg(const OSEvent event, OSMesgQueue* const pQueue, const OSMesg msg)
+{
+	if(event < UBX_HOST_EVENT_COUNT)
+	{
+		_UbxHostLock();
+
+		gHostOs.pEventQueue[event] = pQueue;
+		gHostOs.eventMsg[event] = msg;
+
+		_UbxHostUnlock();
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+OSIntMask osSetIntMask(const OSIntMask mask)
+{
+	_UbxHostLock();
+
+	const OSIntMask prevMask = gHostOs.intMask;
+	gHostOs.intMask = mask;
+
+	/* Anything that came in while interrupts were disabled is handled as soon as they are enabled again. */
+	_UbxHostCheckPreemptLocked();
+	_UbxHostUnlock();
+
+	return prevMask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u32 osGetCount()
+{
+	return (u32) _UbxHostGetTime();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+OSTime osGetTime()
+{
+	return _UbxHostGetTime();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osSetTime(const OSTime time)
+{
+	gHostOs.timeOffset = 0;
+	gHostOs.timeOffset = time - _UbxHostGetTime();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osSyncPrintf(const char* const fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+
+	fflush(stdout);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
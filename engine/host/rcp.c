@@ -0,0 +1,510 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "host.h"
+
+#include <os.h>
+#include <rcp.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* The RDP clock counter runs at the RCP clock rate, which is 4/3 of the CPU counter rate. */
+#define UBX_HOST_COUNT_TO_RDP_CLOCKS(count) (((count) * 4) / 3)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxHostRcp
+{
+	pthread_t handle;
+
+	OSMesgQueue* pViQueue;
+	OSMesg viMsg;
+	u32 viRetraceCount;
+	u32 viRetraceCounter;
+
+	const OSViMode* pViMode;
+
+	u64 retraceTime;
+	u64 nextRetraceTime;
+
+	/* Task running on the RSP. */
+	OSTask* pSpTask;
+	u64 spStartTime;
+	u64 spDoneTime;
+
+	/* Graphics task that yielded and how much work it has left. */
+	OSTask* pYieldedTask;
+	u64 yieldedRemaining;
+
+	/* Graphics task the RDP is still working on after the RSP finished with it. */
+	OSTask* pDpTask;
+	u64 dpStartTime;
+	u64 dpDoneTime;
+
+	u32 dpcClock;
+	u32 dpcStatus;
+
+	/* Timers counting down on the CPU counter, linked through their next pointers. */
+	OSTimer* pTimerHead;
+
+	u8 yieldRequested;
+	u8 lastTaskYielded;
+} UbxHostRcp;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UbxHostRcp gHostRcp =
+{
+	.viRetraceCount = 1,
+};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostRcpFinishSpLocked(const u64 now)
+{
+	OSTask* const pTask = gHostRcp.pSpTask;
+
+	gHostRcp.pSpTask = NULL;
+	gHostRcp.lastTaskYielded = 0;
+
+	if(pTask->t.type == M_GFXTASK)
+	{
+		if(gHostRcp.yieldRequested && gHostRcp.yieldedRemaining > 0)
+		{
+			gHostRcp.pYieldedTask = pTask;
+			gHostRcp.lastTaskYielded = 1;
+		}
+		else
+		{
+			/* The RDP finishes the last of the commands the RSP sent it a little while after the RSP is done. */
+			gHostRcp.pDpTask = pTask;
+			gHostRcp.dpDoneTime = now + gUbxHost.rcpCost.rdpTailCount;
+
+			++gUbxHost.gfxTaskCount;
+		}
+	}
+	else
+	{
+		++gUbxHost.audioTaskCount;
+	}
+
+	gHostRcp.yieldRequested = 0;
+
+	_UbxHostPostEventLocked(OS_EVENT_SP);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostRcpFinishDpLocked(const u64 now)
+{
+	gHostRcp.dpcClock += (u32) UBX_HOST_COUNT_TO_RDP_CLOCKS(now - gHostRcp.dpStartTime);
+	gHostRcp.pDpTask = NULL;
+
+	_UbxHostPostEventLocked(OS_EVENT_DP);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostRcpRetraceLocked()
+{
+	++gUbxHost.retraceCount;
+
+	/* Swaps only take effect on a retrace. */
+	if(gUbxHost.pNextFrameBuffer)
+	{
+		gUbxHost.pCurrentFrameBuffer = gUbxHost.pNextFrameBuffer;
+	}
+
+	if(gHostRcp.pViQueue && ++gHostRcp.viRetraceCounter >= gHostRcp.viRetraceCount)
+	{
+		gHostRcp.viRetraceCounter = 0;
+		_UbxHostPostMesgLocked(gHostRcp.pViQueue, gHostRcp.viMsg);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxHostRcpExpireTimersLocked(const u64 now)
+{
+	OSTimer** ppTimer = &gHostRcp.pTimerHead;
+
+	while(*ppTimer)
+	{
+		OSTimer* const pTimer = *ppTimer;
+
+		if(now < pTimer->value)
+		{
+			ppTimer = &pTimer->next;
+			continue;
+		}
+
+		if(pTimer->mq)
+		{
+			_UbxHostPostMesgLocked(pTimer->mq, pTimer->msg);
+		}
+
+		if(pTimer->interval > 0)
+		{
+			pTimer->value += pTimer->interval;
+			ppTimer = &pTimer->next;
+		}
+		else
+		{
+			*ppTimer = pTimer->next;
+			pTimer->next = NULL;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void* _UbxHostRcpThread(void* const pParam)
+{
+	(void) pParam;
+
+	const u64 runEndTime = (u64) gUbxHost.runSeconds * OS_CPU_COUNTER;
+
+	_UbxHostLock();
+
+	for(;;)
+	{
+		const u64 now = _UbxHostGetTime();
+
+		if(runEndTime > 0 && now >= runEndTime)
+		{
+			fprintf(
+				stderr,
+				"Host run finished: %u retraces, %u gfx tasks, %u audio tasks, %u yields\n",
+				(unsigned) gUbxHost.retraceCount,
+				(unsigned) gUbxHost.gfxTaskCount,
+				(unsigned) gUbxHost.audioTaskCount,
+				(unsigned) gUbxHost.yieldCount);
+			fflush(stdout);
+
+			UbxHostExit(EXIT_SUCCESS);
+		}
+
+		if(now >= gHostRcp.nextRetraceTime)
+		{
+			gHostRcp.nextRetraceTime += gHostRcp.retraceTime;
+			_UbxHostRcpRetraceLocked();
+		}
+
+		if(gHostRcp.pSpTask && now >= gHostRcp.spDoneTime)
+		{
+			_UbxHostRcpFinishSpLocked(now);
+		}
+
+		if(gHostRcp.pDpTask && now >= gHostRcp.dpDoneTime)
+		{
+			_UbxHostRcpFinishDpLocked(now);
+		}
+
+		_UbxHostRcpExpireTimersLocked(now);
+
+		u64 wakeTime = gHostRcp.nextRetraceTime;
+
+		for(const OSTimer* pTimer = gHostRcp.pTimerHead; pTimer; pTimer = pTimer->next)
+		{
+			if(pTimer->value < wakeTime)
+			{
+				wakeTime = pTimer->value;
+			}
+		}
+
+		if(gHostRcp.pSpTask && gHostRcp.spDoneTime < wakeTime)
+		{
+			wakeTime = gHostRcp.spDoneTime;
+		}
+
+		if(gHostRcp.pDpTask && gHostRcp.dpDoneTime < wakeTime)
+		{
+			wakeTime = gHostRcp.dpDoneTime;
+		}
+
+		if(runEndTime > 0 && runEndTime < wakeTime)
+		{
+			wakeTime = runEndTime;
+		}
+
+		_UbxHostWaitHardwareLocked((wakeTime > now) ? (wakeTime - now) : 0);
+	}
+
+	return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxHostStartHardware()
+{
+	gHostRcp.retraceTime = OS_CPU_COUNTER / ((osTvType == OS_TV_PAL) ? 50 : 60);
+	gHostRcp.nextRetraceTime = gHostRcp.retraceTime;
+
+	pthread_create(&gHostRcp.handle, NULL, _UbxHostRcpThread, NULL);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u32 UbxHostIoRead(const u32 addr)
+{
+	u32 value = 0;
+
+	_UbxHostLock();
+
+	switch(addr)
+	{
+		case DPC_STATUS_REG:
+			value = gHostRcp.dpcStatus;
+			break;
+
+		case DPC_CLOCK_REG:
+			value = gHostRcp.dpcClock & 0xFFFFFF;
+			break;
+
+		default:
+			/* Every other register reads back as zero; the RDP's busy counters aren't simulated. */
+			break;
+	}
+
+	_UbxHostUnlock();
+
+	return value;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxHostIoWrite(const u32 addr, const u32 value)
+{
+	_UbxHostLock();
+
+	if(addr == DPC_STATUS_REG && (value & DPC_CLR_CLOCK_CTR))
+	{
+		gHostRcp.dpcClock = 0;
+	}
+
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osSpTaskLoad(OSTask* const pTask)
+{
+	/* The simulated RSP has nothing to load; the task is costed when it starts. */
+	(void) pTask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osSpTaskStartGo(OSTask* const pTask)
+{
+	_UbxHostLock();
+
+	const u64 now = _UbxHostGetTime();
+	u64 cost;
+
+	if(pTask == gHostRcp.pYieldedTask && (pTask->t.flags & OS_TASK_YIELDED))
+	{
+		/* Resuming a yielded task only costs whatever it had left. */
+		cost = gHostRcp.yieldedRemaining;
+		gHostRcp.pYieldedTask = NULL;
+	}
+	else if(pTask->t.type == M_GFXTASK)
+	{
+		cost = gUbxHost.rcpCost.gfxBaseCount + ((pTask->t.data_size / sizeof(Gfx)) * gUbxHost.rcpCost.gfxCommandCount);
+		gHostRcp.dpStartTime = now;
+	}
+	else
+	{
+		cost = gUbxHost.rcpCost.audioBaseCount;
+	}
+
+	gHostRcp.pSpTask = pTask;
+	gHostRcp.spStartTime = now;
+	gHostRcp.spDoneTime = now + cost;
+	gHostRcp.yieldRequested = 0;
+	gHostRcp.yieldedRemaining = 0;
+
+	_UbxHostWakeHardwareLocked();
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osSpTaskYield()
+{
+	_UbxHostLock();
+
+	const u64 now = _UbxHostGetTime();
+
+	/* A task that is about to finish anyway completes normally instead of yielding. */
+	if(gHostRcp.pSpTask
+		&& gHostRcp.pSpTask->t.type == M_GFXTASK
+		&& !gHostRcp.yieldRequested
+		&& gHostRcp.spDoneTime > now)
+	{
+		gHostRcp.yieldRequested = 1;
+		gHostRcp.yieldedRemaining = gHostRcp.spDoneTime - now;
+		gHostRcp.spDoneTime = now;
+
+		++gUbxHost.yieldCount;
+
+		_UbxHostWakeHardwareLocked();
+	}
+
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+OSYieldResult osSpTaskYielded(OSTask* const pTask)
+{
+	_UbxHostLock();
+
+	const u8 yielded = gHostRcp.lastTaskYielded && gHostRcp.pYieldedTask == pTask;
+
+	if(yielded)
+	{
+		pTask->t.flags |= OS_TASK_YIELDED;
+	}
+	else
+	{
+		pTask->t.flags &= ~OS_TASK_YIELDED;
+	}
+
+	_UbxHostUnlock();
+
+	return yielded;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osCreateViManager(const OSPri priority)
+{
+	(void) priority;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osViSetMode(OSViMode* const pMode)
+{
+	_UbxHostLock();
+	gHostRcp.pViMode = pMode;
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osViSetSpecialFeatures(const u32 features)
+{
+	(void) features;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osViSetEvent(OSMesgQueue* const pQueue, const OSMesg msg, const u32 retraceCount)
+{
+	_UbxHostLock();
+
+	gHostRcp.pViQueue = pQueue;
+	gHostRcp.viMsg = msg;
+	gHostRcp.viRetraceCount = (retraceCount > 0) ? retraceCount : 1;
+	gHostRcp.viRetraceCounter = 0;
+
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osViSwapBuffer(void* const pFrameBuffer)
+{
+	_UbxHostLock();
+	gUbxHost.pNextFrameBuffer = pFrameBuffer;
+	_UbxHostUnlock();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void* osViGetCurrentFramebuffer()
+{
+	return gUbxHost.pCurrentFrameBuffer;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void* osViGetNextFramebuffer()
+{
+	return gUbxHost.pNextFrameBuffer;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osViSetXScale(const f32 scale)
+{
+	gUbxHost.viXScale = scale;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osViSetYScale(const f32 scale)
+{
+	gUbxHost.viYScale = scale;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void osViBlack(const u8 active)
+{
+	(void) active;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int osSetTimer(OSTimer* const pTimer, const OSTime countdown, const OSTime interval, OSMesgQueue* const pQueue, const OSMesg msg)
+{
+	_UbxHostLock();
+
+	/* Setting a timer that's already counting down restarts it. */
+	for(OSTimer** ppTimer = &gHostRcp.pTimerHead; *ppTimer; ppTimer = &(*ppTimer)->next)
+	{
+		if(*ppTimer == pTimer)
+		{
+			*ppTimer = pTimer->next;
+			break;
+		}
+	}
+
+	pTimer->value = _UbxHostGetTime() + ((countdown > 0) ? countdown : interval);
+	pTimer->interval = interval;
+	pTimer->mq = pQueue;
+	pTimer->msg = msg;
+	pTimer->next = gHostRcp.pTimerHead;
+
+	gHostRcp.pTimerHead = pTimer;
+
+	_UbxHostWakeHardwareLocked();
+	_UbxHostUnlock();
+
+	return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
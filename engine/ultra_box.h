@@ -21,10 +21,35 @@
 
 #include "ultra_box/lowlevel/env.h"
 
+#include "ultra_box/lowlevel/arena.h"
+#include "ultra_box/lowlevel/boot.h"
+#include "ultra_box/lowlevel/cache.h"
 #include "ultra_box/lowlevel/device.h"
+#include "ultra_box/lowlevel/event.h"
 #include "ultra_box/lowlevel/gfx.h"
+#include "ultra_box/lowlevel/job.h"
+#include "ultra_box/lowlevel/loader.h"
+#include "ultra_box/lowlevel/overlay.h"
+#include "ultra_box/lowlevel/sched.h"
+#include "ultra_box/lowlevel/serial.h"
 #include "ultra_box/lowlevel/system.h"
 #include "ultra_box/lowlevel/task.h"
+#include "ultra_box/lowlevel/thread.h"
+#include "ultra_box/lowlevel/timing.h"
 #include "ultra_box/lowlevel/video.h"
 
+#include "ultra_box/audio/audio.h"
+
+#include "ultra_box/debug/profiler.h"
+#include "ultra_box/debug/trace.h"
+
+#include "ultra_box/math/fixed.h"
+#include "ultra_box/math/mtx.h"
+#include "ultra_box/math/trig.h"
+
+#include "ultra_box/render/clear.h"
+#include "ultra_box/render/cull.h"
+#include "ultra_box/render/scene.h"
+#include "ultra_box/render/sprite.h"
+
 /*--------------------------------------------------------------------------------------------------------------------*/
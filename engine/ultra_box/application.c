@@ -16,18 +16,32 @@
  * IN THE SOFTWARE.
  */
 
+#include "audio/audio.h"
+
+#include "debug/profiler.h"
+#include "debug/stack.h"
+#include "debug/trace.h"
+
+#include "lowlevel/arena.h"
+#include "lowlevel/cache.h"
 #include "lowlevel/device.h"
+#include "lowlevel/event.h"
+#include "lowlevel/job.h"
+#include "lowlevel/loader.h"
+#include "lowlevel/sched.h"
+#include "lowlevel/serial.h"
 #include "lowlevel/system.h"
+#include "lowlevel/task.h"
+#include "lowlevel/thread.h"
+#include "lowlevel/timing.h"
 #include "lowlevel/video.h"
 
+#include "render/clear.h"
+
 #include <os.h>
 
 #include <stdint.h>
 
-/*--------------------------------------------------------------------------------------------------------------------*/
-
-#define IDLE_THREAD_ID 1
-#define MAIN_THREAD_ID 2
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -47,22 +61,35 @@ extern void OnGameMainLoop(void*);
 
 __attribute__((noreturn)) void idle(void*)
 {
-	/* Initialize the engine components. */
+	/* Initialize the engine components. The event router comes first since the other components subscribe to it. */
+	_UbxEventInitialize();
 	_UbxSystemInitialize();
 	_UbxVideoInitialize();
+	_UbxTimingInitialize();
 	_UbxDeviceInitialize();
+	_UbxArenaInitialize();
+	_UbxLoaderInitialize();
+	_UbxJobInitialize();
+	_UbxSchedInitialize();
+	_UbxAudioInitialize();
+	_UbxSerialInitialize();
+#ifndef _FINALROM
+	_UbxTraceInitialize();
+#endif
 
 	/* Run any startup initialization required by the game. */
 	OnGameInitialize();
 
 	/* Start the main thread. */
-	osCreateThread(&mainThread, MAIN_THREAD_ID, OnGameMainLoop, NULL, _main_stack_end, 10);
+	osCreateThread(&mainThread, UBX_THREAD_ID_MAIN, OnGameMainLoop, NULL, _main_stack_end, UBX_THREAD_PRI_MAIN);
 	osStartThread(&mainThread);
 
 	/* De-prioritize the thread so this becomes the idle thread. */
-	osSetThreadPri(NULL, 0);
+	osSetThreadPri(NULL, UBX_THREAD_PRI_IDLE);
 
-	/* We intentionally spin forever to give this thread time to permanently yield to the main thread. */
+	/* We intentionally spin forever to give this thread time to permanently yield to the main thread. This thread
+	 * can never block since libultra requires at least one runnable thread at all times, so background work is
+	 * handled by the job thread instead, which only runs when every other thread is blocked. */
 	for(;;) {}
 
 	__builtin_unreachable();
@@ -79,15 +106,31 @@ __attribute__((noreturn)) void boot()
 #endif
 
 	/* Fill all global data objects with their default values. */
+	_UbxEventSetDefaults();
 	_UbxSystemSetDefaults();
 	_UbxVideoSetDefaults();
+	_UbxTimingSetDefaults();
 	_UbxDeviceSetDefaults();
+	_UbxArenaSetDefaults();
+	_UbxCacheSetDefaults();
+	_UbxLoaderSetDefaults();
+	_UbxJobSetDefaults();
+	_UbxSchedSetDefaults();
+	_UbxTaskSetDefaults();
+	_UbxAudioSetDefaults();
+	_UbxSerialSetDefaults();
+	_UbxClearSetDefaults();
+#ifndef _FINALROM
+	_UbxStackSetDefaults();
+	_UbxProfilerSetDefaults();
+	_UbxTraceSetDefaults();
+#endif
 
 	/* Handle game-specific initialization that needs to be done at boot-time prior to engine initialization. */
 	OnGameBoot();
 
 	/* Start the thread that will be used for initialization and kicking off the main thread. */
-	osCreateThread(&idleThread, IDLE_THREAD_ID, idle, NULL, _idle_stack_end, 10);
+	osCreateThread(&idleThread, UBX_THREAD_ID_IDLE, idle, NULL, _idle_stack_end, UBX_THREAD_PRI_MAIN);
 	osStartThread(&idleThread);
 
 	__builtin_unreachable();
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "audio.h"
+
+#include "../lowlevel/device.h"
+#include "../lowlevel/event.h"
+#include "../lowlevel/task.h"
+#include "../lowlevel/thread.h"
+
+#include <os_ai.h>
+#include <os_cache.h>
+#include <os_convert.h>
+#include <os_vi.h>
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Additional samples generated each frame beyond what the AI has left so the output never runs dry. */
+#define UBX_AUDIO_EXTRA_SAMPLE_COUNT 80
+
+/* Size of a single stereo 16-bit sample frame in bytes. */
+#define UBX_AUDIO_SAMPLE_SIZE 4
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxAudioData gUbxAudio;
+
+extern u8 _audio_stack_end[];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxAudioDmaTouch(UbxAudioDmaBuffer* const pBuffer)
+{
+	pBuffer->lastFrame = gUbxAudio.frameIndex;
+
+	if(gUbxAudio.pDmaHead == pBuffer)
+	{
+		return;
+	}
+
+	/* Unlink the buffer ... */
+	pBuffer->pPrev->pNext = pBuffer->pNext;
+
+	if(pBuffer->pNext)
+	{
+		pBuffer->pNext->pPrev = pBuffer->pPrev;
+	}
+	else
+	{
+		gUbxAudio.pDmaTail = pBuffer->pPrev;
+	}
+
+	/* ... and move it to the front of the list as the most recently used. */
+	pBuffer->pPrev = NULL;
+	pBuffer->pNext = gUbxAudio.pDmaHead;
+
+	gUbxAudio.pDmaHead->pPrev = pBuffer;
+	gUbxAudio.pDmaHead = pBuffer;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static s32 _UbxAudioDmaCallback(const s32 addr, const s32 len, void* const pState)
+{
+	(void) pState;
+
+	const u32 romAddr = (u32) addr;
+	const u32 romEnd = romAddr + (u32) len;
+
+	/* Look for a buffer that already holds the requested data. */
+	for(UbxAudioDmaBuffer* pBuffer = gUbxAudio.pDmaHead; pBuffer; pBuffer = pBuffer->pNext)
+	{
+		if(romAddr >= pBuffer->romAddr && romEnd <= pBuffer->romAddr + gUbxAudio.dmaBufferSize)
+		{
+			_UbxAudioDmaTouch(pBuffer);
+			return (s32) osVirtualToPhysical(pBuffer->pData + (romAddr - pBuffer->romAddr));
+		}
+	}
+
+	/* Evict the least recently used buffer. Buffers referenced earlier this frame are still needed by the task being
+	 * built, so when even the oldest one was used this frame, the cache is too small for the number of voices playing.
+	 * The request then gets whatever buffer already holds the start of the data, or failing that, the newest one. The
+	 * voice plays some wrong samples for a frame, but no sample data the command list uses is overwritten, and the
+	 * number of DMAs in flight can never be more than there are buffers and replies the queue can hold. */
+	UbxAudioDmaBuffer* pBuffer = gUbxAudio.pDmaTail;
+
+	if(pBuffer->lastFrame == gUbxAudio.frameIndex || gUbxAudio.dmaPendingCount >= UBX_AUDIO_MAX_DMA_BUFFER_COUNT)
+	{
+		++gUbxAudio.dmaOverflowCount;
+
+		UbxAudioDmaBuffer* pNearest = gUbxAudio.pDmaHead;
+		u32 offset = 0;
+
+		for(pBuffer = gUbxAudio.pDmaHead; pBuffer; pBuffer = pBuffer->pNext)
+		{
+			if(romAddr >= pBuffer->romAddr && romAddr < pBuffer->romAddr + gUbxAudio.dmaBufferSize)
+			{
+				pNearest = pBuffer;
+				offset = romAddr - pBuffer->romAddr;
+				break;
+			}
+		}
+
+		return (s32) osVirtualToPhysical(pNearest->pData + offset);
+	}
+
+	++gUbxAudio.dmaMissCount;
+
+	/* The PI can only transfer from 2-byte aligned ROM addresses. */
+	pBuffer->romAddr = romAddr & ~0x1;
+	_UbxAudioDmaTouch(pBuffer);
+
+	OSIoMesg* const pIoMsg = &gUbxAudio.dmaIoMsg[pBuffer - gUbxAudio.dmaBuffer];
+
+	pIoMsg->hdr.pri = OS_MESG_PRI_HIGH;
+	pIoMsg->hdr.retQueue = &gUbxAudio.dmaMsgQueue;
+	pIoMsg->dramAddr = pBuffer->pData;
+	pIoMsg->devAddr = pBuffer->romAddr;
+	pIoMsg->size = (u32) gUbxAudio.dmaBufferSize;
+
+	osEPiStartDma(gUbxDevice.pCartRom, pIoMsg, OS_READ);
+	++gUbxAudio.dmaPendingCount;
+
+	return (s32) osVirtualToPhysical(pBuffer->pData + (romAddr - pBuffer->romAddr));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static ALDMAproc _UbxAudioDmaNew(void* const pState)
+{
+	(void) pState;
+
+	return _UbxAudioDmaCallback;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxAudioThread(void*)
+{
+	u32 cmdIndex = 0;
+	u32 outputIndex = 0;
+
+	for(;;)
+	{
+		/* Audio is generated once per retrace. */
+		osRecvMesg(&gUbxAudio.retraceMsgQueue, NULL, OS_MESG_BLOCK);
+
+		if(gUbxAudio.pendingOutputIndex >= 0)
+		{
+			const u32 pendingCmdIndex = (cmdIndex + UBX_AUDIO_CMD_BUFFER_COUNT - 1) % UBX_AUDIO_CMD_BUFFER_COUNT;
+
+			/* Wait for last frame's task, then queue its output behind whatever the AI is already playing. The audio
+			 * task interrupts any graphics task in its way, so this wait is short. With yielding disabled in the
+			 * scheduler, the wait lasts until the graphics task ends, and one running longer than the spare samples
+			 * in the AI will make it run dry. */
+			UbxSchedWait(&gUbxAudio.schedTask[pendingCmdIndex]);
+
+			/* The AI only holds two buffers. When both are still queued, there's more than enough audio to play, so
+			 * hold on to the output and try again on the next retrace rather than generating another frame. */
+			if(osAiSetNextBuffer(gUbxAudio.pOutputBuffer[gUbxAudio.pendingOutputIndex], gUbxAudio.pendingOutputSize) != 0)
+			{
+				++gUbxAudio.aiBusyCount;
+				continue;
+			}
+
+			gUbxAudio.pendingOutputIndex = -1;
+		}
+
+		/* Only generate enough samples to top the AI back up to one frame's worth plus a little extra. */
+		const u32 samplesLeft = osAiGetLength() / UBX_AUDIO_SAMPLE_SIZE;
+		s32 sampleCount = (s32) (gUbxAudio.frameSampleCount + UBX_AUDIO_EXTRA_SAMPLE_COUNT) - (s32) samplesLeft;
+
+		sampleCount &= ~0xF;
+
+		if(sampleCount < (s32) gUbxAudio.minFrameSampleCount)
+		{
+			sampleCount = (s32) gUbxAudio.minFrameSampleCount;
+		}
+		else if(sampleCount > (s32) gUbxAudio.maxFrameSampleCount)
+		{
+			sampleCount = (s32) gUbxAudio.maxFrameSampleCount;
+		}
+
+		++gUbxAudio.frameIndex;
+
+		/* Build the audio command list; this is where the synthesizer requests sample data through the DMA callback. */
+		Acmd* const pCmdStart = gUbxAudio.pCmdBuffer[cmdIndex];
+		s32 cmdCount = 0;
+
+		Acmd* const pCmdEnd = alAudioFrame(
+			pCmdStart,
+			&cmdCount,
+			(s16*) osVirtualToPhysical(gUbxAudio.pOutputBuffer[outputIndex]),
+			sampleCount);
+
+		/* Every sample DMA has to land before the RSP reads from the buffers. */
+		for(; gUbxAudio.dmaPendingCount > 0; --gUbxAudio.dmaPendingCount)
+		{
+			osRecvMesg(&gUbxAudio.dmaMsgQueue, NULL, OS_MESG_BLOCK);
+		}
+
+		if(cmdCount == 0)
+		{
+			continue;
+		}
+
+		/* The cache writeback tracker belongs to the main thread, so the command list is written back directly. */
+		osWritebackDCache(pCmdStart, (s32) ((u8*) pCmdEnd - (u8*) pCmdStart));
+
+		OSTask* const pTask = &gUbxAudio.task[cmdIndex];
+		UbxSchedTask* const pSchedTask = &gUbxAudio.schedTask[cmdIndex];
+
+		UBX_TASK_SET_DATA(pTask, pCmdStart, pCmdEnd);
+
+		UbxSchedInitTask(pSchedTask, pTask);
+		pSchedTask->pDoneQueue = &gUbxAudio.taskMsgQueue;
+
+		UbxSchedSubmit(pSchedTask);
+
+		gUbxAudio.pendingOutputIndex = (s32) outputIndex;
+		gUbxAudio.pendingOutputSize = (u32) sampleCount * UBX_AUDIO_SAMPLE_SIZE;
+
+		cmdIndex = (cmdIndex + 1) % UBX_AUDIO_CMD_BUFFER_COUNT;
+		outputIndex = (outputIndex + 1) % UBX_AUDIO_OUTPUT_BUFFER_COUNT;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxAudioSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxAudio, 0, sizeof(gUbxAudio));
+
+	/* Audio stays disabled until the game provides a heap for it. */
+	gUbxAudio.pHeapBuffer = NULL;
+	gUbxAudio.heapSize = 0;
+
+	gUbxAudio.cmdBufferLength = 0x1000;
+	gUbxAudio.dmaBufferCount = 32;
+	gUbxAudio.dmaBufferSize = 0x400;
+
+	gUbxAudio.outputRate = 32000;
+	gUbxAudio.maxVoices = 16;
+	gUbxAudio.maxUpdates = 64;
+
+	gUbxAudio.fxType = AL_FX_NONE;
+
+	gUbxAudio.threadPriority = UBX_THREAD_PRI_AUDIO;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxAudioInitialize()
+{
+	if(!gUbxAudio.pHeapBuffer || gUbxAudio.heapSize == 0)
+	{
+		return;
+	}
+
+	if(gUbxAudio.dmaBufferCount == 0 || gUbxAudio.dmaBufferCount > UBX_AUDIO_MAX_DMA_BUFFER_COUNT)
+	{
+		gUbxAudio.dmaBufferCount = UBX_AUDIO_MAX_DMA_BUFFER_COUNT;
+	}
+
+	alHeapInit(&gUbxAudio.heap, gUbxAudio.pHeapBuffer, (s32) gUbxAudio.heapSize);
+
+	/* Determine how many samples make up a frame at the rate the AI is actually able to run at. */
+	const u32 actualRate = (u32) osAiSetFrequency(gUbxAudio.outputRate);
+	const u32 retraceRate = (osTvType == OS_TV_PAL) ? 50 : 60;
+
+	gUbxAudio.outputRate = actualRate;
+	gUbxAudio.frameSampleCount = ((actualRate + retraceRate - 1) / retraceRate + 0xF) & ~0xF;
+	gUbxAudio.minFrameSampleCount = gUbxAudio.frameSampleCount - UBX_AUDIO_EXTRA_SAMPLE_COUNT;
+	gUbxAudio.maxFrameSampleCount = gUbxAudio.frameSampleCount + UBX_AUDIO_EXTRA_SAMPLE_COUNT;
+	gUbxAudio.minFrameSampleCount &= ~0xF;
+	gUbxAudio.maxFrameSampleCount &= ~0xF;
+
+	/* Allocate the sample cache, linking every buffer into the LRU list. */
+	for(size_t i = 0; i < gUbxAudio.dmaBufferCount; ++i)
+	{
+		UbxAudioDmaBuffer* const pBuffer = &gUbxAudio.dmaBuffer[i];
+
+		pBuffer->pData = alHeapAlloc(&gUbxAudio.heap, 1, (s32) gUbxAudio.dmaBufferSize);
+		pBuffer->romAddr = 0xFFFFFFFF - (u32) gUbxAudio.dmaBufferSize;
+		pBuffer->lastFrame = 0;
+		pBuffer->pPrev = (i > 0) ? &gUbxAudio.dmaBuffer[i - 1] : NULL;
+		pBuffer->pNext = (i + 1 < gUbxAudio.dmaBufferCount) ? &gUbxAudio.dmaBuffer[i + 1] : NULL;
+	}
+
+	gUbxAudio.pDmaHead = &gUbxAudio.dmaBuffer[0];
+	gUbxAudio.pDmaTail = &gUbxAudio.dmaBuffer[gUbxAudio.dmaBufferCount - 1];
+
+	/* Allocate the command lists and the output buffers. */
+	for(size_t i = 0; i < UBX_AUDIO_CMD_BUFFER_COUNT; ++i)
+	{
+		gUbxAudio.pCmdBuffer[i] = alHeapAlloc(&gUbxAudio.heap, 1, (s32) (gUbxAudio.cmdBufferLength * sizeof(Acmd)));
+
+		OSTask* const pTask = &gUbxAudio.task[i];
+		memset(pTask, 0, sizeof(OSTask));
+
+		pTask->t.type = M_AUDTASK;
+
+		UBX_TASK_SET_BOOT_UCODE(pTask, (u64*) rspbootTextStart, (u64*) rspbootTextEnd);
+		UBX_TASK_SET_RSP_UCODE(pTask, (u64*) aspMainTextStart, (u64*) aspMainTextEnd);
+		UBX_TASK_SET_RSP_UCODE_DATA(pTask, (u64*) aspMainDataStart, (u64*) aspMainDataEnd);
+	}
+
+	for(size_t i = 0; i < UBX_AUDIO_OUTPUT_BUFFER_COUNT; ++i)
+	{
+		gUbxAudio.pOutputBuffer[i] = alHeapAlloc(&gUbxAudio.heap, 1, (s32) (gUbxAudio.maxFrameSampleCount * UBX_AUDIO_SAMPLE_SIZE));
+	}
+
+	/* Initialize the synthesizer. */
+	ALSynConfig config;
+	memset(&config, 0, sizeof(config));
+
+	config.maxVVoices = (s32) gUbxAudio.maxVoices;
+	config.maxPVoices = (s32) gUbxAudio.maxVoices;
+	config.maxUpdates = (s32) gUbxAudio.maxUpdates;
+	config.maxFXbusses = 1;
+	config.dmaproc = _UbxAudioDmaNew;
+	config.heap = &gUbxAudio.heap;
+	config.outputRate = (s32) actualRate;
+	config.fxType = gUbxAudio.fxType;
+	config.params = NULL;
+
+	alInit(&gUbxAudio.globals, &config);
+
+	gUbxAudio.pendingOutputIndex = -1;
+
+	osCreateMesgQueue(&gUbxAudio.retraceMsgQueue, gUbxAudio.retraceMsg, 2);
+	osCreateMesgQueue(&gUbxAudio.taskMsgQueue, &gUbxAudio.taskMsg, 1);
+	osCreateMesgQueue(&gUbxAudio.dmaMsgQueue, gUbxAudio.dmaMsg, UBX_AUDIO_MAX_DMA_BUFFER_COUNT);
+
+	UbxEventSubscribe(&gUbxAudio.retraceMsgQueue, UBX_EVENT_MASK(UBX_EVENT_VI));
+
+	/* Start the audio thread. */
+	osCreateThread(&gUbxAudio.thread, UBX_THREAD_ID_AUDIO, _UbxAudioThread, NULL, _audio_stack_end, gUbxAudio.threadPriority);
+	osStartThread(&gUbxAudio.thread);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/env.h"
+#include "../lowlevel/sched.h"
+
+#include <libaudio.h>
+#include <os_message.h>
+#include <os_pi.h>
+#include <os_thread.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_AUDIO_OUTPUT_BUFFER_COUNT  3
+#define UBX_AUDIO_CMD_BUFFER_COUNT     2
+#define UBX_AUDIO_MAX_DMA_BUFFER_COUNT 64
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxAudioDmaBuffer UbxAudioDmaBuffer;
+
+struct _UbxAudioDmaBuffer
+{
+	UbxAudioDmaBuffer* pPrev;
+	UbxAudioDmaBuffer* pNext;
+
+	u8* pData;
+
+	u32 romAddr;
+	u32 lastFrame;
+};
+
+typedef struct _UbxAudioData
+{
+	OSThread thread;
+
+	OSMesgQueue retraceMsgQueue;
+	OSMesg retraceMsg[2];
+
+	OSMesgQueue taskMsgQueue;
+	OSMesg taskMsg;
+
+	OSMesgQueue dmaMsgQueue;
+	OSMesg dmaMsg[UBX_AUDIO_MAX_DMA_BUFFER_COUNT];
+
+	OSIoMesg dmaIoMsg[UBX_AUDIO_MAX_DMA_BUFFER_COUNT];
+
+	ALHeap heap;
+	ALGlobals globals;
+
+	OSTask task[UBX_AUDIO_CMD_BUFFER_COUNT];
+	UbxSchedTask schedTask[UBX_AUDIO_CMD_BUFFER_COUNT];
+
+	Acmd* pCmdBuffer[UBX_AUDIO_CMD_BUFFER_COUNT];
+	s16* pOutputBuffer[UBX_AUDIO_OUTPUT_BUFFER_COUNT];
+
+	UbxAudioDmaBuffer dmaBuffer[UBX_AUDIO_MAX_DMA_BUFFER_COUNT];
+	UbxAudioDmaBuffer* pDmaHead;
+	UbxAudioDmaBuffer* pDmaTail;
+
+	u8* pHeapBuffer;
+
+	size_t heapSize;
+	size_t cmdBufferLength;
+	size_t dmaBufferCount;
+	size_t dmaBufferSize;
+
+	u32 outputRate;
+	u32 maxVoices;
+	u32 maxUpdates;
+
+	ALFxId fxType;
+
+	u32 frameSampleCount;
+	u32 minFrameSampleCount;
+	u32 maxFrameSampleCount;
+
+	u32 frameIndex;
+	u32 dmaPendingCount;
+	u32 dmaMissCount;
+	u32 dmaOverflowCount;
+	u32 aiBusyCount;
+
+	s32 pendingOutputIndex;
+	u32 pendingOutputSize;
+
+	OSPri threadPriority;
+} UbxAudioData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxAudioData gUbxAudio;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxAudioSetDefaults();
+extern void _UbxAudioInitialize();
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "profiler.h"
+
+#ifndef _FINALROM
+
+#include "trace.h"
+
+#include "../lowlevel/gfx.h"
+
+#include <os_exception.h>
+#include <os_time.h>
+#include <os_vi.h>
+#include <rcp.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_PROFILER_HUD_WIDTH         256
+#define UBX_PROFILER_HUD_BAR_HEIGHT    4
+#define UBX_PROFILER_HUD_BAR_SPACING   2
+#define UBX_PROFILER_HUD_GRAPH_HEIGHT  32
+#define UBX_PROFILER_HUD_COLUMN_WIDTH  (UBX_PROFILER_HUD_WIDTH / UBX_PROFILER_HISTORY_LENGTH)
+
+/* The RDP counters tick at the RCP clock (62.5 MHz) while the CPU counter ticks at 46.875 MHz. */
+#define UBX_PROFILER_RCP_TO_CPU_CYCLES(c) (((c) * 3) / 4)
+
+#define UBX_PROFILER_FILL_COLOR(r, g, b) ((GPACK_RGBA5551(r, g, b, 1) << 16) | GPACK_RGBA5551(r, g, b, 1))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxProfilerData gUbxProfiler;
+
+static const u32 gZoneColor[UBX_PROFILER_MAX_ZONES] =
+{
+	UBX_PROFILER_FILL_COLOR(255, 96, 96),
+	UBX_PROFILER_FILL_COLOR(96, 255, 96),
+	UBX_PROFILER_FILL_COLOR(96, 96, 255),
+	UBX_PROFILER_FILL_COLOR(255, 255, 96),
+	UBX_PROFILER_FILL_COLOR(255, 96, 255),
+	UBX_PROFILER_FILL_COLOR(96, 255, 255),
+	UBX_PROFILER_FILL_COLOR(255, 160, 64),
+	UBX_PROFILER_FILL_COLOR(160, 96, 255),
+};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static s32 _UbxProfilerScale(const u32 cycles, const u32 frameBudget)
+{
+	/* The full width of the overlay covers two frames. */
+	const u64 width = ((u64) cycles * (UBX_PROFILER_HUD_WIDTH / 2)) / frameBudget;
+
+	return (width > UBX_PROFILER_HUD_WIDTH) ? UBX_PROFILER_HUD_WIDTH : (s32) width;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxProfilerFillRect(const s32 x, const s32 y, const s32 width, const s32 height, const u32 color)
+{
+	if(width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	UBX_GFX_SET_FILL_COLOR(color);
+	gDPFillRectangle(UBX_GFX_CMD_NEXT, x, y, x + width - 1, y + height - 1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxProfilerSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxProfiler, 0, sizeof(gUbxProfiler));
+
+	gUbxProfiler.enableHud = 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxProfilerOnRspStart(const OSTask* const pTask)
+{
+	(void) pTask;
+
+	gUbxProfiler.rspStart = osGetCount();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxProfilerOnRspDone(const OSTask* const pTask)
+{
+	const u32 cycles = osGetCount() - gUbxProfiler.rspStart;
+
+	/* Yielded tasks are counted in pieces, so each frame only sees the time the task actually spent on the RSP. */
+	if(pTask->t.type == M_AUDTASK)
+	{
+		gUbxProfiler.current.rspAudioCycles += cycles;
+	}
+	else
+	{
+		gUbxProfiler.current.rspGfxCycles += cycles;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxProfilerOnRdpStart()
+{
+	/* The counters are only 24 bits wide, so they're cleared for every task rather than once per frame. */
+	IO_WRITE(DPC_STATUS_REG, DPC_CLR_CLOCK_CTR | DPC_CLR_CMD_CTR | DPC_CLR_PIPE_CTR | DPC_CLR_TMEM_CTR);
+
+	gUbxProfiler.rdpStart = osGetCount();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxProfilerOnRdpDone()
+{
+	gUbxProfiler.current.rdpCycles += osGetCount() - gUbxProfiler.rdpStart;
+
+	gUbxProfiler.current.rdpClock += IO_READ(DPC_CLOCK_REG) & 0xFFFFFF;
+	gUbxProfiler.current.rdpBufBusy += IO_READ(DPC_BUFBUSY_REG) & 0xFFFFFF;
+	gUbxProfiler.current.rdpPipeBusy += IO_READ(DPC_PIPEBUSY_REG) & 0xFFFFFF;
+	gUbxProfiler.current.rdpTmemBusy += IO_READ(DPC_TMEM_REG) & 0xFFFFFF;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxProfilerNewFrame()
+{
+	const u32 now = osGetCount();
+
+	/* The scheduler thread writes the RCP timings, so keep it out while the frame is swapped. */
+	const OSIntMask prevIntMask = osSetIntMask(OS_IM_NONE);
+
+	if(gUbxProfiler.frameCount > 0)
+	{
+		gUbxProfiler.current.frameCycles = now - gUbxProfiler.frameStart;
+		gUbxProfiler.historyIndex = (gUbxProfiler.historyIndex + 1) % UBX_PROFILER_HISTORY_LENGTH;
+		gUbxProfiler.history[gUbxProfiler.historyIndex] = gUbxProfiler.current;
+	}
+
+	memset(&gUbxProfiler.current, 0, sizeof(UbxProfilerFrame));
+
+	osSetIntMask(prevIntMask);
+
+	gUbxProfiler.frameStart = now;
+	++gUbxProfiler.frameCount;
+
+	UBX_TRACE_FRAME();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxProfilerZoneBegin(const u32 zone)
+{
+	if(zone < UBX_PROFILER_MAX_ZONES)
+	{
+		gUbxProfiler.zoneStart[zone] = osGetCount();
+	}
+
+	UBX_TRACE_ZONE_BEGIN(zone);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxProfilerZoneEnd(const u32 zone)
+{
+	if(zone < UBX_PROFILER_MAX_ZONES)
+	{
+		gUbxProfiler.current.zoneCycles[zone] += osGetCount() - gUbxProfiler.zoneStart[zone];
+	}
+
+	UBX_TRACE_ZONE_END(zone);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxProfilerDrawHud(const s32 x, s32 y)
+{
+	if(!gUbxProfiler.enableHud)
+	{
+		return;
+	}
+
+	const UbxProfilerFrame* const pFrame = UbxProfilerGetFrame(0);
+	const u32 frameBudget = OS_CPU_COUNTER / ((osTvType == OS_TV_PAL) ? 50 : 60);
+	const s32 top = y;
+
+	/* The fill mode goes through the state tracker so any tracked state set after the HUD is compared against it. */
+	UBX_GFX_SET_CYCLE_TYPE(G_CYC_FILL);
+	UBX_GFX_SET_RENDER_MODE(G_RM_NOOP, G_RM_NOOP2);
+
+	/* CPU zones, stacked in zone order. */
+	{
+		s32 offset = 0;
+
+		for(u32 i = 0; i < UBX_PROFILER_MAX_ZONES; ++i)
+		{
+			const s32 width = _UbxProfilerScale(pFrame->zoneCycles[i], frameBudget);
+
+			_UbxProfilerFillRect(x + offset, y, width, UBX_PROFILER_HUD_BAR_HEIGHT, gZoneColor[i]);
+			offset += width;
+		}
+
+		y += UBX_PROFILER_HUD_BAR_HEIGHT + UBX_PROFILER_HUD_BAR_SPACING;
+	}
+
+	/* RSP time split between audio and graphics. */
+	{
+		const s32 audioWidth = _UbxProfilerScale(pFrame->rspAudioCycles, frameBudget);
+		const s32 gfxWidth = _UbxProfilerScale(pFrame->rspGfxCycles, frameBudget);
+
+		_UbxProfilerFillRect(x, y, audioWidth, UBX_PROFILER_HUD_BAR_HEIGHT, UBX_PROFILER_FILL_COLOR(255, 255, 96));
+		_UbxProfilerFillRect(x + audioWidth, y, gfxWidth, UBX_PROFILER_HUD_BAR_HEIGHT, UBX_PROFILER_FILL_COLOR(96, 255, 96));
+
+		y += UBX_PROFILER_HUD_BAR_HEIGHT + UBX_PROFILER_HUD_BAR_SPACING;
+	}
+
+	/* RDP wall time with the pipe and TMEM busy counters underneath it. */
+	{
+		const u32 rdpCounter[] =
+		{
+			pFrame->rdpCycles,
+			UBX_PROFILER_RCP_TO_CPU_CYCLES(pFrame->rdpPipeBusy),
+			UBX_PROFILER_RCP_TO_CPU_CYCLES(pFrame->rdpTmemBusy),
+		};
+
+		for(u32 i = 0; i < sizeof(rdpCounter) / sizeof(rdpCounter[0]); ++i)
+		{
+			const s32 width = _UbxProfilerScale(rdpCounter[i], frameBudget);
+
+			_UbxProfilerFillRect(x, y, width, UBX_PROFILER_HUD_BAR_HEIGHT, UBX_PROFILER_FILL_COLOR(255, 96 + (i * 64), 96));
+			y += UBX_PROFILER_HUD_BAR_HEIGHT + UBX_PROFILER_HUD_BAR_SPACING;
+		}
+	}
+
+	/* Frame budget marker across all of the bars. */
+	_UbxProfilerFillRect(x + (UBX_PROFILER_HUD_WIDTH / 2), top, 1, y - top, UBX_PROFILER_FILL_COLOR(255, 255, 255));
+
+	/* Frame time history graph, oldest frame on the left. */
+	{
+		const s32 bottom = y + UBX_PROFILER_HUD_GRAPH_HEIGHT;
+
+		for(u32 i = 0; i < UBX_PROFILER_HISTORY_LENGTH; ++i)
+		{
+			const u32 frameCycles = UbxProfilerGetFrame(UBX_PROFILER_HISTORY_LENGTH - 1 - i)->frameCycles;
+			const s32 height = (_UbxProfilerScale(frameCycles, frameBudget) * UBX_PROFILER_HUD_GRAPH_HEIGHT) / UBX_PROFILER_HUD_WIDTH;
+			const u32 color = (frameCycles > frameBudget) ? UBX_PROFILER_FILL_COLOR(255, 96, 96) : UBX_PROFILER_FILL_COLOR(96, 255, 96);
+
+			_UbxProfilerFillRect(x + (i * UBX_PROFILER_HUD_COLUMN_WIDTH), bottom - height, UBX_PROFILER_HUD_COLUMN_WIDTH - 1, height, color);
+		}
+
+		_UbxProfilerFillRect(x, y + (UBX_PROFILER_HUD_GRAPH_HEIGHT / 2), UBX_PROFILER_HUD_WIDTH, 1, UBX_PROFILER_FILL_COLOR(255, 255, 255));
+	}
+
+	UbxGfxPipeSync();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
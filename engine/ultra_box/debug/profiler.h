@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/env.h"
+
+#include <sptask.h>
+#include <ultratypes.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_PROFILER_MAX_ZONES      8
+#define UBX_PROFILER_HISTORY_LENGTH 32
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef _FINALROM
+	#define UBX_PROFILER_NEW_FRAME()
+	#define UBX_PROFILER_ZONE_BEGIN(zone)
+	#define UBX_PROFILER_ZONE_END(zone)
+	#define UBX_PROFILER_DRAW_HUD(x, y)
+
+	#define _UBX_PROFILER_ON_RSP_START(pTask)
+	#define _UBX_PROFILER_ON_RSP_DONE(pTask)
+	#define _UBX_PROFILER_ON_RDP_START()
+	#define _UBX_PROFILER_ON_RDP_DONE()
+
+#else
+	#define UBX_PROFILER_NEW_FRAME()      UbxProfilerNewFrame()
+	#define UBX_PROFILER_ZONE_BEGIN(zone) UbxProfilerZoneBegin(zone)
+	#define UBX_PROFILER_ZONE_END(zone)   UbxProfilerZoneEnd(zone)
+	#define UBX_PROFILER_DRAW_HUD(x, y)   UbxProfilerDrawHud(x, y)
+
+	#define _UBX_PROFILER_ON_RSP_START(pTask) _UbxProfilerOnRspStart(pTask)
+	#define _UBX_PROFILER_ON_RSP_DONE(pTask)  _UbxProfilerOnRspDone(pTask)
+	#define _UBX_PROFILER_ON_RDP_START()      _UbxProfilerOnRdpStart()
+	#define _UBX_PROFILER_ON_RDP_DONE()       _UbxProfilerOnRdpDone()
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* All CPU timings are in CPU counter cycles (OS_CPU_COUNTER per second) while the RDP counters are in RCP clock cycles
+ * (62.5 MHz) exactly as they are read from the DPC registers. */
+typedef struct _UbxProfilerFrame
+{
+	u32 frameCycles;
+	u32 zoneCycles[UBX_PROFILER_MAX_ZONES];
+
+	u32 rspGfxCycles;
+	u32 rspAudioCycles;
+	u32 rdpCycles;
+
+	u32 rdpClock;
+	u32 rdpBufBusy;
+	u32 rdpPipeBusy;
+	u32 rdpTmemBusy;
+} UbxProfilerFrame;
+
+typedef struct _UbxProfilerData
+{
+	UbxProfilerFrame history[UBX_PROFILER_HISTORY_LENGTH];
+	UbxProfilerFrame current;
+
+	u32 zoneStart[UBX_PROFILER_MAX_ZONES];
+
+	u32 frameStart;
+	u32 rspStart;
+	u32 rdpStart;
+
+	u32 historyIndex;
+	u32 frameCount;
+
+	u8 enableHud;
+} UbxProfilerData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxProfilerData gUbxProfiler;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxProfilerSetDefaults();
+
+extern void _UbxProfilerOnRspStart(const OSTask* pTask);
+extern void _UbxProfilerOnRspDone(const OSTask* pTask);
+extern void _UbxProfilerOnRdpStart();
+extern void _UbxProfilerOnRdpDone();
+
+/* Close out the current frame, pushing its timings into the history. This should be called once at the very start of
+ * each iteration of the game's main loop. */
+extern void UbxProfilerNewFrame();
+
+/* Time a section of CPU work. Zones are identified by the game as indices below UBX_PROFILER_MAX_ZONES and are expected
+ * not to overlap since the overlay draws them back-to-back. A zone may be entered more than once in a frame. Zones and
+ * frames are also recorded in the trace ring. */
+extern void UbxProfilerZoneBegin(u32 zone);
+extern void UbxProfilerZoneEnd(u32 zone);
+
+/* Append the profiler overlay for the most recently completed frame to the current gfx command list. Each bar spans
+ * two vertical retrace intervals with the one frame budget marked by a white line, and the graph underneath shows the
+ * total frame time of the history. The overlay is drawn with fill rectangles, so it needs a 16-bit color image. The RDP
+ * is left in fill mode, set through the state tracker, so the tracked 'UBX_GFX_SET' macros restore what comes next. */
+extern void UbxProfilerDrawHud(s32 x, s32 y);
+
+/* Access a completed frame where 0 is the most recent one and UBX_PROFILER_HISTORY_LENGTH - 1 is the oldest. */
+static inline const UbxProfilerFrame* UbxProfilerGetFrame(const u32 age)
+{
+	return &gUbxProfiler.history[(gUbxProfiler.historyIndex - age) % UBX_PROFILER_HISTORY_LENGTH];
+}
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
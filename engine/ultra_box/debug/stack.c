@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "stack.h"
+
+#ifndef _FINALROM
+
+#include <os_exception.h>
+#include <os_libc.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_STACK_GUARD_WORD_COUNT (UBX_STACK_GUARD_SIZE / sizeof(u32))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxStackDesc
+{
+	const char* name;
+	u32* pGuard;
+} UbxStackDesc;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* The boot stack is the main thread's stack, so it's covered by the main thread's guard words. */
+extern u8 _main_stack_start[];
+extern u8 _idle_stack_start[];
+extern u8 _loader_stack_start[];
+extern u8 _job_stack_start[];
+extern u8 _event_stack_start[];
+extern u8 _sched_stack_start[];
+extern u8 _audio_stack_start[];
+extern u8 _serial_stack_start[];
+extern u8 _trace_stack_start[];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxStackData gUbxStack;
+
+static const UbxStackDesc gStack[] =
+{
+	{ "main",   (u32*) _main_stack_start },
+	{ "idle",   (u32*) _idle_stack_start },
+	{ "loader", (u32*) _loader_stack_start },
+	{ "job",    (u32*) _job_stack_start },
+	{ "event",  (u32*) _event_stack_start },
+	{ "sched",  (u32*) _sched_stack_start },
+	{ "audio",  (u32*) _audio_stack_start },
+	{ "serial", (u32*) _serial_stack_start },
+	{ "trace",  (u32*) _trace_stack_start },
+};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxStackSetDefaults()
+{
+	gUbxStack.overflowMask = 0;
+
+	for(size_t i = 0; i < sizeof(gStack) / sizeof(gStack[0]); ++i)
+	{
+		for(size_t j = 0; j < UBX_STACK_GUARD_WORD_COUNT; ++j)
+		{
+			gStack[i].pGuard[j] = UBX_STACK_GUARD_WORD;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxStackCheck()
+{
+	for(size_t i = 0; i < sizeof(gStack) / sizeof(gStack[0]); ++i)
+	{
+		for(size_t j = 0; j < UBX_STACK_GUARD_WORD_COUNT; ++j)
+		{
+			if(gStack[i].pGuard[j] != UBX_STACK_GUARD_WORD)
+			{
+				gUbxStack.overflowMask |= 1u << i;
+				break;
+			}
+		}
+	}
+
+	if(gUbxStack.overflowMask == 0)
+	{
+		return;
+	}
+
+	for(size_t i = 0; i < sizeof(gStack) / sizeof(gStack[0]); ++i)
+	{
+		if(gUbxStack.overflowMask & (1u << i))
+		{
+			osSyncPrintf("Stack overflow: %s thread\n", gStack[i].name);
+		}
+	}
+
+	/* Nothing past this point can be trusted, so stop every thread from running. */
+	osSetIntMask(OS_IM_NONE);
+
+	for(;;) {}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
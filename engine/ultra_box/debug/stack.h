@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/env.h"
+
+#include <ultratypes.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Bytes reserved by the linker script at the bottom of every thread stack. Must match the value in build/n64_linker.py. */
+#define UBX_STACK_GUARD_SIZE 16
+
+/* "UBXS" */
+#define UBX_STACK_GUARD_WORD 0x55425853
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef _FINALROM
+	#define UBX_STACK_CHECK()
+
+#else
+	#define UBX_STACK_CHECK() UbxStackCheck()
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxStackData
+{
+	/* One bit for each stack whose guard words have been overwritten, in the order they're listed in stack.c. */
+	u32 overflowMask;
+} UbxStackData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxStackData gUbxStack;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Fill the guard words of every thread stack. This runs at boot before any of the threads are started. */
+extern void _UbxStackSetDefaults();
+
+/* Make sure no thread has run past the end of its stack. Thread stacks are sized by the build from their worst-case
+ * usage, but calls through pointers and recursion can still exceed that, so any overflow is reported over ISViewer and
+ * then halts the system before the corrupted memory can cause harder to diagnose problems. This is called by the event
+ * router on every vertical retrace. */
+extern void UbxStackCheck();
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
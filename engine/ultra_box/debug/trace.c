@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "trace.h"
+
+#ifndef _FINALROM
+
+#include "../lowlevel/event.h"
+#include "../lowlevel/thread.h"
+
+#include <os_libc.h>
+#include <os_time.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_TRACE_EVENT_INDEX_MASK (UBX_TRACE_MAX_EVENT_COUNT - 1)
+
+/* Each event is written as 24 hex digits. */
+#define UBX_TRACE_LINE_LENGTH (6 + (UBX_TRACE_EVENTS_PER_LINE * 24) + 2)
+
+/* Bump this whenever the event layout changes so old captures aren't misread. */
+#define UBX_TRACE_STREAM_VERSION 1
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxTraceData gUbxTrace;
+
+extern u8 _trace_stack_end[];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static char* _UbxTraceWriteHex(char* pOutput, const u32 value, const u32 digitCount)
+{
+	static const char hexDigit[] = "0123456789abcdef";
+
+	for(u32 i = 0; i < digitCount; ++i)
+	{
+		pOutput[i] = hexDigit[(value >> ((digitCount - 1 - i) * 4)) & 0xF];
+	}
+
+	return pOutput + digitCount;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxTraceFlush()
+{
+	const u32 droppedCount = __atomic_exchange_n(&gUbxTrace.droppedCount, 0, __ATOMIC_RELAXED);
+
+	if(droppedCount > 0)
+	{
+		osSyncPrintf("@ubxd %lu\n", (unsigned long) droppedCount);
+	}
+
+	for(;;)
+	{
+		char line[UBX_TRACE_LINE_LENGTH];
+		char* pLine = line;
+		u32 eventCount = 0;
+
+		memcpy(pLine, "@ubxt ", 6);
+		pLine += 6;
+
+		while(eventCount < UBX_TRACE_EVENTS_PER_LINE)
+		{
+			const u32 readIndex = gUbxTrace.readIndex;
+
+			if(readIndex == __atomic_load_n(&gUbxTrace.writeIndex, __ATOMIC_ACQUIRE))
+			{
+				break;
+			}
+
+			UbxTraceEvent* const pEvent = &gUbxTrace.event[readIndex & UBX_TRACE_EVENT_INDEX_MASK];
+
+			/* The slot has been reserved, but the thread that reserved it hasn't finished writing it yet. */
+			if(pEvent->type == UBX_TRACE_EVENT_NONE)
+			{
+				break;
+			}
+
+			pLine = _UbxTraceWriteHex(pLine, pEvent->timestamp, 8);
+			pLine = _UbxTraceWriteHex(pLine, pEvent->value, 8);
+			pLine = _UbxTraceWriteHex(pLine, pEvent->threadId, 4);
+			pLine = _UbxTraceWriteHex(pLine, pEvent->id, 2);
+			pLine = _UbxTraceWriteHex(pLine, pEvent->type, 2);
+
+			/* Release the slot back to the writers. */
+			pEvent->type = UBX_TRACE_EVENT_NONE;
+			__atomic_store_n(&gUbxTrace.readIndex, readIndex + 1, __ATOMIC_RELEASE);
+
+			++eventCount;
+		}
+
+		if(eventCount == 0)
+		{
+			break;
+		}
+
+		pLine[0] = '\n';
+		pLine[1] = '\0';
+
+		osSyncPrintf("%s", line);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxTraceThread(void*)
+{
+	for(;;)
+	{
+		/* Wait for the next vertical retrace. */
+		osRecvMesg(&gUbxTrace.msgQueue, NULL, OS_MESG_BLOCK);
+
+		_UbxTraceFlush();
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxTraceSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxTrace, 0, sizeof(gUbxTrace));
+
+	gUbxTrace.threadPriority = UBX_THREAD_PRI_TRACE;
+	gUbxTrace.enable = 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxTraceInitialize()
+{
+	osCreateMesgQueue(&gUbxTrace.msgQueue, gUbxTrace.msg, UBX_TRACE_MAX_QUEUE_LENGTH);
+	UbxEventSubscribe(&gUbxTrace.msgQueue, UBX_EVENT_MASK(UBX_EVENT_VI));
+
+	/* The stream header tells the decoder how to convert timestamps. */
+	osSyncPrintf("@ubxh %d %lu\n", UBX_TRACE_STREAM_VERSION, (unsigned long) OS_CPU_COUNTER);
+
+	/* Start the trace thread. */
+	osCreateThread(&gUbxTrace.thread, UBX_THREAD_ID_TRACE, _UbxTraceThread, NULL, _trace_stack_end, gUbxTrace.threadPriority);
+	osStartThread(&gUbxTrace.thread);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxTracePush(const UbxTraceEventType type, const u8 id, const u32 value)
+{
+	if(!gUbxTrace.enable)
+	{
+		return;
+	}
+
+	u32 index = __atomic_load_n(&gUbxTrace.writeIndex, __ATOMIC_RELAXED);
+
+	/* Reserve a slot without taking a lock; a thread that gets preempted here simply retries with the new index. */
+	do
+	{
+		if(index - __atomic_load_n(&gUbxTrace.readIndex, __ATOMIC_ACQUIRE) >= UBX_TRACE_MAX_EVENT_COUNT)
+		{
+			__atomic_fetch_add(&gUbxTrace.droppedCount, 1, __ATOMIC_RELAXED);
+			return;
+		}
+	}
+	while(!__atomic_compare_exchange_n(&gUbxTrace.writeIndex, &index, index + 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	UbxTraceEvent* const pEvent = &gUbxTrace.event[index & UBX_TRACE_EVENT_INDEX_MASK];
+
+	pEvent->timestamp = osGetCount();
+	pEvent->value = value;
+	pEvent->threadId = (u16) osGetThreadId(NULL);
+	pEvent->id = id;
+
+	/* Setting the type last marks the slot as ready to be flushed. */
+	__atomic_store_n(&pEvent->type, (u8) type, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxTraceName(const char kind, const u8 id, const char* const name)
+{
+	osSyncPrintf("@ubxn %c %u %s\n", kind, (unsigned) id, name);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
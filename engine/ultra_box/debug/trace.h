@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/env.h"
+
+#include <os_message.h>
+#include <os_thread.h>
+#include <ultratypes.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Must be a power of two. */
+#define UBX_TRACE_MAX_EVENT_COUNT 1024
+
+#define UBX_TRACE_MAX_QUEUE_LENGTH 4
+
+/* Maximum number of events written out per line of ISViewer output. */
+#define UBX_TRACE_EVENTS_PER_LINE 8
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxTraceEventType
+{
+	UBX_TRACE_EVENT_NONE,
+	UBX_TRACE_EVENT_FRAME,
+	UBX_TRACE_EVENT_ZONE_BEGIN,
+	UBX_TRACE_EVENT_ZONE_END,
+	UBX_TRACE_EVENT_COUNTER,
+	UBX_TRACE_EVENT_TASK_SUBMIT,
+	UBX_TRACE_EVENT_TASK_START,
+	UBX_TRACE_EVENT_TASK_COMPLETE,
+} UbxTraceEventType;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef _FINALROM
+	#define UBX_TRACE_FRAME()
+	#define UBX_TRACE_ZONE_BEGIN(id)
+	#define UBX_TRACE_ZONE_END(id)
+	#define UBX_TRACE_COUNTER(id, value)
+	#define UBX_TRACE_TASK(type, taskType, taskId)
+	#define UBX_TRACE_NAME_ZONE(id, name)
+	#define UBX_TRACE_NAME_COUNTER(id, name)
+
+#else
+	#define UBX_TRACE_FRAME()                      UbxTracePush(UBX_TRACE_EVENT_FRAME, 0, 0)
+	#define UBX_TRACE_ZONE_BEGIN(id)               UbxTracePush(UBX_TRACE_EVENT_ZONE_BEGIN, (id), 0)
+	#define UBX_TRACE_ZONE_END(id)                 UbxTracePush(UBX_TRACE_EVENT_ZONE_END, (id), 0)
+	#define UBX_TRACE_COUNTER(id, value)           UbxTracePush(UBX_TRACE_EVENT_COUNTER, (id), (u32) (value))
+	#define UBX_TRACE_TASK(type, taskType, taskId) UbxTracePush((type), (taskType), (u32) (taskId))
+	#define UBX_TRACE_NAME_ZONE(id, name)          UbxTraceName('z', (id), (name))
+	#define UBX_TRACE_NAME_COUNTER(id, name)       UbxTraceName('c', (id), (name))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Events are written out big-endian and field-for-field in this order, 12 bytes each. */
+typedef struct _UbxTraceEvent
+{
+	u32 timestamp;
+	u32 value;
+	u16 threadId;
+	u8 id;
+	volatile u8 type;
+} UbxTraceEvent;
+
+typedef struct _UbxTraceData
+{
+	OSThread thread;
+
+	OSMesgQueue msgQueue;
+	OSMesg msg[UBX_TRACE_MAX_QUEUE_LENGTH];
+
+	UbxTraceEvent event[UBX_TRACE_MAX_EVENT_COUNT];
+
+	u32 writeIndex;
+	u32 readIndex;
+
+	u32 droppedCount;
+
+	OSPri threadPriority;
+
+	u8 enable;
+} UbxTraceData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxTraceData gUbxTrace;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxTraceSetDefaults();
+extern void _UbxTraceInitialize();
+
+/* Record an event in the trace ring. This is safe to call from any thread; when the ring is full, the event is dropped
+ * and counted rather than blocking the caller. Recorded events are written out over ISViewer once per retrace by a
+ * low priority thread, to be decoded on the host with ubxtrace. */
+extern void UbxTracePush(UbxTraceEventType type, u8 id, u32 value);
+
+/* Write out a name for a zone ('z') or counter ('c') ID immediately so the decoder can label the events with it. */
+extern void UbxTraceName(char kind, u8 id, const char* name);
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
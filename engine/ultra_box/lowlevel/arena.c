@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "arena.h"
+#include "cache.h"
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define ARENA_ALIGN_UP(value) (((value) + (UBX_ARENA_ALIGNMENT - 1)) & ~(UBX_ARENA_ALIGNMENT - 1))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxArenaData gUbxArena;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxArenaSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxArena, 0, sizeof(gUbxArena));
+
+	/* Default to one arena per display buffer. The backing memory must be supplied by the game. */
+	gUbxArena.frameCount = 2;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxArenaInitialize()
+{
+	if(gUbxArena.frameCount > UBX_ARENA_MAX_FRAME_COUNT)
+	{
+		gUbxArena.frameCount = UBX_ARENA_MAX_FRAME_COUNT;
+	}
+	else if(gUbxArena.frameCount == 0)
+	{
+		gUbxArena.frameCount = 1;
+	}
+
+	/* Align the backing memory to the start of a data cache line. */
+	const u32 bufferStart = ARENA_ALIGN_UP((u32) gUbxArena.pBuffer);
+	const u32 bufferEnd = (u32) gUbxArena.pBuffer + gUbxArena.bufferSize;
+	const u32 usableSize = (gUbxArena.pBuffer && bufferEnd > bufferStart) ? bufferEnd - bufferStart : 0;
+
+	/* Split the backing memory evenly between each frame, keeping every arena aligned to a cache line. */
+	const u32 arenaSize = (usableSize / gUbxArena.frameCount) & ~(UBX_ARENA_ALIGNMENT - 1);
+
+	for(size_t i = 0; i < gUbxArena.frameCount; ++i)
+	{
+		UbxArena* const pArena = &gUbxArena.frame[i];
+
+		pArena->pStart = (u8*) (bufferStart + (arenaSize * i));
+		pArena->pTail = pArena->pStart;
+		pArena->pEnd = pArena->pStart + arenaSize;
+		pArena->pFence = NULL;
+		pArena->state = UBX_ARENA_STATE_FREE;
+	}
+
+	gUbxArena.activeIndex = 0;
+	gUbxArena.retireIndex = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxArenaBeginFrame()
+{
+	UbxArena* const pArena = &gUbxArena.frame[gUbxArena.activeIndex];
+
+	/* The RCP may still be reading from this arena if the game hasn't retired it yet. Arenas are retired in the order
+	 * they were submitted, so wait on the fence of each older frame in turn until the one we need is free again. */
+	while(pArena->state == UBX_ARENA_STATE_SUBMITTED)
+	{
+		UbxSchedWait(gUbxArena.frame[gUbxArena.retireIndex].pFence);
+		UbxArenaRetireFrame();
+	}
+
+	pArena->pTail = pArena->pStart;
+	pArena->state = UBX_ARENA_STATE_BUILDING;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void* UbxArenaAlloc(const size_t size)
+{
+	UbxArena* const pArena = &gUbxArena.frame[gUbxArena.activeIndex];
+
+	/* Round the allocation up so every block starts on its own cache line; the RSP
+	 * also requires 8-byte alignment for its DMAs, which this covers as well. */
+	const size_t alignedSize = ARENA_ALIGN_UP(size);
+
+	if(pArena->state != UBX_ARENA_STATE_BUILDING || alignedSize > (size_t) (pArena->pEnd - pArena->pTail))
+	{
+		return NULL;
+	}
+
+	u8* const pBlock = pArena->pTail;
+	pArena->pTail += alignedSize;
+
+	return pBlock;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxArenaTrim(void* const pLastAlloc, const size_t usedSize)
+{
+	UbxArena* const pArena = &gUbxArena.frame[gUbxArena.activeIndex];
+
+	u8* const pBlock = (u8*) pLastAlloc;
+	u8* const pNewTail = pBlock + ARENA_ALIGN_UP(usedSize);
+
+	/* Only the most recent allocation can be trimmed. */
+	if(pBlock >= pArena->pStart && pNewTail <= pArena->pTail)
+	{
+		pArena->pTail = pNewTail;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxArenaSubmitFrame(UbxSchedTask* const pFence)
+{
+	UbxArena* const pArena = &gUbxArena.frame[gUbxArena.activeIndex];
+
+	if(pArena->state != UBX_ARENA_STATE_BUILDING)
+	{
+		return;
+	}
+
+	/* Register the entire used range in one go rather than once per object. */
+	UbxCacheMarkDirty(pArena->pStart, (size_t) (pArena->pTail - pArena->pStart));
+
+	pArena->pFence = pFence;
+	pArena->state = UBX_ARENA_STATE_SUBMITTED;
+
+	/* Move on to the next arena for the following frame. */
+	gUbxArena.activeIndex = (gUbxArena.activeIndex + 1) % gUbxArena.frameCount;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxArenaRetireFrame()
+{
+	for(;;)
+	{
+		UbxArena* const pArena = &gUbxArena.frame[gUbxArena.retireIndex];
+
+		if(pArena->state != UBX_ARENA_STATE_SUBMITTED || !UbxSchedIsComplete(pArena->pFence))
+		{
+			return;
+		}
+
+		pArena->pTail = pArena->pStart;
+		pArena->pFence = NULL;
+		pArena->state = UBX_ARENA_STATE_FREE;
+
+		gUbxArena.retireIndex = (gUbxArena.retireIndex + 1) % gUbxArena.frameCount;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
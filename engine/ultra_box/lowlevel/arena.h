@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+#include "sched.h"
+
+#include <gbi.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_ARENA_MAX_FRAME_COUNT 3
+#define UBX_ARENA_ALIGNMENT       0x10
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxArenaState
+{
+	UBX_ARENA_STATE_FREE,
+	UBX_ARENA_STATE_BUILDING,
+	UBX_ARENA_STATE_SUBMITTED,
+} UbxArenaState;
+
+typedef struct _UbxArena
+{
+	u8* pStart;
+	u8* pTail;
+	u8* pEnd;
+
+	/* Last RCP task reading from the arena; the arena is in use until the scheduler has completed it. */
+	UbxSchedTask* pFence;
+
+	UbxArenaState state;
+} UbxArena;
+
+typedef struct _UbxArenaData
+{
+	UbxArena frame[UBX_ARENA_MAX_FRAME_COUNT];
+
+	u8* pBuffer;
+
+	size_t bufferSize;
+	size_t frameCount;
+
+	size_t activeIndex;
+	size_t retireIndex;
+} UbxArenaData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxArenaData gUbxArena;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxArenaSetDefaults();
+extern void _UbxArenaInitialize();
+
+/* Start building a new frame, blocking on the fence task of that frame's arena if the RCP is still using it. */
+extern void UbxArenaBeginFrame();
+
+/* Allocate a block of RCP-visible memory from the active frame arena (returns NULL when the arena is exhausted). */
+extern void* UbxArenaAlloc(size_t size);
+
+/* Give back the unused tail of the most recent allocation (e.g., a display list that didn't use its full capacity). */
+extern void UbxArenaTrim(void* pLastAlloc, size_t usedSize);
+
+/* Register everything allocated this frame with the cache writeback tracker as a single range and mark the arena
+ * as in-flight until the given task has completed. The fence must be the frame's last task that reads from the arena
+ * and must have a completion message queue. The actual writeback happens on the next call to UbxCacheFlush(). */
+extern void UbxArenaSubmitFrame(UbxSchedTask* pFence);
+
+/* Release every in-flight arena whose fence task has completed, oldest first. */
+extern void UbxArenaRetireFrame();
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_ARENA_ALLOC(type, count) ((type*) UbxArenaAlloc(sizeof(type) * (count)))
+
+#define UBX_ARENA_ALLOC_MTX(count)            UBX_ARENA_ALLOC(Mtx, count)
+#define UBX_ARENA_ALLOC_VTX(count)            UBX_ARENA_ALLOC(Vtx, count)
+#define UBX_ARENA_ALLOC_LIGHTS(lights, count) UBX_ARENA_ALLOC(Lights##lights, count)
+#define UBX_ARENA_ALLOC_GFX(count)            UBX_ARENA_ALLOC(Gfx, count)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "boot.h"
+
+#include <R4300.h>
+#include <rcp.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Nothing outside of the boot section has been loaded when this code runs, so every function here must be placed in
+ * that section, and none of them may call into libultra or libc (or let the compiler generate calls to memcpy). */
+#define UBX_BOOT_FUNC __attribute__((section(".text.boot"), optimize("no-tree-loop-distribute-patterns")))
+
+#define UBX_BOOT_DMA_CHUNK_SIZE     0x10000
+#define UBX_BOOT_STREAM_BUFFER_SIZE 0x400
+
+/* Amount of the ROM copied into RAM by the IPL3, starting from the boot segment. */
+#define UBX_BOOT_IPL3_LOAD_SIZE 0x100000
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern u8 _boot_rom_start[];
+extern u8 _text_start[];
+extern u8 _text_end[];
+extern u8 _text_rom_start[];
+
+/* The stream buffer is in the BSS since it's only needed until the BSS is cleared right after this stage completes. */
+static u8 gStreamBuffer[UBX_BOOT_STREAM_BUFFER_SIZE] __attribute__((aligned(DCACHE_LINESIZE)));
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxBootStream
+{
+	u32 romAddr;
+	u32 romEnd;
+	u32 offset;
+	u32 length;
+} UbxBootStream;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UBX_BOOT_FUNC void _UbxBootInvalDCache(u8* const pAddr, const u32 size)
+{
+	for(u32 i = 0; i < size; i += DCACHE_LINESIZE)
+	{
+		__asm__ volatile("cache %0, 0(%1)" : : "i"(C_HINV | CACH_PD), "r"(pAddr + i) : "memory");
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UBX_BOOT_FUNC void _UbxBootWritebackDCache(u8* const pAddr, const u32 size)
+{
+	for(u32 i = 0; i < size; i += DCACHE_LINESIZE)
+	{
+		__asm__ volatile("cache %0, 0(%1)" : : "i"(C_HWB | CACH_PD), "r"(pAddr + i) : "memory");
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UBX_BOOT_FUNC void _UbxBootInvalICache(u8* const pAddr, const u32 size)
+{
+	for(u32 i = 0; i < size; i += ICACHE_LINESIZE)
+	{
+		__asm__ volatile("cache %0, 0(%1)" : : "i"(C_HINV | CACH_PI), "r"(pAddr + i) : "memory");
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UBX_BOOT_FUNC void _UbxBootDma(u8* const pDest, const u32 romAddr, const u32 size)
+{
+	/* The PI manager doesn't exist yet, so talk to the PI directly. */
+	for(u32 offset = 0; offset < size; offset += UBX_BOOT_DMA_CHUNK_SIZE)
+	{
+		const u32 remaining = size - offset;
+		const u32 chunkSize = (remaining > UBX_BOOT_DMA_CHUNK_SIZE) ? UBX_BOOT_DMA_CHUNK_SIZE : remaining;
+
+		while(IO_READ(PI_STATUS_REG) & (PI_STATUS_DMA_BUSY | PI_STATUS_IO_BUSY)) {}
+
+		IO_WRITE(PI_DRAM_ADDR_REG, K0_TO_PHYS(pDest + offset));
+		IO_WRITE(PI_CART_ADDR_REG, PI_DOM1_ADDR2 + romAddr + offset);
+		IO_WRITE(PI_WR_LEN_REG, chunkSize - 1);
+	}
+
+	while(IO_READ(PI_STATUS_REG) & (PI_STATUS_DMA_BUSY | PI_STATUS_IO_BUSY)) {}
+
+	/* Make sure the PI interrupt raised by the transfers isn't still pending once libultra has been initialized. */
+	IO_WRITE(PI_STATUS_REG, PI_STATUS_CLR_INTR);
+
+	/* Drop any cache lines covering the destination so the CPU sees the new data. */
+	_UbxBootInvalDCache(pDest, size);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UBX_BOOT_FUNC u32 _UbxBootReadByte(UbxBootStream* const pStream)
+{
+	if(pStream->offset == pStream->length)
+	{
+		/* Refill the stream buffer. Reads may run past the end of the compressed data by up to
+		 * one buffer's length, but that only ever pulls in more of the ROM, so it's harmless. */
+		_UbxBootDma(gStreamBuffer, pStream->romAddr, UBX_BOOT_STREAM_BUFFER_SIZE);
+
+		pStream->romAddr += UBX_BOOT_STREAM_BUFFER_SIZE;
+		pStream->offset = 0;
+		pStream->length = UBX_BOOT_STREAM_BUFFER_SIZE;
+	}
+
+	return gStreamBuffer[pStream->offset++];
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UBX_BOOT_FUNC void _UbxBootDecompress(u8* const pDest, const u32 romAddr, const u32 decompressedSize)
+{
+	UbxBootStream stream;
+	stream.romAddr = romAddr;
+	stream.offset = 0;
+	stream.length = 0;
+
+	u8* pOut = pDest;
+	u8* const pOutEnd = pDest + decompressedSize;
+
+	/* LZSS with a 4 KiB window: each flag byte describes the next 8 items starting from the lowest bit, where
+	 * a set bit is a literal byte and a clear bit is a 2-byte back reference of 12-bit distance and 4-bit length. */
+	while(pOut < pOutEnd)
+	{
+		const u32 flags = _UbxBootReadByte(&stream);
+
+		for(u32 bit = 0; bit < 8 && pOut < pOutEnd; ++bit)
+		{
+			if(flags & (1 << bit))
+			{
+				*pOut++ = (u8) _UbxBootReadByte(&stream);
+			}
+			else
+			{
+				const u32 byte0 = _UbxBootReadByte(&stream);
+				const u32 byte1 = _UbxBootReadByte(&stream);
+
+				const u32 distance = ((byte0 << 4) | (byte1 >> 4)) + 1;
+				const u32 length = (byte1 & 0xF) + 3;
+
+				const u8* pSrc = pOut - distance;
+
+				for(u32 i = 0; i < length && pOut < pOutEnd; ++i)
+				{
+					*pOut++ = *pSrc++;
+				}
+			}
+		}
+	}
+
+	/* The output was written by the CPU, so it has to be flushed out to RAM before instructions can be fetched from it. */
+	_UbxBootWritebackDCache(pDest, decompressedSize);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BOOT_FUNC void _UbxBootLoadCode()
+{
+	const u32 romStart = (u32) _text_rom_start;
+	const u32 totalSize = (u32) (_text_end - _text_start);
+
+	/* Read the header the linker script reserves at the start of the code segment. */
+	_UbxBootDma(_text_start, romStart, UBX_BOOT_HEADER_SIZE);
+
+	const UbxBootHeader* const pHeader = (const UbxBootHeader*) _text_start;
+
+	u8* const pPayload = _text_start + UBX_BOOT_HEADER_SIZE;
+	const u32 payloadRomStart = romStart + UBX_BOOT_HEADER_SIZE;
+
+	if(pHeader->magic == UBX_BOOT_COMPRESSED_MAGIC)
+	{
+		_UbxBootDecompress(pPayload, payloadRomStart, pHeader->decompressedSize);
+	}
+	else
+	{
+		/* The code segment directly follows the boot segment in both ROM and RAM, so the IPL3 has already copied
+		 * everything up to the end of its load into place. Only the rest needs to be read from ROM. */
+		const u32 ipl3RomEnd = (u32) _boot_rom_start + UBX_BOOT_IPL3_LOAD_SIZE;
+		const u32 payloadRomEnd = romStart + totalSize;
+
+		if(payloadRomEnd > ipl3RomEnd)
+		{
+			const u32 loadedSize = (ipl3RomEnd > payloadRomStart) ? ipl3RomEnd - payloadRomStart : 0;
+
+			_UbxBootDma(pPayload + loadedSize, payloadRomStart + loadedSize, payloadRomEnd - payloadRomStart - loadedSize);
+		}
+	}
+
+	_UbxBootInvalICache(_text_start, totalSize);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <ultratypes.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Magic number ("UBXZ") marking the start of the code segment in ROM as compressed. */
+#define UBX_BOOT_COMPRESSED_MAGIC 0x5542585A
+
+/* Size of the header reserved at the start of the code segment by the linker script. */
+#define UBX_BOOT_HEADER_SIZE 0x10
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxBootHeader
+{
+	u32 magic;
+	u32 decompressedSize;
+	u32 compressedSize;
+	u32 reserved;
+} UbxBootHeader;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* First-stage loader called from the ROM entry point before anything else has been initialized. This brings
+ * in the part of the code segment past the 1 MiB the IPL3 copies from the start of the ROM, or the whole
+ * segment when the ROM builder has compressed it, which lifts the IPL3 size limit. */
+extern void _UbxBootLoadCode();
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "cache.h"
+
+#include <os_cache.h>
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxCacheData gUbxCache;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxCacheSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxCache, 0, sizeof(gUbxCache));
+
+	/* Writing back the entire data cache always walks every line in it, so once the dirty ranges
+	 * add up to the size of the cache, it's cheaper to do that than to walk each range separately. */
+	gUbxCache.writebackAllThreshold = UBX_CACHE_DCACHE_SIZE;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxCacheMarkDirty(const void* const pAddr, const size_t size)
+{
+	if(size == 0)
+	{
+		return;
+	}
+
+	if(gUbxCache.rangeCount == UBX_CACHE_MAX_RANGE_COUNT)
+	{
+		/* Every range registered so far is already complete, so it's safe to write them back early to make room. */
+		UbxCacheFlush();
+	}
+
+	UbxCacheRange* const pRange = &gUbxCache.range[gUbxCache.rangeCount];
+
+	/* Expand the range out to whole cache lines so that neighboring ranges can be detected when merging. */
+	pRange->start = (u32) pAddr & ~(UBX_CACHE_DCACHE_LINE_SIZE - 1);
+	pRange->end = ((u32) pAddr + size + (UBX_CACHE_DCACHE_LINE_SIZE - 1)) & ~(UBX_CACHE_DCACHE_LINE_SIZE - 1);
+
+	++gUbxCache.rangeCount;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxCacheFlush()
+{
+	const size_t rangeCount = gUbxCache.rangeCount;
+
+	if(rangeCount == 0)
+	{
+		return;
+	}
+
+	UbxCacheRange* const pRange = gUbxCache.range;
+
+	/* Sort the ranges by their start address. Ranges are usually registered in roughly ascending
+	 * order since they tend to come from linear allocators, which makes insertion sort a good fit. */
+	for(size_t i = 1; i < rangeCount; ++i)
+	{
+		const UbxCacheRange current = pRange[i];
+		size_t j = i;
+
+		while(j > 0 && pRange[j - 1].start > current.start)
+		{
+			pRange[j] = pRange[j - 1];
+			--j;
+		}
+
+		pRange[j] = current;
+	}
+
+	/* Merge any ranges that overlap or touch each other. */
+	size_t mergedCount = 0;
+	u32 totalSize = 0;
+
+	for(size_t i = 1; i < rangeCount; ++i)
+	{
+		UbxCacheRange* const pMerged = &pRange[mergedCount];
+
+		if(pRange[i].start <= pMerged->end)
+		{
+			if(pRange[i].end > pMerged->end)
+			{
+				pMerged->end = pRange[i].end;
+			}
+		}
+		else
+		{
+			totalSize += pMerged->end - pMerged->start;
+			pRange[++mergedCount] = pRange[i];
+		}
+	}
+
+	totalSize += pRange[mergedCount].end - pRange[mergedCount].start;
+	++mergedCount;
+
+	if(totalSize >= gUbxCache.writebackAllThreshold)
+	{
+		osWritebackDCacheAll();
+	}
+	else
+	{
+		for(size_t i = 0; i < mergedCount; ++i)
+		{
+			osWritebackDCache((void*) pRange[i].start, (s32) (pRange[i].end - pRange[i].start));
+		}
+	}
+
+	gUbxCache.rangeCount = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
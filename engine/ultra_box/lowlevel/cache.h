@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <ultratypes.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_CACHE_MAX_RANGE_COUNT 64
+#define UBX_CACHE_DCACHE_LINE_SIZE 0x10
+#define UBX_CACHE_DCACHE_SIZE      0x2000
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxCacheRange
+{
+	u32 start;
+	u32 end;
+} UbxCacheRange;
+
+typedef struct _UbxCacheData
+{
+	UbxCacheRange range[UBX_CACHE_MAX_RANGE_COUNT];
+
+	size_t rangeCount;
+	size_t writebackAllThreshold;
+} UbxCacheData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxCacheData gUbxCache;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxCacheSetDefaults();
+
+/* Register a range of memory that has been written by the CPU and will be read by the RCP or a DMA. */
+extern void UbxCacheMarkDirty(const void* pAddr, size_t size);
+
+/* Write back all registered ranges using the fewest cache operations possible; call this right before
+ * submitting any task or DMA that reads the dirty memory. */
+extern void UbxCacheFlush();
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
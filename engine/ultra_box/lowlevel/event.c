@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "event.h"
+#include "thread.h"
+
+#include "../debug/stack.h"
+
+#include <os_exception.h>
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxEventData gUbxEvent;
+
+extern u8 _event_stack_end[];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxEventThread(void*)
+{
+	for(;;)
+	{
+		OSMesg msg;
+
+		osRecvMesg(&gUbxEvent.msgQueue, &msg, OS_MESG_BLOCK);
+
+		const u32 eventMask = UBX_EVENT_MASK(UbxEventFromMesg(msg));
+
+		/* The router sees every retrace no matter what the game is doing, which makes it the one place the stack
+		 * guards are certain to be checked once per frame. */
+		if(eventMask & UBX_EVENT_MASK(UBX_EVENT_VI))
+		{
+			UBX_STACK_CHECK();
+		}
+
+		for(size_t i = 0; i < gUbxEvent.subscriberCount; ++i)
+		{
+			UbxEventSubscriber* const pSubscriber = &gUbxEvent.subscriber[i];
+
+			if(!(pSubscriber->eventMask & eventMask))
+			{
+				continue;
+			}
+
+			pSubscriber->pendingMask |= eventMask;
+
+			if(osSendMesg(pSubscriber->pQueue, msg, OS_MESG_NOBLOCK) != 0)
+			{
+				++pSubscriber->droppedCount;
+			}
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxEventSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxEvent, 0, sizeof(gUbxEvent));
+
+	gUbxEvent.threadPriority = UBX_THREAD_PRI_EVENT;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxEventInitialize()
+{
+	/* Create the single queue every hardware event is delivered to. */
+	osCreateMesgQueue(&gUbxEvent.msgQueue, gUbxEvent.msg, UBX_EVENT_MAX_QUEUE_LENGTH);
+
+	osSetEventMesg(OS_EVENT_SP, &gUbxEvent.msgQueue, UbxEventToMesg(UBX_EVENT_SP));
+	osSetEventMesg(OS_EVENT_DP, &gUbxEvent.msgQueue, UbxEventToMesg(UBX_EVENT_DP));
+	osSetEventMesg(OS_EVENT_SI, &gUbxEvent.msgQueue, UbxEventToMesg(UBX_EVENT_SI));
+	osSetEventMesg(OS_EVENT_PRENMI, &gUbxEvent.msgQueue, UbxEventToMesg(UBX_EVENT_PRENMI));
+
+	/* Start the router thread. The VI event is attached separately once the VI manager exists. */
+	osCreateThread(&gUbxEvent.thread, UBX_THREAD_ID_EVENT, _UbxEventThread, NULL, _event_stack_end, gUbxEvent.threadPriority);
+	osStartThread(&gUbxEvent.thread);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxEventSubscribe(OSMesgQueue* const pQueue, const u32 eventMask)
+{
+	/* Keep the router from running while the subscriber list is being changed. */
+	const OSIntMask prevIntMask = osSetIntMask(OS_IM_NONE);
+
+	if(gUbxEvent.subscriberCount < UBX_EVENT_MAX_SUBSCRIBER_COUNT)
+	{
+		UbxEventSubscriber* const pSubscriber = &gUbxEvent.subscriber[gUbxEvent.subscriberCount];
+
+		pSubscriber->pQueue = pQueue;
+		pSubscriber->eventMask = eventMask;
+		pSubscriber->droppedCount = 0;
+		pSubscriber->pendingMask = 0;
+
+		++gUbxEvent.subscriberCount;
+	}
+
+	osSetIntMask(prevIntMask);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u32 UbxEventTakePending(OSMesgQueue* const pQueue)
+{
+	u32 pendingMask = 0;
+
+	/* Keep the router from setting more bits between reading the mask and clearing it. */
+	const OSIntMask prevIntMask = osSetIntMask(OS_IM_NONE);
+
+	for(size_t i = 0; i < gUbxEvent.subscriberCount; ++i)
+	{
+		if(gUbxEvent.subscriber[i].pQueue == pQueue)
+		{
+			pendingMask = gUbxEvent.subscriber[i].pendingMask;
+			gUbxEvent.subscriber[i].pendingMask = 0;
+			break;
+		}
+	}
+
+	osSetIntMask(prevIntMask);
+
+	return pendingMask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxEventUnsubscribe(OSMesgQueue* const pQueue)
+{
+	const OSIntMask prevIntMask = osSetIntMask(OS_IM_NONE);
+
+	for(size_t i = 0; i < gUbxEvent.subscriberCount; ++i)
+	{
+		if(gUbxEvent.subscriber[i].pQueue == pQueue)
+		{
+			/* Fill the gap with the last subscriber since ordering doesn't matter. */
+			--gUbxEvent.subscriberCount;
+			gUbxEvent.subscriber[i] = gUbxEvent.subscriber[gUbxEvent.subscriberCount];
+			break;
+		}
+	}
+
+	osSetIntMask(prevIntMask);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxEventPost(const UbxEventType type)
+{
+	osSendMesg(&gUbxEvent.msgQueue, UbxEventToMesg(type), OS_MESG_NOBLOCK);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
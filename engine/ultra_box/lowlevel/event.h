@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <os_message.h>
+#include <os_thread.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_EVENT_MAX_QUEUE_LENGTH    32
+#define UBX_EVENT_MAX_SUBSCRIBER_COUNT 16
+
+#define UBX_EVENT_MASK(type) (1u << (type))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxEventType
+{
+	UBX_EVENT_SP,
+	UBX_EVENT_DP,
+	UBX_EVENT_VI,
+	UBX_EVENT_SI,
+	UBX_EVENT_PRENMI,
+
+	/* The PI interrupt belongs to the PI manager, so this event is posted by the loader each time it completes a
+	 * request rather than coming from the hardware. */
+	UBX_EVENT_PI,
+
+	UBX_EVENT_COUNT,
+} UbxEventType;
+
+typedef struct _UbxEventSubscriber
+{
+	OSMesgQueue* pQueue;
+
+	u32 eventMask;
+	u32 droppedCount;
+
+	/* Events forwarded since the subscriber last took them, whether or not their message made it into the queue. */
+	u32 pendingMask;
+} UbxEventSubscriber;
+
+typedef struct _UbxEventData
+{
+	OSThread thread;
+
+	OSMesgQueue msgQueue;
+	OSMesg msg[UBX_EVENT_MAX_QUEUE_LENGTH];
+
+	UbxEventSubscriber subscriber[UBX_EVENT_MAX_SUBSCRIBER_COUNT];
+
+	size_t subscriberCount;
+
+	OSPri threadPriority;
+} UbxEventData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxEventData gUbxEvent;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxEventSetDefaults();
+extern void _UbxEventInitialize();
+
+/* Forward every event matching the mask to a message queue. Each event arrives as its UbxEventType cast to an OSMesg.
+ * Events are never allowed to block the router, so any that arrive while the queue is full are dropped and counted. */
+extern void UbxEventSubscribe(OSMesgQueue* pQueue, u32 eventMask);
+
+/* Return the mask of events forwarded to a message queue since the last call and clear it. This includes events that
+ * were dropped because the queue was full, so a subscriber that can't afford to lose an event should check it every
+ * time it wakes up rather than relying on the event messages themselves. Repeats of an event are merged. */
+extern u32 UbxEventTakePending(OSMesgQueue* pQueue);
+
+/* Stop forwarding events to a message queue. */
+extern void UbxEventUnsubscribe(OSMesgQueue* pQueue);
+
+/* Send an event to every subscriber of its type from software. */
+extern void UbxEventPost(UbxEventType type);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline UbxEventType UbxEventFromMesg(const OSMesg msg)
+{
+	return (UbxEventType) (u32) msg;
+}
+
+static inline OSMesg UbxEventToMesg(const UbxEventType type)
+{
+	return (OSMesg) (u32) type;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -18,8 +18,271 @@
 
 #include "gfx.h"
 
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* RDP sync rules followed by the state tracker:
+ *
+ * - Pipe sync: required before changing any RDP attribute (othermode, combiner, colors, images, scissor) while a
+ *   primitive that uses it may still be in the pipeline.
+ * - Tile sync: required before changing a tile descriptor while a primitive or load may still be using it.
+ * - Load sync: required before loading TMEM while a primitive or earlier load may still be using it.
+ *
+ * Commands written with the regular 'gSP' and 'gDP' macros are invisible to the tracker, so any of them may have been
+ * a primitive; whenever the command list has grown since the last tracked command, every sync is considered pending.
+ */
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 UbxGfxCommand gUbxGfxCmd;
+UbxGfxState gUbxGfxState;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxGfxBeginTracked()
+{
+	if(UBX_GFX_CMD_LIST_TAIL != gUbxGfxState.pTrackedTail)
+	{
+		gUbxGfxState.pendingSync = UBX_GFX_SYNC_ALL;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxGfxEndTracked()
+{
+	gUbxGfxState.pTrackedTail = UBX_GFX_CMD_LIST_TAIL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxGfxSync(const u32 syncFlags)
+{
+	const u32 requiredSync = gUbxGfxState.pendingSync & syncFlags;
+
+	if(requiredSync & UBX_GFX_SYNC_PIPE)
+	{
+		gDPPipeSync(UBX_GFX_CMD_NEXT);
+	}
+
+	if(requiredSync & UBX_GFX_SYNC_TILE)
+	{
+		gDPTileSync(UBX_GFX_CMD_NEXT);
+	}
+
+	if(requiredSync & UBX_GFX_SYNC_LOAD)
+	{
+		gDPLoadSync(UBX_GFX_CMD_NEXT);
+	}
+
+	gUbxGfxState.pendingSync &= ~requiredSync;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static u32 _UbxGfxGetSlotSync(const u32 slot)
+{
+	if(slot == UBX_GFX_SLOT_TEXTURE || slot == UBX_GFX_SLOT_TEXTURE_IMAGE)
+	{
+		/* The RSP texture state and the texture image address aren't used by primitives in the RDP pipeline. */
+		return 0;
+	}
+
+	if(slot >= UBX_GFX_SLOT_TILE)
+	{
+		return UBX_GFX_SYNC_TILE;
+	}
+
+	return UBX_GFX_SYNC_PIPE;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static u32 _UbxGfxResolveSlot(const UbxGfxSlot slot, const Gfx* const pCmd)
+{
+	/* Both tile commands carry the tile index in the same bits. */
+	if(slot == UBX_GFX_SLOT_TILE || slot == UBX_GFX_SLOT_TILE_SIZE)
+	{
+		return (u32) slot + ((pCmd->words.w1 >> 24) & 0x7);
+	}
+
+	return (u32) slot;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxStateReset()
+{
+	memset(&gUbxGfxState, 0, sizeof(gUbxGfxState));
+
+	gUbxGfxState.pendingSync = UBX_GFX_SYNC_ALL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxStateAssumeGeometryMode(const u32 mask, const u32 mode)
+{
+	gUbxGfxState.geometryMode = (gUbxGfxState.geometryMode & ~mask) | (mode & mask);
+	gUbxGfxState.geometryModeKnownMask |= mask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxStateAssumeOtherModeH(const u32 mask, const u32 value)
+{
+	gUbxGfxState.otherModeH = (gUbxGfxState.otherModeH & ~mask) | (value & mask);
+	gUbxGfxState.otherModeHKnownMask |= mask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxStateAssumeOtherModeL(const u32 mask, const u32 value)
+{
+	gUbxGfxState.otherModeL = (gUbxGfxState.otherModeL & ~mask) | (value & mask);
+	gUbxGfxState.otherModeLKnownMask |= mask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxStateAssumeCommand(const UbxGfxSlot slot, const Gfx* const pCmd)
+{
+	const u32 resolvedSlot = _UbxGfxResolveSlot(slot, pCmd);
+
+	gUbxGfxState.slot[resolvedSlot] = *pCmd;
+	gUbxGfxState.slotKnownMask |= 1u << resolvedSlot;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxStateAssumeSynced(const u32 syncFlags)
+{
+	gUbxGfxState.pendingSync &= ~syncFlags;
+	gUbxGfxState.pTrackedTail = UBX_GFX_CMD_LIST_TAIL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxSetGeometryMode(const u32 clearBits, const u32 setBits)
+{
+	_UbxGfxBeginTracked();
+
+	const u32 knownMask = gUbxGfxState.geometryModeKnownMask;
+
+	/* Drop any bits that are already in the requested state. */
+	const u32 changedClearBits = clearBits & ~(knownMask & ~gUbxGfxState.geometryMode);
+	const u32 changedSetBits = setBits & ~(knownMask & gUbxGfxState.geometryMode);
+
+	if(changedClearBits || changedSetBits)
+	{
+		/* Geometry mode is RSP state, so no RDP sync is needed. */
+		gSPGeometryMode(UBX_GFX_CMD_NEXT, changedClearBits, changedSetBits);
+
+		gUbxGfxState.geometryMode = (gUbxGfxState.geometryMode & ~clearBits) | setBits;
+		gUbxGfxState.geometryModeKnownMask |= clearBits | setBits;
+	}
+	else
+	{
+		++gUbxGfxState.skippedCount;
+	}
+
+	_UbxGfxEndTracked();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxSetOtherModeH(const u32 shift, const u32 len, const u32 value)
+{
+	_UbxGfxBeginTracked();
+
+	const u32 mask = UBX_GFX_OTHERMODE_MASK(shift, len);
+
+	if((gUbxGfxState.otherModeHKnownMask & mask) != mask || (gUbxGfxState.otherModeH & mask) != (value & mask))
+	{
+		_UbxGfxSync(UBX_GFX_SYNC_PIPE);
+		gSPSetOtherMode(UBX_GFX_CMD_NEXT, G_SETOTHERMODE_H, shift, len, value);
+
+		UbxGfxStateAssumeOtherModeH(mask, value);
+	}
+	else
+	{
+		++gUbxGfxState.skippedCount;
+	}
+
+	_UbxGfxEndTracked();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxSetOtherModeL(const u32 shift, const u32 len, const u32 value)
+{
+	_UbxGfxBeginTracked();
+
+	const u32 mask = UBX_GFX_OTHERMODE_MASK(shift, len);
+
+	if((gUbxGfxState.otherModeLKnownMask & mask) != mask || (gUbxGfxState.otherModeL & mask) != (value & mask))
+	{
+		_UbxGfxSync(UBX_GFX_SYNC_PIPE);
+		gSPSetOtherMode(UBX_GFX_CMD_NEXT, G_SETOTHERMODE_L, shift, len, value);
+
+		UbxGfxStateAssumeOtherModeL(mask, value);
+	}
+	else
+	{
+		++gUbxGfxState.skippedCount;
+	}
+
+	_UbxGfxEndTracked();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxSetCommand(const UbxGfxSlot slot, const Gfx* const pCmd)
+{
+	_UbxGfxBeginTracked();
+
+	const u32 resolvedSlot = _UbxGfxResolveSlot(slot, pCmd);
+	const Gfx* const pShadow = &gUbxGfxState.slot[resolvedSlot];
+
+	if(!(gUbxGfxState.slotKnownMask & (1u << resolvedSlot))
+		|| pShadow->words.w0 != pCmd->words.w0
+		|| pShadow->words.w1 != pCmd->words.w1)
+	{
+		_UbxGfxSync(_UbxGfxGetSlotSync(resolvedSlot));
+		*UBX_GFX_CMD_NEXT = *pCmd;
+
+		UbxGfxStateAssumeCommand(slot, pCmd);
+	}
+	else
+	{
+		++gUbxGfxState.skippedCount;
+	}
+
+	_UbxGfxEndTracked();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxLoad(const Gfx* const pCmd)
+{
+	_UbxGfxBeginTracked();
+
+	_UbxGfxSync(UBX_GFX_SYNC_LOAD);
+	*UBX_GFX_CMD_NEXT = *pCmd;
+
+	/* The load is now using TMEM and the load tile until it finishes. */
+	gUbxGfxState.pendingSync |= UBX_GFX_SYNC_TILE | UBX_GFX_SYNC_LOAD;
+
+	_UbxGfxEndTracked();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxGfxPipeSync()
+{
+	_UbxGfxBeginTracked();
+	_UbxGfxSync(UBX_GFX_SYNC_PIPE);
+	_UbxGfxEndTracked();
+}
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -29,15 +29,66 @@ UBX_BEGIN_EXTERN_C;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+#define UBX_GFX_SYNC_PIPE 0x1
+#define UBX_GFX_SYNC_TILE 0x2
+#define UBX_GFX_SYNC_LOAD 0x4
+#define UBX_GFX_SYNC_ALL  (UBX_GFX_SYNC_PIPE | UBX_GFX_SYNC_TILE | UBX_GFX_SYNC_LOAD)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 typedef struct _UbxGfxCommand
 {
 	Gfx* pListTail;
 	Gfx* pListHead;
 } UbxGfxCommand;
 
+/* State that is set by a single command is shadowed as a copy of the last command emitted for it. */
+typedef enum _UbxGfxSlot
+{
+	UBX_GFX_SLOT_COMBINE,
+	UBX_GFX_SLOT_PRIM_COLOR,
+	UBX_GFX_SLOT_ENV_COLOR,
+	UBX_GFX_SLOT_BLEND_COLOR,
+	UBX_GFX_SLOT_FOG_COLOR,
+	UBX_GFX_SLOT_FILL_COLOR,
+	UBX_GFX_SLOT_PRIM_DEPTH,
+	UBX_GFX_SLOT_SCISSOR,
+	UBX_GFX_SLOT_COLOR_IMAGE,
+	UBX_GFX_SLOT_DEPTH_IMAGE,
+	UBX_GFX_SLOT_TEXTURE_IMAGE,
+	UBX_GFX_SLOT_TEXTURE,
+	UBX_GFX_SLOT_TILE,
+	UBX_GFX_SLOT_TILE_SIZE = UBX_GFX_SLOT_TILE + 8,
+
+	UBX_GFX_SLOT_COUNT = UBX_GFX_SLOT_TILE_SIZE + 8,
+} UbxGfxSlot;
+
+typedef struct _UbxGfxState
+{
+	Gfx slot[UBX_GFX_SLOT_COUNT];
+
+	Gfx* pTrackedTail;
+
+	u32 slotKnownMask;
+
+	u32 geometryMode;
+	u32 geometryModeKnownMask;
+
+	u32 otherModeH;
+	u32 otherModeHKnownMask;
+
+	u32 otherModeL;
+	u32 otherModeLKnownMask;
+
+	u32 pendingSync;
+
+	u32 skippedCount;
+} UbxGfxState;
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 extern UbxGfxCommand gUbxGfxCmd;
+extern UbxGfxState gUbxGfxState;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -46,6 +97,84 @@ extern UbxGfxCommand gUbxGfxCmd;
 #define UBX_GFX_CMD_LIST_HEAD    (gUbxGfxCmd.pListHead)
 #define UBX_GFX_CMD_LIST_TAIL    (gUbxGfxCmd.pListTail)
 
+#define UBX_GFX_OTHERMODE_MASK(shift, len) ((u32) (((1ull << (len)) - 1) << (shift)))
+
+/* Tracked equivalents of the 'gDP' and 'gSP' state commands. These write to the current command list only when the
+ * value differs from what the RCP already has, and insert whatever syncs the change requires. */
+#define UBX_GFX_SET_CYCLE_TYPE(type)       UbxGfxSetOtherModeH(G_MDSFT_CYCLETYPE, 2, (type))
+#define UBX_GFX_SET_TEXTURE_PERSP(type)    UbxGfxSetOtherModeH(G_MDSFT_TEXTPERSP, 1, (type))
+#define UBX_GFX_SET_TEXTURE_DETAIL(type)   UbxGfxSetOtherModeH(G_MDSFT_TEXTDETAIL, 2, (type))
+#define UBX_GFX_SET_TEXTURE_LOD(type)      UbxGfxSetOtherModeH(G_MDSFT_TEXTLOD, 1, (type))
+#define UBX_GFX_SET_TEXTURE_LUT(type)      UbxGfxSetOtherModeH(G_MDSFT_TEXTLUT, 2, (type))
+#define UBX_GFX_SET_TEXTURE_FILTER(type)   UbxGfxSetOtherModeH(G_MDSFT_TEXTFILT, 2, (type))
+#define UBX_GFX_SET_TEXTURE_CONVERT(type)  UbxGfxSetOtherModeH(G_MDSFT_TEXTCONV, 3, (type))
+#define UBX_GFX_SET_COLOR_DITHER(type)     UbxGfxSetOtherModeH(G_MDSFT_RGBDITHER, 2, (type))
+#define UBX_GFX_SET_ALPHA_COMPARE(type)    UbxGfxSetOtherModeL(G_MDSFT_ALPHACOMPARE, 2, (type))
+#define UBX_GFX_SET_DEPTH_SOURCE(type)     UbxGfxSetOtherModeL(G_MDSFT_ZSRCSEL, 1, (type))
+#define UBX_GFX_SET_RENDER_MODE(c0, c1)    UbxGfxSetOtherModeL(G_MDSFT_RENDERMODE, 29, (c0) | (c1))
+#define UBX_GFX_SET_GEOMETRY_MODE(mode)    UbxGfxSetGeometryMode(0, (mode))
+#define UBX_GFX_CLEAR_GEOMETRY_MODE(mode)  UbxGfxSetGeometryMode((mode), 0)
+
+#define _UBX_GFX_SET_SLOT(slot, cmd, ...) \
+	do { \
+		Gfx _ubxGfxSlotCmd; \
+		cmd(&_ubxGfxSlotCmd, __VA_ARGS__); \
+		UbxGfxSetCommand((slot), &_ubxGfxSlotCmd); \
+	} while(0)
+
+/* The combine mode names expand to the full LERP argument lists before they reach gDPSetCombineLERP. */
+#define UBX_GFX_SET_COMBINE_MODE(a, b)                _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_COMBINE, gDPSetCombineLERP, a, b)
+#define UBX_GFX_SET_PRIM_COLOR(m, l, r, g, b, a)      _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_PRIM_COLOR, gDPSetPrimColor, m, l, r, g, b, a)
+#define UBX_GFX_SET_ENV_COLOR(r, g, b, a)             _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_ENV_COLOR, gDPSetEnvColor, r, g, b, a)
+#define UBX_GFX_SET_BLEND_COLOR(r, g, b, a)           _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_BLEND_COLOR, gDPSetBlendColor, r, g, b, a)
+#define UBX_GFX_SET_FOG_COLOR(r, g, b, a)             _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_FOG_COLOR, gDPSetFogColor, r, g, b, a)
+#define UBX_GFX_SET_FILL_COLOR(color)                 _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_FILL_COLOR, gDPSetFillColor, color)
+#define UBX_GFX_SET_SCISSOR(mode, ulx, uly, lrx, lry) _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_SCISSOR, gDPSetScissor, mode, ulx, uly, lrx, lry)
+#define UBX_GFX_SET_COLOR_IMAGE(fmt, siz, w, addr)    _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_COLOR_IMAGE, gDPSetColorImage, fmt, siz, w, addr)
+#define UBX_GFX_SET_DEPTH_IMAGE(addr)                 _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_DEPTH_IMAGE, gDPSetDepthImage, addr)
+#define UBX_GFX_SET_TEXTURE(s, t, level, tile, on)    _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_TEXTURE, gSPTexture, s, t, level, tile, on)
+#define UBX_GFX_SET_TEXTURE_IMAGE(fmt, siz, w, addr)  _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_TEXTURE_IMAGE, gDPSetTextureImage, fmt, siz, w, addr)
+#define UBX_GFX_SET_TILE(...)                         _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_TILE, gDPSetTile, __VA_ARGS__)
+#define UBX_GFX_SET_TILE_SIZE(...)                    _UBX_GFX_SET_SLOT(UBX_GFX_SLOT_TILE_SIZE, gDPSetTileSize, __VA_ARGS__)
+
+#define UBX_GFX_LOAD_BLOCK(...) \
+	do { \
+		Gfx _ubxGfxLoadCmd; \
+		gDPLoadBlock(&_ubxGfxLoadCmd, __VA_ARGS__); \
+		UbxGfxLoad(&_ubxGfxLoadCmd); \
+	} while(0)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Forget all tracked state. This must be called whenever a new command list is started with UBX_GFX_CMD_USE. */
+extern void UbxGfxStateReset();
+
+/* Tell the tracker what state the RCP is in after a display list it can't see (such as a static init list) has run. */
+extern void UbxGfxStateAssumeGeometryMode(u32 mask, u32 mode);
+extern void UbxGfxStateAssumeOtherModeH(u32 mask, u32 value);
+extern void UbxGfxStateAssumeOtherModeL(u32 mask, u32 value);
+extern void UbxGfxStateAssumeCommand(UbxGfxSlot slot, const Gfx* pCmd);
+
+/* Tell the tracker that nothing has been drawn since the given syncs, either because the commands written since the
+ * last tracked one (matrices, vertices, untracked syncs) can't have drawn anything or because they end in a sync. */
+extern void UbxGfxStateAssumeSynced(u32 syncFlags);
+
+/* Clear then set bits in the RSP geometry mode. */
+extern void UbxGfxSetGeometryMode(u32 clearBits, u32 setBits);
+
+/* Set a field of the RDP othermode registers. */
+extern void UbxGfxSetOtherModeH(u32 shift, u32 len, u32 value);
+extern void UbxGfxSetOtherModeL(u32 shift, u32 len, u32 value);
+
+/* Emit a prebuilt state command for a slot. Tile descriptors are routed to their own slot based on the tile index. */
+extern void UbxGfxSetCommand(UbxGfxSlot slot, const Gfx* pCmd);
+
+/* Emit a texture or TLUT load command. */
+extern void UbxGfxLoad(const Gfx* pCmd);
+
+/* Emit a pipe sync only if something could have been drawn since the last one. */
+extern void UbxGfxPipeSync();
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 UBX_END_EXTERN_C;
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "job.h"
+#include "thread.h"
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxJobData gUbxJob;
+
+extern u8 _job_stack_end[];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxJobThread(void*)
+{
+	for(;;)
+	{
+		OSMesg msg;
+
+		/* Sleep until there is a job to run. */
+		osRecvMesg(&gUbxJob.msgQueue, &msg, OS_MESG_BLOCK);
+
+		UbxJob* const pJob = (UbxJob*) msg;
+
+		pJob->status = UBX_JOB_STATUS_RUNNING;
+		pJob->func(pJob, pJob->pUserData);
+		pJob->status = UBX_JOB_STATUS_COMPLETE;
+
+		if(pJob->pDoneQueue)
+		{
+			osSendMesg(pJob->pDoneQueue, pJob->doneMsg, OS_MESG_BLOCK);
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxJobSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxJob, 0, sizeof(gUbxJob));
+
+	gUbxJob.msgQueueLength = UBX_JOB_MAX_QUEUE_LENGTH;
+	gUbxJob.threadPriority = UBX_THREAD_PRI_JOB;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxJobInitialize()
+{
+	if(gUbxJob.msgQueueLength == 0 || gUbxJob.msgQueueLength > UBX_JOB_MAX_QUEUE_LENGTH)
+	{
+		gUbxJob.msgQueueLength = UBX_JOB_MAX_QUEUE_LENGTH;
+	}
+
+	osCreateMesgQueue(&gUbxJob.msgQueue, gUbxJob.msg, (s32) gUbxJob.msgQueueLength);
+
+	/* Start the job thread. */
+	osCreateThread(&gUbxJob.thread, UBX_THREAD_ID_JOB, _UbxJobThread, NULL, _job_stack_end, gUbxJob.threadPriority);
+	osStartThread(&gUbxJob.thread);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxJobInit(UbxJob* const pJob, const UbxJobFunc func, void* const pUserData)
+{
+	memset(pJob, 0, sizeof(UbxJob));
+
+	pJob->func = func;
+	pJob->pUserData = pUserData;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxJobSubmit(UbxJob* const pJob)
+{
+	pJob->status = UBX_JOB_STATUS_PENDING;
+
+	osSendMesg(&gUbxJob.msgQueue, (OSMesg) pJob, OS_MESG_BLOCK);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
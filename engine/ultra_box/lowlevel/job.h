@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <os_message.h>
+#include <os_thread.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_JOB_MAX_QUEUE_LENGTH 32
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxJobStatus
+{
+	UBX_JOB_STATUS_IDLE,
+	UBX_JOB_STATUS_PENDING,
+	UBX_JOB_STATUS_RUNNING,
+	UBX_JOB_STATUS_COMPLETE,
+} UbxJobStatus;
+
+typedef struct _UbxJob UbxJob;
+
+/* Job function; this is always invoked from the job thread. */
+typedef void (*UbxJobFunc)(UbxJob*, void*);
+
+struct _UbxJob
+{
+	UbxJobFunc func;
+
+	OSMesgQueue* pDoneQueue;
+
+	void* pUserData;
+
+	OSMesg doneMsg;
+
+	volatile UbxJobStatus status;
+};
+
+typedef struct _UbxJobData
+{
+	OSThread thread;
+
+	OSMesgQueue msgQueue;
+	OSMesg msg[UBX_JOB_MAX_QUEUE_LENGTH];
+
+	size_t msgQueueLength;
+
+	OSPri threadPriority;
+} UbxJobData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxJobData gUbxJob;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxJobSetDefaults();
+extern void _UbxJobInitialize();
+
+/* Fill out a job with no completion message queue. */
+extern void UbxJobInit(UbxJob* pJob, UbxJobFunc func, void* pUserData);
+
+/* Queue a job to run in the background. Jobs run one at a time in the order they were submitted, and only when no
+ * other engine or game thread has anything to do. The job is owned by the job thread until it has completed. */
+extern void UbxJobSubmit(UbxJob* pJob);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline int UbxJobIsComplete(const UbxJob* const pJob)
+{
+	return pJob->status == UBX_JOB_STATUS_COMPLETE;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
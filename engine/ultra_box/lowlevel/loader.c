@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "loader.h"
+#include "device.h"
+#include "event.h"
+#include "thread.h"
+
+#include <os_cache.h>
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxLoaderData gUbxLoader;
+
+extern u8 _loader_stack_end[];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxLoaderEnqueue(UbxLoaderRequest* const pRequest)
+{
+	const UbxLoaderPriority priority = pRequest->priority;
+
+	pRequest->pNext = NULL;
+
+	if(gUbxLoader.pTail[priority])
+	{
+		gUbxLoader.pTail[priority]->pNext = pRequest;
+	}
+	else
+	{
+		gUbxLoader.pHead[priority] = pRequest;
+	}
+
+	gUbxLoader.pTail[priority] = pRequest;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UbxLoaderRequest* _UbxLoaderPeek()
+{
+	for(size_t i = 0; i < UBX_LOADER_PRIORITY_COUNT; ++i)
+	{
+		if(gUbxLoader.pHead[i])
+		{
+			return gUbxLoader.pHead[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxLoaderComplete(UbxLoaderRequest* const pRequest)
+{
+	const UbxLoaderPriority priority = pRequest->priority;
+
+	/* Completed requests are always at the head of their list. */
+	gUbxLoader.pHead[priority] = pRequest->pNext;
+	if(!gUbxLoader.pHead[priority])
+	{
+		gUbxLoader.pTail[priority] = NULL;
+	}
+
+	pRequest->pNext = NULL;
+	pRequest->status = UBX_LOADER_STATUS_COMPLETE;
+
+	if(pRequest->onComplete)
+	{
+		pRequest->onComplete(pRequest, pRequest->pUserData);
+	}
+
+	if(pRequest->pDoneQueue)
+	{
+		osSendMesg(pRequest->pDoneQueue, pRequest->doneMsg, OS_MESG_BLOCK);
+	}
+
+	UbxEventPost(UBX_EVENT_PI);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxLoaderThread(void*)
+{
+	for(;;)
+	{
+		OSMesg msg;
+
+		/* Sleep until there is work to do when nothing is pending; otherwise, just pick up any new requests
+		 * without blocking so they are considered before the next chunk is transferred. */
+		const s32 flags = _UbxLoaderPeek() ? OS_MESG_NOBLOCK : OS_MESG_BLOCK;
+
+		if(osRecvMesg(&gUbxLoader.requestMsgQueue, &msg, flags) == 0)
+		{
+			_UbxLoaderEnqueue((UbxLoaderRequest*) msg);
+
+			while(osRecvMesg(&gUbxLoader.requestMsgQueue, &msg, OS_MESG_NOBLOCK) == 0)
+			{
+				_UbxLoaderEnqueue((UbxLoaderRequest*) msg);
+			}
+		}
+
+		UbxLoaderRequest* const pRequest = _UbxLoaderPeek();
+
+		if(pRequest->status == UBX_LOADER_STATUS_PENDING)
+		{
+			/* Invalidate the whole destination up front so no stale cache lines can be written back over it. */
+			osInvalDCache(pRequest->pDest, (s32) pRequest->size);
+			pRequest->status = UBX_LOADER_STATUS_ACTIVE;
+		}
+
+		/* Large transfers are split into chunks so that a higher priority request submitted in the meantime
+		 * only has to wait for the current chunk to finish rather than the whole transfer. */
+		u32 chunkSize = pRequest->size - pRequest->offset;
+		if(chunkSize > gUbxLoader.chunkSize)
+		{
+			chunkSize = (u32) gUbxLoader.chunkSize;
+		}
+
+		if(chunkSize > 0)
+		{
+			OSIoMesg* const pIoMsg = &gUbxLoader.ioMsg;
+
+			pIoMsg->hdr.pri = OS_MESG_PRI_NORMAL;
+			pIoMsg->hdr.retQueue = &gUbxLoader.dmaMsgQueue;
+			pIoMsg->dramAddr = (u8*) pRequest->pDest + pRequest->offset;
+			pIoMsg->devAddr = pRequest->devAddr + pRequest->offset;
+			pIoMsg->size = chunkSize;
+
+			osEPiStartDma(pRequest->pPiHandle, pIoMsg, OS_READ);
+			osRecvMesg(&gUbxLoader.dmaMsgQueue, NULL, OS_MESG_BLOCK);
+
+			pRequest->offset += chunkSize;
+		}
+
+		if(pRequest->offset >= pRequest->size)
+		{
+			_UbxLoaderComplete(pRequest);
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxLoaderSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxLoader, 0, sizeof(gUbxLoader));
+
+	gUbxLoader.requestMsgQueueLength = UBX_LOADER_MAX_QUEUE_LENGTH;
+	gUbxLoader.chunkSize = 0x4000;
+	gUbxLoader.threadPriority = UBX_THREAD_PRI_LOADER;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxLoaderInitialize()
+{
+	if(gUbxLoader.requestMsgQueueLength == 0 || gUbxLoader.requestMsgQueueLength > UBX_LOADER_MAX_QUEUE_LENGTH)
+	{
+		gUbxLoader.requestMsgQueueLength = UBX_LOADER_MAX_QUEUE_LENGTH;
+	}
+
+	/* The PI requires transfer sizes to stay 2-byte aligned, and keeping chunks 8-byte aligned means
+	 * the RAM address of every chunk after the first stays aligned as well. */
+	gUbxLoader.chunkSize &= ~0x7;
+	if(gUbxLoader.chunkSize == 0)
+	{
+		gUbxLoader.chunkSize = 0x4000;
+	}
+
+	osCreateMesgQueue(&gUbxLoader.requestMsgQueue, gUbxLoader.requestMsg, (s32) gUbxLoader.requestMsgQueueLength);
+	osCreateMesgQueue(&gUbxLoader.dmaMsgQueue, &gUbxLoader.dmaMsg, 1);
+
+	/* Start the loader thread. */
+	osCreateThread(&gUbxLoader.thread, UBX_THREAD_ID_LOADER, _UbxLoaderThread, NULL, _loader_stack_end, gUbxLoader.threadPriority);
+	osStartThread(&gUbxLoader.thread);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxLoaderInitRequest(
+	UbxLoaderRequest* const pRequest,
+	void* const pDest,
+	const u32 romAddr,
+	const u32 size,
+	const UbxLoaderPriority priority)
+{
+	memset(pRequest, 0, sizeof(UbxLoaderRequest));
+
+	pRequest->pPiHandle = gUbxDevice.pCartRom;
+	pRequest->pDest = pDest;
+	pRequest->devAddr = romAddr;
+	pRequest->size = size;
+	pRequest->priority = priority;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxLoaderSubmit(UbxLoaderRequest* const pRequest)
+{
+	if(pRequest->priority >= UBX_LOADER_PRIORITY_COUNT)
+	{
+		pRequest->priority = UBX_LOADER_PRIORITY_LOW;
+	}
+
+	pRequest->pNext = NULL;
+	pRequest->offset = 0;
+	pRequest->status = UBX_LOADER_STATUS_PENDING;
+
+	osSendMesg(&gUbxLoader.requestMsgQueue, (OSMesg) pRequest, OS_MESG_BLOCK);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxLoaderReadSync(void* const pDest, const u32 romAddr, const u32 size)
+{
+	OSMesgQueue doneMsgQueue;
+	OSMesg doneMsg;
+
+	UbxLoaderRequest request;
+
+	osCreateMesgQueue(&doneMsgQueue, &doneMsg, 1);
+
+	UbxLoaderInitRequest(&request, pDest, romAddr, size, UBX_LOADER_PRIORITY_HIGH);
+	request.pDoneQueue = &doneMsgQueue;
+
+	UbxLoaderSubmit(&request);
+	osRecvMesg(&doneMsgQueue, NULL, OS_MESG_BLOCK);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
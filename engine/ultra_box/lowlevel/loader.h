@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <os_message.h>
+#include <os_pi.h>
+#include <os_thread.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_LOADER_MAX_QUEUE_LENGTH 16
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxLoaderPriority
+{
+	UBX_LOADER_PRIORITY_HIGH,
+	UBX_LOADER_PRIORITY_NORMAL,
+	UBX_LOADER_PRIORITY_LOW,
+
+	UBX_LOADER_PRIORITY_COUNT,
+} UbxLoaderPriority;
+
+typedef enum _UbxLoaderStatus
+{
+	UBX_LOADER_STATUS_IDLE,
+	UBX_LOADER_STATUS_PENDING,
+	UBX_LOADER_STATUS_ACTIVE,
+	UBX_LOADER_STATUS_COMPLETE,
+} UbxLoaderStatus;
+
+typedef struct _UbxLoaderRequest UbxLoaderRequest;
+
+/* Completion callback; this is always invoked from the loader thread. */
+typedef void (*UbxLoaderCallback)(UbxLoaderRequest*, void*);
+
+struct _UbxLoaderRequest
+{
+	UbxLoaderRequest* pNext;
+
+	OSPiHandle* pPiHandle;
+	OSMesgQueue* pDoneQueue;
+
+	UbxLoaderCallback onComplete;
+
+	void* pUserData;
+	void* pDest;
+
+	OSMesg doneMsg;
+
+	u32 devAddr;
+	u32 size;
+	u32 offset;
+
+	UbxLoaderPriority priority;
+
+	volatile UbxLoaderStatus status;
+};
+
+typedef struct _UbxLoaderData
+{
+	OSThread thread;
+
+	OSMesgQueue requestMsgQueue;
+	OSMesg requestMsg[UBX_LOADER_MAX_QUEUE_LENGTH];
+
+	OSMesgQueue dmaMsgQueue;
+	OSMesg dmaMsg;
+
+	OSIoMesg ioMsg;
+
+	UbxLoaderRequest* pHead[UBX_LOADER_PRIORITY_COUNT];
+	UbxLoaderRequest* pTail[UBX_LOADER_PRIORITY_COUNT];
+
+	size_t requestMsgQueueLength;
+	size_t chunkSize;
+
+	OSPri threadPriority;
+} UbxLoaderData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxLoaderData gUbxLoader;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxLoaderSetDefaults();
+extern void _UbxLoaderInitialize();
+
+/* Fill out a request for reading from the cartridge ROM with no completion callback or message queue.
+ * The destination must be 8-byte aligned, and the ROM address and size must both be 2-byte aligned. */
+extern void UbxLoaderInitRequest(UbxLoaderRequest* pRequest, void* pDest, u32 romAddr, u32 size, UbxLoaderPriority priority);
+
+/* Queue a request on the loader thread. The request is owned by the loader until it has completed, and the
+ * destination memory must not be touched by the CPU during that time since its cache lines are invalidated. */
+extern void UbxLoaderSubmit(UbxLoaderRequest* pRequest);
+
+/* Read from the cartridge ROM at high priority, blocking the calling thread until the data has arrived. */
+extern void UbxLoaderReadSync(void* pDest, u32 romAddr, u32 size);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline int UbxLoaderIsComplete(const UbxLoaderRequest* const pRequest)
+{
+	return pRequest->status == UBX_LOADER_STATUS_COMPLETE;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "overlay.h"
+#include "loader.h"
+
+#include <os_cache.h>
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxOverlayLoad(const UbxOverlay* const pOverlay)
+{
+	const u32 loadSize = (u32) (pOverlay->pBssStart - pOverlay->pRamStart);
+	const u32 totalSize = (u32) (pOverlay->pRamEnd - pOverlay->pRamStart);
+
+	/* Only the code and data are stored in ROM; the loader takes care of invalidating the data cache over them. */
+	UbxLoaderReadSync(pOverlay->pRamStart, (u32) pOverlay->pRomStart, loadSize);
+
+	/* Any instructions left in the cache from the overlay that previously occupied this region are now stale. */
+	osInvalICache(pOverlay->pRamStart, (s32) totalSize);
+
+	/* The BSS is zeroed by the CPU rather than copied from ROM since the ROM only has to store what gets loaded. */
+	memset(pOverlay->pBssStart, 0, (size_t) (pOverlay->pRamEnd - pOverlay->pBssStart));
+
+	for(const UbxOverlayInitFunc* pInit = pOverlay->pInitStart; pInit < pOverlay->pInitEnd; ++pInit)
+	{
+		(*pInit)();
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
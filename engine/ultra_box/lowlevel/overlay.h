@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <ultratypes.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef void (*UbxOverlayInitFunc)();
+
+typedef struct _UbxOverlay
+{
+	u8* pRamStart;
+	u8* pBssStart;
+	u8* pRamEnd;
+
+	const UbxOverlayInitFunc* pInitStart;
+	const UbxOverlayInitFunc* pInitEnd;
+
+	u8* pRomStart;
+	u8* pRomEnd;
+} UbxOverlay;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Declare the linker symbols for an overlay added to the project with csbuild.AddN64Overlay(). */
+#define UBX_OVERLAY_DECLARE(name) \
+	extern u8 _ovl_##name##_ram_start[]; \
+	extern u8 _ovl_##name##_bss_start[]; \
+	extern u8 _ovl_##name##_ram_end[]; \
+	extern const UbxOverlayInitFunc _ovl_##name##_init_start[]; \
+	extern const UbxOverlayInitFunc _ovl_##name##_init_end[]; \
+	extern u8 _ovl_##name##_rom_start[]; \
+	extern u8 _ovl_##name##_rom_end[]
+
+/* Initializer for a UbxOverlay object from the linker symbols of a declared overlay. */
+#define UBX_OVERLAY_INIT(name) \
+	{ \
+		_ovl_##name##_ram_start, \
+		_ovl_##name##_bss_start, \
+		_ovl_##name##_ram_end, \
+		_ovl_##name##_init_start, \
+		_ovl_##name##_init_end, \
+		_ovl_##name##_rom_start, \
+		_ovl_##name##_rom_end, \
+	}
+
+/* Register a function inside an overlay source file to be called each time that overlay is loaded. */
+#define UBX_OVERLAY_INIT_HOOK(func) \
+	static const UbxOverlayInitFunc _ubxOverlayInitHook_##func \
+		__attribute__((section(".ubx_ovl_init"), used)) = func
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Load an overlay into its RAM region and run its init hooks, blocking until everything has completed. No code or
+ * data from any other overlay sharing the same region may be in use when this is called since it will be overwritten. */
+extern void UbxOverlayLoad(const UbxOverlay* pOverlay);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "sched.h"
+#include "event.h"
+#include "thread.h"
+
+#include "../debug/profiler.h"
+#include "../debug/trace.h"
+
+#include <os_time.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_SCHED_PENDING_RSP 0x1
+#define UBX_SCHED_PENDING_RDP 0x2
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxSchedData gUbxSched;
+
+extern u8 _sched_stack_end[];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSchedEnqueue(UbxSchedTask** const ppHead, UbxSchedTask** const ppTail, UbxSchedTask* const pSchedTask)
+{
+	pSchedTask->pNext = NULL;
+
+	if(*ppTail)
+	{
+		(*ppTail)->pNext = pSchedTask;
+	}
+	else
+	{
+		*ppHead = pSchedTask;
+	}
+
+	*ppTail = pSchedTask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static UbxSchedTask* _UbxSchedDequeue(UbxSchedTask** const ppHead, UbxSchedTask** const ppTail)
+{
+	UbxSchedTask* const pSchedTask = *ppHead;
+
+	*ppHead = pSchedTask->pNext;
+	if(!*ppHead)
+	{
+		*ppTail = NULL;
+	}
+
+	pSchedTask->pNext = NULL;
+	return pSchedTask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSchedComplete(UbxSchedTask* const pSchedTask)
+{
+	pSchedTask->status = UBX_SCHED_STATUS_COMPLETE;
+
+	UBX_TRACE_TASK(UBX_TRACE_EVENT_TASK_COMPLETE, pSchedTask->pTask->t.type, pSchedTask);
+
+	if(pSchedTask->pDoneQueue)
+	{
+		osSendMesg(pSchedTask->pDoneQueue, pSchedTask->doneMsg, OS_MESG_NOBLOCK);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSchedStartRsp(UbxSchedTask* const pSchedTask)
+{
+	gUbxSched.pRspTask = pSchedTask;
+	pSchedTask->status = UBX_SCHED_STATUS_RUNNING;
+
+	_UBX_PROFILER_ON_RSP_START(pSchedTask->pTask);
+	UBX_TRACE_TASK(UBX_TRACE_EVENT_TASK_START, pSchedTask->pTask->t.type, pSchedTask);
+	osSpTaskStart(pSchedTask->pTask);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSchedDispatch()
+{
+	if(gUbxSched.pRspTask)
+	{
+		return;
+	}
+
+	if(gUbxSched.pAudioHead)
+	{
+		_UbxSchedStartRsp(_UbxSchedDequeue(&gUbxSched.pAudioHead, &gUbxSched.pAudioTail));
+	}
+	else if(gUbxSched.pYieldedTask)
+	{
+		/* Resume the graphics task that was interrupted; the yielded flag in the task tells the microcode to restore its state. */
+		UbxSchedTask* const pSchedTask = gUbxSched.pYieldedTask;
+		gUbxSched.pYieldedTask = NULL;
+
+		_UbxSchedStartRsp(pSchedTask);
+	}
+	else if(gUbxSched.pGfxHead && !gUbxSched.pRdpTask)
+	{
+		/* Graphics tasks wait for the RDP to finish the previous one since they share the frame and depth buffers. */
+		UbxSchedTask* const pSchedTask = _UbxSchedDequeue(&gUbxSched.pGfxHead, &gUbxSched.pGfxTail);
+		gUbxSched.pRdpTask = pSchedTask;
+		pSchedTask->startCount = osGetCount();
+
+		_UBX_PROFILER_ON_RDP_START();
+		_UbxSchedStartRsp(pSchedTask);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSchedOnSubmit(UbxSchedTask* const pSchedTask)
+{
+	if(pSchedTask->pTask->t.type == M_AUDTASK)
+	{
+		pSchedTask->pendingFlags = UBX_SCHED_PENDING_RSP;
+		_UbxSchedEnqueue(&gUbxSched.pAudioHead, &gUbxSched.pAudioTail, pSchedTask);
+
+		UbxSchedTask* const pRspTask = gUbxSched.pRspTask;
+
+		/* Get the audio task on the RSP as soon as possible if a graphics task is in the way. */
+		if(gUbxSched.enableYield
+			&& !gUbxSched.yieldRequested
+			&& pRspTask
+			&& pRspTask->pTask->t.type == M_GFXTASK
+			&& pRspTask->pTask->t.yield_data_ptr)
+		{
+			gUbxSched.yieldRequested = 1;
+			osSpTaskYield();
+		}
+	}
+	else
+	{
+		pSchedTask->pendingFlags = UBX_SCHED_PENDING_RSP | UBX_SCHED_PENDING_RDP;
+		_UbxSchedEnqueue(&gUbxSched.pGfxHead, &gUbxSched.pGfxTail, pSchedTask);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSchedOnRspDone()
+{
+	UbxSchedTask* const pSchedTask = gUbxSched.pRspTask;
+
+	if(!pSchedTask)
+	{
+		return;
+	}
+
+	gUbxSched.pRspTask = NULL;
+
+	_UBX_PROFILER_ON_RSP_DONE(pSchedTask->pTask);
+
+	if(gUbxSched.yieldRequested)
+	{
+		gUbxSched.yieldRequested = 0;
+
+		/* The task may have finished before it got the yield request, in which case it's handled as normal. */
+		if(pSchedTask->pTask->t.type == M_GFXTASK && osSpTaskYielded(pSchedTask->pTask))
+		{
+			pSchedTask->status = UBX_SCHED_STATUS_YIELDED;
+			gUbxSched.pYieldedTask = pSchedTask;
+			return;
+		}
+	}
+
+	pSchedTask->pendingFlags &= ~UBX_SCHED_PENDING_RSP;
+
+	if(!pSchedTask->pendingFlags)
+	{
+		_UbxSchedComplete(pSchedTask);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSchedOnRdpDone()
+{
+	UbxSchedTask* const pSchedTask = gUbxSched.pRdpTask;
+
+	if(!pSchedTask)
+	{
+		return;
+	}
+
+	gUbxSched.pRdpTask = NULL;
+	pSchedTask->pendingFlags &= ~UBX_SCHED_PENDING_RDP;
+	pSchedTask->rdpDoneCount = osGetCount();
+
+	_UBX_PROFILER_ON_RDP_DONE();
+
+	if(!pSchedTask->pendingFlags)
+	{
+		_UbxSchedComplete(pSchedTask);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSchedThread(void*)
+{
+	for(;;)
+	{
+		OSMesg msg;
+
+		osRecvMesg(&gUbxSched.msgQueue, &msg, OS_MESG_BLOCK);
+
+		/* Events from the router are small integers while submitted tasks are always pointers into RAM. */
+		if((u32) msg >= UBX_EVENT_COUNT)
+		{
+			_UbxSchedOnSubmit((UbxSchedTask*) msg);
+		}
+
+		/* Submits can fill the queue and make the router drop an event message, so the completions are always taken
+		 * from the router's pending mask instead; the messages only wake the thread up. A repeated event can't be
+		 * missed by merging since only one task at a time is ever running on each processor. */
+		const u32 pendingMask = UbxEventTakePending(&gUbxSched.msgQueue);
+
+		if(pendingMask & UBX_EVENT_MASK(UBX_EVENT_SP))
+		{
+			_UbxSchedOnRspDone();
+		}
+
+		if(pendingMask & UBX_EVENT_MASK(UBX_EVENT_DP))
+		{
+			_UbxSchedOnRdpDone();
+		}
+
+		_UbxSchedDispatch();
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxSchedSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxSched, 0, sizeof(gUbxSched));
+
+	gUbxSched.threadPriority = UBX_THREAD_PRI_SCHED;
+	gUbxSched.enableYield = 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxSchedInitialize()
+{
+	osCreateMesgQueue(&gUbxSched.msgQueue, gUbxSched.msg, UBX_SCHED_MAX_QUEUE_LENGTH);
+	UbxEventSubscribe(&gUbxSched.msgQueue, UBX_EVENT_MASK(UBX_EVENT_SP) | UBX_EVENT_MASK(UBX_EVENT_DP));
+
+	/* Start the scheduler thread. */
+	osCreateThread(&gUbxSched.thread, UBX_THREAD_ID_SCHED, _UbxSchedThread, NULL, _sched_stack_end, gUbxSched.threadPriority);
+	osStartThread(&gUbxSched.thread);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSchedInitTask(UbxSchedTask* const pSchedTask, OSTask* const pTask)
+{
+	memset(pSchedTask, 0, sizeof(UbxSchedTask));
+
+	pSchedTask->pTask = pTask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSchedSubmit(UbxSchedTask* const pSchedTask)
+{
+	pSchedTask->pTask->t.flags &= ~OS_TASK_YIELDED;
+	pSchedTask->status = UBX_SCHED_STATUS_PENDING;
+
+	UBX_TRACE_TASK(UBX_TRACE_EVENT_TASK_SUBMIT, pSchedTask->pTask->t.type, pSchedTask);
+
+	osSendMesg(&gUbxSched.msgQueue, (OSMesg) pSchedTask, OS_MESG_BLOCK);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
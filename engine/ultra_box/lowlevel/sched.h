@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <os_message.h>
+#include <os_thread.h>
+#include <sptask.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_SCHED_MAX_QUEUE_LENGTH 16
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxSchedStatus
+{
+	UBX_SCHED_STATUS_IDLE,
+	UBX_SCHED_STATUS_PENDING,
+	UBX_SCHED_STATUS_RUNNING,
+	UBX_SCHED_STATUS_YIELDED,
+	UBX_SCHED_STATUS_COMPLETE,
+} UbxSchedStatus;
+
+typedef struct _UbxSchedTask UbxSchedTask;
+
+struct _UbxSchedTask
+{
+	UbxSchedTask* pNext;
+
+	OSTask* pTask;
+	OSMesgQueue* pDoneQueue;
+
+	OSMesg doneMsg;
+
+	u32 pendingFlags;
+
+	/* CPU counter values recorded when a graphics task was started and when the RDP finished with it. */
+	u32 startCount;
+	u32 rdpDoneCount;
+
+	volatile UbxSchedStatus status;
+};
+
+typedef struct _UbxSchedData
+{
+	OSThread thread;
+
+	OSMesgQueue msgQueue;
+	OSMesg msg[UBX_SCHED_MAX_QUEUE_LENGTH];
+
+	UbxSchedTask* pAudioHead;
+	UbxSchedTask* pAudioTail;
+	UbxSchedTask* pGfxHead;
+	UbxSchedTask* pGfxTail;
+
+	UbxSchedTask* pRspTask;
+	UbxSchedTask* pRdpTask;
+	UbxSchedTask* pYieldedTask;
+
+	OSPri threadPriority;
+
+	u8 enableYield;
+	u8 yieldRequested;
+} UbxSchedData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxSchedData gUbxSched;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxSchedSetDefaults();
+extern void _UbxSchedInitialize();
+
+/* Fill out a scheduler task wrapping an RSP task with no completion message queue. */
+extern void UbxSchedInitTask(UbxSchedTask* pSchedTask, OSTask* pTask);
+
+/* Queue a task to run on the RCP. Audio tasks always run before graphics tasks, and when yielding is enabled, an audio
+ * task will interrupt a running graphics task that has yield data. Graphics tasks run one at a time in submission order
+ * and are not considered complete until the RDP has finished with them as well. */
+extern void UbxSchedSubmit(UbxSchedTask* pSchedTask);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline int UbxSchedIsComplete(const UbxSchedTask* const pSchedTask)
+{
+	return pSchedTask->status == UBX_SCHED_STATUS_COMPLETE;
+}
+
+/* Block until a task has completed. The task must have a completion message queue, and only one thread may wait on
+ * that queue at a time. Messages left in the queue by tasks that had already completed are skipped over. */
+static inline void UbxSchedWait(const UbxSchedTask* const pSchedTask)
+{
+	while(!UbxSchedIsComplete(pSchedTask))
+	{
+		osRecvMesg(pSchedTask->pDoneQueue, NULL, OS_MESG_BLOCK);
+	}
+}
+
+/* Time in CPU counter cycles that a completed graphics task had the RCP for, including any time it spent yielded. */
+static inline u32 UbxSchedGetGfxCount(const UbxSchedTask* const pSchedTask)
+{
+	return pSchedTask->rdpDoneCount - pSchedTask->startCount;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
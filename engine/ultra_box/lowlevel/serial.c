@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "serial.h"
+#include "event.h"
+#include "thread.h"
+
+#include <os_eeprom.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Time the EEPROM needs to store a written block; this is the same delay libultra's osEepromLongWrite() waits. */
+#define UBX_SERIAL_EEPROM_WRITE_DELAY_USEC 12000
+
+/* Message sent by the EEPROM timer. It's past the last event, and like the events, it can never be a pointer. */
+#define UBX_SERIAL_TIMER_MSG ((OSMesg) UBX_EVENT_COUNT)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxSerialData gUbxSerial;
+
+extern u8 _serial_stack_end[];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSerialReadControllers()
+{
+	const u32 nextIndex = (gUbxSerial.padIndex + 1) % UBX_SERIAL_PAD_BUFFER_COUNT;
+
+	/* The first wait is handled inside libultra; the second waits for the read itself to finish. */
+	osContStartReadData(&gUbxSerial.siMsgQueue);
+	osRecvMesg(&gUbxSerial.siMsgQueue, NULL, OS_MESG_BLOCK);
+	osContGetReadData(gUbxSerial.pad[nextIndex]);
+
+	/* Publish the new buffer only once it has been completely filled. */
+	gUbxSerial.padIndex = nextIndex;
+	++gUbxSerial.readCount;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static u8 _UbxSerialStepEeprom(UbxSerialRequest* const pRequest)
+{
+	if(!gUbxSerial.eepromType)
+	{
+		pRequest->result = CONT_NO_RESPONSE_ERROR;
+		return 1;
+	}
+
+	if(pRequest->progress >= pRequest->size)
+	{
+		pRequest->result = 0;
+		return 1;
+	}
+
+	const u8 address = (u8) (pRequest->offset + (pRequest->progress / EEPROM_BLOCK_SIZE));
+	u8* const pData = pRequest->pBuffer + pRequest->progress;
+
+	pRequest->result = (pRequest->op == UBX_SERIAL_OP_EEPROM_READ)
+		? osEepromRead(&gUbxSerial.siMsgQueue, address, pData)
+		: osEepromWrite(&gUbxSerial.siMsgQueue, address, pData);
+
+	if(pRequest->result != 0)
+	{
+		return 1;
+	}
+
+	pRequest->progress += EEPROM_BLOCK_SIZE;
+
+	/* Leave the EEPROM alone until it has stored the block, but keep reading the controllers in the meantime. A write
+	 * finishes on the step after its last block has been stored. */
+	if(pRequest->op == UBX_SERIAL_OP_EEPROM_WRITE)
+	{
+		gUbxSerial.eepromBusy = 1;
+		osSetTimer(
+			&gUbxSerial.eepromTimer,
+			OS_USEC_TO_CYCLES(UBX_SERIAL_EEPROM_WRITE_DELAY_USEC),
+			0,
+			&gUbxSerial.msgQueue,
+			UBX_SERIAL_TIMER_MSG);
+
+		return 0;
+	}
+
+	return pRequest->progress >= pRequest->size;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static u8 _UbxSerialStepPak(UbxSerialRequest* const pRequest)
+{
+	const u32 remaining = (pRequest->progress < pRequest->size) ? pRequest->size - pRequest->progress : 0;
+	const u32 stepSize = (remaining > UBX_SERIAL_PAK_STEP_SIZE) ? UBX_SERIAL_PAK_STEP_SIZE : remaining;
+
+	if(stepSize == 0)
+	{
+		pRequest->result = 0;
+		return 1;
+	}
+
+	pRequest->result = osPfsReadWriteFile(
+		pRequest->pPfs,
+		pRequest->fileNo,
+		(pRequest->op == UBX_SERIAL_OP_PAK_READ) ? PFS_READ : PFS_WRITE,
+		(int) (pRequest->offset + pRequest->progress),
+		(int) stepSize,
+		pRequest->pBuffer + pRequest->progress);
+
+	pRequest->progress += stepSize;
+	return (pRequest->result != 0) || (pRequest->progress >= pRequest->size);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Run the next step of a request, returning non-zero once the request has finished. Each step is kept short enough
+ * that the controllers can still be read on time when a retrace arrives while it's running. */
+static u8 _UbxSerialStepRequest(UbxSerialRequest* const pRequest)
+{
+	OSMesgQueue* const pSiQueue = &gUbxSerial.siMsgQueue;
+
+	switch(pRequest->op)
+	{
+		case UBX_SERIAL_OP_CONT_QUERY:
+			osContStartQuery(pSiQueue);
+			osRecvMesg(pSiQueue, NULL, OS_MESG_BLOCK);
+			osContGetQuery(gUbxSerial.contStatus);
+			pRequest->result = 0;
+			return 1;
+
+		case UBX_SERIAL_OP_EEPROM_READ:
+		case UBX_SERIAL_OP_EEPROM_WRITE:
+			return _UbxSerialStepEeprom(pRequest);
+
+		case UBX_SERIAL_OP_PAK_INIT:
+			pRequest->result = osPfsInitPak(pSiQueue, pRequest->pPfs, pRequest->channel);
+			return 1;
+
+		case UBX_SERIAL_OP_PAK_READ:
+		case UBX_SERIAL_OP_PAK_WRITE:
+			return _UbxSerialStepPak(pRequest);
+
+		case UBX_SERIAL_OP_RUMBLE_INIT:
+			pRequest->result = osMotorInit(pSiQueue, pRequest->pPfs, pRequest->channel);
+			return 1;
+
+		case UBX_SERIAL_OP_RUMBLE_START:
+			pRequest->result = osMotorStart(pRequest->pPfs);
+			return 1;
+
+		case UBX_SERIAL_OP_RUMBLE_STOP:
+			pRequest->result = osMotorStop(pRequest->pPfs);
+			return 1;
+
+		default:
+			break;
+	}
+
+	pRequest->result = -1;
+	return 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSerialThread(void*)
+{
+	for(;;)
+	{
+		OSMesg msg;
+
+		osRecvMesg(&gUbxSerial.msgQueue, &msg, OS_MESG_BLOCK);
+
+		/* Events from the router are small integers while submitted requests are always pointers into RAM. */
+		if(msg == UBX_SERIAL_TIMER_MSG)
+		{
+			gUbxSerial.eepromBusy = 0;
+		}
+		else if((u32) msg < UBX_EVENT_COUNT)
+		{
+			if(UbxEventFromMesg(msg) == UBX_EVENT_VI && gUbxSerial.enableRead)
+			{
+				_UbxSerialReadControllers();
+			}
+		}
+		else
+		{
+			UbxSerialRequest* const pRequest = (UbxSerialRequest*) msg;
+
+			pRequest->pNext = NULL;
+
+			if(gUbxSerial.pTail)
+			{
+				gUbxSerial.pTail->pNext = pRequest;
+			}
+			else
+			{
+				gUbxSerial.pHead = pRequest;
+			}
+
+			gUbxSerial.pTail = pRequest;
+		}
+
+		/* Step through queued requests until something else arrives, so a pending retrace always gets its controller
+		 * read before the next step is started. Requests are run in order, so everything waits on an EEPROM write. */
+		while(gUbxSerial.pHead && !gUbxSerial.eepromBusy && MQ_IS_EMPTY(&gUbxSerial.msgQueue))
+		{
+			UbxSerialRequest* const pRequest = gUbxSerial.pHead;
+
+			if(!_UbxSerialStepRequest(pRequest))
+			{
+				continue;
+			}
+
+			gUbxSerial.pHead = pRequest->pNext;
+			if(!gUbxSerial.pHead)
+			{
+				gUbxSerial.pTail = NULL;
+			}
+
+			pRequest->pNext = NULL;
+			pRequest->status = UBX_SERIAL_STATUS_COMPLETE;
+
+			if(pRequest->pDoneQueue)
+			{
+				osSendMesg(pRequest->pDoneQueue, pRequest->doneMsg, OS_MESG_NOBLOCK);
+			}
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxSerialSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxSerial, 0, sizeof(gUbxSerial));
+
+	gUbxSerial.threadPriority = UBX_THREAD_PRI_SERIAL;
+	gUbxSerial.enableRead = 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxSerialInitialize()
+{
+	osCreateMesgQueue(&gUbxSerial.msgQueue, gUbxSerial.msg, UBX_SERIAL_MAX_QUEUE_LENGTH);
+	osCreateMesgQueue(&gUbxSerial.siMsgQueue, gUbxSerial.siMsg, sizeof(gUbxSerial.siMsg) / sizeof(OSMesg));
+
+	/* libultra waits on the SI queue internally, so it must never receive anything other than SI events. */
+	UbxEventSubscribe(&gUbxSerial.siMsgQueue, UBX_EVENT_MASK(UBX_EVENT_SI));
+
+	/* Probe the SI devices up front while nothing else is using the SI. */
+	osContInit(&gUbxSerial.siMsgQueue, &gUbxSerial.contPattern, gUbxSerial.contStatus);
+	gUbxSerial.eepromType = osEepromProbe(&gUbxSerial.siMsgQueue);
+
+	UbxEventSubscribe(&gUbxSerial.msgQueue, UBX_EVENT_MASK(UBX_EVENT_VI));
+
+	/* Start the serial thread. */
+	osCreateThread(&gUbxSerial.thread, UBX_THREAD_ID_SERIAL, _UbxSerialThread, NULL, _serial_stack_end, gUbxSerial.threadPriority);
+	osStartThread(&gUbxSerial.thread);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSerialInitRequest(UbxSerialRequest* const pRequest, const UbxSerialOp op)
+{
+	memset(pRequest, 0, sizeof(UbxSerialRequest));
+
+	pRequest->op = op;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSerialSubmit(UbxSerialRequest* const pRequest)
+{
+	pRequest->progress = 0;
+	pRequest->status = UBX_SERIAL_STATUS_PENDING;
+
+	osSendMesg(&gUbxSerial.msgQueue, (OSMesg) pRequest, OS_MESG_BLOCK);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSerialReadPad(const u32 channel, OSContPad* const pOutPad)
+{
+	*pOutPad = gUbxSerial.pad[gUbxSerial.padIndex][channel];
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <os_cont.h>
+#include <os_message.h>
+#include <os_pfs.h>
+#include <os_thread.h>
+#include <os_time.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_SERIAL_MAX_QUEUE_LENGTH 16
+#define UBX_SERIAL_PAD_BUFFER_COUNT 2
+
+/* Most Controller Pak data transferred in one step of a request; this is one page of the pak. */
+#define UBX_SERIAL_PAK_STEP_SIZE 0x100
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxSerialOp
+{
+	UBX_SERIAL_OP_CONT_QUERY,
+	UBX_SERIAL_OP_EEPROM_READ,
+	UBX_SERIAL_OP_EEPROM_WRITE,
+	UBX_SERIAL_OP_PAK_INIT,
+	UBX_SERIAL_OP_PAK_READ,
+	UBX_SERIAL_OP_PAK_WRITE,
+	UBX_SERIAL_OP_RUMBLE_INIT,
+	UBX_SERIAL_OP_RUMBLE_START,
+	UBX_SERIAL_OP_RUMBLE_STOP,
+} UbxSerialOp;
+
+typedef enum _UbxSerialStatus
+{
+	UBX_SERIAL_STATUS_IDLE,
+	UBX_SERIAL_STATUS_PENDING,
+	UBX_SERIAL_STATUS_COMPLETE,
+} UbxSerialStatus;
+
+typedef struct _UbxSerialRequest UbxSerialRequest;
+
+struct _UbxSerialRequest
+{
+	UbxSerialRequest* pNext;
+
+	OSMesgQueue* pDoneQueue;
+
+	/* Controller Pak and Rumble Pak operations use the file system handle initialized by the matching INIT op. */
+	OSPfs* pPfs;
+
+	u8* pBuffer;
+
+	OSMesg doneMsg;
+
+	/* EEPROM block address for EEPROM ops or byte offset within the file for Controller Pak ops. EEPROM sizes must be
+	 * a multiple of EEPROM_BLOCK_SIZE, and Controller Pak offsets and sizes a multiple of BLOCKSIZE. */
+	u32 offset;
+	u32 size;
+
+	/* Bytes transferred so far by the serial thread. */
+	u32 progress;
+
+	s32 fileNo;
+	s32 channel;
+
+	/* Result of the libultra call that serviced the request (0 on success). */
+	s32 result;
+
+	UbxSerialOp op;
+
+	volatile UbxSerialStatus status;
+};
+
+typedef struct _UbxSerialData
+{
+	OSThread thread;
+
+	OSMesgQueue msgQueue;
+	OSMesg msg[UBX_SERIAL_MAX_QUEUE_LENGTH];
+
+	OSMesgQueue siMsgQueue;
+	OSMesg siMsg[2];
+
+	/* Counts down the time the EEPROM needs to store a block before it can be accessed again. */
+	OSTimer eepromTimer;
+
+	OSContStatus contStatus[MAXCONTROLLERS];
+	OSContPad pad[UBX_SERIAL_PAD_BUFFER_COUNT][MAXCONTROLLERS];
+
+	UbxSerialRequest* pHead;
+	UbxSerialRequest* pTail;
+
+	OSPri threadPriority;
+
+	volatile u32 padIndex;
+	volatile u32 readCount;
+
+	s32 eepromType;
+
+	u8 contPattern;
+	u8 enableRead;
+	u8 eepromBusy;
+} UbxSerialData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxSerialData gUbxSerial;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxSerialSetDefaults();
+extern void _UbxSerialInitialize();
+
+/* Fill out a request for the given operation with no completion message queue. */
+extern void UbxSerialInitRequest(UbxSerialRequest* pRequest, UbxSerialOp op);
+
+/* Queue an accessory operation on the serial thread. Controllers are read right after every vertical retrace, and
+ * queued operations run in submission order in whatever time is left, one EEPROM block or Controller Pak page at a
+ * time. A pending controller read is always serviced between those steps, so a slow save never holds up input. The
+ * request is owned by the serial thread until it has completed. */
+extern void UbxSerialSubmit(UbxSerialRequest* pRequest);
+
+/* Copy out the most recently completed controller read for a channel. This never blocks. */
+extern void UbxSerialReadPad(u32 channel, OSContPad* pOutPad);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline int UbxSerialIsComplete(const UbxSerialRequest* const pRequest)
+{
+	return pRequest->status == UBX_SERIAL_STATUS_COMPLETE;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -31,29 +31,28 @@ void _UbxSystemSetDefaults()
 	/* Clear the data structure. */
 	memset(&gUbxSystem, 0, sizeof(gUbxSystem));
 
-	/* Set the default lengths for each system message system. */
+	/* Set the default lengths for each system message system. RCP events are handled by the scheduler. */
 	gUbxSystem.dmaMsgQueueLength = 1;
-	gUbxSystem.rcpMsgQueueLength = 1;
-	gUbxSystem.rdpMsgQueueLength = 1;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-void _UbxSystemInitialize()
+static s32 _UbxSystemClampQueueLength(const size_t length)
 {
-	OSMesg dummyMsg;
-	memset(&dummyMsg, 0, sizeof(dummyMsg));
+	if(length == 0)
+	{
+		return 1;
+	}
 
-	/* Create the DMA message queue. */
-	osCreateMesgQueue(&gUbxSystem.dmaMsgQueue, &gUbxSystem.dmaMsg, gUbxSystem.dmaMsgQueueLength);
+	return (s32) ((length > UBX_SYSTEM_MAX_QUEUE_LENGTH) ? UBX_SYSTEM_MAX_QUEUE_LENGTH : length);
+}
 
-	/* Create the RCP message queue. */
-	osCreateMesgQueue(&gUbxSystem.rcpMsgQueue, &gUbxSystem.rcpMsg, gUbxSystem.rcpMsgQueueLength);
-	osSetEventMesg(OS_EVENT_SP, &gUbxSystem.rcpMsgQueue, dummyMsg);
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-	/* Create the RDP message queue. */
-	osCreateMesgQueue(&gUbxSystem.rdpMsgQueue, &gUbxSystem.rdpMsg, gUbxSystem.rdpMsgQueueLength);
-	osSetEventMesg(OS_EVENT_DP, &gUbxSystem.rdpMsgQueue, dummyMsg);
+void _UbxSystemInitialize()
+{
+	/* Create the DMA message queue. */
+	osCreateMesgQueue(&gUbxSystem.dmaMsgQueue, gUbxSystem.dmaMsg, _UbxSystemClampQueueLength(gUbxSystem.dmaMsgQueueLength));
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
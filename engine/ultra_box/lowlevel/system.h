@@ -30,19 +30,15 @@ UBX_BEGIN_EXTERN_C;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+#define UBX_SYSTEM_MAX_QUEUE_LENGTH 8
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 typedef struct _UbxSystemData
 {
 	OSMesgQueue dmaMsgQueue;
-	OSMesg dmaMsg;
+	OSMesg dmaMsg[UBX_SYSTEM_MAX_QUEUE_LENGTH];
 	size_t dmaMsgQueueLength;
-
-	OSMesgQueue rcpMsgQueue;
-	OSMesg rcpMsg;
-	size_t rcpMsgQueueLength;
-
-	OSMesgQueue rdpMsgQueue;
-	OSMesg rdpMsg;
-	size_t rdpMsgQueueLength;
 } UbxSystemData;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "task.h"
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxTaskData gUbxTask;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxTaskSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxTask, 0, sizeof(gUbxTask));
+
+	/* The XBUS micro-code is the only variant that doesn't need any extra memory. */
+	gUbxTask.gfxUcode = UBX_TASK_GFX_UCODE_XBUS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxTaskInitGfx(OSTask* const pTask)
+{
+	UBX_TASK_SET_BOOT_UCODE(pTask, rspbootTextStart, rspbootTextEnd);
+
+	/* Without yield data, the scheduler can't interrupt the task to let an audio task run. */
+	UBX_TASK_SET_YIELD_DATA(pTask, gUbxTask.yieldBuffer, (u8*) gUbxTask.yieldBuffer + sizeof(gUbxTask.yieldBuffer));
+
+	if(gUbxTask.gfxUcode == UBX_TASK_GFX_UCODE_FIFO && gUbxTask.pFifoBuffer && gUbxTask.fifoBufferSize > 0)
+	{
+		UBX_TASK_SET_RSP_UCODE(pTask, gspF3DEX2_fifoTextStart, gspF3DEX2_fifoTextEnd);
+		UBX_TASK_SET_RSP_UCODE_DATA(pTask, gspF3DEX2_fifoDataStart, gspF3DEX2_fifoDataEnd);
+		UBX_TASK_SET_OUTPUT_FIFO(pTask, gUbxTask.pFifoBuffer, (u8*) gUbxTask.pFifoBuffer + gUbxTask.fifoBufferSize);
+	}
+	else
+	{
+		UBX_TASK_SET_RSP_UCODE(pTask, gspF3DEX2_xbusTextStart, gspF3DEX2_xbusTextEnd);
+		UBX_TASK_SET_RSP_UCODE_DATA(pTask, gspF3DEX2_xbusDataStart, gspF3DEX2_xbusDataEnd);
+		UBX_TASK_CLEAR_OUTPUT(pTask);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
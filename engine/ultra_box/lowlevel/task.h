@@ -19,13 +19,29 @@
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+#include "env.h"
+
+#include <sptask.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Suggested size of the RDP command FIFO in bytes. The RSP only stalls once it gets this far ahead of the RDP, so a
+ * larger FIFO lets it finish the display list sooner, but there is little to gain beyond this. */
+#define UBX_TASK_DEFAULT_FIFO_SIZE 0x10000
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 #define UBX_TASK_SET_DATA(ostaskptr, startptr, endptr) ( \
 	(ostaskptr)->t.data_ptr = (u64*)(startptr), \
 	(ostaskptr)->t.data_size = (u32)(endptr) - (u32)(startptr) \
 )
 
 #define UBX_TASK_SET_YIELD_DATA(ostaskptr, startptr, endptr) ( \
-	(ostaskptr)->t.yield_data = (u64*)(startptr), \
+	(ostaskptr)->t.yield_data_ptr = (u64*)(startptr), \
 	(ostaskptr)->t.yield_data_size = (u32)(endptr) - (u32)(startptr) \
 )
 
@@ -44,4 +60,56 @@
 	(ostaskptr)->t.ucode_data_size = (u32)(endptr) - (u32)(startptr) \
 )
 
-/*--------------------------------------------------------------------------------------------------------------------*/
\ No newline at end of file
+/* FIFO micro-code takes the end address of the output buffer in place of its size. */
+#define UBX_TASK_SET_OUTPUT_FIFO(ostaskptr, startptr, endptr) ( \
+	(ostaskptr)->t.output_buff = (u64*)(startptr), \
+	(ostaskptr)->t.output_buff_size = (u64*)(endptr) \
+)
+
+#define UBX_TASK_CLEAR_OUTPUT(ostaskptr) ( \
+	(ostaskptr)->t.output_buff = NULL, \
+	(ostaskptr)->t.output_buff_size = NULL \
+)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxTaskGfxUcode
+{
+	/* The RSP feeds the RDP directly through DMEM, so each one stalls whenever the other falls behind. */
+	UBX_TASK_GFX_UCODE_XBUS,
+
+	/* The RSP writes RDP commands to a FIFO in RDRAM, which lets it run ahead of the RDP. */
+	UBX_TASK_GFX_UCODE_FIFO,
+} UbxTaskGfxUcode;
+
+typedef struct _UbxTaskData
+{
+	/* RDRAM buffer for the FIFO micro-code to write RDP commands to. It must be 16-byte aligned and can't be shared
+	 * between graphics tasks that may be in flight at the same time. */
+	u64* pFifoBuffer;
+	u32 fifoBufferSize;
+
+	/* Micro-code variant given to graphics tasks by UbxTaskInitGfx(). */
+	u8 gfxUcode;
+
+	/* Where the RSP saves the state of a graphics task that yields to an audio task. The scheduler only ever has one
+	 * graphics task yielded at a time, so every graphics task shares this buffer. */
+	u64 yieldBuffer[OS_YIELD_DATA_SIZE / sizeof(u64)] __attribute__((aligned(0x10)));
+} UbxTaskData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxTaskData gUbxTask;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxTaskSetDefaults();
+
+/* Set the boot micro-code, the F3DEX2 micro-code variant picked in gUbxTask, its output buffer and the shared yield
+ * buffer on a graphics task. The XBUS variant is used when the FIFO variant is picked without a FIFO buffer to go with
+ * it. */
+extern void UbxTaskInitGfx(OSTask* pTask);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+
+#include <os_thread.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Thread IDs for every thread owned by the engine. */
+#define UBX_THREAD_ID_IDLE   1
+#define UBX_THREAD_ID_MAIN   2
+#define UBX_THREAD_ID_LOADER 3
+#define UBX_THREAD_ID_JOB    4
+#define UBX_THREAD_ID_EVENT  5
+#define UBX_THREAD_ID_SCHED  6
+#define UBX_THREAD_ID_AUDIO  7
+#define UBX_THREAD_ID_TRACE  8
+#define UBX_THREAD_ID_SERIAL 9
+
+/* Default priorities for every thread owned by the engine. Service threads sit above the main
+ * thread since they spend nearly all their time blocked and need to respond quickly when woken.
+ * The job and trace threads sit just above the idle thread so they only ever run on otherwise wasted cycles. */
+#define UBX_THREAD_PRI_IDLE   OS_PRIORITY_IDLE
+#define UBX_THREAD_PRI_JOB    (OS_PRIORITY_IDLE + 1)
+#define UBX_THREAD_PRI_TRACE  (OS_PRIORITY_IDLE + 1)
+#define UBX_THREAD_PRI_MAIN   10
+#define UBX_THREAD_PRI_LOADER 20
+#define UBX_THREAD_PRI_SERIAL 30
+#define UBX_THREAD_PRI_AUDIO  110
+#define UBX_THREAD_PRI_SCHED  120
+#define UBX_THREAD_PRI_EVENT  OS_PRIORITY_APPMAX
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "timing.h"
+#include "video.h"
+
+#include <os.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxTimingData gUbxTiming;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxTimingSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxTiming, 0, sizeof(gUbxTiming));
+
+	/* Simulate at 60 Hz on every TV type and render as fast as the display allows. */
+	gUbxTiming.tickRate = 60;
+	gUbxTiming.renderRate = 60;
+
+	/* Never run more than a quarter second of simulation in a single frame. */
+	gUbxTiming.maxTicksPerFrame = 15;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxTimingInitialize()
+{
+	if(gUbxTiming.tickRate == 0)
+	{
+		gUbxTiming.tickRate = 60;
+	}
+
+	if(gUbxTiming.maxTicksPerFrame == 0)
+	{
+		gUbxTiming.maxTicksPerFrame = 1;
+	}
+
+	gUbxTiming.retraceRate = (osTvType == OS_TV_PAL) ? 50 : 60;
+
+	if(gUbxTiming.renderRate == 0 || gUbxTiming.renderRate > gUbxTiming.retraceRate)
+	{
+		gUbxTiming.renderRate = gUbxTiming.retraceRate;
+	}
+
+	gUbxTiming.tickTime = OS_CPU_COUNTER / gUbxTiming.tickRate;
+	gUbxTiming.retraceTime = OS_CPU_COUNTER / gUbxTiming.retraceRate;
+	gUbxTiming.maxFrameTime = gUbxTiming.tickTime * gUbxTiming.maxTicksPerFrame;
+	gUbxTiming.tickSeconds = 1.0f / (f32) gUbxTiming.tickRate;
+
+	gUbxTiming.lastFrameTime = osGetTime();
+	gUbxTiming.lastPresentTime = gUbxTiming.lastFrameTime;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u32 UbxTimingBeginFrame()
+{
+	const OSTime now = osGetTime();
+
+	OSTime elapsed = now - gUbxTiming.lastFrameTime;
+	gUbxTiming.lastFrameTime = now;
+
+	if(elapsed > gUbxTiming.maxFrameTime)
+	{
+		elapsed = gUbxTiming.maxFrameTime;
+	}
+
+	gUbxTiming.accumulator += elapsed;
+
+	u32 tickCount = 0;
+	while(gUbxTiming.accumulator >= gUbxTiming.tickTime)
+	{
+		gUbxTiming.accumulator -= gUbxTiming.tickTime;
+		++tickCount;
+	}
+
+	gUbxTiming.tickCount += tickCount;
+	gUbxTiming.alpha = (UbxFixed) ((gUbxTiming.accumulator << UBX_FIXED_SHIFT) / gUbxTiming.tickTime);
+
+	return tickCount;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxTimingPaceFrame()
+{
+	/* Spread the fractional part of the retrace interval over several frames, e.g., 50 Hz retraces at a 30 Hz render
+	 * rate give intervals of 1, 2, 2, 1, 2, 2, ... */
+	gUbxTiming.paceAccumulator += gUbxTiming.retraceRate;
+
+	u32 retraceCount = gUbxTiming.paceAccumulator / gUbxTiming.renderRate;
+	gUbxTiming.paceAccumulator -= retraceCount * gUbxTiming.renderRate;
+
+	if(retraceCount == 0)
+	{
+		retraceCount = 1;
+	}
+
+	/* The swap only takes effect on a retrace, so always wait for at least one of them. */
+	for(;;)
+	{
+		osRecvMesg(&gUbxVideo.retraceMsgQueue, NULL, OS_MESG_BLOCK);
+
+		const OSTime now = osGetTime();
+		const OSTime elapsed = now - gUbxTiming.lastPresentTime + (gUbxTiming.retraceTime >> 1);
+		const u32 elapsedCount = (u32) (elapsed / gUbxTiming.retraceTime);
+
+		if(elapsedCount >= retraceCount)
+		{
+			gUbxTiming.lastPresentTime = now;
+			break;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
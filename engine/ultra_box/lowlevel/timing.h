@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "env.h"
+#include "../math/fixed.h"
+
+#include <os_time.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxTimingData
+{
+	OSTime lastFrameTime;
+	OSTime lastPresentTime;
+	OSTime accumulator;
+
+	/* Length of one simulation tick and of one vertical retrace in CPU counter cycles. */
+	OSTime tickTime;
+	OSTime retraceTime;
+
+	/* Real time beyond this in a single frame is dropped so a long stall can't snowball into ever longer frames. */
+	OSTime maxFrameTime;
+
+	/* Length of one simulation tick in seconds for game code that works in floats. */
+	f32 tickSeconds;
+
+	/* How far the accumulator is into the next tick, for interpolating between the last two simulation states. */
+	UbxFixed alpha;
+
+	u32 tickRate;
+	u32 renderRate;
+	u32 retraceRate;
+	u32 paceAccumulator;
+
+	u32 tickCount;
+	u32 maxTicksPerFrame;
+} UbxTimingData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxTimingData gUbxTiming;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxTimingSetDefaults();
+extern void _UbxTimingInitialize();
+
+/* Measure the real time since the previous frame and return the number of fixed simulation ticks to run for it.
+ * This also updates the interpolation alpha for rendering the frame. */
+extern u32 UbxTimingBeginFrame();
+
+/* Wait on the vertical retrace until the frame that was just swapped has been shown for as long as the render rate
+ * calls for. Rates that don't evenly divide the retrace rate (e.g., 30 Hz on PAL) alternate between the nearest whole
+ * numbers of retraces, and retraces that already went by while the frame was being built are counted as well. */
+extern void UbxTimingPaceFrame();
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
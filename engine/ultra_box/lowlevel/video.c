@@ -17,6 +17,7 @@
  */
 
 #include "video.h"
+#include "event.h"
 
 #include <string.h>
 
@@ -31,17 +32,18 @@ void _UbxVideoSetDefaults()
 	/* Clear the data structure. */
 	memset(&gUbxVideo, 0, sizeof(gUbxVideo));
 
-	/* Set the default message queue length. */
+	/* Set the default message queue length. Only the most recent retrace matters, so anything extra gets dropped. */
 	gUbxVideo.retraceMsgQueueLength = 1;
+
+	/* Dynamic resolution is disabled until the game sets a load budget, and never goes below 10/16 of the full size. */
+	gUbxVideo.scale = UBX_VIDEO_SCALE_ONE;
+	gUbxVideo.minScale = 10;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void _UbxVideoInitialize()
 {
-	OSMesg dummyMsg;
-	memset(&dummyMsg, 0, sizeof(dummyMsg));
-
 	/* Initialize the video interface. */
 	osCreateViManager(OS_PRIORITY_VIMGR);
 
@@ -52,9 +54,115 @@ void _UbxVideoInitialize()
 	osViSetSpecialFeatures(OS_VI_DITHER_FILTER_OFF);
 	osViSetSpecialFeatures(OS_VI_DIVOT_OFF);
 
+	if(gUbxVideo.retraceMsgQueueLength == 0 || gUbxVideo.retraceMsgQueueLength > UBX_VIDEO_MAX_QUEUE_LENGTH)
+	{
+		gUbxVideo.retraceMsgQueueLength = 1;
+	}
+
+	/* Route the vertical retrace interrupt through the event router. */
+	osViSetEvent(&gUbxEvent.msgQueue, UbxEventToMesg(UBX_EVENT_VI), 1);
+
 	/* Create the message queue for the vertical retrace interrupt. */
-	osCreateMesgQueue(&gUbxVideo.retraceMsgQueue, &gUbxVideo.retraceMsg, gUbxVideo.retraceMsgQueueLength);
-	osViSetEvent(&gUbxVideo.retraceMsgQueue, dummyMsg, 1);
+	osCreateMesgQueue(&gUbxVideo.retraceMsgQueue, gUbxVideo.retraceMsg, (s32) gUbxVideo.retraceMsgQueueLength);
+	UbxEventSubscribe(&gUbxVideo.retraceMsgQueue, UBX_EVENT_MASK(UBX_EVENT_VI));
+
+	if(gUbxVideo.minScale == 0 || gUbxVideo.minScale > UBX_VIDEO_SCALE_ONE)
+	{
+		gUbxVideo.minScale = UBX_VIDEO_SCALE_ONE;
+	}
+
+	/* Start out at the full size, which is also what the VI mode presents without any scaling. */
+	gUbxVideo.scale = UBX_VIDEO_SCALE_ONE;
+	gUbxVideo.renderWidth = gUbxVideo.maxWidth;
+	gUbxVideo.renderHeight = gUbxVideo.maxHeight;
+	gUbxVideo.presentWidth = gUbxVideo.maxWidth;
+	gUbxVideo.presentHeight = gUbxVideo.maxHeight;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxVideoSwapBuffer(void* const pFrameBuffer)
+{
+	/* The scale registers are latched on the same retrace as the new frame buffer, so the two always change together.
+	 * Only the amount of each line the VI reads changes; the stride stays the same since it's part of the VI mode. */
+	if(gUbxVideo.renderWidth != gUbxVideo.presentWidth || gUbxVideo.renderHeight != gUbxVideo.presentHeight)
+	{
+		osViSetXScale((f32) gUbxVideo.renderWidth / (f32) gUbxVideo.maxWidth);
+		osViSetYScale((f32) gUbxVideo.renderHeight / (f32) gUbxVideo.maxHeight);
+
+		gUbxVideo.presentWidth = gUbxVideo.renderWidth;
+		gUbxVideo.presentHeight = gUbxVideo.renderHeight;
+	}
+
+	osViSwapBuffer(pFrameBuffer);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxVideoUpdateResolution(const u32 gfxCount)
+{
+	if(gUbxVideo.loadBudget == 0)
+	{
+		return;
+	}
+
+	const u32 load = (u32) (((u64) gfxCount << 8) / gUbxVideo.loadBudget);
+	u8 scale = gUbxVideo.scale;
+
+	if(load > UBX_VIDEO_LOAD_HIGH)
+	{
+		gUbxVideo.lowLoadFrames = 0;
+
+		if(++gUbxVideo.highLoadFrames >= UBX_VIDEO_LOAD_HIGH_FRAMES && scale > gUbxVideo.minScale)
+		{
+			--scale;
+			gUbxVideo.highLoadFrames = 0;
+		}
+	}
+	else if(load < UBX_VIDEO_LOAD_LOW)
+	{
+		gUbxVideo.highLoadFrames = 0;
+
+		if(++gUbxVideo.lowLoadFrames >= UBX_VIDEO_LOAD_LOW_FRAMES && scale < UBX_VIDEO_SCALE_ONE)
+		{
+			++scale;
+			gUbxVideo.lowLoadFrames = 0;
+		}
+	}
+	else
+	{
+		/* Anything between the two marks is where the controller wants to settle, so it resets both counters. */
+		gUbxVideo.highLoadFrames = 0;
+		gUbxVideo.lowLoadFrames = 0;
+	}
+
+	if(scale != gUbxVideo.scale)
+	{
+		gUbxVideo.scale = scale;
+
+		/* Keep the width a multiple of 4 pixels so each line of the render area stays 8-byte aligned. */
+		gUbxVideo.renderWidth = (u16) (((u32) gUbxVideo.maxWidth * scale / UBX_VIDEO_SCALE_ONE) & ~3u);
+		gUbxVideo.renderHeight = (u16) (((u32) gUbxVideo.maxHeight * scale / UBX_VIDEO_SCALE_ONE) & ~1u);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxVideoGetViewport(Vp* const pOut)
+{
+	/* Viewport values are in 14.2 fixed-point, with the scale and translation each being half the render size. */
+	const s16 halfWidth = (s16) (gUbxVideo.renderWidth << 1);
+	const s16 halfHeight = (s16) (gUbxVideo.renderHeight << 1);
+
+	pOut->vp.vscale[0] = halfWidth;
+	pOut->vp.vscale[1] = halfHeight;
+	pOut->vp.vscale[2] = G_MAXZ / 2;
+	pOut->vp.vscale[3] = 0;
+
+	pOut->vp.vtrans[0] = halfWidth;
+	pOut->vp.vtrans[1] = halfHeight;
+	pOut->vp.vtrans[2] = G_MAXZ / 2;
+	pOut->vp.vtrans[3] = 0;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
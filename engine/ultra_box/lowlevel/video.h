@@ -21,6 +21,7 @@
 
 #include "env.h"
 
+#include <gbi.h>
 #include <os_vi.h>
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -29,13 +30,48 @@ UBX_BEGIN_EXTERN_C;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+#define UBX_VIDEO_MAX_QUEUE_LENGTH 4
+
+/* Dynamic resolution scales are in sixteenths of the full render size. */
+#define UBX_VIDEO_SCALE_ONE 16
+
+/* The render size drops a step once the graphics load has been above the high mark for a couple of frames, but only
+ * grows again after it has stayed below the low mark for half a second. The gap between the two marks is wider than the
+ * change in pixel count of a single step, so a step in either direction can't immediately trigger one back. */
+#define UBX_VIDEO_LOAD_HIGH        240 /* Out of 256. */
+#define UBX_VIDEO_LOAD_LOW         176 /* Out of 256. */
+#define UBX_VIDEO_LOAD_HIGH_FRAMES 2
+#define UBX_VIDEO_LOAD_LOW_FRAMES  30
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 typedef struct _UbxVideoData
 {
 	OSMesgQueue retraceMsgQueue;
-	OSMesg retraceMsg;
+	OSMesg retraceMsg[UBX_VIDEO_MAX_QUEUE_LENGTH];
 
 	size_t retraceMsgQueueLength;
 	size_t viModeIndex;
+
+	/* Graphics time budget per frame in CPU counter cycles; zero disables dynamic resolution. */
+	u32 loadBudget;
+
+	/* Size of the color buffers; the render size never exceeds this, and the color image stride always matches it. */
+	u16 maxWidth;
+	u16 maxHeight;
+
+	/* Size to render the frame currently being built at. */
+	u16 renderWidth;
+	u16 renderHeight;
+
+	/* Render size of the frame most recently handed to the VI. */
+	u16 presentWidth;
+	u16 presentHeight;
+
+	u8 scale;
+	u8 minScale;
+	u8 highLoadFrames;
+	u8 lowLoadFrames;
 } UbxVideoData;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -45,6 +81,17 @@ extern UbxVideoData gUbxVideo;
 extern void _UbxVideoSetDefaults();
 extern void _UbxVideoInitialize();
 
+/* Hand a finished frame to the VI, scaling it back up to the full output size when it was rendered smaller. */
+extern void UbxVideoSwapBuffer(void* pFrameBuffer);
+
+/* Feed the graphics time of the most recently completed frame (e.g., from UbxSchedGetGfxCount()) to the dynamic
+ * resolution controller, which picks the render size of the next frame. Call this after UbxVideoSwapBuffer() since
+ * the frame being swapped must be presented at the size it was rendered at. */
+extern void UbxVideoUpdateResolution(u32 gfxCount);
+
+/* Fill out a viewport covering the current render size. */
+extern void UbxVideoGetViewport(Vp* pOut);
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 UBX_END_EXTERN_C;
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/env.h"
+
+#include <ultratypes.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Signed 15.16 fixed-point value; this is the same format the RSP uses for its matrix elements. */
+typedef s32 UbxFixed;
+
+/* Binary angle where 0x10000 is one full turn. */
+typedef u16 UbxAngle;
+
+typedef struct _UbxVec3
+{
+	UbxFixed x;
+	UbxFixed y;
+	UbxFixed z;
+} UbxVec3;
+
+typedef struct _UbxQuat
+{
+	UbxFixed x;
+	UbxFixed y;
+	UbxFixed z;
+	UbxFixed w;
+} UbxQuat;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_FIXED_SHIFT 16
+#define UBX_FIXED_ONE   (1 << UBX_FIXED_SHIFT)
+#define UBX_FIXED_HALF  (1 << (UBX_FIXED_SHIFT - 1))
+
+#define UBX_FIXED_FROM_INT(i)   ((UbxFixed) ((s32) (i) * UBX_FIXED_ONE))
+#define UBX_FIXED_FROM_FLOAT(f) ((UbxFixed) ((f32) (f) * (f32) UBX_FIXED_ONE))
+#define UBX_FIXED_TO_INT(x)     ((s32) (x) >> UBX_FIXED_SHIFT)
+#define UBX_FIXED_TO_FLOAT(x)   ((f32) (x) * (1.0f / (f32) UBX_FIXED_ONE))
+
+#define UBX_FIXED_MUL(a, b) ((UbxFixed) (((s64) (a) * (s64) (b)) >> UBX_FIXED_SHIFT))
+#define UBX_FIXED_DIV(a, b) ((UbxFixed) (((s64) (a) << UBX_FIXED_SHIFT) / (s64) (b)))
+
+#define UBX_ANGLE_FROM_DEGREES(d) ((UbxAngle) (s32) ((f32) (d) * (65536.0f / 360.0f)))
+#define UBX_ANGLE_FROM_RADIANS(r) ((UbxAngle) (s32) ((f32) (r) * (65536.0f / 6.28318530718f)))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "mtx.h"
+#include "trig.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Sum of three 16.16 products, accumulated at full 64-bit precision and shifted back down only once. */
+#define DOT3(a0, b0, a1, b1, a2, b2) \
+	((UbxFixed) (((s64) (a0) * (s64) (b0) + (s64) (a1) * (s64) (b1) + (s64) (a2) * (s64) (b2)) >> UBX_FIXED_SHIFT))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline void _UbxPackMtxRow(
+	u32* const pInt,
+	u32* const pFrac,
+	const UbxFixed e0,
+	const UbxFixed e1,
+	const UbxFixed e2,
+	const UbxFixed e3)
+{
+	/* The RSP matrix format stores the integer halves of all 16 elements in the first 32 bytes
+	 * and the fractional halves in the last 32 bytes, with two elements packed per word. */
+	pInt[0] = ((u32) e0 & 0xFFFF0000) | ((u32) e1 >> 16);
+	pInt[1] = ((u32) e2 & 0xFFFF0000) | ((u32) e3 >> 16);
+	pFrac[0] = ((u32) e0 << 16) | ((u32) e1 & 0xFFFF);
+	pFrac[1] = ((u32) e2 << 16) | ((u32) e3 & 0xFFFF);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineIdentity(UbxAffine* const pOut)
+{
+	UbxAffineScale(pOut, UBX_FIXED_ONE, UBX_FIXED_ONE, UBX_FIXED_ONE);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineTranslate(UbxAffine* const pOut, const UbxFixed x, const UbxFixed y, const UbxFixed z)
+{
+	UbxAffineIdentity(pOut);
+
+	pOut->m[3][0] = x;
+	pOut->m[3][1] = y;
+	pOut->m[3][2] = z;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineScale(UbxAffine* const pOut, const UbxFixed x, const UbxFixed y, const UbxFixed z)
+{
+	pOut->m[0][0] = x;
+	pOut->m[0][1] = 0;
+	pOut->m[0][2] = 0;
+
+	pOut->m[1][0] = 0;
+	pOut->m[1][1] = y;
+	pOut->m[1][2] = 0;
+
+	pOut->m[2][0] = 0;
+	pOut->m[2][1] = 0;
+	pOut->m[2][2] = z;
+
+	pOut->m[3][0] = 0;
+	pOut->m[3][1] = 0;
+	pOut->m[3][2] = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineRotateX(UbxAffine* const pOut, const UbxAngle angle)
+{
+	UbxFixed s, c;
+	UbxSinCos(angle, &s, &c);
+
+	UbxAffineIdentity(pOut);
+
+	pOut->m[1][1] = c;
+	pOut->m[1][2] = s;
+	pOut->m[2][1] = -s;
+	pOut->m[2][2] = c;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineRotateY(UbxAffine* const pOut, const UbxAngle angle)
+{
+	UbxFixed s, c;
+	UbxSinCos(angle, &s, &c);
+
+	UbxAffineIdentity(pOut);
+
+	pOut->m[0][0] = c;
+	pOut->m[0][2] = -s;
+	pOut->m[2][0] = s;
+	pOut->m[2][2] = c;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineRotateZ(UbxAffine* const pOut, const UbxAngle angle)
+{
+	UbxFixed s, c;
+	UbxSinCos(angle, &s, &c);
+
+	UbxAffineIdentity(pOut);
+
+	pOut->m[0][0] = c;
+	pOut->m[0][1] = s;
+	pOut->m[1][0] = -s;
+	pOut->m[1][1] = c;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineFromMtxF(UbxAffine* const pOut, float mf[4][4])
+{
+	for(size_t i = 0; i < 4; ++i)
+	{
+		pOut->m[i][0] = UBX_FIXED_FROM_FLOAT(mf[i][0]);
+		pOut->m[i][1] = UBX_FIXED_FROM_FLOAT(mf[i][1]);
+		pOut->m[i][2] = UBX_FIXED_FROM_FLOAT(mf[i][2]);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineFromQuat(UbxAffine* const pOut, const UbxQuat* const pRot)
+{
+	static const UbxVec3 origin = { 0, 0, 0 };
+	static const UbxVec3 unitScale = { UBX_FIXED_ONE, UBX_FIXED_ONE, UBX_FIXED_ONE };
+
+	UbxAffineFromTRS(pOut, &origin, pRot, &unitScale);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineFromTRS(UbxAffine* const pOut, const UbxVec3* const pPos, const UbxQuat* const pRot, const UbxVec3* const pScale)
+{
+	const UbxFixed x = pRot->x;
+	const UbxFixed y = pRot->y;
+	const UbxFixed z = pRot->z;
+	const UbxFixed w = pRot->w;
+
+	/* Doubling the components first saves a shift on every one of the products below. */
+	const UbxFixed x2 = x << 1;
+	const UbxFixed y2 = y << 1;
+	const UbxFixed z2 = z << 1;
+
+	const UbxFixed xx = UBX_FIXED_MUL(x, x2);
+	const UbxFixed yy = UBX_FIXED_MUL(y, y2);
+	const UbxFixed zz = UBX_FIXED_MUL(z, z2);
+	const UbxFixed xy = UBX_FIXED_MUL(x, y2);
+	const UbxFixed xz = UBX_FIXED_MUL(x, z2);
+	const UbxFixed yz = UBX_FIXED_MUL(y, z2);
+	const UbxFixed wx = UBX_FIXED_MUL(w, x2);
+	const UbxFixed wy = UBX_FIXED_MUL(w, y2);
+	const UbxFixed wz = UBX_FIXED_MUL(w, z2);
+
+	const UbxFixed sx = pScale->x;
+	const UbxFixed sy = pScale->y;
+	const UbxFixed sz = pScale->z;
+
+	/* Each basis row of the rotation is scaled by its corresponding axis scale, which is
+	 * exactly what multiplying a scale matrix on the left of the rotation matrix produces. */
+	pOut->m[0][0] = UBX_FIXED_MUL(sx, UBX_FIXED_ONE - (yy + zz));
+	pOut->m[0][1] = UBX_FIXED_MUL(sx, xy + wz);
+	pOut->m[0][2] = UBX_FIXED_MUL(sx, xz - wy);
+
+	pOut->m[1][0] = UBX_FIXED_MUL(sy, xy - wz);
+	pOut->m[1][1] = UBX_FIXED_MUL(sy, UBX_FIXED_ONE - (xx + zz));
+	pOut->m[1][2] = UBX_FIXED_MUL(sy, yz + wx);
+
+	pOut->m[2][0] = UBX_FIXED_MUL(sz, xz + wy);
+	pOut->m[2][1] = UBX_FIXED_MUL(sz, yz - wx);
+	pOut->m[2][2] = UBX_FIXED_MUL(sz, UBX_FIXED_ONE - (xx + yy));
+
+	pOut->m[3][0] = pPos->x;
+	pOut->m[3][1] = pPos->y;
+	pOut->m[3][2] = pPos->z;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineMul(UbxAffine* const pOut, const UbxAffine* const pLeft, const UbxAffine* const pRight)
+{
+	/* Load the entire right-hand matrix into registers before doing any math. This lets every product in a row
+	 * issue back-to-back, so the latency of each MULT is hidden behind the next one instead of stalling on loads,
+	 * and it also makes it safe for the output to alias either of the inputs. */
+	const UbxFixed r00 = pRight->m[0][0], r01 = pRight->m[0][1], r02 = pRight->m[0][2];
+	const UbxFixed r10 = pRight->m[1][0], r11 = pRight->m[1][1], r12 = pRight->m[1][2];
+	const UbxFixed r20 = pRight->m[2][0], r21 = pRight->m[2][1], r22 = pRight->m[2][2];
+	const UbxFixed r30 = pRight->m[3][0], r31 = pRight->m[3][1], r32 = pRight->m[3][2];
+
+	UbxFixed result[4][3];
+
+	for(size_t i = 0; i < 4; ++i)
+	{
+		const UbxFixed l0 = pLeft->m[i][0];
+		const UbxFixed l1 = pLeft->m[i][1];
+		const UbxFixed l2 = pLeft->m[i][2];
+
+		result[i][0] = DOT3(l0, r00, l1, r10, l2, r20);
+		result[i][1] = DOT3(l0, r01, l1, r11, l2, r21);
+		result[i][2] = DOT3(l0, r02, l1, r12, l2, r22);
+	}
+
+	result[3][0] += r30;
+	result[3][1] += r31;
+	result[3][2] += r32;
+
+	for(size_t i = 0; i < 4; ++i)
+	{
+		pOut->m[i][0] = result[i][0];
+		pOut->m[i][1] = result[i][1];
+		pOut->m[i][2] = result[i][2];
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineMulToMtx(Mtx* const pOut, const UbxAffine* const pLeft, const UbxAffine* const pRight)
+{
+	/* See UbxAffineMul() for why the right-hand matrix is loaded up front. */
+	const UbxFixed r00 = pRight->m[0][0], r01 = pRight->m[0][1], r02 = pRight->m[0][2];
+	const UbxFixed r10 = pRight->m[1][0], r11 = pRight->m[1][1], r12 = pRight->m[1][2];
+	const UbxFixed r20 = pRight->m[2][0], r21 = pRight->m[2][1], r22 = pRight->m[2][2];
+
+	u32* const pInt = (u32*) &pOut->m[0][0];
+	u32* const pFrac = (u32*) &pOut->m[2][0];
+
+	/* Each row is packed into the output as soon as it's finished, so no intermediate matrix is ever written out. */
+	for(size_t i = 0; i < 3; ++i)
+	{
+		const UbxFixed l0 = pLeft->m[i][0];
+		const UbxFixed l1 = pLeft->m[i][1];
+		const UbxFixed l2 = pLeft->m[i][2];
+
+		_UbxPackMtxRow(
+			&pInt[i * 2],
+			&pFrac[i * 2],
+			DOT3(l0, r00, l1, r10, l2, r20),
+			DOT3(l0, r01, l1, r11, l2, r21),
+			DOT3(l0, r02, l1, r12, l2, r22),
+			0);
+	}
+
+	{
+		const UbxFixed l0 = pLeft->m[3][0];
+		const UbxFixed l1 = pLeft->m[3][1];
+		const UbxFixed l2 = pLeft->m[3][2];
+
+		_UbxPackMtxRow(
+			&pInt[6],
+			&pFrac[6],
+			DOT3(l0, r00, l1, r10, l2, r20) + pRight->m[3][0],
+			DOT3(l0, r01, l1, r11, l2, r21) + pRight->m[3][1],
+			DOT3(l0, r02, l1, r12, l2, r22) + pRight->m[3][2],
+			UBX_FIXED_ONE);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineToMtx(Mtx* const pOut, const UbxAffine* const pIn)
+{
+	u32* const pInt = (u32*) &pOut->m[0][0];
+	u32* const pFrac = (u32*) &pOut->m[2][0];
+
+	_UbxPackMtxRow(&pInt[0], &pFrac[0], pIn->m[0][0], pIn->m[0][1], pIn->m[0][2], 0);
+	_UbxPackMtxRow(&pInt[2], &pFrac[2], pIn->m[1][0], pIn->m[1][1], pIn->m[1][2], 0);
+	_UbxPackMtxRow(&pInt[4], &pFrac[4], pIn->m[2][0], pIn->m[2][1], pIn->m[2][2], 0);
+	_UbxPackMtxRow(&pInt[6], &pFrac[6], pIn->m[3][0], pIn->m[3][1], pIn->m[3][2], UBX_FIXED_ONE);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxAffineTransformPoint(UbxVec3* const pOut, const UbxAffine* const pIn, const UbxVec3* const pPoint)
+{
+	const UbxFixed x = pPoint->x;
+	const UbxFixed y = pPoint->y;
+	const UbxFixed z = pPoint->z;
+
+	pOut->x = DOT3(x, pIn->m[0][0], y, pIn->m[1][0], z, pIn->m[2][0]) + pIn->m[3][0];
+	pOut->y = DOT3(x, pIn->m[0][1], y, pIn->m[1][1], z, pIn->m[2][1]) + pIn->m[3][1];
+	pOut->z = DOT3(x, pIn->m[0][2], y, pIn->m[1][2], z, pIn->m[2][2]) + pIn->m[3][2];
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxQuatIdentity(UbxQuat* const pOut)
+{
+	pOut->x = 0;
+	pOut->y = 0;
+	pOut->z = 0;
+	pOut->w = UBX_FIXED_ONE;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxQuatFromAxisAngle(UbxQuat* const pOut, const UbxAngle angle, const UbxFixed x, const UbxFixed y, const UbxFixed z)
+{
+	UbxFixed s, c;
+	UbxSinCos((UbxAngle) (angle >> 1), &s, &c);
+
+	pOut->x = UBX_FIXED_MUL(x, s);
+	pOut->y = UBX_FIXED_MUL(y, s);
+	pOut->z = UBX_FIXED_MUL(z, s);
+	pOut->w = c;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxQuatMul(UbxQuat* const pOut, const UbxQuat* const pLeft, const UbxQuat* const pRight)
+{
+	/* Applying 'left' then 'right' to row vectors is the Hamilton product 'right * left'. */
+	const s64 ax = pRight->x, ay = pRight->y, az = pRight->z, aw = pRight->w;
+	const s64 bx = pLeft->x, by = pLeft->y, bz = pLeft->z, bw = pLeft->w;
+
+	const UbxFixed x = (UbxFixed) ((aw * bx + ax * bw + ay * bz - az * by) >> UBX_FIXED_SHIFT);
+	const UbxFixed y = (UbxFixed) ((aw * by - ax * bz + ay * bw + az * bx) >> UBX_FIXED_SHIFT);
+	const UbxFixed z = (UbxFixed) ((aw * bz + ax * by - ay * bx + az * bw) >> UBX_FIXED_SHIFT);
+	const UbxFixed w = (UbxFixed) ((aw * bw - ax * bx - ay * by - az * bz) >> UBX_FIXED_SHIFT);
+
+	pOut->x = x;
+	pOut->y = y;
+	pOut->z = z;
+	pOut->w = w;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
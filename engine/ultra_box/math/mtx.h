@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "fixed.h"
+
+#include <gbi.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* 4x3 affine transform in 16.16 fixed-point. This follows the same row-vector convention as the 'gu' library,
+ * so rows 0-2 are the basis vectors, row 3 is the translation, and the implicit 4th column is (0, 0, 0, 1). */
+typedef struct _UbxAffine
+{
+	UbxFixed m[4][3];
+} UbxAffine;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void UbxAffineIdentity(UbxAffine* pOut);
+extern void UbxAffineTranslate(UbxAffine* pOut, UbxFixed x, UbxFixed y, UbxFixed z);
+extern void UbxAffineScale(UbxAffine* pOut, UbxFixed x, UbxFixed y, UbxFixed z);
+extern void UbxAffineRotateX(UbxAffine* pOut, UbxAngle angle);
+extern void UbxAffineRotateY(UbxAffine* pOut, UbxAngle angle);
+extern void UbxAffineRotateZ(UbxAffine* pOut, UbxAngle angle);
+
+/* Convert a float matrix (e.g., a view matrix from guLookAtF) to a fixed-point affine transform. */
+extern void UbxAffineFromMtxF(UbxAffine* pOut, float mf[4][4]);
+
+/* Build a rotation matrix from a unit quaternion. */
+extern void UbxAffineFromQuat(UbxAffine* pOut, const UbxQuat* pRot);
+
+/* Build the equivalent of 'scale * rotate * translate' directly without any intermediate matrix multiplies. */
+extern void UbxAffineFromTRS(UbxAffine* pOut, const UbxVec3* pPos, const UbxQuat* pRot, const UbxVec3* pScale);
+
+/* Compute 'left * right'; the output may alias either input. */
+extern void UbxAffineMul(UbxAffine* pOut, const UbxAffine* pLeft, const UbxAffine* pRight);
+
+/* Compute 'left * right', writing the result directly into the RSP's split integer/fraction matrix format. */
+extern void UbxAffineMulToMtx(Mtx* pOut, const UbxAffine* pLeft, const UbxAffine* pRight);
+
+/* Convert an affine transform to the RSP's split integer/fraction matrix format. */
+extern void UbxAffineToMtx(Mtx* pOut, const UbxAffine* pIn);
+
+/* Transform a point by an affine transform. */
+extern void UbxAffineTransformPoint(UbxVec3* pOut, const UbxAffine* pIn, const UbxVec3* pPoint);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void UbxQuatIdentity(UbxQuat* pOut);
+
+/* Build a quaternion from a rotation around a unit-length axis. */
+extern void UbxQuatFromAxisAngle(UbxQuat* pOut, UbxAngle angle, UbxFixed x, UbxFixed y, UbxFixed z);
+
+/* Compute the rotation 'left' followed by 'right'; the output may alias either input. */
+extern void UbxQuatMul(UbxQuat* pOut, const UbxQuat* pLeft, const UbxQuat* pRight);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "trig.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define TRIG_TABLE_BITS    10
+#define TRIG_TABLE_LENGTH  (1 << TRIG_TABLE_BITS)
+#define TRIG_QUARTER_TURN  0x4000
+#define TRIG_LERP_BITS     (14 - TRIG_TABLE_BITS)
+#define TRIG_LERP_MASK     ((1 << TRIG_LERP_BITS) - 1)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Quarter-wave sine table covering [0, 90) degrees in 16.16 fixed-point. The value at exactly 90 degrees
+ * (1.0) does not fit in 16 bits, so it's handled as a special case when reading past the end of the table. */
+static const u16 gSinTable[TRIG_TABLE_LENGTH] =
+{
+	0x0000, 0x0065, 0x00C9, 0x012E, 0x0192, 0x01F7, 0x025B, 0x02C0, 0x0324, 0x0389, 0x03ED, 0x0452, 0x04B6, 0x051B, 0x057F, 0x05E4,
+	0x0648, 0x06AD, 0x0711, 0x0776, 0x07DA, 0x083F, 0x08A3, 0x0908, 0x096C, 0x09D1, 0x0A35, 0x0A9A, 0x0AFE, 0x0B62, 0x0BC7, 0x0C2B,
+	0x0C90, 0x0CF4, 0x0D59, 0x0DBD, 0x0E21, 0x0E86, 0x0EEA, 0x0F4E, 0x0FB3, 0x1017, 0x107B, 0x10E0, 0x1144, 0x11A8, 0x120D, 0x1271,
+	0x12D5, 0x1339, 0x139E, 0x1402, 0x1466, 0x14CA, 0x152E, 0x1593, 0x15F7, 0x165B, 0x16BF, 0x1723, 0x1787, 0x17EB, 0x1850, 0x18B4,
+	0x1918, 0x197C, 0x19E0, 0x1A44, 0x1AA8, 0x1B0C, 0x1B70, 0x1BD4, 0x1C38, 0x1C9B, 0x1CFF, 0x1D63, 0x1DC7, 0x1E2B, 0x1E8F, 0x1EF3,
+	0x1F56, 0x1FBA, 0x201E, 0x2082, 0x20E5, 0x2149, 0x21AD, 0x2210, 0x2274, 0x22D7, 0x233B, 0x239F, 0x2402, 0x2466, 0x24C9, 0x252D,
+	0x2590, 0x25F4, 0x2657, 0x26BA, 0x271E, 0x2781, 0x27E4, 0x2848, 0x28AB, 0x290E, 0x2971, 0x29D5, 0x2A38, 0x2A9B, 0x2AFE, 0x2B61,
+	0x2BC4, 0x2C27, 0x2C8A, 0x2CED, 0x2D50, 0x2DB3, 0x2E16, 0x2E79, 0x2EDC, 0x2F3F, 0x2FA1, 0x3004, 0x3067, 0x30CA, 0x312C, 0x318F,
+	0x31F1, 0x3254, 0x32B7, 0x3319, 0x337C, 0x33DE, 0x3440, 0x34A3, 0x3505, 0x3568, 0x35CA, 0x362C, 0x368E, 0x36F1, 0x3753, 0x37B5,
+	0x3817, 0x3879, 0x38DB, 0x393D, 0x399F, 0x3A01, 0x3A63, 0x3AC5, 0x3B27, 0x3B88, 0x3BEA, 0x3C4C, 0x3CAE, 0x3D0F, 0x3D71, 0x3DD2,
+	0x3E34, 0x3E95, 0x3EF7, 0x3F58, 0x3FBA, 0x401B, 0x407C, 0x40DE, 0x413F, 0x41A0, 0x4201, 0x4262, 0x42C3, 0x4324, 0x4385, 0x43E6,
+	0x4447, 0x44A8, 0x4509, 0x456A, 0x45CB, 0x462B, 0x468C, 0x46EC, 0x474D, 0x47AE, 0x480E, 0x486F, 0x48CF, 0x492F, 0x4990, 0x49F0,
+	0x4A50, 0x4AB0, 0x4B10, 0x4B71, 0x4BD1, 0x4C31, 0x4C90, 0x4CF0, 0x4D50, 0x4DB0, 0x4E10, 0x4E70, 0x4ECF, 0x4F2F, 0x4F8E, 0x4FEE,
+	0x504D, 0x50AD, 0x510C, 0x516C, 0x51CB, 0x522A, 0x5289, 0x52E8, 0x5348, 0x53A7, 0x5406, 0x5464, 0x54C3, 0x5522, 0x5581, 0x55E0,
+	0x563E, 0x569D, 0x56FC, 0x575A, 0x57B9, 0x5817, 0x5875, 0x58D4, 0x5932, 0x5990, 0x59EE, 0x5A4C, 0x5AAA, 0x5B08, 0x5B66, 0x5BC4,
+	0x5C22, 0x5C80, 0x5CDE, 0x5D3B, 0x5D99, 0x5DF6, 0x5E54, 0x5EB1, 0x5F0F, 0x5F6C, 0x5FC9, 0x6026, 0x6084, 0x60E1, 0x613E, 0x619B,
+	0x61F8, 0x6254, 0x62B1, 0x630E, 0x636B, 0x63C7, 0x6424, 0x6480, 0x64DD, 0x6539, 0x6595, 0x65F2, 0x664E, 0x66AA, 0x6706, 0x6762,
+	0x67BE, 0x681A, 0x6876, 0x68D1, 0x692D, 0x6989, 0x69E4, 0x6A40, 0x6A9B, 0x6AF6, 0x6B52, 0x6BAD, 0x6C08, 0x6C63, 0x6CBE, 0x6D19,
+	0x6D74, 0x6DCF, 0x6E2A, 0x6E85, 0x6EDF, 0x6F3A, 0x6F94, 0x6FEF, 0x7049, 0x70A3, 0x70FE, 0x7158, 0x71B2, 0x720C, 0x7266, 0x72C0,
+	0x731A, 0x7373, 0x73CD, 0x7427, 0x7480, 0x74DA, 0x7533, 0x758D, 0x75E6, 0x763F, 0x7698, 0x76F1, 0x774A, 0x77A3, 0x77FC, 0x7855,
+	0x78AD, 0x7906, 0x795F, 0x79B7, 0x7A10, 0x7A68, 0x7AC0, 0x7B18, 0x7B70, 0x7BC8, 0x7C20, 0x7C78, 0x7CD0, 0x7D28, 0x7D7F, 0x7DD7,
+	0x7E2F, 0x7E86, 0x7EDD, 0x7F35, 0x7F8C, 0x7FE3, 0x803A, 0x8091, 0x80E8, 0x813F, 0x8195, 0x81EC, 0x8243, 0x8299, 0x82F0, 0x8346,
+	0x839C, 0x83F2, 0x8449, 0x849F, 0x84F5, 0x854A, 0x85A0, 0x85F6, 0x864C, 0x86A1, 0x86F7, 0x874C, 0x87A1, 0x87F6, 0x884C, 0x88A1,
+	0x88F6, 0x894A, 0x899F, 0x89F4, 0x8A49, 0x8A9D, 0x8AF2, 0x8B46, 0x8B9A, 0x8BEF, 0x8C43, 0x8C97, 0x8CEB, 0x8D3F, 0x8D93, 0x8DE6,
+	0x8E3A, 0x8E8D, 0x8EE1, 0x8F34, 0x8F88, 0x8FDB, 0x902E, 0x9081, 0x90D4, 0x9127, 0x9179, 0x91CC, 0x921F, 0x9271, 0x92C4, 0x9316,
+	0x9368, 0x93BA, 0x940C, 0x945E, 0x94B0, 0x9502, 0x9554, 0x95A5, 0x95F7, 0x9648, 0x969A, 0x96EB, 0x973C, 0x978D, 0x97DE, 0x982F,
+	0x9880, 0x98D0, 0x9921, 0x9972, 0x99C2, 0x9A12, 0x9A63, 0x9AB3, 0x9B03, 0x9B53, 0x9BA3, 0x9BF2, 0x9C42, 0x9C92, 0x9CE1, 0x9D31,
+	0x9D80, 0x9DCF, 0x9E1E, 0x9E6D, 0x9EBC, 0x9F0B, 0x9F5A, 0x9FA8, 0x9FF7, 0xA045, 0xA094, 0xA0E2, 0xA130, 0xA17E, 0xA1CC, 0xA21A,
+	0xA268, 0xA2B5, 0xA303, 0xA350, 0xA39E, 0xA3EB, 0xA438, 0xA485, 0xA4D2, 0xA51F, 0xA56C, 0xA5B8, 0xA605, 0xA652, 0xA69E, 0xA6EA,
+	0xA736, 0xA782, 0xA7CE, 0xA81A, 0xA866, 0xA8B2, 0xA8FD, 0xA949, 0xA994, 0xA9DF, 0xAA2A, 0xAA76, 0xAAC1, 0xAB0B, 0xAB56, 0xABA1,
+	0xABEB, 0xAC36, 0xAC80, 0xACCA, 0xAD14, 0xAD5E, 0xADA8, 0xADF2, 0xAE3C, 0xAE85, 0xAECF, 0xAF18, 0xAF62, 0xAFAB, 0xAFF4, 0xB03D,
+	0xB086, 0xB0CE, 0xB117, 0xB160, 0xB1A8, 0xB1F0, 0xB239, 0xB281, 0xB2C9, 0xB311, 0xB358, 0xB3A0, 0xB3E8, 0xB42F, 0xB477, 0xB4BE,
+	0xB505, 0xB54C, 0xB593, 0xB5DA, 0xB620, 0xB667, 0xB6AD, 0xB6F4, 0xB73A, 0xB780, 0xB7C6, 0xB80C, 0xB852, 0xB898, 0xB8DD, 0xB923,
+	0xB968, 0xB9AE, 0xB9F3, 0xBA38, 0xBA7D, 0xBAC1, 0xBB06, 0xBB4B, 0xBB8F, 0xBBD4, 0xBC18, 0xBC5C, 0xBCA0, 0xBCE4, 0xBD28, 0xBD6B,
+	0xBDAF, 0xBDF2, 0xBE36, 0xBE79, 0xBEBC, 0xBEFF, 0xBF42, 0xBF85, 0xBFC7, 0xC00A, 0xC04C, 0xC08F, 0xC0D1, 0xC113, 0xC155, 0xC197,
+	0xC1D8, 0xC21A, 0xC25C, 0xC29D, 0xC2DE, 0xC31F, 0xC360, 0xC3A1, 0xC3E2, 0xC423, 0xC463, 0xC4A4, 0xC4E4, 0xC524, 0xC564, 0xC5A4,
+	0xC5E4, 0xC624, 0xC663, 0xC6A3, 0xC6E2, 0xC721, 0xC761, 0xC7A0, 0xC7DE, 0xC81D, 0xC85C, 0xC89A, 0xC8D9, 0xC917, 0xC955, 0xC993,
+	0xC9D1, 0xCA0F, 0xCA4D, 0xCA8A, 0xCAC7, 0xCB05, 0xCB42, 0xCB7F, 0xCBBC, 0xCBF9, 0xCC35, 0xCC72, 0xCCAE, 0xCCEB, 0xCD27, 0xCD63,
+	0xCD9F, 0xCDDB, 0xCE17, 0xCE52, 0xCE8E, 0xCEC9, 0xCF04, 0xCF3F, 0xCF7A, 0xCFB5, 0xCFF0, 0xD02A, 0xD065, 0xD09F, 0xD0D9, 0xD113,
+	0xD14D, 0xD187, 0xD1C1, 0xD1FA, 0xD234, 0xD26D, 0xD2A6, 0xD2DF, 0xD318, 0xD351, 0xD38A, 0xD3C2, 0xD3FB, 0xD433, 0xD46B, 0xD4A3,
+	0xD4DB, 0xD513, 0xD54B, 0xD582, 0xD5BA, 0xD5F1, 0xD628, 0xD65F, 0xD696, 0xD6CD, 0xD703, 0xD73A, 0xD770, 0xD7A6, 0xD7DC, 0xD812,
+	0xD848, 0xD87E, 0xD8B4, 0xD8E9, 0xD91E, 0xD954, 0xD989, 0xD9BE, 0xD9F2, 0xDA27, 0xDA5C, 0xDA90, 0xDAC4, 0xDAF8, 0xDB2C, 0xDB60,
+	0xDB94, 0xDBC8, 0xDBFB, 0xDC2F, 0xDC62, 0xDC95, 0xDCC8, 0xDCFB, 0xDD2D, 0xDD60, 0xDD92, 0xDDC5, 0xDDF7, 0xDE29, 0xDE5B, 0xDE8C,
+	0xDEBE, 0xDEF0, 0xDF21, 0xDF52, 0xDF83, 0xDFB4, 0xDFE5, 0xE016, 0xE046, 0xE077, 0xE0A7, 0xE0D7, 0xE107, 0xE137, 0xE167, 0xE196,
+	0xE1C6, 0xE1F5, 0xE224, 0xE253, 0xE282, 0xE2B1, 0xE2DF, 0xE30E, 0xE33C, 0xE36B, 0xE399, 0xE3C7, 0xE3F4, 0xE422, 0xE450, 0xE47D,
+	0xE4AA, 0xE4D7, 0xE504, 0xE531, 0xE55E, 0xE58B, 0xE5B7, 0xE5E3, 0xE610, 0xE63C, 0xE667, 0xE693, 0xE6BF, 0xE6EA, 0xE716, 0xE741,
+	0xE76C, 0xE797, 0xE7C2, 0xE7EC, 0xE817, 0xE841, 0xE86B, 0xE895, 0xE8BF, 0xE8E9, 0xE913, 0xE93C, 0xE966, 0xE98F, 0xE9B8, 0xE9E1,
+	0xEA0A, 0xEA32, 0xEA5B, 0xEA83, 0xEAAB, 0xEAD4, 0xEAFC, 0xEB23, 0xEB4B, 0xEB73, 0xEB9A, 0xEBC1, 0xEBE8, 0xEC0F, 0xEC36, 0xEC5D,
+	0xEC83, 0xECAA, 0xECD0, 0xECF6, 0xED1C, 0xED42, 0xED68, 0xED8D, 0xEDB3, 0xEDD8, 0xEDFD, 0xEE22, 0xEE47, 0xEE6B, 0xEE90, 0xEEB4,
+	0xEED9, 0xEEFD, 0xEF21, 0xEF45, 0xEF68, 0xEF8C, 0xEFAF, 0xEFD2, 0xEFF5, 0xF018, 0xF03B, 0xF05E, 0xF080, 0xF0A3, 0xF0C5, 0xF0E7,
+	0xF109, 0xF12B, 0xF14C, 0xF16E, 0xF18F, 0xF1B1, 0xF1D2, 0xF1F3, 0xF213, 0xF234, 0xF254, 0xF275, 0xF295, 0xF2B5, 0xF2D5, 0xF2F5,
+	0xF314, 0xF334, 0xF353, 0xF372, 0xF391, 0xF3B0, 0xF3CF, 0xF3ED, 0xF40C, 0xF42A, 0xF448, 0xF466, 0xF484, 0xF4A2, 0xF4BF, 0xF4DD,
+	0xF4FA, 0xF517, 0xF534, 0xF551, 0xF56E, 0xF58A, 0xF5A6, 0xF5C3, 0xF5DF, 0xF5FB, 0xF616, 0xF632, 0xF64E, 0xF669, 0xF684, 0xF69F,
+	0xF6BA, 0xF6D5, 0xF6EF, 0xF70A, 0xF724, 0xF73E, 0xF758, 0xF772, 0xF78C, 0xF7A5, 0xF7BF, 0xF7D8, 0xF7F1, 0xF80A, 0xF823, 0xF83B,
+	0xF854, 0xF86C, 0xF885, 0xF89D, 0xF8B4, 0xF8CC, 0xF8E4, 0xF8FB, 0xF913, 0xF92A, 0xF941, 0xF958, 0xF96E, 0xF985, 0xF99B, 0xF9B2,
+	0xF9C8, 0xF9DE, 0xF9F3, 0xFA09, 0xFA1F, 0xFA34, 0xFA49, 0xFA5E, 0xFA73, 0xFA88, 0xFA9C, 0xFAB1, 0xFAC5, 0xFAD9, 0xFAED, 0xFB01,
+	0xFB15, 0xFB28, 0xFB3C, 0xFB4F, 0xFB62, 0xFB75, 0xFB88, 0xFB9A, 0xFBAD, 0xFBBF, 0xFBD1, 0xFBE3, 0xFBF5, 0xFC07, 0xFC18, 0xFC2A,
+	0xFC3B, 0xFC4C, 0xFC5D, 0xFC6E, 0xFC7F, 0xFC8F, 0xFCA0, 0xFCB0, 0xFCC0, 0xFCD0, 0xFCDF, 0xFCEF, 0xFCFE, 0xFD0E, 0xFD1D, 0xFD2C,
+	0xFD3B, 0xFD49, 0xFD58, 0xFD66, 0xFD74, 0xFD83, 0xFD90, 0xFD9E, 0xFDAC, 0xFDB9, 0xFDC7, 0xFDD4, 0xFDE1, 0xFDEE, 0xFDFA, 0xFE07,
+	0xFE13, 0xFE1F, 0xFE2B, 0xFE37, 0xFE43, 0xFE4F, 0xFE5A, 0xFE66, 0xFE71, 0xFE7C, 0xFE87, 0xFE91, 0xFE9C, 0xFEA6, 0xFEB0, 0xFEBA,
+	0xFEC4, 0xFECE, 0xFED8, 0xFEE1, 0xFEEB, 0xFEF4, 0xFEFD, 0xFF06, 0xFF0E, 0xFF17, 0xFF1F, 0xFF28, 0xFF30, 0xFF38, 0xFF3F, 0xFF47,
+	0xFF4E, 0xFF56, 0xFF5D, 0xFF64, 0xFF6B, 0xFF71, 0xFF78, 0xFF7E, 0xFF85, 0xFF8B, 0xFF91, 0xFF96, 0xFF9C, 0xFFA2, 0xFFA7, 0xFFAC,
+	0xFFB1, 0xFFB6, 0xFFBB, 0xFFBF, 0xFFC4, 0xFFC8, 0xFFCC, 0xFFD0, 0xFFD4, 0xFFD7, 0xFFDB, 0xFFDE, 0xFFE1, 0xFFE4, 0xFFE7, 0xFFEA,
+	0xFFEC, 0xFFEF, 0xFFF1, 0xFFF3, 0xFFF5, 0xFFF7, 0xFFF8, 0xFFFA, 0xFFFB, 0xFFFC, 0xFFFD, 0xFFFE, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline UbxFixed _UbxSinTableEntry(const u32 index)
+{
+	return (index < TRIG_TABLE_LENGTH) ? (UbxFixed) gSinTable[index] : UBX_FIXED_ONE;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline UbxFixed _UbxSinQuarter(const u32 quarterAngle)
+{
+	/* Linearly interpolate between the two nearest table entries; the quarter angle is in the range [0, 0x4000]. */
+	const u32 index = quarterAngle >> TRIG_LERP_BITS;
+	const s32 lerp = (s32) (quarterAngle & TRIG_LERP_MASK);
+
+	const UbxFixed s0 = _UbxSinTableEntry(index);
+	const UbxFixed s1 = _UbxSinTableEntry(index + 1);
+
+	return s0 + (((s1 - s0) * lerp) >> TRIG_LERP_BITS);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxFixed UbxSin(const UbxAngle angle)
+{
+	const u32 quadrant = (u32) angle >> 14;
+	const u32 quarterAngle = (u32) angle & (TRIG_QUARTER_TURN - 1);
+
+	switch(quadrant)
+	{
+		case 0:  return _UbxSinQuarter(quarterAngle);
+		case 1:  return _UbxSinQuarter(TRIG_QUARTER_TURN - quarterAngle);
+		case 2:  return -_UbxSinQuarter(quarterAngle);
+		default: return -_UbxSinQuarter(TRIG_QUARTER_TURN - quarterAngle);
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxFixed UbxCos(const UbxAngle angle)
+{
+	return UbxSin((UbxAngle) (angle + TRIG_QUARTER_TURN));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSinCos(const UbxAngle angle, UbxFixed* const pOutSin, UbxFixed* const pOutCos)
+{
+	(*pOutSin) = UbxSin(angle);
+	(*pOutCos) = UbxSin((UbxAngle) (angle + TRIG_QUARTER_TURN));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "clear.h"
+
+#include "../lowlevel/gfx.h"
+
+#include <os.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxClearData gUbxClear;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxClearFill(const u32 ulx, const u32 uly, const u32 lrx, const u32 lry)
+{
+	/* Fill mode treats the lower-right corner as inclusive. */
+	gDPFillRectangle(UBX_GFX_CMD_NEXT, ulx, uly, lrx - 1, lry - 1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _UbxClearSetDefaults()
+{
+	/* Clear the data structure. */
+	memset(&gUbxClear, 0, sizeof(gUbxClear));
+
+	/* Default to clearing everything since that is always correct; games should opt out of whatever they don't need. */
+	gUbxClear.colorMode = UBX_CLEAR_COLOR_FULL;
+	gUbxClear.clearDepth = 1;
+	gUbxClear.colorValue = (GPACK_RGBA5551(0, 0, 0, 1) << 16) | GPACK_RGBA5551(0, 0, 0, 1);
+	gUbxClear.depthValue = (GPACK_ZDZ(G_MAXFBZ, 0) << 16) | GPACK_ZDZ(G_MAXFBZ, 0);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxClearAddDirtyRect(s32 ulx, s32 uly, s32 lrx, s32 lry)
+{
+	ulx = (ulx < 0) ? 0 : ulx;
+	uly = (uly < 0) ? 0 : uly;
+	lrx = (lrx > gUbxClear.width) ? gUbxClear.width : lrx;
+	lry = (lry > gUbxClear.height) ? gUbxClear.height : lry;
+
+	if(ulx >= lrx || uly >= lry)
+	{
+		return;
+	}
+
+	if(gUbxClear.dirtyRectCount == UBX_CLEAR_MAX_DIRTY_RECTS)
+	{
+		gUbxClear.dirtyRectOverflow = 1;
+		return;
+	}
+
+	UbxClearRect* const pRect = &gUbxClear.dirtyRect[gUbxClear.dirtyRectCount];
+
+	pRect->ulx = (u16) ulx;
+	pRect->uly = (u16) uly;
+	pRect->lrx = (u16) lrx;
+	pRect->lry = (u16) lry;
+
+	++gUbxClear.dirtyRectCount;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxClearEmit(const void* const pColorBuffer)
+{
+	const u32 width = gUbxClear.width;
+	const u32 fillWidth = (gUbxClear.fillWidth && gUbxClear.fillWidth < width) ? gUbxClear.fillWidth : width;
+	const u32 fillHeight = (gUbxClear.fillHeight && gUbxClear.fillHeight < gUbxClear.height)
+		? gUbxClear.fillHeight
+		: gUbxClear.height;
+
+	u32 colorMode = gUbxClear.colorMode;
+
+	if(colorMode == UBX_CLEAR_COLOR_DIRTY_RECTS && gUbxClear.dirtyRectOverflow)
+	{
+		colorMode = UBX_CLEAR_COLOR_FULL;
+	}
+
+	if(gUbxClear.clearDepth || colorMode != UBX_CLEAR_COLOR_NONE)
+	{
+		UBX_GFX_SET_CYCLE_TYPE(G_CYC_FILL);
+	}
+
+	/* The state tracker inserts the pipe syncs required between each fill and the image changes that follow it. */
+	if(gUbxClear.clearDepth)
+	{
+		UBX_GFX_SET_COLOR_IMAGE(G_IM_FMT_RGBA, G_IM_SIZ_16b, width, OS_K0_TO_PHYSICAL(gUbxClear.pDepthBuffer));
+		UBX_GFX_SET_FILL_COLOR(gUbxClear.depthValue);
+		_UbxClearFill(0, 0, fillWidth, fillHeight);
+	}
+
+	UBX_GFX_SET_COLOR_IMAGE(G_IM_FMT_RGBA, G_IM_SIZ_16b, width, OS_K0_TO_PHYSICAL(pColorBuffer));
+
+	if(colorMode == UBX_CLEAR_COLOR_FULL)
+	{
+		UBX_GFX_SET_FILL_COLOR(gUbxClear.colorValue);
+		_UbxClearFill(0, 0, fillWidth, fillHeight);
+	}
+	else if(colorMode == UBX_CLEAR_COLOR_DIRTY_RECTS && gUbxClear.dirtyRectCount > 0)
+	{
+		UBX_GFX_SET_FILL_COLOR(gUbxClear.colorValue);
+
+		for(u32 i = 0; i < gUbxClear.dirtyRectCount; ++i)
+		{
+			const UbxClearRect* const pRect = &gUbxClear.dirtyRect[i];
+
+			_UbxClearFill(pRect->ulx, pRect->uly, pRect->lrx, pRect->lry);
+		}
+	}
+
+	UBX_GFX_SET_DEPTH_IMAGE(OS_K0_TO_PHYSICAL(gUbxClear.pDepthBuffer));
+
+	gUbxClear.dirtyRectCount = 0;
+	gUbxClear.dirtyRectOverflow = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/env.h"
+
+#include <gbi.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_CLEAR_MAX_DIRTY_RECTS 16
+
+/* Place a depth buffer in the '.zbuffer' section, which the linker script aligns to the start of the next 1 MiB bank
+ * of RDRAM after all resident data. Keeping depth and color accesses in different banks lets each bank hold its page
+ * open instead of both fighting over the same one while the RDP interleaves depth and color reads and writes. */
+#define UBX_CLEAR_DEPTH_BUFFER_SECTION __attribute__((section(".zbuffer"), aligned(0x40)))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxClearColorMode
+{
+	UBX_CLEAR_COLOR_NONE,        /* The frame covers the entire color buffer, so it never needs clearing. */
+	UBX_CLEAR_COLOR_FULL,        /* Fill the entire color buffer. */
+	UBX_CLEAR_COLOR_DIRTY_RECTS, /* Fill only the rects added for this frame. */
+} UbxClearColorMode;
+
+/* Lower-right coordinates are exclusive. */
+typedef struct _UbxClearRect
+{
+	u16 ulx;
+	u16 uly;
+	u16 lrx;
+	u16 lry;
+} UbxClearRect;
+
+typedef struct _UbxClearData
+{
+	UbxClearRect dirtyRect[UBX_CLEAR_MAX_DIRTY_RECTS];
+
+	void* pDepthBuffer;
+
+	u32 colorValue;
+	u32 depthValue;
+
+	u16 width;
+	u16 height;
+
+	/* Area to fill from the top-left corner, which may be smaller than the buffers when rendering at a reduced size;
+	 * zero means the full width or height. */
+	u16 fillWidth;
+	u16 fillHeight;
+
+	u8 colorMode;
+	u8 clearDepth;
+	u8 dirtyRectCount;
+	u8 dirtyRectOverflow;
+} UbxClearData;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern UbxClearData gUbxClear;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void _UbxClearSetDefaults();
+
+/* Mark part of the color buffer that will be cleared in UBX_CLEAR_COLOR_DIRTY_RECTS mode. This is for areas the frame
+ * won't draw over itself, such as where a HUD element was last drawn into the same color buffer; with multiple color
+ * buffers that is usually more than one frame ago. Running out of rects falls back to clearing the whole buffer. */
+extern void UbxClearAddDirtyRect(s32 ulx, s32 uly, s32 lrx, s32 lry);
+
+/* Append the clears for this frame to the current gfx command list through the gfx state tracker, then leave the color
+ * and depth images bound for drawing. This is meant to go at the start of the frame's draw list rather than in its own
+ * task, which saves the RCP a task round-trip; the dirty rects are consumed by this. */
+extern void UbxClearEmit(const void* pColorBuffer);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "cull.h"
+
+#include "../lowlevel/gfx.h"
+
+#include <gu.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Sum of three 16.16 products, accumulated at full 64-bit precision and shifted back down only once. */
+#define DOT3(a0, b0, a1, b1, a2, b2) \
+	((UbxFixed) (((s64) (a0) * (s64) (b0) + (s64) (a1) * (s64) (b1) + (s64) (a2) * (s64) (b2)) >> UBX_FIXED_SHIFT))
+
+#define ABS(x) (((x) < 0) ? -(x) : (x))
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline void _UbxSetPlane(UbxPlane* const pOut, const f32 x, const f32 y, const f32 z, const f32 dist)
+{
+	pOut->normal.x = UBX_FIXED_FROM_FLOAT(x);
+	pOut->normal.y = UBX_FIXED_FROM_FLOAT(y);
+	pOut->normal.z = UBX_FIXED_FROM_FLOAT(z);
+	pOut->dist = UBX_FIXED_FROM_FLOAT(dist);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline UbxFixed _UbxPlaneDistance(const UbxPlane* const pPlane, const UbxVec3* const pPoint)
+{
+	return DOT3(pPlane->normal.x, pPoint->x, pPlane->normal.y, pPoint->y, pPlane->normal.z, pPoint->z) + pPlane->dist;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxFrustumFromPerspective(
+	UbxFrustum* const pOut,
+	const f32 fovy,
+	const f32 aspect,
+	const f32 near,
+	const f32 far)
+{
+	/* The side planes all pass through the eye, so each one only needs the slope of its edge of the view volume. */
+	const f32 halfFovy = fovy * (3.14159265359f / 360.0f);
+	const f32 tanY = sinf(halfFovy) / cosf(halfFovy);
+	const f32 tanX = tanY * aspect;
+
+	const f32 invLenY = 1.0f / sqrtf(1.0f + (tanY * tanY));
+	const f32 invLenX = 1.0f / sqrtf(1.0f + (tanX * tanX));
+
+	_UbxSetPlane(&pOut->plane[UBX_FRUSTUM_PLANE_NEAR], 0.0f, 0.0f, -1.0f, -near);
+	_UbxSetPlane(&pOut->plane[UBX_FRUSTUM_PLANE_FAR], 0.0f, 0.0f, 1.0f, far);
+	_UbxSetPlane(&pOut->plane[UBX_FRUSTUM_PLANE_LEFT], invLenX, 0.0f, -tanX * invLenX, 0.0f);
+	_UbxSetPlane(&pOut->plane[UBX_FRUSTUM_PLANE_RIGHT], -invLenX, 0.0f, -tanX * invLenX, 0.0f);
+	_UbxSetPlane(&pOut->plane[UBX_FRUSTUM_PLANE_TOP], 0.0f, -invLenY, -tanY * invLenY, 0.0f);
+	_UbxSetPlane(&pOut->plane[UBX_FRUSTUM_PLANE_BOTTOM], 0.0f, invLenY, -tanY * invLenY, 0.0f);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxCullResult UbxCullSphere(
+	const UbxFrustum* const pFrustum,
+	const UbxAffine* const pModelView,
+	const UbxSphere* const pSphere)
+{
+	UbxVec3 center;
+	UbxAffineTransformPoint(&center, pModelView, &pSphere->center);
+
+	/* Scale the radius by the longest basis vector so the sphere stays conservative under non-uniform scales.
+	 * Model-view transforms routinely carry very small scales (e.g., high precision vertex data being scaled back
+	 * down to world units), which would lose most of their precision if squared in fixed-point. */
+	f32 maxScaleSq = 0.0f;
+	for(int i = 0; i < 3; ++i)
+	{
+		const f32 x = UBX_FIXED_TO_FLOAT(pModelView->m[i][0]);
+		const f32 y = UBX_FIXED_TO_FLOAT(pModelView->m[i][1]);
+		const f32 z = UBX_FIXED_TO_FLOAT(pModelView->m[i][2]);
+		const f32 lenSq = (x * x) + (y * y) + (z * z);
+
+		if(lenSq > maxScaleSq)
+		{
+			maxScaleSq = lenSq;
+		}
+	}
+
+	const UbxFixed radius = UBX_FIXED_FROM_FLOAT(UBX_FIXED_TO_FLOAT(pSphere->radius) * sqrtf(maxScaleSq));
+
+	UbxCullResult result = UBX_CULL_INSIDE;
+	for(int i = 0; i < UBX_FRUSTUM_PLANE_COUNT; ++i)
+	{
+		const UbxFixed dist = _UbxPlaneDistance(&pFrustum->plane[i], &center);
+
+		if(dist < -radius)
+		{
+			return UBX_CULL_OUTSIDE;
+		}
+
+		if(dist < radius)
+		{
+			result = UBX_CULL_INTERSECT;
+		}
+	}
+
+	return result;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UbxCullResult UbxCullAabb(
+	const UbxFrustum* const pFrustum,
+	const UbxAffine* const pModelView,
+	const UbxAabb* const pAabb)
+{
+	const UbxVec3 localCenter =
+	{
+		(pAabb->min.x + pAabb->max.x) >> 1,
+		(pAabb->min.y + pAabb->max.y) >> 1,
+		(pAabb->min.z + pAabb->max.z) >> 1,
+	};
+	const UbxFixed ex = (pAabb->max.x - pAabb->min.x) >> 1;
+	const UbxFixed ey = (pAabb->max.y - pAabb->min.y) >> 1;
+	const UbxFixed ez = (pAabb->max.z - pAabb->min.z) >> 1;
+
+	UbxVec3 center;
+	UbxAffineTransformPoint(&center, pModelView, &localCenter);
+
+	/* Half extents of the view space box that encloses the transformed box. */
+	const UbxAffine* const pM = pModelView;
+	const UbxVec3 extent =
+	{
+		DOT3(ex, ABS(pM->m[0][0]), ey, ABS(pM->m[1][0]), ez, ABS(pM->m[2][0])),
+		DOT3(ex, ABS(pM->m[0][1]), ey, ABS(pM->m[1][1]), ez, ABS(pM->m[2][1])),
+		DOT3(ex, ABS(pM->m[0][2]), ey, ABS(pM->m[1][2]), ez, ABS(pM->m[2][2])),
+	};
+
+	UbxCullResult result = UBX_CULL_INSIDE;
+	for(int i = 0; i < UBX_FRUSTUM_PLANE_COUNT; ++i)
+	{
+		const UbxPlane* const pPlane = &pFrustum->plane[i];
+
+		/* Projected radius of the box onto the plane normal. */
+		const UbxFixed radius = DOT3(
+			ABS(pPlane->normal.x), extent.x,
+			ABS(pPlane->normal.y), extent.y,
+			ABS(pPlane->normal.z), extent.z);
+		const UbxFixed dist = _UbxPlaneDistance(pPlane, &center);
+
+		if(dist < -radius)
+		{
+			return UBX_CULL_OUTSIDE;
+		}
+
+		if(dist < radius)
+		{
+			result = UBX_CULL_INTERSECT;
+		}
+	}
+
+	return result;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxCullEmitBounds(Vtx* const pOutVtx, const UbxAabb* const pAabb)
+{
+	const s16 x[2] = { (s16) UBX_FIXED_TO_INT(pAabb->min.x), (s16) UBX_FIXED_TO_INT(pAabb->max.x + UBX_FIXED_ONE - 1) };
+	const s16 y[2] = { (s16) UBX_FIXED_TO_INT(pAabb->min.y), (s16) UBX_FIXED_TO_INT(pAabb->max.y + UBX_FIXED_ONE - 1) };
+	const s16 z[2] = { (s16) UBX_FIXED_TO_INT(pAabb->min.z), (s16) UBX_FIXED_TO_INT(pAabb->max.z + UBX_FIXED_ONE - 1) };
+
+	for(int i = 0; i < UBX_CULL_BOUNDS_VTX_COUNT; ++i)
+	{
+		Vtx_t* const pVtx = &pOutVtx[i].v;
+
+		pVtx->ob[0] = x[i & 1];
+		pVtx->ob[1] = y[(i >> 1) & 1];
+		pVtx->ob[2] = z[(i >> 2) & 1];
+		pVtx->flag = 0;
+		pVtx->tc[0] = 0;
+		pVtx->tc[1] = 0;
+		pVtx->cn[0] = 0;
+		pVtx->cn[1] = 0;
+		pVtx->cn[2] = 0;
+		pVtx->cn[3] = 0;
+	}
+
+	/* The RSP skips the rest of the display list when every vertex in the range is outside the same clip plane. */
+	gSPVertex(UBX_GFX_CMD_NEXT, pOutVtx, UBX_CULL_BOUNDS_VTX_COUNT, 0);
+	gSPCullDisplayList(UBX_GFX_CMD_NEXT, 0, UBX_CULL_BOUNDS_VTX_COUNT - 1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
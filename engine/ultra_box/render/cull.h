@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/env.h"
+#include "../math/mtx.h"
+
+#include <gbi.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Number of vertices written by UbxCullEmitBounds(); these occupy the first slots of the RSP vertex buffer. */
+#define UBX_CULL_BOUNDS_VTX_COUNT 8
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _UbxFrustumPlane
+{
+	UBX_FRUSTUM_PLANE_NEAR,
+	UBX_FRUSTUM_PLANE_FAR,
+	UBX_FRUSTUM_PLANE_LEFT,
+	UBX_FRUSTUM_PLANE_RIGHT,
+	UBX_FRUSTUM_PLANE_TOP,
+	UBX_FRUSTUM_PLANE_BOTTOM,
+
+	UBX_FRUSTUM_PLANE_COUNT,
+} UbxFrustumPlane;
+
+typedef enum _UbxCullResult
+{
+	UBX_CULL_OUTSIDE,
+	UBX_CULL_INTERSECT,
+	UBX_CULL_INSIDE,
+} UbxCullResult;
+
+/* Plane with a unit-length normal pointing into the frustum, so 'dot(normal, p) + dist' is the signed distance of
+ * point 'p' from the plane and is positive on the visible side. */
+typedef struct _UbxPlane
+{
+	UbxVec3 normal;
+	UbxFixed dist;
+} UbxPlane;
+
+/* View frustum in view space (the camera is at the origin looking down -Z, matching guLookAt and guPerspective). */
+typedef struct _UbxFrustum
+{
+	UbxPlane plane[UBX_FRUSTUM_PLANE_COUNT];
+} UbxFrustum;
+
+/* Bounding volumes are in the same space (and scale) as the vertex data they enclose, so model data can store
+ * one per object and one per cluster (i.e., per vertex batch) without any runtime setup. */
+typedef struct _UbxSphere
+{
+	UbxVec3 center;
+	UbxFixed radius;
+} UbxSphere;
+
+typedef struct _UbxAabb
+{
+	UbxVec3 min;
+	UbxVec3 max;
+} UbxAabb;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Build the view frustum for a projection; the arguments are the same as those passed to guPerspective. */
+extern void UbxFrustumFromPerspective(UbxFrustum* pOut, f32 fovy, f32 aspect, f32 near, f32 far);
+
+/* Test bounding volumes against a frustum after transforming them by the model-view transform used to draw them.
+ * Anything that returns UBX_CULL_OUTSIDE should be skipped entirely so its vertices are never loaded by the RSP. */
+extern UbxCullResult UbxCullSphere(const UbxFrustum* pFrustum, const UbxAffine* pModelView, const UbxSphere* pSphere);
+extern UbxCullResult UbxCullAabb(const UbxFrustum* pFrustum, const UbxAffine* pModelView, const UbxAabb* pAabb);
+
+/* Emit an RSP-side cull test for a cluster using the corners of its bounding box. This loads the corners into
+ * the vertex buffer and follows them with gSPCullDisplayList, so the rest of the current display list is skipped
+ * when all corners are off screen. This is only worth doing for clusters the CPU did not test itself, such as those
+ * inside static display lists; the caller must provide (and write back) storage for the corner vertices. */
+extern void UbxCullEmitBounds(Vtx* pOutVtx, const UbxAabb* pAabb);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "scene.h"
+
+#include "../lowlevel/cache.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSceneInit(UbxScene* const pScene, UbxSceneNode* const pNodeBuffer, const u16 nodeCapacity)
+{
+	pScene->pNodes = pNodeBuffer;
+	pScene->nodeCount = 0;
+	pScene->nodeCapacity = nodeCapacity;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+u16 UbxSceneAddNode(UbxScene* const pScene, const u16 parent)
+{
+	if(pScene->nodeCount == pScene->nodeCapacity)
+	{
+		return UBX_SCENE_NODE_NONE;
+	}
+
+	const u16 index = pScene->nodeCount;
+	UbxSceneNode* const pNode = &pScene->pNodes[index];
+
+	++pScene->nodeCount;
+
+	UbxAffineIdentity(&pNode->world);
+	UbxQuatIdentity(&pNode->rot);
+
+	pNode->pos.x = 0;
+	pNode->pos.y = 0;
+	pNode->pos.z = 0;
+	pNode->scale.x = UBX_FIXED_ONE;
+	pNode->scale.y = UBX_FIXED_ONE;
+	pNode->scale.z = UBX_FIXED_ONE;
+	pNode->parent = (parent < index) ? parent : UBX_SCENE_NODE_NONE;
+	pNode->flags = UBX_SCENE_NODE_FLAG_DIRTY;
+	pNode->mtxIndex = 0;
+
+	return index;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSceneUpdate(UbxScene* const pScene)
+{
+	UbxSceneNode* const pNodes = pScene->pNodes;
+	const u16 nodeCount = pScene->nodeCount;
+
+	for(u16 i = 0; i < nodeCount; ++i)
+	{
+		UbxSceneNode* const pNode = &pNodes[i];
+		const UbxSceneNode* const pParent = (pNode->parent != UBX_SCENE_NODE_NONE) ? &pNodes[pNode->parent] : NULL;
+
+		/* Parents always come first, so the parent's 'changed' flag is already final for this update. */
+		const u8 parentChanged = pParent ? (pParent->flags & UBX_SCENE_NODE_FLAG_CHANGED) : 0;
+
+		if(!(pNode->flags & UBX_SCENE_NODE_FLAG_DIRTY) && !parentChanged)
+		{
+			pNode->flags &= ~UBX_SCENE_NODE_FLAG_CHANGED;
+			continue;
+		}
+
+		UbxAffineFromTRS(&pNode->world, &pNode->pos, &pNode->rot, &pNode->scale);
+
+		if(pParent)
+		{
+			UbxAffineMul(&pNode->world, &pNode->world, &pParent->world);
+		}
+
+		/* Write the new matrix to the next slot since the current one may still be in use by the RCP. */
+		pNode->mtxIndex = (pNode->mtxIndex + 1) % UBX_SCENE_MTX_SLOT_COUNT;
+
+		Mtx* const pMtx = &pNode->mtx[pNode->mtxIndex];
+
+		UbxAffineToMtx(pMtx, &pNode->world);
+		UbxCacheMarkDirty(pMtx, sizeof(Mtx));
+
+		pNode->flags = (pNode->flags & ~UBX_SCENE_NODE_FLAG_DIRTY) | UBX_SCENE_NODE_FLAG_CHANGED;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
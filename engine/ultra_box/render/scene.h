@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/arena.h"
+#include "../lowlevel/env.h"
+#include "../math/mtx.h"
+
+#include <gbi.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_SCENE_NODE_NONE 0xFFFF
+
+/* Each node keeps one RSP matrix per frame that can be in flight, so rewriting a node's matrix never touches
+ * a copy that an earlier frame's display list is still reading. */
+#define UBX_SCENE_MTX_SLOT_COUNT UBX_ARENA_MAX_FRAME_COUNT
+
+#define UBX_SCENE_NODE_FLAG_DIRTY   0x01 /* The local transform was changed since the last update. */
+#define UBX_SCENE_NODE_FLAG_CHANGED 0x02 /* The world transform was recomputed by the last update. */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct _UbxSceneNode
+{
+	Mtx mtx[UBX_SCENE_MTX_SLOT_COUNT];
+
+	UbxAffine world;
+
+	UbxQuat rot;
+	UbxVec3 pos;
+	UbxVec3 scale;
+
+	u16 parent;
+
+	u8 flags;
+	u8 mtxIndex;
+} UbxSceneNode;
+
+/* Flat scene graph. Nodes are stored with every parent before all of its children, which lets a single forward
+ * pass over the array propagate transform changes down the hierarchy without any recursion. */
+typedef struct _UbxScene
+{
+	UbxSceneNode* pNodes;
+
+	u16 nodeCount;
+	u16 nodeCapacity;
+} UbxScene;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Use caller-provided storage for the scene's nodes. */
+extern void UbxSceneInit(UbxScene* pScene, UbxSceneNode* pNodeBuffer, u16 nodeCapacity);
+
+/* Add a node with an identity local transform. The parent must already be in the scene (or be UBX_SCENE_NODE_NONE
+ * for a root node), which is what keeps the array in parent-before-child order. Returns UBX_SCENE_NODE_NONE when the
+ * scene is full. */
+extern u16 UbxSceneAddNode(UbxScene* pScene, u16 parent);
+
+/* Recompute the world transform and RSP matrix of every node whose local transform changed, along with all of its
+ * descendants; everything else keeps the matrix it had on previous frames. This registers the new matrices with
+ * the cache, so it must be called before the next UbxCacheFlush() that precedes the draw task. */
+extern void UbxSceneUpdate(UbxScene* pScene);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline void UbxSceneSetPosition(UbxScene* const pScene, const u16 index, const UbxVec3* const pPos)
+{
+	UbxSceneNode* const pNode = &pScene->pNodes[index];
+
+	pNode->pos = *pPos;
+	pNode->flags |= UBX_SCENE_NODE_FLAG_DIRTY;
+}
+
+static inline void UbxSceneSetRotation(UbxScene* const pScene, const u16 index, const UbxQuat* const pRot)
+{
+	UbxSceneNode* const pNode = &pScene->pNodes[index];
+
+	pNode->rot = *pRot;
+	pNode->flags |= UBX_SCENE_NODE_FLAG_DIRTY;
+}
+
+static inline void UbxSceneSetScale(UbxScene* const pScene, const u16 index, const UbxVec3* const pScale)
+{
+	UbxSceneNode* const pNode = &pScene->pNodes[index];
+
+	pNode->scale = *pScale;
+	pNode->flags |= UBX_SCENE_NODE_FLAG_DIRTY;
+}
+
+/* Get the world transform of a node as of the last update. */
+static inline const UbxAffine* UbxSceneGetWorld(const UbxScene* const pScene, const u16 index)
+{
+	return &pScene->pNodes[index].world;
+}
+
+/* Get the RSP world matrix of a node as of the last update; it stays valid until the node changes again. */
+static inline const Mtx* UbxSceneGetMtx(const UbxScene* const pScene, const u16 index)
+{
+	const UbxSceneNode* const pNode = &pScene->pNodes[index];
+
+	return &pNode->mtx[pNode->mtxIndex];
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
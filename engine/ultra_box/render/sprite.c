@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "sprite.h"
+
+#include "../lowlevel/gfx.h"
+
+#include <os.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_SPRITE_KEY_ORDER_MASK 0x0000FFFF
+#define UBX_SPRITE_KEY_MODE_SHIFT 24
+#define UBX_SPRITE_KEY_LAYER_SHIFT 28
+
+#define UBX_SPRITE_KEY(layer, mode, order) \
+	(((u32) ((layer) & UBX_SPRITE_MAX_LAYER) << UBX_SPRITE_KEY_LAYER_SHIFT) \
+		| ((u32) (mode) << UBX_SPRITE_KEY_MODE_SHIFT) \
+		| ((u32) (order) & UBX_SPRITE_KEY_ORDER_MASK))
+
+#define UBX_SPRITE_KEY_GET_MODE(key) (((key) >> UBX_SPRITE_KEY_MODE_SHIFT) & 0xF)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSpriteAdd(
+	UbxSpriteBatch* const pBatch,
+	const UbxSpriteTexture* const pTexture,
+	s16 x,
+	s16 y,
+	u16 s,
+	u16 t,
+	u16 width,
+	u16 height,
+	const u32 color,
+	const u8 layer,
+	const UbxSpriteMode mode)
+{
+	/* Rectangle coordinates are unsigned on the RDP, so anything hanging off the top or left edge of the screen is
+	 * clipped here; the scissor takes care of the other two edges. */
+	if(x < 0)
+	{
+		if(-x >= width)
+		{
+			return;
+		}
+
+		s += (u16) -x;
+		width -= (u16) -x;
+		x = 0;
+	}
+
+	if(y < 0)
+	{
+		if(-y >= height)
+		{
+			return;
+		}
+
+		t += (u16) -y;
+		height -= (u16) -y;
+		y = 0;
+	}
+
+	if(width == 0 || height == 0)
+	{
+		return;
+	}
+
+	if(pBatch->count == pBatch->capacity)
+	{
+		++pBatch->droppedCount;
+		return;
+	}
+
+	UbxSprite* const pSprite = &pBatch->pSprites[pBatch->count];
+
+	pSprite->pTexture = pTexture;
+	pSprite->color = color;
+	pSprite->key = UBX_SPRITE_KEY(layer, mode, pBatch->count);
+	pSprite->x = x;
+	pSprite->y = y;
+	pSprite->width = width;
+	pSprite->height = height;
+	pSprite->s = s;
+	pSprite->t = t;
+
+	++pBatch->count;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline int _UbxSpriteLess(const UbxSprite* const pLeft, const UbxSprite* const pRight)
+{
+	const u32 leftGroup = pLeft->key & ~UBX_SPRITE_KEY_ORDER_MASK;
+	const u32 rightGroup = pRight->key & ~UBX_SPRITE_KEY_ORDER_MASK;
+
+	if(leftGroup != rightGroup)
+	{
+		return leftGroup < rightGroup;
+	}
+
+	if(pLeft->pTexture != pRight->pTexture)
+	{
+		return (u32) pLeft->pTexture < (u32) pRight->pTexture;
+	}
+
+	if(pLeft->color != pRight->color)
+	{
+		return pLeft->color < pRight->color;
+	}
+
+	/* Fall back to the submission order so the result is the same from frame to frame. */
+	return pLeft->key < pRight->key;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSpriteSort(UbxSprite* const pSprites, const u32 count)
+{
+	/* Shell sort is in-place, needs no recursion, and does well on the mostly-sorted input a HUD tends to produce. */
+	static const u32 gaps[] = { 701, 301, 132, 57, 23, 10, 4, 1 };
+
+	for(u32 g = 0; g < sizeof(gaps) / sizeof(gaps[0]); ++g)
+	{
+		const u32 gap = gaps[g];
+
+		for(u32 i = gap; i < count; ++i)
+		{
+			const UbxSprite current = pSprites[i];
+			u32 j = i;
+
+			while(j >= gap && _UbxSpriteLess(&current, &pSprites[j - gap]))
+			{
+				pSprites[j] = pSprites[j - gap];
+				j -= gap;
+			}
+
+			pSprites[j] = current;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSpriteSetMode(const UbxSpriteMode mode)
+{
+	switch(mode)
+	{
+		case UBX_SPRITE_MODE_FILL:
+			UBX_GFX_SET_CYCLE_TYPE(G_CYC_FILL);
+			UBX_GFX_SET_RENDER_MODE(G_RM_NOOP, G_RM_NOOP2);
+			break;
+
+		case UBX_SPRITE_MODE_COPY:
+			UBX_GFX_SET_CYCLE_TYPE(G_CYC_COPY);
+			UBX_GFX_SET_TEXTURE_PERSP(G_TP_NONE);
+			UBX_GFX_SET_TEXTURE_LUT(G_TT_NONE);
+			UBX_GFX_SET_TEXTURE_FILTER(G_TF_POINT);
+			UBX_GFX_SET_RENDER_MODE(G_RM_NOOP, G_RM_NOOP2);
+
+			/* Copy mode can't blend, but it can drop texels whose alpha is below the blend color alpha. */
+			UBX_GFX_SET_ALPHA_COMPARE(G_AC_THRESHOLD);
+			UBX_GFX_SET_BLEND_COLOR(0, 0, 0, 1);
+			break;
+
+		case UBX_SPRITE_MODE_BLEND_FILL:
+			UBX_GFX_SET_CYCLE_TYPE(G_CYC_1CYCLE);
+			UBX_GFX_SET_ALPHA_COMPARE(G_AC_NONE);
+			UBX_GFX_SET_RENDER_MODE(G_RM_XLU_SURF, G_RM_XLU_SURF2);
+			UBX_GFX_SET_COMBINE_MODE(G_CC_PRIMITIVE, G_CC_PRIMITIVE);
+			break;
+
+		case UBX_SPRITE_MODE_TEXTURE:
+			UBX_GFX_SET_CYCLE_TYPE(G_CYC_1CYCLE);
+			UBX_GFX_SET_TEXTURE_PERSP(G_TP_NONE);
+			UBX_GFX_SET_TEXTURE_LUT(G_TT_NONE);
+			UBX_GFX_SET_TEXTURE_LOD(G_TL_TILE);
+			UBX_GFX_SET_TEXTURE_DETAIL(G_TD_CLAMP);
+			UBX_GFX_SET_TEXTURE_FILTER(G_TF_POINT);
+			UBX_GFX_SET_TEXTURE_CONVERT(G_TC_FILT);
+			UBX_GFX_SET_ALPHA_COMPARE(G_AC_NONE);
+			UBX_GFX_SET_RENDER_MODE(G_RM_XLU_SURF, G_RM_XLU_SURF2);
+			UBX_GFX_SET_COMBINE_MODE(G_CC_MODULATERGBA_PRIM, G_CC_MODULATERGBA_PRIM);
+			break;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _UbxSpriteLoadTexture(const UbxSpriteTexture* const pTexture)
+{
+	const u32 fmt = pTexture->fmt;
+	const u32 siz = pTexture->siz;
+	const u32 width = pTexture->width;
+	const u32 height = pTexture->height;
+	const u32 texelBits = 4u << siz;
+
+	/* Load blocks only move 16-bit or 32-bit texels, so smaller texels are loaded as packed 16-bit pairs or quads. */
+	const u32 loadSiz = (siz == G_IM_SIZ_32b) ? G_IM_SIZ_32b : G_IM_SIZ_16b;
+	const u32 loadCount = ((width * height * texelBits) + ((4u << loadSiz) - 1)) / (4u << loadSiz);
+
+	/* The load advances to the next TMEM row each time the accumulated 'dxt' reaches one. */
+	const u32 rowWords = ((width * texelBits) >= 64) ? ((width * texelBits) / 64) : 1;
+	const u32 dxt = ((1u << G_TX_DXT_FRAC) + rowWords - 1) / rowWords;
+
+	/* 32-bit texels are split across the two halves of TMEM, so each of their rows only takes up half the space. */
+	const u32 lineBytes = (siz == G_IM_SIZ_32b) ? (width * 2) : ((width * texelBits) / 8);
+	const u32 line = (lineBytes + 7) >> 3;
+
+	UBX_GFX_SET_TEXTURE_IMAGE(fmt, loadSiz, 1, OS_K0_TO_PHYSICAL(pTexture->pImage));
+	UBX_GFX_SET_TILE(
+		fmt, loadSiz, 0, 0, G_TX_LOADTILE, 0,
+		G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOLOD,
+		G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOLOD);
+	UBX_GFX_LOAD_BLOCK(G_TX_LOADTILE, 0, 0, loadCount - 1, dxt);
+	UBX_GFX_SET_TILE(
+		fmt, siz, line, 0, G_TX_RENDERTILE, 0,
+		G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOLOD,
+		G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOLOD);
+	UBX_GFX_SET_TILE_SIZE(
+		G_TX_RENDERTILE, 0, 0,
+		(width - 1) << G_TEXTURE_IMAGE_FRAC,
+		(height - 1) << G_TEXTURE_IMAGE_FRAC);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSpriteBatchInit(UbxSpriteBatch* const pBatch, UbxSprite* const pSpriteBuffer, const u16 capacity)
+{
+	pBatch->pSprites = pSpriteBuffer;
+	pBatch->count = 0;
+	pBatch->capacity = capacity;
+	pBatch->droppedCount = 0;
+	pBatch->loadCount = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSpriteDraw(
+	UbxSpriteBatch* const pBatch,
+	const UbxSpriteTexture* const pTexture,
+	const s16 x,
+	const s16 y,
+	const u16 s,
+	const u16 t,
+	const u16 width,
+	const u16 height,
+	const u32 color,
+	const u8 layer,
+	const u8 flags)
+{
+	/* Copy mode skips the color combiner and blender entirely, so it can only be used when neither is needed and the
+	 * texels are already in the frame buffer's format. */
+	const UbxSpriteMode mode = (!(flags & UBX_SPRITE_FLAG_BLEND)
+			&& color == UBX_SPRITE_COLOR_WHITE
+			&& pTexture->fmt == G_IM_FMT_RGBA
+			&& pTexture->siz == G_IM_SIZ_16b)
+		? UBX_SPRITE_MODE_COPY
+		: UBX_SPRITE_MODE_TEXTURE;
+
+	_UbxSpriteAdd(pBatch, pTexture, x, y, s, t, width, height, color, layer, mode);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSpriteFill(
+	UbxSpriteBatch* const pBatch,
+	const s16 x,
+	const s16 y,
+	const u16 width,
+	const u16 height,
+	const u32 color,
+	const u8 layer)
+{
+	const UbxSpriteMode mode = ((color & 0xFF) == 0xFF) ? UBX_SPRITE_MODE_FILL : UBX_SPRITE_MODE_BLEND_FILL;
+
+	_UbxSpriteAdd(pBatch, NULL, x, y, 0, 0, width, height, color, layer, mode);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void UbxSpriteBatchFlush(UbxSpriteBatch* const pBatch)
+{
+	UbxSprite* const pSprites = pBatch->pSprites;
+	const u32 count = pBatch->count;
+
+	_UbxSpriteSort(pSprites, count);
+
+	const UbxSpriteTexture* pLoadedTexture = NULL;
+	u32 currentMode = 0xFFFFFFFF;
+
+	for(u32 i = 0; i < count; ++i)
+	{
+		const UbxSprite* const pSprite = &pSprites[i];
+		const u32 mode = UBX_SPRITE_KEY_GET_MODE(pSprite->key);
+
+		const u8 r = (u8) (pSprite->color >> 24);
+		const u8 g = (u8) (pSprite->color >> 16);
+		const u8 b = (u8) (pSprite->color >> 8);
+		const u8 a = (u8) pSprite->color;
+
+		const u32 ulx = (u32) pSprite->x;
+		const u32 uly = (u32) pSprite->y;
+		const u32 lrx = ulx + pSprite->width;
+		const u32 lry = uly + pSprite->height;
+
+		if(mode != currentMode)
+		{
+			_UbxSpriteSetMode((UbxSpriteMode) mode);
+			currentMode = mode;
+		}
+
+		/* Sprites are sorted by texture within each mode, so each texture is only loaded once per run. */
+		if(pSprite->pTexture && pSprite->pTexture != pLoadedTexture)
+		{
+			_UbxSpriteLoadTexture(pSprite->pTexture);
+			pLoadedTexture = pSprite->pTexture;
+
+			++pBatch->loadCount;
+		}
+
+		/* Fill and copy modes treat the lower-right corner as inclusive while 1-cycle mode treats it as exclusive. */
+		switch(mode)
+		{
+			case UBX_SPRITE_MODE_FILL:
+			{
+				const u32 packed = GPACK_RGBA5551(r, g, b, 1);
+
+				UBX_GFX_SET_FILL_COLOR((packed << 16) | packed);
+				gDPFillRectangle(UBX_GFX_CMD_NEXT, ulx, uly, lrx - 1, lry - 1);
+				break;
+			}
+
+			case UBX_SPRITE_MODE_COPY:
+				gSPTextureRectangle(
+					UBX_GFX_CMD_NEXT,
+					ulx << 2, uly << 2, (lrx - 1) << 2, (lry - 1) << 2,
+					G_TX_RENDERTILE,
+					pSprite->s << 5, pSprite->t << 5,
+					4 << 10, 1 << 10);
+				break;
+
+			case UBX_SPRITE_MODE_BLEND_FILL:
+				UBX_GFX_SET_PRIM_COLOR(0, 0, r, g, b, a);
+				gDPFillRectangle(UBX_GFX_CMD_NEXT, ulx, uly, lrx, lry);
+				break;
+
+			case UBX_SPRITE_MODE_TEXTURE:
+				UBX_GFX_SET_PRIM_COLOR(0, 0, r, g, b, a);
+				gSPTextureRectangle(
+					UBX_GFX_CMD_NEXT,
+					ulx << 2, uly << 2, lrx << 2, lry << 2,
+					G_TX_RENDERTILE,
+					pSprite->s << 5, pSprite->t << 5,
+					1 << 10, 1 << 10);
+				break;
+		}
+	}
+
+	pBatch->count = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#pragma once
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#include "../lowlevel/env.h"
+
+#include <gbi.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_BEGIN_EXTERN_C;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define UBX_SPRITE_COLOR_WHITE 0xFFFFFFFF
+
+/* Pack an RGBA8888 color for sprites and rectangles. */
+#define UBX_SPRITE_RGBA(r, g, b, a) \
+	(((u32) (u8) (r) << 24) | ((u32) (u8) (g) << 16) | ((u32) (u8) (b) << 8) | (u32) (u8) (a))
+
+/* Blend the sprite with the frame buffer using the alpha of its texels and color. Without this, textured sprites only
+ * support cutout transparency, which lets unscaled, untinted RGBA16 sprites be drawn in copy mode. */
+#define UBX_SPRITE_FLAG_BLEND 0x01
+
+#define UBX_SPRITE_MAX_LAYER 0xF
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* The RDP draws each sprite run in whichever of these modes is cheapest for it. */
+typedef enum _UbxSpriteMode
+{
+	UBX_SPRITE_MODE_FILL,       /* Opaque rectangle; fill mode writes 4 pixels per clock. */
+	UBX_SPRITE_MODE_COPY,       /* Opaque or cutout RGBA16 texture; copy mode writes 4 texels per clock. */
+	UBX_SPRITE_MODE_BLEND_FILL, /* Translucent rectangle drawn in 1-cycle mode. */
+	UBX_SPRITE_MODE_TEXTURE,    /* Tinted, blended or non-RGBA16 texture drawn in 1-cycle mode. */
+} UbxSpriteMode;
+
+/* Sprite texture; the whole image is loaded into TMEM at once, so it must fit in 4KB. Color-indexed formats are not
+ * supported since they would also need a TLUT load. */
+typedef struct _UbxSpriteTexture
+{
+	const void* pImage;
+
+	u16 width;
+	u16 height;
+
+	u8 fmt;
+	u8 siz;
+} UbxSpriteTexture;
+
+typedef struct _UbxSprite
+{
+	const UbxSpriteTexture* pTexture;
+
+	u32 color;
+
+	/* Layer, draw mode and submission order packed so one compare handles most of the sort. */
+	u32 key;
+
+	s16 x;
+	s16 y;
+	u16 width;
+	u16 height;
+	u16 s;
+	u16 t;
+} UbxSprite;
+
+/* Sprites are collected over a frame and only turned into RDP commands on flush, where they are sorted by layer,
+ * draw mode, texture, and color so each texture is loaded once and redundant state changes are skipped. Sprites in a
+ * lower layer are always drawn first; within a layer, overlapping sprites must not rely on submission order. */
+typedef struct _UbxSpriteBatch
+{
+	UbxSprite* pSprites;
+
+	u16 count;
+	u16 capacity;
+
+	u32 droppedCount;
+	u32 loadCount;
+} UbxSpriteBatch;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Use caller-provided storage for the batch's sprites. */
+extern void UbxSpriteBatchInit(UbxSpriteBatch* pBatch, UbxSprite* pSpriteBuffer, u16 capacity);
+
+/* Add a sprite showing the 'width' x 'height' texel region of a texture starting at 's', 't'. The texels are drawn
+ * unscaled with their top-left corner at screen position 'x', 'y' and modulated by 'color'. */
+extern void UbxSpriteDraw(
+	UbxSpriteBatch* pBatch,
+	const UbxSpriteTexture* pTexture,
+	s16 x,
+	s16 y,
+	u16 s,
+	u16 t,
+	u16 width,
+	u16 height,
+	u32 color,
+	u8 layer,
+	u8 flags);
+
+/* Add a solid rectangle; rectangles with an alpha below 255 are blended. */
+extern void UbxSpriteFill(UbxSpriteBatch* pBatch, s16 x, s16 y, u16 width, u16 height, u32 color, u8 layer);
+
+/* Sort the collected sprites and append them to the current gfx command list, then empty the batch. This goes through
+ * the gfx state tracker and assumes a 16-bit color image with a scissor already set. It changes the cycle type, render
+ * mode, combine mode and texture state, so any 3D drawing after it must set those again. */
+extern void UbxSpriteBatchFlush(UbxSpriteBatch* pBatch);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+UBX_END_EXTERN_C;
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include <ultra_box.h>
+
+#include <math.h>
+
+#include <ultra64.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef _BENCHMARK_MATH
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define BENCH_ITERATION_COUNT 256
+#define BENCH_PASS_COUNT      4
+#define BENCH_OUTPUT_COUNT    16
+
+/* The CPU count register increments at half the CPU clock rate. */
+#define BENCH_COUNT_TO_CPU_CYCLES(count) ((count) * 2)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef void (*BenchFunc)(u32 iteration);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Results are written out to memory so the compiler can't discard any of the work being measured. */
+static Mtx gBenchMtx[BENCH_OUTPUT_COUNT] __attribute__((aligned(0x10)));
+static volatile f32 gBenchFloatSink;
+static volatile UbxFixed gBenchFixedSink;
+
+static Mtx gBenchViewMtxF;
+static UbxAffine gBenchViewAffine;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline f32 _BenchAngleRadians(const u32 iteration)
+{
+	return (f32) iteration * (6.28318530718f / (f32) BENCH_ITERATION_COUNT);
+}
+
+static inline UbxAngle _BenchAngle(const u32 iteration)
+{
+	return (UbxAngle) (iteration * (0x10000 / BENCH_ITERATION_COUNT));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _BenchTransformGu(const u32 iteration)
+{
+	Mtx transMtx;
+	Mtx rotMtx;
+	Mtx scaleMtx;
+	Mtx viewMtx;
+
+	const f32 angle = _BenchAngleRadians(iteration);
+
+	guTranslateF(&transMtx, sinf(angle), 0.0f, 0.0f);
+	guRotateF(&rotMtx, angle * (360.0f / 6.28318530718f), 0.0f, 1.0f, 0.0f);
+	guScaleF(&scaleMtx, 0.5f, 0.5f, 0.5f);
+
+	guMtxCatF(&scaleMtx, &rotMtx, &rotMtx);
+	guMtxCatF(&rotMtx, &transMtx, &transMtx);
+	guMtxCatF(&transMtx, &gBenchViewMtxF, &viewMtx);
+	guMtxF2L(&viewMtx, &gBenchMtx[iteration % BENCH_OUTPUT_COUNT]);
+}
+
+static void _BenchTransformUbx(const u32 iteration)
+{
+	const UbxAngle angle = _BenchAngle(iteration);
+
+	const UbxVec3 pos = { UbxSin(angle), 0, 0 };
+	const UbxVec3 scale = { UBX_FIXED_HALF, UBX_FIXED_HALF, UBX_FIXED_HALF };
+
+	UbxQuat rot;
+	UbxAffine model;
+
+	UbxQuatFromAxisAngle(&rot, angle, 0, UBX_FIXED_ONE, 0);
+	UbxAffineFromTRS(&model, &pos, &rot, &scale);
+	UbxAffineMulToMtx(&gBenchMtx[iteration % BENCH_OUTPUT_COUNT], &model, &gBenchViewAffine);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _BenchMulGu(const u32 iteration)
+{
+	Mtx resultMtx;
+
+	guMtxCatF(&gBenchViewMtxF, &gBenchViewMtxF, &resultMtx);
+	guMtxF2L(&resultMtx, &gBenchMtx[iteration % BENCH_OUTPUT_COUNT]);
+}
+
+static void _BenchMulUbx(const u32 iteration)
+{
+	UbxAffineMulToMtx(&gBenchMtx[iteration % BENCH_OUTPUT_COUNT], &gBenchViewAffine, &gBenchViewAffine);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _BenchRotateGu(const u32 iteration)
+{
+	Mtx rotMtx;
+
+	guRotateF(&rotMtx, (f32) iteration, 0.0f, 1.0f, 0.0f);
+	guMtxF2L(&rotMtx, &gBenchMtx[iteration % BENCH_OUTPUT_COUNT]);
+}
+
+static void _BenchRotateUbx(const u32 iteration)
+{
+	UbxQuat rot;
+	UbxAffine rotAffine;
+
+	UbxQuatFromAxisAngle(&rot, UBX_ANGLE_FROM_DEGREES(iteration), 0, UBX_FIXED_ONE, 0);
+	UbxAffineFromQuat(&rotAffine, &rot);
+	UbxAffineToMtx(&gBenchMtx[iteration % BENCH_OUTPUT_COUNT], &rotAffine);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _BenchSinCosLibm(const u32 iteration)
+{
+	const f32 angle = _BenchAngleRadians(iteration);
+	gBenchFloatSink = sinf(angle) + cosf(angle);
+}
+
+static void _BenchSinCosUbx(const u32 iteration)
+{
+	UbxFixed s, c;
+	UbxSinCos(_BenchAngle(iteration), &s, &c);
+	gBenchFixedSink = s + c;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static u32 _BenchRun(const BenchFunc func)
+{
+	u32 bestCount = 0xFFFFFFFF;
+
+	/* Keep the best of several passes to filter out any time lost to interrupts and other threads. */
+	for(u32 pass = 0; pass < BENCH_PASS_COUNT; ++pass)
+	{
+		const u32 startCount = osGetCount();
+
+		for(u32 i = 0; i < BENCH_ITERATION_COUNT; ++i)
+		{
+			func(i);
+		}
+
+		const u32 elapsedCount = osGetCount() - startCount;
+
+		if(elapsedCount < bestCount)
+		{
+			bestCount = elapsedCount;
+		}
+	}
+
+	return BENCH_COUNT_TO_CPU_CYCLES(bestCount) / BENCH_ITERATION_COUNT;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _BenchReport(const char* const name, const BenchFunc guFunc, const BenchFunc ubxFunc)
+{
+	const u32 guCycles = _BenchRun(guFunc);
+	const u32 ubxCycles = _BenchRun(ubxFunc);
+
+	osSyncPrintf("[bench] %-12s gu: %6lu cycles, ubx: %6lu cycles\n", name, guCycles, ubxCycles);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void RunMathBenchmark()
+{
+	/* Both paths share the same view matrix, just like they would in a real frame. */
+	guLookAtF(
+		&gBenchViewMtxF,
+		0.0f, 0.0f, 2.5f,
+		0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f);
+	UbxAffineFromMtxF(&gBenchViewAffine, &gBenchViewMtxF);
+
+	osSyncPrintf("[bench] Average CPU cycles per call (best of %d passes, %d iterations each)\n", BENCH_PASS_COUNT, BENCH_ITERATION_COUNT);
+
+	_BenchReport("transform", _BenchTransformGu, _BenchTransformUbx);
+	_BenchReport("multiply", _BenchMulGu, _BenchMulUbx);
+	_BenchReport("rotate", _BenchRotateGu, _BenchRotateUbx);
+	_BenchReport("sincos", _BenchSinCosLibm, _BenchSinCosUbx);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif /* _BENCHMARK_MATH */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
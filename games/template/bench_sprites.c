@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include <ultra_box.h>
+
+#include <ultra64.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef _BENCHMARK_SPRITES
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define BENCH_SPRITE_COUNT   256
+#define BENCH_ICON_COUNT     4
+#define BENCH_ICON_SIZE      16
+#define BENCH_GRID_SPACING   18
+#define BENCH_PHASE_FRAMES   128
+
+/* The CPU count register increments at half the CPU clock rate. */
+#define BENCH_COUNT_TO_CPU_CYCLES(count) ((count) * 2)
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum _BenchPhase
+{
+	BENCH_PHASE_BATCHED,
+	BENCH_PHASE_TRIANGLES,
+
+	BENCH_PHASE_COUNT,
+} BenchPhase;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static u16 gBenchIconTexels[BENCH_ICON_COUNT][BENCH_ICON_SIZE * BENCH_ICON_SIZE] __attribute__((aligned(0x10)));
+static UbxSpriteTexture gBenchIcons[BENCH_ICON_COUNT];
+
+static UbxSprite gBenchSpriteBuffer[BENCH_SPRITE_COUNT];
+static UbxSpriteBatch gBenchBatch;
+
+static u32 gBenchFrame;
+static u32 gBenchCpuCount;
+static u32 gBenchLoadCount;
+
+static const char* const gBenchPhaseNames[BENCH_PHASE_COUNT] =
+{
+	"batched",
+	"triangles",
+};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* The benchmark draws the same HUD-like screen both ways: every fourth cell is a translucent bar, every third icon is
+ * tinted, and the rest are plain icons that the batcher can draw in copy mode. */
+static inline u32 _BenchCellColor(const u32 index)
+{
+	if((index % 3) == 0)
+	{
+		return UBX_SPRITE_RGBA(255, 160, 64, 255);
+	}
+
+	return UBX_SPRITE_COLOR_WHITE;
+}
+
+static inline u8 _BenchCellIsBar(const u32 index)
+{
+	return (index % 4) == 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _BenchDrawBatched(const s16 originX, const s16 originY, const u32 columns)
+{
+	for(u32 i = 0; i < BENCH_SPRITE_COUNT; ++i)
+	{
+		const s16 x = originX + (s16) ((i % columns) * BENCH_GRID_SPACING);
+		const s16 y = originY + (s16) ((i / columns) * BENCH_GRID_SPACING);
+
+		if(_BenchCellIsBar(i))
+		{
+			UbxSpriteFill(&gBenchBatch, x, y, BENCH_ICON_SIZE, BENCH_ICON_SIZE / 4, UBX_SPRITE_RGBA(0, 0, 0, 128), 0);
+		}
+		else
+		{
+			const UbxSpriteTexture* const pIcon = &gBenchIcons[i % BENCH_ICON_COUNT];
+
+			UbxSpriteDraw(&gBenchBatch, pIcon, x, y, 0, 0, BENCH_ICON_SIZE, BENCH_ICON_SIZE, _BenchCellColor(i), 1, 0);
+		}
+	}
+
+	UbxSpriteBatchFlush(&gBenchBatch);
+
+	gBenchLoadCount += gBenchBatch.loadCount;
+	gBenchBatch.loadCount = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* The baseline draws each cell as a pair of screen-space triangles in submission order, loading its texture each time,
+ * which is how a game without a 2D path would have to draw its HUD. */
+static void _BenchDrawTriangles(
+	const s16 originX,
+	const s16 originY,
+	const u32 columns,
+	const u32 screenWidth,
+	const u32 screenHeight)
+{
+	Mtx* const pMtx = UBX_ARENA_ALLOC_MTX(2);
+	Vtx* const pVtx = UBX_ARENA_ALLOC_VTX(BENCH_SPRITE_COUNT * 4);
+
+	if(!pMtx || !pVtx)
+	{
+		return;
+	}
+
+	guOrtho(&pMtx[0], 0.0f, (f32) screenWidth, (f32) screenHeight, 0.0f, -1.0f, 1.0f, 1.0f);
+	guMtxIdent(&pMtx[1]);
+
+	gSPMatrix(UBX_GFX_CMD_NEXT, OS_K0_TO_PHYSICAL(&pMtx[0]), G_MTX_PROJECTION | G_MTX_LOAD | G_MTX_NOPUSH);
+	gSPMatrix(UBX_GFX_CMD_NEXT, OS_K0_TO_PHYSICAL(&pMtx[1]), G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_NOPUSH);
+
+	UBX_GFX_CLEAR_GEOMETRY_MODE(G_ZBUFFER | G_CULL_BOTH | G_LIGHTING);
+	UBX_GFX_SET_GEOMETRY_MODE(G_SHADE);
+	UBX_GFX_SET_CYCLE_TYPE(G_CYC_1CYCLE);
+	UBX_GFX_SET_TEXTURE_PERSP(G_TP_NONE);
+	UBX_GFX_SET_TEXTURE_FILTER(G_TF_POINT);
+	UBX_GFX_SET_RENDER_MODE(G_RM_XLU_SURF, G_RM_XLU_SURF2);
+
+	for(u32 i = 0; i < BENCH_SPRITE_COUNT; ++i)
+	{
+		const s16 x = originX + (s16) ((i % columns) * BENCH_GRID_SPACING);
+		const s16 y = originY + (s16) ((i / columns) * BENCH_GRID_SPACING);
+		const u8 isBar = _BenchCellIsBar(i);
+		const s16 height = isBar ? (BENCH_ICON_SIZE / 4) : BENCH_ICON_SIZE;
+		const u32 color = isBar ? UBX_SPRITE_RGBA(0, 0, 0, 128) : _BenchCellColor(i);
+
+		Vtx* const pQuad = &pVtx[i * 4];
+
+		for(u32 v = 0; v < 4; ++v)
+		{
+			const s16 dx = (v & 1) ? BENCH_ICON_SIZE : 0;
+			const s16 dy = (v & 2) ? height : 0;
+
+			pQuad[v].v.ob[0] = x + dx;
+			pQuad[v].v.ob[1] = y + dy;
+			pQuad[v].v.ob[2] = 0;
+			pQuad[v].v.flag = 0;
+			pQuad[v].v.tc[0] = dx << 5;
+			pQuad[v].v.tc[1] = dy << 5;
+			pQuad[v].v.cn[0] = (u8) (color >> 24);
+			pQuad[v].v.cn[1] = (u8) (color >> 16);
+			pQuad[v].v.cn[2] = (u8) (color >> 8);
+			pQuad[v].v.cn[3] = (u8) color;
+		}
+
+		if(isBar)
+		{
+			UBX_GFX_SET_TEXTURE(0, 0, 0, G_TX_RENDERTILE, G_OFF);
+			UBX_GFX_SET_COMBINE_MODE(G_CC_SHADE, G_CC_SHADE);
+		}
+		else
+		{
+			const UbxSpriteTexture* const pIcon = &gBenchIcons[i % BENCH_ICON_COUNT];
+
+			UBX_GFX_SET_TEXTURE(0x8000, 0x8000, 0, G_TX_RENDERTILE, G_ON);
+			UBX_GFX_SET_COMBINE_MODE(G_CC_MODULATERGBA, G_CC_MODULATERGBA);
+
+			++gBenchLoadCount;
+
+			UBX_GFX_SET_TEXTURE_IMAGE(G_IM_FMT_RGBA, G_IM_SIZ_16b, 1, OS_K0_TO_PHYSICAL(pIcon->pImage));
+			UBX_GFX_SET_TILE(
+				G_IM_FMT_RGBA, G_IM_SIZ_16b, 0, 0, G_TX_LOADTILE, 0,
+				G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOLOD,
+				G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOLOD);
+			UBX_GFX_LOAD_BLOCK(
+				G_TX_LOADTILE, 0, 0,
+				(BENCH_ICON_SIZE * BENCH_ICON_SIZE) - 1,
+				CALC_DXT(BENCH_ICON_SIZE, G_IM_SIZ_16b_BYTES));
+			UBX_GFX_SET_TILE(
+				G_IM_FMT_RGBA, G_IM_SIZ_16b, (BENCH_ICON_SIZE * G_IM_SIZ_16b_LINE_BYTES + 7) >> 3, 0, G_TX_RENDERTILE, 0,
+				G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOLOD,
+				G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOLOD);
+			UBX_GFX_SET_TILE_SIZE(
+				G_TX_RENDERTILE, 0, 0,
+				(BENCH_ICON_SIZE - 1) << G_TEXTURE_IMAGE_FRAC,
+				(BENCH_ICON_SIZE - 1) << G_TEXTURE_IMAGE_FRAC);
+		}
+
+		gSPVertex(UBX_GFX_CMD_NEXT, pQuad, 4, 0);
+		gSP2Triangles(UBX_GFX_CMD_NEXT, 0, 2, 1, 0, 1, 2, 3, 0);
+	}
+
+	/* Leave texturing off so anything drawn after this doesn't pay for texture coordinate generation. */
+	UBX_GFX_SET_TEXTURE(0, 0, 0, G_TX_RENDERTILE, G_OFF);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _BenchReport(const BenchPhase phase)
+{
+#ifndef _FINALROM
+	u32 rspCycles = 0;
+	u32 rdpCycles = 0;
+
+	/* Only average the most recent frames so none of them overlap the previous phase. */
+	for(u32 age = 0; age < UBX_PROFILER_HISTORY_LENGTH; ++age)
+	{
+		const UbxProfilerFrame* const pFrame = UbxProfilerGetFrame(age);
+
+		rspCycles += pFrame->rspGfxCycles;
+		rdpCycles += pFrame->rdpCycles;
+	}
+
+	osSyncPrintf(
+		"[bench] sprites %-9s cpu: %7lu cycles, rsp: %7lu cycles, rdp: %7lu clocks, loads: %lu\n",
+		gBenchPhaseNames[phase],
+		BENCH_COUNT_TO_CPU_CYCLES(gBenchCpuCount) / BENCH_PHASE_FRAMES,
+		rspCycles / UBX_PROFILER_HISTORY_LENGTH,
+		rdpCycles / UBX_PROFILER_HISTORY_LENGTH,
+		gBenchLoadCount / BENCH_PHASE_FRAMES);
+#else
+	(void) phase;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void InitSpriteBenchmark()
+{
+	/* Generate a few icons with a transparent border so copy mode has to use its alpha compare. */
+	for(u32 icon = 0; icon < BENCH_ICON_COUNT; ++icon)
+	{
+		u16* const pTexels = gBenchIconTexels[icon];
+
+		for(u32 y = 0; y < BENCH_ICON_SIZE; ++y)
+		{
+			for(u32 x = 0; x < BENCH_ICON_SIZE; ++x)
+			{
+				const u8 border = (x == 0 || y == 0 || x == BENCH_ICON_SIZE - 1 || y == BENCH_ICON_SIZE - 1);
+				const u8 checker = ((x >> 2) ^ (y >> 2) ^ icon) & 1;
+
+				pTexels[(y * BENCH_ICON_SIZE) + x] = border
+					? 0
+					: GPACK_RGBA5551(checker ? 255 : 64, (icon & 1) ? 255 : 64, (icon & 2) ? 255 : 64, 1);
+			}
+		}
+
+		gBenchIcons[icon].pImage = pTexels;
+		gBenchIcons[icon].width = BENCH_ICON_SIZE;
+		gBenchIcons[icon].height = BENCH_ICON_SIZE;
+		gBenchIcons[icon].fmt = G_IM_FMT_RGBA;
+		gBenchIcons[icon].siz = G_IM_SIZ_16b;
+	}
+
+	UbxCacheMarkDirty(gBenchIconTexels, sizeof(gBenchIconTexels));
+
+	UbxSpriteBatchInit(&gBenchBatch, gBenchSpriteBuffer, BENCH_SPRITE_COUNT);
+
+	gBenchFrame = 0;
+	gBenchCpuCount = 0;
+	gBenchLoadCount = 0;
+
+	osSyncPrintf("[bench] Drawing %d sprites per frame, alternating every %d frames\n", BENCH_SPRITE_COUNT, BENCH_PHASE_FRAMES);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void DrawSpriteBenchmark(const u32 screenWidth, const u32 screenHeight)
+{
+	const BenchPhase phase = (BenchPhase) ((gBenchFrame / BENCH_PHASE_FRAMES) % BENCH_PHASE_COUNT);
+	const u32 columns = screenWidth / BENCH_GRID_SPACING;
+
+	/* Scroll the grid so part of it is always clipped against the top-left edges of the screen. */
+	const s16 originX = (s16) (gBenchFrame % BENCH_GRID_SPACING) - BENCH_GRID_SPACING;
+	const s16 originY = (s16) (gBenchFrame % BENCH_GRID_SPACING) - BENCH_GRID_SPACING;
+
+	const u32 startCount = osGetCount();
+
+	if(phase == BENCH_PHASE_BATCHED)
+	{
+		_BenchDrawBatched(originX, originY, columns);
+	}
+	else
+	{
+		_BenchDrawTriangles(originX, originY, columns, screenWidth, screenHeight);
+	}
+
+	gBenchCpuCount += osGetCount() - startCount;
+	++gBenchFrame;
+
+	if((gBenchFrame % BENCH_PHASE_FRAMES) == 0)
+	{
+		_BenchReport(phase);
+
+		gBenchCpuCount = 0;
+		gBenchLoadCount = 0;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif /* _BENCHMARK_SPRITES */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
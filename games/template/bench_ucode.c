@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2023, Zoe J. Bare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+ * TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include <ultra_box.h>
+
+#include <ultra64.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef _BENCHMARK_GFX_UCODE
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define BENCH_PHASE_FRAMES 128
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static u32 gBenchFrame;
+static u32 gBenchGfxCount;
+
+static const char* const gBenchUcodeNames[] =
+{
+	"xbus",
+	"fifo",
+};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _BenchReport(const u8 gfxUcode)
+{
+#ifndef _FINALROM
+	u32 rspCycles = 0;
+	u32 rdpCycles = 0;
+
+	/* Only average the most recent frames so none of them overlap the previous phase. */
+	for(u32 age = 0; age < UBX_PROFILER_HISTORY_LENGTH; ++age)
+	{
+		const UbxProfilerFrame* const pFrame = UbxProfilerGetFrame(age);
+
+		rspCycles += pFrame->rspGfxCycles;
+		rdpCycles += pFrame->rdpCycles;
+	}
+
+	/* The total is the time from the RSP starting the task to the RDP finishing it, which is the part that shrinks
+	 * when the two of them overlap. */
+	osSyncPrintf(
+		"[bench] ucode %s rsp: %7lu cycles, rdp: %7lu cycles, total: %7lu cycles\n",
+		gBenchUcodeNames[gfxUcode],
+		rspCycles / UBX_PROFILER_HISTORY_LENGTH,
+		rdpCycles / UBX_PROFILER_HISTORY_LENGTH,
+		gBenchGfxCount / BENCH_PHASE_FRAMES);
+#else
+	(void) gfxUcode;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void PrepareUcodeBenchmark(OSTask* const pDrawTask)
+{
+	/* Alternate between the two micro-code variants, drawing the same scene with each of them. */
+	gUbxTask.gfxUcode = ((gBenchFrame / BENCH_PHASE_FRAMES) & 1) ? UBX_TASK_GFX_UCODE_FIFO : UBX_TASK_GFX_UCODE_XBUS;
+
+	UbxTaskInitGfx(pDrawTask);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void FinishUcodeBenchmark(const u32 gfxCount)
+{
+	gBenchGfxCount += gfxCount;
+	++gBenchFrame;
+
+	if((gBenchFrame % BENCH_PHASE_FRAMES) == 0)
+	{
+		_BenchReport(gUbxTask.gfxUcode);
+
+		gBenchGfxCount = 0;
+	}
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif /* _BENCHMARK_GFX_UCODE */
@@ -24,6 +24,9 @@ _start:
 	# Setup the program stack.
 	la $sp, _boot_stack_end
 
+	# Load the rest of the program since the IPL3 only copies the first 1 MiB of the ROM.
+	jal _UbxBootLoadCode
+
 	# Clear out the BSS section
 	la   $a0, _bss_start
 	la   $a1, _bss_end
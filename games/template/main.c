@@ -47,26 +47,57 @@
 #endif
 
 #ifdef _DISPLAY_PAL
-	#define DISPLAY_VSYNC_TIME_DELTA (1.0f / 50.0f)
+	#define DISPLAY_RETRACE_RATE 50
 
 #else
-	#define DISPLAY_VSYNC_TIME_DELTA (1.0f / 60.0f)
+	#define DISPLAY_RETRACE_RATE 60
 
 #endif
 
+/* Number of frames rendered per second (e.g., 20, 30 or 60); anything above the retrace rate is capped to it. The
+ * simulation always runs at the engine's fixed tick rate regardless of this. */
+#ifndef GAME_RENDER_RATE
+	#define GAME_RENDER_RATE 60
+#endif
+
+#if GAME_RENDER_RATE < DISPLAY_RETRACE_RATE
+	#define GAME_FRAME_RATE GAME_RENDER_RATE
+#else
+	#define GAME_FRAME_RATE DISPLAY_RETRACE_RATE
+#endif
+
 #define DISPLAY_HALF_WIDTH  (DISPLAY_WIDTH / 2)
 #define DISPLAY_HALF_HEIGHT (DISPLAY_HEIGHT / 2)
 
 #define DISPLAY_BUFFER_COUNT 2
 
-#define GFX_CLEAR_CMD_LENGTH 16
-#define GFX_DRAW_CMD_LENGTH  2048
+#ifdef _BENCHMARK_SPRITES
+	/* The triangle half of the sprite benchmark needs room for a much longer display list and its vertices. */
+	#define GFX_DRAW_CMD_LENGTH 8192
+	#define FRAME_ARENA_SIZE    ((GFX_DRAW_CMD_LENGTH * sizeof(Gfx)) + 0x6000)
+
+#else
+	#define GFX_DRAW_CMD_LENGTH 2048
+	#define FRAME_ARENA_SIZE    ((GFX_DRAW_CMD_LENGTH * sizeof(Gfx)) + 0x2000)
+
+#endif
+
+#define SCENE_NODE_COUNT 8
+
+#define PROFILER_ZONE_NEW_FRAME 0
+#define PROFILER_ZONE_UPDATE    1
+#define PROFILER_ZONE_RENDER    2
 
 #define CFB_CLEAR_VALUE  GPACK_RGBA5551(0, 16, 16, 1)
 #define ZBUF_CLEAR_VALUE GPACK_ZDZ(G_MAXFBZ, 0)
 
 #define M_TAU (M_PI * 2.0f)
 
+#define CAMERA_FOVY   80.0f
+#define CAMERA_ASPECT ((f32) DISPLAY_WIDTH / (f32) DISPLAY_HEIGHT)
+#define CAMERA_NEAR   COORD_AS_FLT(0.01f)
+#define CAMERA_FAR    COORD_AS_FLT(10.0f)
+
 /* World coordinate system scale
  *
  * All vertices and transforms must be scaled by this value to be in the same coordinate system.
@@ -141,43 +172,69 @@
 
 typedef struct _Transform
 {
-	Mtx modelView;
+	Mtx view;
 	Mtx projection;
+	Vp viewport;
 } Transform;
 
 typedef struct _GfxState
 {
-	Gfx clearCmd[GFX_CLEAR_CMD_LENGTH];
-	Gfx drawCmd[GFX_DRAW_CMD_LENGTH];
-
-	OSTask clearTask;
 	OSTask drawTask;
+
+	UbxSchedTask drawSchedTask;
 } GfxState;
 
 typedef struct _FrameState
 {
-	Transform transform;
+	Transform* pTransform;
+	Vtx* pQuadVtx;
+
+	u8 quadVisible;
 } FrameState;
 
-typedef struct _GameState
+typedef struct _SimState
 {
 	float movAmt;
 	float rotAngle;
 	float morphAmt;
+} SimState;
+
+typedef struct _GameState
+{
+	/* Simulation state as of the last two fixed ticks; each frame is rendered somewhere in between them. */
+	SimState prevSim;
+	SimState sim;
 
 	u16 perspNorm;
+
+	UbxFrustum frustum;
+
+	UbxScene scene;
+
+	u16 rootNode;
+	u16 quadNode;
 } GameState;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 u16 gFrameBuffer[DISPLAY_BUFFER_COUNT][DISPLAY_WIDTH * DISPLAY_HEIGHT] __attribute__((aligned(0x10)));
+#ifdef _DEPTH_BUFFER_OWN_BANK
+u16 gDepthBuffer[DISPLAY_WIDTH * DISPLAY_HEIGHT] UBX_CLEAR_DEPTH_BUFFER_SECTION;
+#else
 u16 gDepthBuffer[DISPLAY_WIDTH * DISPLAY_HEIGHT] __attribute__((aligned(0x10)));
+#endif
 u64 gDramStack[SP_DRAM_STACK_SIZE64] __attribute__((aligned(0x10)));
+u64 gRdpFifoBuffer[UBX_TASK_DEFAULT_FIFO_SIZE / sizeof(u64)] __attribute__((aligned(0x10)));
+u8 gFrameArenaBuffer[DISPLAY_BUFFER_COUNT * FRAME_ARENA_SIZE] __attribute__((aligned(0x10)));
+UbxSceneNode gSceneNodes[SCENE_NODE_COUNT] __attribute__((aligned(0x10)));
 
 size_t gDrawBufferIndex = 0;
 
 GfxState gGfxState[DISPLAY_BUFFER_COUNT];
-FrameState gFrameState[DISPLAY_BUFFER_COUNT];
+FrameState gFrameState;
+
+OSMesgQueue gGfxDoneMsgQueue;
+OSMesg gGfxDoneMsg[DISPLAY_BUFFER_COUNT];
 
 GameState gGameState;
 
@@ -233,7 +290,89 @@ static const Gfx rcpInitDlist[] =
 	gsSPEndDisplayList(),
 };
 
-static Vtx gQuadVtx[DISPLAY_BUFFER_COUNT][4];
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/* Tell the gfx state tracker what the RCP init display list leaves behind; this must be kept in sync with it. */
+static void AssumeRcpInitState()
+{
+	Gfx cmd;
+
+	UbxGfxStateAssumeGeometryMode(
+		G_ZBUFFER
+			| G_SHADE
+			| G_SHADING_SMOOTH
+			| G_CULL_BOTH
+			| G_FOG
+			| G_LIGHTING
+			| G_TEXTURE_GEN
+			| G_TEXTURE_GEN_LINEAR
+			| G_LOD
+			| G_CLIPPING,
+		G_ZBUFFER | G_CLIPPING);
+
+	UbxGfxStateAssumeOtherModeH(
+		UBX_GFX_OTHERMODE_MASK(G_MDSFT_PIPELINE, 1)
+			| UBX_GFX_OTHERMODE_MASK(G_MDSFT_TEXTLOD, 1)
+			| UBX_GFX_OTHERMODE_MASK(G_MDSFT_TEXTLUT, 2)
+			| UBX_GFX_OTHERMODE_MASK(G_MDSFT_TEXTDETAIL, 2)
+			| UBX_GFX_OTHERMODE_MASK(G_MDSFT_TEXTPERSP, 1)
+			| UBX_GFX_OTHERMODE_MASK(G_MDSFT_TEXTFILT, 2)
+			| UBX_GFX_OTHERMODE_MASK(G_MDSFT_TEXTCONV, 3)
+			| UBX_GFX_OTHERMODE_MASK(G_MDSFT_COMBKEY, 1)
+			| UBX_GFX_OTHERMODE_MASK(G_MDSFT_RGBDITHER, 2),
+		G_PM_NPRIMITIVE
+			| G_TL_TILE
+			| G_TT_NONE
+			| G_TD_CLAMP
+			| G_TP_PERSP
+			| G_TF_BILERP
+			| G_TC_FILT
+			| G_CK_NONE
+			| G_CD_DISABLE);
+
+	UbxGfxStateAssumeOtherModeL(UBX_GFX_OTHERMODE_MASK(G_MDSFT_ALPHACOMPARE, 2), G_AC_NONE);
+
+	gSPTexture(&cmd, 0, 0, 0, 0, G_OFF);
+	UbxGfxStateAssumeCommand(UBX_GFX_SLOT_TEXTURE, &cmd);
+
+	gDPSetScissor(&cmd, G_SC_NON_INTERLACE, 0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
+	UbxGfxStateAssumeCommand(UBX_GFX_SLOT_SCISSOR, &cmd);
+
+	gDPSetPrimColor(&cmd, 0, 0, 0, 0, 64, 255);
+	UbxGfxStateAssumeCommand(UBX_GFX_SLOT_PRIM_COLOR, &cmd);
+
+	/* The init display list doesn't draw anything and ends with a pipe sync. */
+	UbxGfxStateAssumeSynced(UBX_GFX_SYNC_ALL);
+}
+
+static const Vtx gDefaultQuadVtx[4] =
+{
+	{ .v = { { 0, 0, 0 }, 0,  {       (0),        (0) },  { 0xFF, 0x00, 0x00, 0xFF } } },
+	{ .v = { { 0, 0, 0 }, 0,  { (31 << 6),        (0) },  { 0x00, 0xFF, 0x00, 0xFF } } },
+	{ .v = { { 0, 0, 0 }, 0,  {       (0), (127 << 6) },  { 0x00, 0x00, 0xFF, 0xFF } } },
+	{ .v = { { 0, 0, 0 }, 0,  { (31 << 6), (127 << 6) },  { 0xFF, 0xFF, 0x00, 0xFF } } },
+};
+
+/* Bounds of the quad in its own (high precision) vertex space; this covers every shape the morph can produce. */
+static const UbxSphere gQuadBounds =
+{
+	.center = { 0, 0, 0 },
+	.radius = UBX_FIXED_FROM_FLOAT(COORD_AS_HP1_FLT(2.3f)),
+};
+
+#ifdef _BENCHMARK_MATH
+extern void RunMathBenchmark();
+#endif
+
+#ifdef _BENCHMARK_SPRITES
+extern void InitSpriteBenchmark();
+extern void DrawSpriteBenchmark(u32 screenWidth, u32 screenHeight);
+#endif
+
+#ifdef _BENCHMARK_GFX_UCODE
+extern void PrepareUcodeBenchmark(OSTask* pDrawTask);
+extern void FinishUcodeBenchmark(u32 gfxCount);
+#endif
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -242,6 +381,36 @@ void OnGameBoot()
 	// Set the VI mode index to the value determined by our build settings.
 	gUbxVideo.viModeIndex = DISPLAY_VI_MODE_INDEX;
 
+	/* Let the engine drop the render size whenever the graphics tasks stop fitting in a single frame; the VI scales each
+	 * frame back up to the full display size. */
+	gUbxVideo.maxWidth = DISPLAY_WIDTH;
+	gUbxVideo.maxHeight = DISPLAY_HEIGHT;
+	gUbxVideo.loadBudget = (u32) (OS_CPU_COUNTER / GAME_FRAME_RATE);
+
+	/* Present each frame for as many retraces as the render rate calls for. */
+	gUbxTiming.renderRate = GAME_RENDER_RATE;
+
+	/* Give the engine the memory it will use for per-frame RCP data (vertices, matrices, display lists, etc). */
+	gUbxArena.pBuffer = gFrameArenaBuffer;
+	gUbxArena.bufferSize = sizeof(gFrameArenaBuffer);
+	gUbxArena.frameCount = DISPLAY_BUFFER_COUNT;
+
+	/* Clear the depth buffer and the whole color buffer at the start of every frame. This is only an example; a real
+	 * game should draw over the entire color buffer and use UBX_CLEAR_COLOR_NONE (or UBX_CLEAR_COLOR_DIRTY_RECTS for
+	 * the parts it leaves alone), since each full screen fill costs real RDP time. */
+	gUbxClear.pDepthBuffer = gDepthBuffer;
+	gUbxClear.width = DISPLAY_WIDTH;
+	gUbxClear.height = DISPLAY_HEIGHT;
+	gUbxClear.colorMode = UBX_CLEAR_COLOR_FULL;
+	gUbxClear.colorValue = CFB_CLEAR_VALUE | (CFB_CLEAR_VALUE << 16);
+	gUbxClear.depthValue = ZBUF_CLEAR_VALUE | (ZBUF_CLEAR_VALUE << 16);
+
+	/* Use the FIFO micro-code so the RSP can work ahead of the RDP instead of waiting on it. Only one draw task is ever
+	 * in flight at a time, so both of them can share the same FIFO. */
+	gUbxTask.pFifoBuffer = gRdpFifoBuffer;
+	gUbxTask.fifoBufferSize = sizeof(gRdpFifoBuffer);
+	gUbxTask.gfxUcode = UBX_TASK_GFX_UCODE_FIFO;
+
 	const OSTask defaultGfxTask =
 	{
 		.t =
@@ -265,20 +434,19 @@ void OnGameBoot()
 		},
 	};
 
+	/* The scheduler signals this queue when the RCP has finished with a draw task, which also fences its frame arena. */
+	osCreateMesgQueue(&gGfxDoneMsgQueue, gGfxDoneMsg, DISPLAY_BUFFER_COUNT);
+
 	for(size_t i = 0; i < DISPLAY_BUFFER_COUNT; ++i)
 	{
-		gGfxState[i].clearTask = defaultGfxTask;
 		gGfxState[i].drawTask = defaultGfxTask;
 
-		/* Set the static micro-code for the gfx clear task. */
-		UBX_TASK_SET_BOOT_UCODE(&gGfxState[i].clearTask, (u64*) rspbootTextStart, (u64*) rspbootTextEnd);
-		UBX_TASK_SET_RSP_UCODE(&gGfxState[i].clearTask, (u64*) gspF3DEX2_xbusTextStart, (u64*) gspF3DEX2_xbusTextEnd);
-		UBX_TASK_SET_RSP_UCODE_DATA(&gGfxState[i].clearTask, (u64*) gspF3DEX2_xbusDataStart, (u64*) gspF3DEX2_xbusDataEnd);
+		/* Set the static micro-code and the yield buffer for the gfx draw task. */
+		UbxTaskInitGfx(&gGfxState[i].drawTask);
 
-		/* Set the static micro-code for the gfx draw task. */
-		UBX_TASK_SET_BOOT_UCODE(&gGfxState[i].drawTask, (u64*) rspbootTextStart, (u64*) rspbootTextEnd);
-		UBX_TASK_SET_RSP_UCODE(&gGfxState[i].drawTask, (u64*) gspF3DEX2_xbusTextStart, (u64*) gspF3DEX2_xbusTextEnd);
-		UBX_TASK_SET_RSP_UCODE_DATA(&gGfxState[i].drawTask, (u64*) gspF3DEX2_xbusDataStart, (u64*) gspF3DEX2_xbusDataEnd);
+		/* All tasks go through the scheduler so they can share the RCP with the audio tasks. */
+		UbxSchedInitTask(&gGfxState[i].drawSchedTask, &gGfxState[i].drawTask);
+		gGfxState[i].drawSchedTask.pDoneQueue = &gGfxDoneMsgQueue;
 	}
 }
 
@@ -286,22 +454,40 @@ void OnGameBoot()
 
 void OnGameInitialize()
 {
-	const Vtx defaultQuadVtx[4] =
+	/* Initialize the game state. */
+	memset(&gGameState, 0, sizeof(GameState));
+
+	/* The projection never changes, so the view frustum used for culling only needs to be built once. */
+	UbxFrustumFromPerspective(&gGameState.frustum, CAMERA_FOVY, CAMERA_ASPECT, CAMERA_NEAR, CAMERA_FAR);
+
+	/* Build the scene graph. The root node never moves, so its matrix is only ever computed on the first update. */
+	UbxSceneInit(&gGameState.scene, gSceneNodes, SCENE_NODE_COUNT);
+	gGameState.rootNode = UbxSceneAddNode(&gGameState.scene, UBX_SCENE_NODE_NONE);
+	gGameState.quadNode = UbxSceneAddNode(&gGameState.scene, gGameState.rootNode);
+
+	/* The quad's vertices use the high precision scale, so its node brings them back down to the world scale. */
+	const UbxVec3 quadScale =
 	{
-		{ .v = { { 0, 0, 0 }, 0,  {       (0),        (0) },  { 0xFF, 0x00, 0x00, 0xFF } } },
-		{ .v = { { 0, 0, 0 }, 0,  { (31 << 6),        (0) },  { 0x00, 0xFF, 0x00, 0xFF } } },
-		{ .v = { { 0, 0, 0 }, 0,  {       (0), (127 << 6) },  { 0x00, 0x00, 0xFF, 0xFF } } },
-		{ .v = { { 0, 0, 0 }, 0,  { (31 << 6), (127 << 6) },  { 0xFF, 0xFF, 0x00, 0xFF } } },
+		UBX_FIXED_FROM_FLOAT(COORD_AS_HP2_FLT(1.0f)),
+		UBX_FIXED_FROM_FLOAT(COORD_AS_HP2_FLT(1.0f)),
+		UBX_FIXED_FROM_FLOAT(COORD_AS_HP2_FLT(1.0f)),
 	};
+	UbxSceneSetScale(&gGameState.scene, gGameState.quadNode, &quadScale);
 
-	for(size_t i = 0; i < DISPLAY_BUFFER_COUNT; ++i)
-	{
-		/* Initialize the quad vertex data. */
-		memcpy(gQuadVtx[i], defaultQuadVtx, sizeof(defaultQuadVtx));
-	}
+	/* Label the profiler zones in trace captures. */
+	UBX_TRACE_NAME_ZONE(PROFILER_ZONE_NEW_FRAME, "NewFrame");
+	UBX_TRACE_NAME_ZONE(PROFILER_ZONE_UPDATE, "Update");
+	UBX_TRACE_NAME_ZONE(PROFILER_ZONE_RENDER, "Render");
 
-	/* Initialize the game state. */
-	memset(&gGameState, 0, sizeof(GameState));
+#ifdef _BENCHMARK_MATH
+	/* Compare the engine's fixed-point transform path against the float 'gu' path. */
+	RunMathBenchmark();
+#endif
+
+#ifdef _BENCHMARK_SPRITES
+	/* Compare the sprite batcher against drawing the same sprites as triangles. */
+	InitSpriteBenchmark();
+#endif
 
 	/* Do an initial buffer swap so there is a vertical retrace to wait on when we get to the main loop. */
 	osViSwapBuffer(gFrameBuffer[1]);
@@ -311,6 +497,7 @@ void OnGameInitialize()
 
 /* Forward declare the game main loop functions. */
 void _OnGameNewFrame();
+void _OnGameTick(const OSContPad*);
 void _OnGameUpdate();
 void _OnGameRender();
 
@@ -319,8 +506,16 @@ __attribute__((noreturn)) void OnGameMainLoop(void*)
 	/* Main loop */
 	for(;;)
 	{
+		UBX_PROFILER_NEW_FRAME();
+
+		UBX_PROFILER_ZONE_BEGIN(PROFILER_ZONE_NEW_FRAME);
 		_OnGameNewFrame();
+		UBX_PROFILER_ZONE_END(PROFILER_ZONE_NEW_FRAME);
+
+		UBX_PROFILER_ZONE_BEGIN(PROFILER_ZONE_UPDATE);
 		_OnGameUpdate();
+		UBX_PROFILER_ZONE_END(PROFILER_ZONE_UPDATE);
+
 		_OnGameRender();
 	}
 
@@ -331,49 +526,59 @@ __attribute__((noreturn)) void OnGameMainLoop(void*)
 
 void _OnGameNewFrame()
 {
-	GfxState* pGfxState = &gGfxState[gDrawBufferIndex];
+	/* Start allocating from this frame's arena; this will only block if the RCP is still using it. */
+	UbxArenaBeginFrame();
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-	/* Setup the gfx display list for clearing the display buffers; start this as early in the frame as possible
-	 * to give the RCP time to work on it while we update the game and prepare the 'draw scene' display list. */
+/* Interpolate between two angles in the [0, tau) range along the shortest way around. */
+static inline f32 _LerpAngle(const f32 from, const f32 to, const f32 alpha)
+{
+	f32 delta = to - from;
+	if(delta > M_PI)
+	{
+		delta -= M_TAU;
+	}
+	else if(delta < -M_PI)
 	{
-		UBX_GFX_CMD_USE(pGfxState->clearCmd);
+		delta += M_TAU;
+	}
 
-		/* Initialize the RDP to its default state. */
-		gSPDisplayList(UBX_GFX_CMD_NEXT, rcpInitDlist);
+	return from + (delta * alpha);
+}
 
-		/* Clear the active frame buffer and the depth buffer. */
-		{
-			gDPSetCycleType(UBX_GFX_CMD_NEXT, G_CYC_FILL);
-
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Warray-bounds"
-			/* Depth buffer */
-			gDPSetColorImage(UBX_GFX_CMD_NEXT, G_IM_FMT_RGBA, G_IM_SIZ_16b, DISPLAY_WIDTH, OS_K0_TO_PHYSICAL(gDepthBuffer));
-			gDPSetFillColor(UBX_GFX_CMD_NEXT, ZBUF_CLEAR_VALUE | (ZBUF_CLEAR_VALUE << 16));
-			gDPFillRectangle(UBX_GFX_CMD_NEXT, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT - 1);
-#pragma GCC diagnostic pop
-
-			/* Frame buffer (this is only an example; in a real game, you should be drawing to the entire frame buffer, making this unnessary) */
-			gDPSetColorImage(UBX_GFX_CMD_NEXT, G_IM_FMT_RGBA, G_IM_SIZ_16b, DISPLAY_WIDTH, OS_K0_TO_PHYSICAL(gFrameBuffer[gDrawBufferIndex]));
-			gDPSetFillColor(UBX_GFX_CMD_NEXT, CFB_CLEAR_VALUE | (CFB_CLEAR_VALUE << 16));
-			gDPFillRectangle(UBX_GFX_CMD_NEXT, 0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
-
-			/* Set the depth buffer */
-			gDPSetDepthImage(UBX_GFX_CMD_NEXT, OS_K0_TO_PHYSICAL(gDepthBuffer));
-		}
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-		/* Finalize the clear command list for this frame. */
-		gDPFullSync(UBX_GFX_CMD_NEXT);
-		gSPEndDisplayList(UBX_GFX_CMD_NEXT);
+void _OnGameTick(const OSContPad* const pPad)
+{
+	SimState* const pSim = &gGameState.sim;
+
+	gGameState.prevSim = *pSim;
 
-		/* Bind the current gfx command list to the gfx clear task. */
-		UBX_TASK_SET_DATA(&pGfxState->clearTask, UBX_GFX_CMD_LIST_HEAD, UBX_GFX_CMD_LIST_TAIL);
+	/* Update the object movement value. */
+	pSim->movAmt += 0.2185f * gUbxTiming.tickSeconds;
+	if(pSim->movAmt > M_TAU)
+	{
+		pSim->movAmt -= M_TAU;
+	}
 
-		/* Write back the updated command buffer to physical memory. */
-		osWritebackDCache(pGfxState->clearTask.t.data_ptr, pGfxState->clearTask.t.data_size);
+	/* Update the object rotation; the control stick speeds it up or slows it down. */
+	pSim->rotAngle += (0.7316f + ((f32) pPad->stick_x / 40.0f)) * gUbxTiming.tickSeconds;
+	if(pSim->rotAngle > M_TAU)
+	{
+		pSim->rotAngle -= M_TAU;
+	}
+	else if(pSim->rotAngle < 0.0f)
+	{
+		pSim->rotAngle += M_TAU;
+	}
 
-		/* Launch the gfx clear task. */
-		osSpTaskStart(&pGfxState->clearTask);
+	/* Update the object morph value. */
+	pSim->morphAmt -= 1.4823f * gUbxTiming.tickSeconds;
+	if(pSim->morphAmt < 0.0f)
+	{
+		pSim->morphAmt += M_TAU;
 	}
 }
 
@@ -381,38 +586,40 @@ void _OnGameNewFrame()
 
 void _OnGameUpdate()
 {
-	FrameState* pFrameState = &gFrameState[gDrawBufferIndex];
-	Vtx* pQuadVtx = gQuadVtx[gDrawBufferIndex];
+	FrameState* pFrameState = &gFrameState;
 
-	/* Update the object movement value. */
-	gGameState.movAmt += 0.2185f * DISPLAY_VSYNC_TIME_DELTA;
-	if(gGameState.movAmt > M_TAU)
-	{
-		gGameState.movAmt -= M_TAU;
-	}
+	/* Allocate this frame's dynamic RCP data. */
+	pFrameState->pTransform = UBX_ARENA_ALLOC(Transform, 1);
+	pFrameState->pQuadVtx = UBX_ARENA_ALLOC_VTX(4);
 
-	/* Update the object rotation. */
-	gGameState.rotAngle += 0.7316f * DISPLAY_VSYNC_TIME_DELTA;
-	if(gGameState.rotAngle > M_TAU)
-	{
-		gGameState.rotAngle -= M_TAU;
-	}
+	Vtx* pQuadVtx = pFrameState->pQuadVtx;
+	memcpy(pQuadVtx, gDefaultQuadVtx, sizeof(gDefaultQuadVtx));
 
-	/* Update the object morph value. */
-	gGameState.morphAmt -= 1.4823f * DISPLAY_VSYNC_TIME_DELTA;
-	if(gGameState.morphAmt < 0.0f)
+	OSContPad pad;
+
+	/* Get the most recent controller state; this never waits on the SI. */
+	UbxSerialReadPad(0, &pad);
+
+	/* Advance the simulation by however many fixed ticks fit in the real time that has gone by since the last frame. */
+	const u32 tickCount = UbxTimingBeginFrame();
+	for(u32 i = 0; i < tickCount; ++i)
 	{
-		gGameState.morphAmt += M_TAU;
+		_OnGameTick(&pad);
 	}
 
+	/* Blend the last two simulation states so motion stays smooth when the render and tick rates don't line up. */
+	const f32 alpha = UBX_FIXED_TO_FLOAT(gUbxTiming.alpha);
+	const f32 simRotAngle = _LerpAngle(gGameState.prevSim.rotAngle, gGameState.sim.rotAngle, alpha);
+	const f32 simMorphAmt = _LerpAngle(gGameState.prevSim.morphAmt, gGameState.sim.morphAmt, alpha);
+
 #if 0
 	const s16 ulx = COORD_AS_HP1_VTX(-1.0f);
 	const s16 uly = COORD_AS_HP1_VTX(1.0);
 	const s16 lrx = COORD_AS_HP1_VTX(1.0f);
 	const s16 lry = COORD_AS_HP1_VTX(-1.0f);
 #else
-	const f32 verticalMorph = sinf(gGameState.morphAmt) * 0.7f;
-	const f32 horizontalMorph = cosf(gGameState.morphAmt) * 0.5f;
+	const f32 verticalMorph = sinf(simMorphAmt) * 0.7f;
+	const f32 horizontalMorph = cosf(simMorphAmt) * 0.5f;
 
 	const s16 ulx = COORD_AS_HP1_VTX(-1.0f + horizontalMorph);
 	const s16 uly = COORD_AS_HP1_VTX(1.0f + verticalMorph);
@@ -426,43 +633,50 @@ void _OnGameUpdate()
 	SET_VTX_POS_V(&pQuadVtx[2], ulx, lry, 0);
 	SET_VTX_POS_V(&pQuadVtx[3], lrx, lry, 0);
 
-	/* Write back the vertex data from the cache to physical memory. */
-	osWritebackDCache(pQuadVtx, sizeof(Vtx) * 4);
+	const UbxAngle rotAngle = UBX_ANGLE_FROM_RADIANS(simRotAngle);
+
+	const UbxVec3 objPos = { UBX_FIXED_MUL(UbxSin(rotAngle), UBX_FIXED_FROM_FLOAT(COORD_WORLD_SCALE)), 0, 0 };
 
-	Mtx transMtx;
-	Mtx rotMtx;
-	Mtx scaleMtx;
+	UbxQuat objRot;
+	UbxAffine viewAffine;
+	UbxAffine modelViewAffine;
 	Mtx viewMtx;
 
-	/* Calculate world transform matrices. */
-	guTranslateF(&transMtx, COORD_AS_FLT(sinf(gGameState.rotAngle)), 0.0f, 0.0f);
-	guRotateF(&rotMtx, gGameState.rotAngle / M_TAU * 360.0f, 0.0f, 1.0f, 0.0f);
-	guScaleF(&scaleMtx, COORD_AS_HP2_FLT(1.0f), COORD_AS_HP2_FLT(1.0f), COORD_AS_HP2_FLT(1.0f));
+	/* Move the quad; only nodes changed like this (and their children) get new matrices in the scene update. */
+	UbxQuatFromAxisAngle(&objRot, rotAngle, 0, UBX_FIXED_ONE, 0);
+	UbxSceneSetPosition(&gGameState.scene, gGameState.quadNode, &objPos);
+	UbxSceneSetRotation(&gGameState.scene, gGameState.quadNode, &objRot);
+	UbxSceneUpdate(&gGameState.scene);
 
-	/* Calculate the view matrix. */
+	/* Calculate the view matrix; this is only done once per frame, so the float version is fine here. */
 	guLookAtF(
 		&viewMtx,
 		0.0f, 0.0f, COORD_AS_FLT(2.5f),
 		0.0f, 0.0f, 0.0f,
 		0.0f, 1.0f, 0.0f);
+	UbxAffineFromMtxF(&viewAffine, &viewMtx);
+
+	/* The view matrix is applied on top of the projection matrix, which leaves the node matrices in world space
+	 * and lets unchanged nodes keep using the matrices they already have. */
+	UbxAffineToMtx(&pFrameState->pTransform->view, &viewAffine);
+
+	/* Culling still works in view space, so it needs the full model-view transform. */
+	UbxAffineMul(&modelViewAffine, UbxSceneGetWorld(&gGameState.scene, gGameState.quadNode), &viewAffine);
 
-	/* Calculate the final model-view matrix. */
-	guMtxCatF(&scaleMtx, &rotMtx, &rotMtx);
-	guMtxCatF(&rotMtx, &transMtx, &transMtx);
-	guMtxCatF(&transMtx, &viewMtx, &viewMtx);
-	guMtxF2L(&viewMtx, &pFrameState->transform.modelView);
+	/* Test the quad against the view frustum so its vertices are never loaded by the RSP when it is off screen. */
+	pFrameState->quadVisible = (UbxCullSphere(&gGameState.frustum, &modelViewAffine, &gQuadBounds) != UBX_CULL_OUTSIDE);
 
 	/* Create the projection matrix. */
 	guPerspective(
-		&pFrameState->transform.projection,
+		&pFrameState->pTransform->projection,
 		&gGameState.perspNorm,
-		80.0f,
-		(f32) DISPLAY_WIDTH / (f32) DISPLAY_HEIGHT,
-		COORD_AS_FLT(0.01f), COORD_AS_FLT(10.0f),
+		CAMERA_FOVY,
+		CAMERA_ASPECT,
+		CAMERA_NEAR, CAMERA_FAR,
 		1.0f);
 
-	/* Write back the frame transform data from the cache to physical memory. */
-	osWritebackDCache(&pFrameState->transform, sizeof(Transform));
+	/* The viewport follows the render size, which can change from frame to frame. */
+	UbxVideoGetViewport(&pFrameState->pTransform->viewport);
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -470,66 +684,114 @@ void _OnGameUpdate()
 void _OnGameRender()
 {
 	GfxState* pGfxState = &gGfxState[gDrawBufferIndex];
-	FrameState* pFrameState = &gFrameState[gDrawBufferIndex];
-	Vtx* pQuadVtx = gQuadVtx[gDrawBufferIndex];
+	FrameState* pFrameState = &gFrameState;
+
+	UBX_PROFILER_ZONE_BEGIN(PROFILER_ZONE_RENDER);
 
 	/* Setup the gfx display list for drawing the scene. */
 	{
-		UBX_GFX_CMD_USE(pGfxState->drawCmd);
+		Gfx* pDrawCmd = UBX_ARENA_ALLOC_GFX(GFX_DRAW_CMD_LENGTH);
+
+		UBX_GFX_CMD_USE(pDrawCmd);
+		UbxGfxStateReset();
 
 		/* Initialize the RDP to its default state. */
 		gSPDisplayList(UBX_GFX_CMD_NEXT, rcpInitDlist);
-
+		AssumeRcpInitState();
+
+		/* Restrict drawing to this frame's render size. */
+		gSPViewport(UBX_GFX_CMD_NEXT, &pFrameState->pTransform->viewport);
+		UBX_GFX_SET_SCISSOR(G_SC_NON_INTERLACE, 0, 0, gUbxVideo.renderWidth - 1, gUbxVideo.renderHeight - 1);
+
+		/* Clear the display buffers as part of the draw task itself, which saves the RCP a whole task round-trip. */
+		gUbxClear.fillWidth = gUbxVideo.renderWidth;
+		gUbxClear.fillHeight = gUbxVideo.renderHeight;
+		UbxClearEmit(gFrameBuffer[gDrawBufferIndex]);
+
+		/* Set the default texture state (the init display list already set all of this, so nothing is emitted). */
+		UBX_GFX_SET_TEXTURE_FILTER(G_TF_BILERP);
+		UBX_GFX_SET_TEXTURE_PERSP(G_TP_PERSP);
+		UBX_GFX_SET_TEXTURE_DETAIL(G_TD_CLAMP);
+		UBX_GFX_SET_TEXTURE_LOD(G_TL_TILE);
+		UBX_GFX_SET_TEXTURE_LUT(G_TT_NONE);
+
+		/* Set the geometry rasterizer state. Any syncs needed for these are inserted by the state tracker. */
+		UBX_GFX_SET_GEOMETRY_MODE(G_SHADE | G_SHADING_SMOOTH /*| G_CULL_BACK*/);
+		UBX_GFX_SET_CYCLE_TYPE(G_CYC_1CYCLE);
+		UBX_GFX_SET_RENDER_MODE(G_RM_ZB_XLU_SURF, G_RM_ZB_XLU_SURF2);
+		UBX_GFX_SET_COMBINE_MODE(G_CC_SHADE, G_CC_SHADE);
 
 		/* Set the frame transforms. */
 		gSPPerspNormalize(UBX_GFX_CMD_NEXT, gGameState.perspNorm);
-		gSPMatrix(UBX_GFX_CMD_NEXT, OS_K0_TO_PHYSICAL(&pFrameState->transform.projection), G_MTX_PROJECTION | G_MTX_LOAD | G_MTX_NOPUSH);
-		gSPMatrix(UBX_GFX_CMD_NEXT, OS_K0_TO_PHYSICAL(&pFrameState->transform.modelView), G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_NOPUSH);
-
-		/* Set the default texture state. */
-		gDPSetTextureFilter(UBX_GFX_CMD_NEXT, G_TF_BILERP);
-		gDPSetTexturePersp(UBX_GFX_CMD_NEXT, G_TP_PERSP);
-		gDPSetTextureDetail(UBX_GFX_CMD_NEXT, G_TD_CLAMP);
-		gDPSetTextureLOD(UBX_GFX_CMD_NEXT, G_TL_TILE);
-		gDPSetTextureLUT(UBX_GFX_CMD_NEXT, G_TT_NONE);
-
-		/* Set the geometry rasterizer state. */
-		gSPSetGeometryMode(UBX_GFX_CMD_NEXT, G_SHADE | G_SHADING_SMOOTH /*| G_CULL_BACK*/);
-		gDPSetCycleType(UBX_GFX_CMD_NEXT, G_CYC_1CYCLE);
-		gDPSetRenderMode(UBX_GFX_CMD_NEXT, G_RM_ZB_XLU_SURF, G_RM_ZB_XLU_SURF2);
-		gDPSetCombineMode(UBX_GFX_CMD_NEXT, G_CC_SHADE, G_CC_SHADE);
-		gDPPipeSync(UBX_GFX_CMD_NEXT);
+		gSPMatrix(UBX_GFX_CMD_NEXT, OS_K0_TO_PHYSICAL(&pFrameState->pTransform->projection), G_MTX_PROJECTION | G_MTX_LOAD | G_MTX_NOPUSH);
+		gSPMatrix(UBX_GFX_CMD_NEXT, OS_K0_TO_PHYSICAL(&pFrameState->pTransform->view), G_MTX_PROJECTION | G_MTX_MUL | G_MTX_NOPUSH);
 
 		/* Draw the quad (triangle front faces are counter-clockwise). */
-		gSPVertex(UBX_GFX_CMD_NEXT, pQuadVtx, 4, 0);
-		gSP1Triangle(UBX_GFX_CMD_NEXT, 0, 2, 1, 0);
-		gSP1Triangle(UBX_GFX_CMD_NEXT, 1, 2, 3, 0);
+		if(pFrameState->quadVisible)
+		{
+			const Mtx* const pQuadMtx = UbxSceneGetMtx(&gGameState.scene, gGameState.quadNode);
+
+			gSPMatrix(UBX_GFX_CMD_NEXT, OS_K0_TO_PHYSICAL(pQuadMtx), G_MTX_MODELVIEW | G_MTX_LOAD | G_MTX_NOPUSH);
+			gSPVertex(UBX_GFX_CMD_NEXT, pFrameState->pQuadVtx, 4, 0);
+			gSP1Triangle(UBX_GFX_CMD_NEXT, 0, 2, 1, 0);
+			gSP1Triangle(UBX_GFX_CMD_NEXT, 1, 2, 3, 0);
+		}
+
+#ifdef _BENCHMARK_SPRITES
+		/* Draw a screen full of HUD sprites on top of the scene. */
+		DrawSpriteBenchmark(gUbxVideo.renderWidth, gUbxVideo.renderHeight);
+#endif
+
+		/* Draw the profiler overlay on top of everything else (this is compiled out of final ROMs). */
+		UBX_PROFILER_DRAW_HUD(32, gUbxVideo.renderHeight - 80);
 
 		/* Finalize the display list. */
 		gDPFullSync(UBX_GFX_CMD_NEXT);
 		gSPEndDisplayList(UBX_GFX_CMD_NEXT);
 
+		/* Return the unused portion of the display list to the frame arena. */
+		UbxArenaTrim(pDrawCmd, (size_t) (UBX_GFX_CMD_LIST_TAIL - UBX_GFX_CMD_LIST_HEAD) * sizeof(Gfx));
+
 		/* Bind the current gfx command list to the gfx draw task. */
 		UBX_TASK_SET_DATA(&pGfxState->drawTask, UBX_GFX_CMD_LIST_HEAD, UBX_GFX_CMD_LIST_TAIL);
 
-		/* Write back the updated command buffer to physical memory. */
-		osWritebackDCache(pGfxState->drawTask.t.data_ptr, pGfxState->drawTask.t.data_size);
+		/* Register everything allocated from the frame arena (vertices, transforms, display list) as one dirty range;
+		 * the arena stays in use until the draw task that reads it has completed. */
+		UbxArenaSubmitFrame(&pGfxState->drawSchedTask);
 
-		/* Wait for RDP to finish the 'clear buffers' task before launching the 'draw scene' task. */
-		osRecvMesg(&gUbxSystem.rdpMsgQueue, NULL, OS_MESG_BLOCK);
+		/* Write back all dirty data from the cache to physical memory right before the RCP needs it. */
+		UbxCacheFlush();
+
+		/* Stop timing the CPU before it starts waiting on the RCP. */
+		UBX_PROFILER_ZONE_END(PROFILER_ZONE_RENDER);
+
+#ifdef _BENCHMARK_GFX_UCODE
+		/* Switch the draw task between the XBUS and FIFO micro-code. */
+		PrepareUcodeBenchmark(&pGfxState->drawTask);
+#endif
 
 		/* Launch the gfx draw task. */
-		osSpTaskStart(&pGfxState->drawTask);
+		UbxSchedSubmit(&pGfxState->drawSchedTask);
 	}
 
-	/* Wait for RDP to complete its current workload. */
-	osRecvMesg(&gUbxSystem.rdpMsgQueue, NULL, OS_MESG_BLOCK);
+	/* Wait for the RCP to finish drawing the frame. */
+	UbxSchedWait(&pGfxState->drawSchedTask);
+
+	/* The RDP is done with this frame's data, so its arena can be reused. */
+	UbxArenaRetireFrame();
+
+#ifdef _BENCHMARK_GFX_UCODE
+	FinishUcodeBenchmark(UbxSchedGetGfxCount(&pGfxState->drawSchedTask));
+#endif
 
 	/* Flip the frame buffer */
-	osViSwapBuffer(gFrameBuffer[gDrawBufferIndex]);
+	UbxVideoSwapBuffer(gFrameBuffer[gDrawBufferIndex]);
+
+	/* Pick the render size of the next frame based on how long the RCP took with this one. */
+	UbxVideoUpdateResolution(UbxSchedGetGfxCount(&pGfxState->drawSchedTask));
 
-	/* Wait for the vertical retrace to complete (this is effectively waiting on vsync). */
-	osRecvMesg(&gUbxVideo.retraceMsgQueue, NULL, OS_MESG_BLOCK);
+	/* Wait on vsync until the frame has been on screen for as long as the render rate calls for. */
+	UbxTimingPaceFrame();
 
 	gDrawBufferIndex ^= 1;
 }
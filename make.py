@@ -124,6 +124,9 @@ with csbuild.Toolchain("n64"):
 	csbuild.AddCompilerFlags(
 		# Disabled warnings.
 		"-Wno-incompatible-pointer-types",
+
+		# Write out the stack frame size of each function for the linker to size the thread stacks with.
+		"-fstack-usage",
 	)
 
 with csbuild.Toolchain("clang"):
@@ -201,9 +204,14 @@ with csbuild.Project(UltraBoxEngine.projectName, UltraBoxEngine.path):
 	csbuild.SetOutput(UltraBoxEngine.outputName, csbuild.ProjectType.StaticLibrary)
 	csbuild.SetSupportedToolchains("n64")
 
+	# The libultra stand-in is only ever built by the host project.
+	csbuild.AddExcludeDirectories(f"{UltraBoxEngine.path}/host")
+
 	csbuild.AddSourceFiles(
 		f"{_REPO_ROOT_PATH}/toolchain/{_HOST_PLATFORM}/sdk/ultra/usr/lib/PR/rspboot.o",
-		f"{_REPO_ROOT_PATH}/toolchain/{_HOST_PLATFORM}/sdk/ultra/usr/lib/PR/gspF3DEX2.xbus.o"
+		f"{_REPO_ROOT_PATH}/toolchain/{_HOST_PLATFORM}/sdk/ultra/usr/lib/PR/gspF3DEX2.xbus.o",
+		f"{_REPO_ROOT_PATH}/toolchain/{_HOST_PLATFORM}/sdk/ultra/usr/lib/PR/gspF3DEX2.fifo.o",
+		f"{_REPO_ROOT_PATH}/toolchain/{_HOST_PLATFORM}/sdk/ultra/usr/lib/PR/aspMain.o"
 	)
 
 	with csbuild.Scope(csbuild.ScopeDef.Final):
@@ -219,16 +227,33 @@ with csbuild.Project(UltraBoxEngine.projectName, UltraBoxEngine.path):
 
 		with csbuild.Target("debug", "fastdebug"):
 			csbuild.AddLibraries(
+				"audio",
 				"gultra",
 				"leo_d",
 			)
 
 		with csbuild.Target("release"):
 			csbuild.AddLibraries(
+				"audio",
 				"gultra_rom",
 				"leo",
 			)
 
+		# The boot code runs on the main thread's stack since it's finished by the time the main thread starts. Jobs are
+		# supplied by the game and the synthesizer calls back into the engine through pointers, so those stacks get
+		# extra room for calls the analyzer can't follow.
+		csbuild.AddN64ThreadStack("main", "_start", "OnGameMainLoop", aliases=("boot",))
+		csbuild.AddN64ThreadStack("idle", "idle")
+		csbuild.AddN64ThreadStack("loader", "_UbxLoaderThread")
+		csbuild.AddN64ThreadStack("job", "_UbxJobThread", extraSize=1024)
+		csbuild.AddN64ThreadStack("event", "_UbxEventThread")
+		csbuild.AddN64ThreadStack("sched", "_UbxSchedThread")
+		csbuild.AddN64ThreadStack("audio", "_UbxAudioThread", extraSize=512)
+		csbuild.AddN64ThreadStack("serial", "_UbxSerialThread")
+
+		with csbuild.Target("debug", "fastdebug"):
+			csbuild.AddN64ThreadStack("trace", "_UbxTraceThread")
+
 	with csbuild.Scope(csbuild.ScopeDef.All):
 		csbuild.AddIncludeDirectories(
 			UltraBoxEngine.path,
@@ -241,6 +266,51 @@ with csbuild.Project(UltraBoxEngine.projectName, UltraBoxEngine.path):
 
 ###################################################################################################
 
+class UltraBoxEngineHost(object):
+	projectName = "UltraBoxEngineHost"
+	outputName = "libultrabox_host"
+	path = f"{_REPO_ROOT_PATH}/engine"
+
+# Builds the engine for the development machine on top of a stand-in for libultra so engine code can be exercised
+# and benchmarked without an emulator. The SDK headers assume 32-bit pointers and longs, so these projects only
+# support x86 (e.g. run csbuild with '--architecture x86').
+with csbuild.Project(UltraBoxEngineHost.projectName, UltraBoxEngineHost.path):
+	csbuild.SetOutput(UltraBoxEngineHost.outputName, csbuild.ProjectType.StaticLibrary)
+	csbuild.SetSupportedToolchains("gcc", "clang")
+	csbuild.SetSupportedArchitectures("x86")
+
+	# The boot code pokes the PI registers directly and has no meaning on the host.
+	csbuild.AddExcludeFiles(f"{UltraBoxEngineHost.path}/ultra_box/lowlevel/boot.c")
+
+	with csbuild.Scope(csbuild.ScopeDef.Final):
+		csbuild.AddLibraries(
+			"m",
+			"pthread",
+		)
+		csbuild.AddLinkerFlags(
+			"-pthread",
+		)
+
+	with csbuild.Scope(csbuild.ScopeDef.All):
+		ultraSdkPath = f"{_REPO_ROOT_PATH}/toolchain/{_HOST_PLATFORM}/sdk/ultra/usr"
+
+		csbuild.AddIncludeDirectories(
+			UltraBoxEngineHost.path,
+			f"{ultraSdkPath}/include",
+			f"{ultraSdkPath}/include/PR",
+		)
+		csbuild.AddDefines(
+			"F3DEX_GBI_2",
+			"_LANGUAGE_C",
+			"_MIPS_SZINT=32",
+			"_MIPS_SZLONG=32",
+		)
+		csbuild.AddCompilerFlags(
+			"-include", f"{UltraBoxEngineHost.path}/host/prelude.h",
+		)
+
+###################################################################################################
+
 class External(object):
 	rootPath = f"{_REPO_ROOT_PATH}/external"
 
@@ -316,6 +386,34 @@ with csbuild.Project(MaskRom64.projectName, MaskRom64.path, MaskRom64.dependenci
 
 ###################################################################################################
 
+class UbxDl(object):
+	projectName = "UbxDl"
+	outputName = "ubxdl"
+	path = f"{Tool.rootPath}/ubxdl"
+	dependencies = [
+		ExtLibCxxOpts.projectName,
+		LibToolCommon.projectName,
+	]
+
+with csbuild.Project(UbxDl.projectName, UbxDl.path, UbxDl.dependencies):
+	Tool.commonSetup(UbxDl.outputName)
+
+###################################################################################################
+
+class UbxMap(object):
+	projectName = "UbxMap"
+	outputName = "ubxmap"
+	path = f"{Tool.rootPath}/ubxmap"
+	dependencies = [
+		ExtLibCxxOpts.projectName,
+		LibToolCommon.projectName,
+	]
+
+with csbuild.Project(UbxMap.projectName, UbxMap.path, UbxMap.dependencies):
+	Tool.commonSetup(UbxMap.outputName)
+
+###################################################################################################
+
 class UbxPipeline(object):
 	projectName = "UbxPipeline"
 	outputName = "ubxpipeline"
@@ -331,6 +429,40 @@ with csbuild.Project(UbxPipeline.projectName, UbxPipeline.path, UbxPipeline.depe
 
 ###################################################################################################
 
+class UbxRdp(object):
+	projectName = "UbxRdp"
+	outputName = "ubxrdp"
+	path = f"{Tool.rootPath}/ubxrdp"
+	dependencies = [
+		ExtLibCxxOpts.projectName,
+		LibToolCommon.projectName,
+	]
+
+with csbuild.Project(UbxRdp.projectName, UbxRdp.path, UbxRdp.dependencies):
+	Tool.commonSetup(UbxRdp.outputName)
+
+	# The rasterizer runs on std::thread.
+	with csbuild.Toolchain("gcc", "clang"):
+		csbuild.AddLibraries(
+			"pthread",
+		)
+
+###################################################################################################
+
+class UbxTrace(object):
+	projectName = "UbxTrace"
+	outputName = "ubxtrace"
+	path = f"{Tool.rootPath}/ubxtrace"
+	dependencies = [
+		ExtLibCxxOpts.projectName,
+		LibToolCommon.projectName,
+	]
+
+with csbuild.Project(UbxTrace.projectName, UbxTrace.path, UbxTrace.dependencies):
+	Tool.commonSetup(UbxTrace.outputName)
+
+###################################################################################################
+
 class Game(object):
 	rootPath = f"{_REPO_ROOT_PATH}/games"
 
@@ -356,6 +488,17 @@ class UltraBoxTemplate(object):
 		UltraBoxEngine.projectName,
 	]
 
+	@staticmethod
+	def commonSetup():
+		csbuild.AddDefines(
+			#"_DISPLAY_HIRES",
+			#"_DISPLAY_PAL",
+			#"_BENCHMARK_GFX_UCODE",
+			#"_BENCHMARK_MATH",
+			#"_BENCHMARK_SPRITES",
+			#"_DEPTH_BUFFER_OWN_BANK",
+		)
+
 with csbuild.Project(UltraBoxTemplate.projectName, UltraBoxTemplate.path, UltraBoxTemplate.dependencies):
 	Game.commonSetup(
 		UltraBoxTemplate.outputName,
@@ -363,9 +506,36 @@ with csbuild.Project(UltraBoxTemplate.projectName, UltraBoxTemplate.path, UltraB
 		UltraBoxTemplate.gameCode,
 		UltraBoxTemplate.romVersion)
 
-	csbuild.AddDefines(
-		#"_DISPLAY_HIRES",
-		#"_DISPLAY_PAL",
-	)
+	UltraBoxTemplate.commonSetup()
+
+	# Compress the code segment loaded at boot by the engine's first-stage loader.
+	#csbuild.SetN64CompressCode(True)
+
+	# Code overlays are declared here by name along with the '.ovl' source files that belong to them, e.g.
+	#csbuild.AddN64Overlay("menu", "menu.ovl.c", "menu_*.ovl.c")
+
+	# Memory budgets fail the ROM build when exceeded. They apply to the whole program or to one of its sections,
+	# libraries, or object files, e.g.
+	#csbuild.AddN64MemoryBudget("rom", 1024 * 1024)
+	#csbuild.AddN64MemoryBudget("rdram", 256 * 1024, "ultra_box")
+
+###################################################################################################
+
+class UltraBoxTemplateHost(object):
+	projectName = "UltraBoxTemplateHost"
+	outputName = "template_host"
+	path = UltraBoxTemplate.path
+	dependencies = [
+		UltraBoxEngineHost.projectName,
+	]
+
+with csbuild.Project(UltraBoxTemplateHost.projectName, UltraBoxTemplateHost.path, UltraBoxTemplateHost.dependencies):
+	csbuild.SetOutput(UltraBoxTemplateHost.outputName, csbuild.ProjectType.Application)
+	csbuild.SetSupportedToolchains("gcc", "clang")
+	csbuild.SetSupportedArchitectures("x86")
+
+	csbuild.AddExcludeFiles(f"{UltraBoxTemplateHost.path}/boot.s")
+
+	UltraBoxTemplate.commonSetup()
 
 ###################################################################################################
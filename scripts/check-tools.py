@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023, Zoe J. Bare
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+# documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+# and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all copies or substantial portions
+# of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+# TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+# CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+#
+
+# Runs the native tools built by build-tools.py over the captured fixtures checked in next to their sources and compares
+# the results with the expected output. Each fixture is a '<name>.txt' input with the expected output in '<name>.json'
+# and the expected warnings and errors in '<name>.log'. Run it from anywhere after building the tools:
+#
+#   python3 scripts/check-tools.py
+
+import difflib
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+
+########################################################################################################################
+
+_REPO_ROOT_PATH = os.path.abspath(f"{os.path.dirname(__file__)}/..")
+
+_TOOLS_WITH_FIXTURES = [
+	"ubxtrace",
+]
+
+########################################################################################################################
+
+def _readText(filePath):
+	with open(filePath, "r", newline=None) as f:
+		return f.read()
+
+########################################################################################################################
+
+def _compare(label, expected, actual):
+	if expected == actual:
+		return True
+
+	print(f"Mismatch in {label}:")
+	sys.stdout.writelines(
+		difflib.unified_diff(
+			expected.splitlines(keepends=True),
+			actual.splitlines(keepends=True),
+			fromfile="expected",
+			tofile="actual",
+		)
+	)
+	return False
+
+########################################################################################################################
+
+def _checkFixture(exePath, inputFilePath):
+	fixturePath = os.path.splitext(inputFilePath)[0]
+
+	with tempfile.TemporaryDirectory() as tempDirPath:
+		outputFilePath = os.path.join(tempDirPath, "output.json")
+
+		# Fix the locale so numbers are always written the same way.
+		env = dict(os.environ, LC_ALL="C")
+		result = subprocess.run(
+			[exePath, inputFilePath, "-o", outputFilePath],
+			stdout=subprocess.DEVNULL,
+			stderr=subprocess.PIPE,
+			universal_newlines=True,
+			env=env,
+		)
+
+		if result.returncode != 0:
+			print(f"Tool failed with exit code {result.returncode}:\n{result.stderr}")
+			return False
+
+		fixtureName = os.path.basename(fixturePath)
+		jsonMatches = _compare(f"{fixtureName}.json", _readText(f"{fixturePath}.json"), _readText(outputFilePath))
+		logMatches = _compare(f"{fixtureName}.log", _readText(f"{fixturePath}.log"), result.stderr)
+
+		return jsonMatches and logMatches
+
+########################################################################################################################
+
+def main():
+	exeFileExt = ".exe" if platform.system() == "Windows" else ""
+	failCount = 0
+
+	for toolName in _TOOLS_WITH_FIXTURES:
+		exePath = os.path.normpath(f"{_REPO_ROOT_PATH}/output/tool/release/{toolName}{exeFileExt}")
+		assert os.access(exePath, os.F_OK), f"Cannot find the {toolName} tool at: {exePath}; run build-tools.py first"
+
+		fixtureRootPath = os.path.normpath(f"{_REPO_ROOT_PATH}/tools/native/{toolName}/fixtures")
+
+		for fileName in sorted(os.listdir(fixtureRootPath)):
+			if not fileName.endswith(".txt"):
+				continue
+
+			print(f"Checking {toolName} fixture: \"{fileName}\" ...")
+
+			if not _checkFixture(exePath, os.path.join(fixtureRootPath, fileName)):
+				failCount += 1
+
+	assert failCount == 0, f"{failCount} tool fixture(s) failed"
+	print("All tool fixtures passed")
+
+########################################################################################################################
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,254 @@
+//
+// Copyright (c) 2023, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// F3DEX2 command opcodes. These must match gbi.h when it's included with F3DEX_GBI_2 defined.
+enum GFX_OP : uint8_t
+{
+	GFX_OP_SPNOOP           = 0x00,
+	GFX_OP_VTX              = 0x01,
+	GFX_OP_MODIFYVTX        = 0x02,
+	GFX_OP_CULLDL           = 0x03,
+	GFX_OP_BRANCH_Z         = 0x04,
+	GFX_OP_TRI1             = 0x05,
+	GFX_OP_TRI2             = 0x06,
+	GFX_OP_QUAD             = 0x07,
+	GFX_OP_SPECIAL_3        = 0xD3,
+	GFX_OP_SPECIAL_2        = 0xD4,
+	GFX_OP_SPECIAL_1        = 0xD5,
+	GFX_OP_DMA_IO           = 0xD6,
+	GFX_OP_TEXTURE          = 0xD7,
+	GFX_OP_POPMTX           = 0xD8,
+	GFX_OP_GEOMETRYMODE     = 0xD9,
+	GFX_OP_MTX              = 0xDA,
+	GFX_OP_MOVEWORD         = 0xDB,
+	GFX_OP_MOVEMEM          = 0xDC,
+	GFX_OP_LOAD_UCODE       = 0xDD,
+	GFX_OP_DL               = 0xDE,
+	GFX_OP_ENDDL            = 0xDF,
+	GFX_OP_NOOP             = 0xE0,
+	GFX_OP_RDPHALF_1        = 0xE1,
+	GFX_OP_SETOTHERMODE_L   = 0xE2,
+	GFX_OP_SETOTHERMODE_H   = 0xE3,
+	GFX_OP_TEXRECT          = 0xE4,
+	GFX_OP_TEXRECTFLIP      = 0xE5,
+	GFX_OP_RDPLOADSYNC      = 0xE6,
+	GFX_OP_RDPPIPESYNC      = 0xE7,
+	GFX_OP_RDPTILESYNC      = 0xE8,
+	GFX_OP_RDPFULLSYNC      = 0xE9,
+	GFX_OP_SETKEYGB         = 0xEA,
+	GFX_OP_SETKEYR          = 0xEB,
+	GFX_OP_SETCONVERT       = 0xEC,
+	GFX_OP_SETSCISSOR       = 0xED,
+	GFX_OP_SETPRIMDEPTH     = 0xEE,
+	GFX_OP_RDPSETOTHERMODE  = 0xEF,
+	GFX_OP_LOADTLUT         = 0xF0,
+	GFX_OP_RDPHALF_2        = 0xF1,
+	GFX_OP_SETTILESIZE      = 0xF2,
+	GFX_OP_LOADBLOCK        = 0xF3,
+	GFX_OP_LOADTILE         = 0xF4,
+	GFX_OP_SETTILE          = 0xF5,
+	GFX_OP_FILLRECT         = 0xF6,
+	GFX_OP_SETFILLCOLOR     = 0xF7,
+	GFX_OP_SETFOGCOLOR      = 0xF8,
+	GFX_OP_SETBLENDCOLOR    = 0xF9,
+	GFX_OP_SETPRIMCOLOR     = 0xFA,
+	GFX_OP_SETENVCOLOR      = 0xFB,
+	GFX_OP_SETCOMBINE       = 0xFC,
+	GFX_OP_SETTIMG          = 0xFD,
+	GFX_OP_SETZIMG          = 0xFE,
+	GFX_OP_SETCIMG          = 0xFF,
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Index values for G_MOVEWORD.
+#define GFX_MW_SEGMENT 0x06
+
+// Parameters of G_DL.
+#define GFX_DL_PUSH   0x00
+#define GFX_DL_NOPUSH 0x01
+
+// Parameters of G_MTX, after undoing the inverted push flag in the encoded command.
+#define GFX_MTX_PUSH       0x01
+#define GFX_MTX_LOAD       0x02
+#define GFX_MTX_PROJECTION 0x04
+
+// Index values for G_MOVEMEM.
+#define GFX_MV_VIEWPORT 8
+
+// Geometry mode bits.
+#define GFX_GEOMETRY_ZBUFFER     0x00000001
+#define GFX_GEOMETRY_SHADE       0x00000004
+#define GFX_GEOMETRY_CULL_FRONT  0x00000200
+#define GFX_GEOMETRY_CULL_BACK   0x00000400
+#define GFX_GEOMETRY_LIGHTING    0x00020000
+#define GFX_GEOMETRY_TEXTURE_GEN 0x00040000
+
+// Bit layout of the high other mode word.
+#define GFX_MDSFT_TEXTFILT  12
+#define GFX_TF_POINT        0
+#define GFX_TF_BILERP       2
+#define GFX_TF_AVERAGE      3
+
+#define GFX_MDSFT_CYCLETYPE 20
+#define GFX_CYC_1CYCLE      0
+#define GFX_CYC_2CYCLE      1
+#define GFX_CYC_COPY        2
+#define GFX_CYC_FILL        3
+
+// Render mode bits in the low other mode word.
+#define GFX_RM_Z_CMP    0x0010
+#define GFX_RM_Z_UPD    0x0020
+#define GFX_RM_IM_RD    0x0040
+#define GFX_RM_FORCE_BL 0x4000
+
+// Pixel sizes used by the image commands.
+#define GFX_IM_SIZ_4b  0
+#define GFX_IM_SIZ_8b  1
+#define GFX_IM_SIZ_16b 2
+#define GFX_IM_SIZ_32b 3
+
+// The F3DEX2 display list stack is 18 entries deep and its vertex buffer holds 32 vertices.
+#define GFX_DL_STACK_DEPTH  18
+#define GFX_VTX_BUFFER_SIZE 32
+
+//----------------------------------------------------------------------------------------------------------------------
+
+enum GFX_CLASS
+{
+	GFX_CLASS_FLOW,
+	GFX_CLASS_VERTEX,
+	GFX_CLASS_TRIANGLE,
+	GFX_CLASS_MATRIX,
+	GFX_CLASS_GEOMETRY_STATE,
+	GFX_CLASS_RDP_STATE,
+	GFX_CLASS_TEXTURE,
+	GFX_CLASS_RECTANGLE,
+	GFX_CLASS_SYNC,
+	GFX_CLASS_OTHER,
+
+	GFX_CLASS__COUNT,
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct GfxCommandDesc
+{
+	uint8_t opcode;
+	uint8_t commandClass;
+
+	// Fixed portion of the cost estimate, in RCP clock cycles. Anything that depends on the command's arguments
+	// (vertex counts, rectangle sizes, texture load sizes, etc) is added on top of this while decoding.
+	uint16_t rspCycles;
+	uint16_t rdpCycles;
+
+	const char* name;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+constexpr const char* const gGfxClassName[GFX_CLASS__COUNT] =
+{
+	"flow",      // GFX_CLASS_FLOW
+	"vertex",    // GFX_CLASS_VERTEX
+	"triangle",  // GFX_CLASS_TRIANGLE
+	"matrix",    // GFX_CLASS_MATRIX
+	"geometry",  // GFX_CLASS_GEOMETRY_STATE
+	"rdp_state", // GFX_CLASS_RDP_STATE
+	"texture",   // GFX_CLASS_TEXTURE
+	"rectangle", // GFX_CLASS_RECTANGLE
+	"sync",      // GFX_CLASS_SYNC
+	"other",     // GFX_CLASS_OTHER
+};
+
+// The RSP costs are rough per-command figures for F3DEX2 and the RDP costs only cover command setup and pipeline
+// stalls. They are meant for comparing display lists against each other, not for predicting frame times.
+constexpr GfxCommandDesc gGfxCommandDesc[] =
+{
+	{ GFX_OP_SPNOOP,           GFX_CLASS_OTHER,           8,   0,   "G_SPNOOP"           },
+	{ GFX_OP_VTX,              GFX_CLASS_VERTEX,          60,  0,   "G_VTX"              },
+	{ GFX_OP_MODIFYVTX,        GFX_CLASS_VERTEX,          30,  0,   "G_MODIFYVTX"        },
+	{ GFX_OP_CULLDL,           GFX_CLASS_FLOW,            40,  0,   "G_CULLDL"           },
+	{ GFX_OP_BRANCH_Z,         GFX_CLASS_FLOW,            40,  0,   "G_BRANCH_Z"         },
+	{ GFX_OP_TRI1,             GFX_CLASS_TRIANGLE,        70,  20,  "G_TRI1"             },
+	{ GFX_OP_TRI2,             GFX_CLASS_TRIANGLE,        130, 40,  "G_TRI2"             },
+	{ GFX_OP_QUAD,             GFX_CLASS_TRIANGLE,        130, 40,  "G_QUAD"             },
+	{ GFX_OP_SPECIAL_3,        GFX_CLASS_OTHER,           8,   0,   "G_SPECIAL_3"        },
+	{ GFX_OP_SPECIAL_2,        GFX_CLASS_OTHER,           8,   0,   "G_SPECIAL_2"        },
+	{ GFX_OP_SPECIAL_1,        GFX_CLASS_OTHER,           8,   0,   "G_SPECIAL_1"        },
+	{ GFX_OP_DMA_IO,           GFX_CLASS_OTHER,           40,  0,   "G_DMA_IO"           },
+	{ GFX_OP_TEXTURE,          GFX_CLASS_GEOMETRY_STATE,  12,  0,   "G_TEXTURE"          },
+	{ GFX_OP_POPMTX,           GFX_CLASS_MATRIX,          40,  0,   "G_POPMTX"           },
+	{ GFX_OP_GEOMETRYMODE,     GFX_CLASS_GEOMETRY_STATE,  12,  0,   "G_GEOMETRYMODE"     },
+	{ GFX_OP_MTX,              GFX_CLASS_MATRIX,          120, 0,   "G_MTX"              },
+	{ GFX_OP_MOVEWORD,         GFX_CLASS_GEOMETRY_STATE,  12,  0,   "G_MOVEWORD"         },
+	{ GFX_OP_MOVEMEM,          GFX_CLASS_GEOMETRY_STATE,  50,  0,   "G_MOVEMEM"          },
+	{ GFX_OP_LOAD_UCODE,       GFX_CLASS_OTHER,           400, 0,   "G_LOAD_UCODE"       },
+	{ GFX_OP_DL,               GFX_CLASS_FLOW,            30,  0,   "G_DL"               },
+	{ GFX_OP_ENDDL,            GFX_CLASS_FLOW,            10,  0,   "G_ENDDL"            },
+	{ GFX_OP_NOOP,             GFX_CLASS_OTHER,           8,   0,   "G_NOOP"             },
+	{ GFX_OP_RDPHALF_1,        GFX_CLASS_OTHER,           8,   0,   "G_RDPHALF_1"        },
+	{ GFX_OP_SETOTHERMODE_L,   GFX_CLASS_RDP_STATE,       12,  1,   "G_SETOTHERMODE_L"   },
+	{ GFX_OP_SETOTHERMODE_H,   GFX_CLASS_RDP_STATE,       12,  1,   "G_SETOTHERMODE_H"   },
+	{ GFX_OP_TEXRECT,          GFX_CLASS_RECTANGLE,       16,  10,  "G_TEXRECT"          },
+	{ GFX_OP_TEXRECTFLIP,      GFX_CLASS_RECTANGLE,       16,  10,  "G_TEXRECTFLIP"      },
+	{ GFX_OP_RDPLOADSYNC,      GFX_CLASS_SYNC,            8,   25,  "G_RDPLOADSYNC"      },
+	{ GFX_OP_RDPPIPESYNC,      GFX_CLASS_SYNC,            8,   50,  "G_RDPPIPESYNC"      },
+	{ GFX_OP_RDPTILESYNC,      GFX_CLASS_SYNC,            8,   25,  "G_RDPTILESYNC"      },
+	{ GFX_OP_RDPFULLSYNC,      GFX_CLASS_SYNC,            8,   100, "G_RDPFULLSYNC"      },
+	{ GFX_OP_SETKEYGB,         GFX_CLASS_RDP_STATE,       8,   1,   "G_SETKEYGB"         },
+	{ GFX_OP_SETKEYR,          GFX_CLASS_RDP_STATE,       8,   1,   "G_SETKEYR"          },
+	{ GFX_OP_SETCONVERT,       GFX_CLASS_RDP_STATE,       8,   1,   "G_SETCONVERT"       },
+	{ GFX_OP_SETSCISSOR,       GFX_CLASS_RDP_STATE,       8,   1,   "G_SETSCISSOR"       },
+	{ GFX_OP_SETPRIMDEPTH,     GFX_CLASS_RDP_STATE,       8,   1,   "G_SETPRIMDEPTH"     },
+	{ GFX_OP_RDPSETOTHERMODE,  GFX_CLASS_RDP_STATE,       8,   1,   "G_RDPSETOTHERMODE"  },
+	{ GFX_OP_LOADTLUT,         GFX_CLASS_TEXTURE,         8,   20,  "G_LOADTLUT"         },
+	{ GFX_OP_RDPHALF_2,        GFX_CLASS_OTHER,           8,   0,   "G_RDPHALF_2"        },
+	{ GFX_OP_SETTILESIZE,      GFX_CLASS_TEXTURE,         8,   1,   "G_SETTILESIZE"      },
+	{ GFX_OP_LOADBLOCK,        GFX_CLASS_TEXTURE,         8,   20,  "G_LOADBLOCK"        },
+	{ GFX_OP_LOADTILE,         GFX_CLASS_TEXTURE,         8,   20,  "G_LOADTILE"         },
+	{ GFX_OP_SETTILE,          GFX_CLASS_TEXTURE,         8,   1,   "G_SETTILE"          },
+	{ GFX_OP_FILLRECT,         GFX_CLASS_RECTANGLE,       8,   10,  "G_FILLRECT"         },
+	{ GFX_OP_SETFILLCOLOR,     GFX_CLASS_RDP_STATE,       8,   1,   "G_SETFILLCOLOR"     },
+	{ GFX_OP_SETFOGCOLOR,      GFX_CLASS_RDP_STATE,       8,   1,   "G_SETFOGCOLOR"      },
+	{ GFX_OP_SETBLENDCOLOR,    GFX_CLASS_RDP_STATE,       8,   1,   "G_SETBLENDCOLOR"    },
+	{ GFX_OP_SETPRIMCOLOR,     GFX_CLASS_RDP_STATE,       8,   1,   "G_SETPRIMCOLOR"     },
+	{ GFX_OP_SETENVCOLOR,      GFX_CLASS_RDP_STATE,       8,   1,   "G_SETENVCOLOR"      },
+	{ GFX_OP_SETCOMBINE,       GFX_CLASS_RDP_STATE,       8,   1,   "G_SETCOMBINE"       },
+	{ GFX_OP_SETTIMG,          GFX_CLASS_TEXTURE,         8,   1,   "G_SETTIMG"          },
+	{ GFX_OP_SETZIMG,          GFX_CLASS_RDP_STATE,       8,   1,   "G_SETZIMG"          },
+	{ GFX_OP_SETCIMG,          GFX_CLASS_RDP_STATE,       8,   1,   "G_SETCIMG"          },
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Resolve an address the same way the micro-code does: the top byte selects a segment (KSEG0 addresses land in
+// segment 0, which is always zero), then the result is masked down to a physical RDRAM address.
+inline uint32_t GfxResolveSegmentAddress(const uint32_t segment[16], const uint32_t address)
+{
+	return (segment[(address >> 24) & 0xF] + (address & 0x00FFFFFF)) & 0x00FFFFFF;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
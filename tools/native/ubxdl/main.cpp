@@ -0,0 +1,1509 @@
+//
+// Copyright (c) 2023, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "../common/build.hpp"
+#include "../common/file_buffer.hpp"
+#include "../common/gbi.hpp"
+#include "../common/log.hpp"
+
+#include <assert.h>
+#include <locale.h>
+#include <inttypes.h>
+#include <memory.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#define CXXOPTS_NO_RTTI
+#include <cxxopts.hpp>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define APP_EXIT_SUCCESS 0
+#define APP_EXIT_FAILURE 1
+
+#define APP_VERSION_MAJOR 1
+#define APP_VERSION_MINOR 0
+#define APP_VERSION_PATCH 0
+
+// Bump this whenever the layout of the JSON report changes so CI scripts comparing reports can tell.
+#define REPORT_VERSION 2
+
+// Bump this whenever the layout of the baseline file changes; baselines from another version are rejected.
+#define BASELINE_VERSION 1
+
+// The RSP and RDP both run at this rate.
+#define RCP_CLOCK_RATE 62500000
+
+// Decoding stops after this many commands by default, which catches display lists that loop back on themselves.
+#define DEFAULT_MAX_COMMAND_COUNT 1000000
+
+// Only this many findings are printed per display list unless verbose logging is enabled; the JSON has all of them.
+#define REPORT_MAX_FINDING_COUNT 32
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Cost model terms that depend on command arguments or render state, in RCP clock cycles.
+#define RSP_CYCLES_PER_VERTEX         24
+#define RSP_CYCLES_PER_LIT_VERTEX     16
+#define RSP_CYCLES_PER_TEXGEN_VERTEX  12
+#define RDP_TMEM_BYTES_PER_CYCLE      8
+#define RDP_CYCLES_PER_LOADTILE_ROW   4
+#define RDP_CYCLES_PER_TLUT_ENTRY     1
+
+// Rectangle fill rates in pixels per 4 cycles, so 2-cycle mode doesn't need fractions.
+#define RDP_PIXELS_PER_4_CYCLES_1CYCLE 4
+#define RDP_PIXELS_PER_4_CYCLES_2CYCLE 2
+#define RDP_PIXELS_PER_4_CYCLES_COPY   16
+#define RDP_PIXELS_PER_4_CYCLES_FILL   16
+
+//----------------------------------------------------------------------------------------------------------------------
+
+enum FINDING
+{
+	FINDING_REDUNDANT_STATE,
+	FINDING_UNNECESSARY_PIPE_SYNC,
+	FINDING_UNUSED_PIPE_SYNC,
+	FINDING_UNNECESSARY_LOAD_SYNC,
+	FINDING_UNNECESSARY_TILE_SYNC,
+	FINDING_EXTRA_FULL_SYNC,
+	FINDING_MISSING_PIPE_SYNC,
+	FINDING_STACK_OVERFLOW,
+	FINDING_VERTEX_OUT_OF_RANGE,
+	FINDING_INVALID_ADDRESS,
+	FINDING_UNKNOWN_COMMAND,
+	FINDING_COMMAND_LIMIT,
+
+	FINDING__COUNT,
+};
+
+enum SYNC
+{
+	SYNC_PIPE,
+	SYNC_LOAD,
+	SYNC_TILE,
+
+	SYNC__COUNT,
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+constexpr const char* const gFindingName[FINDING__COUNT] =
+{
+	"redundant_state",       // FINDING_REDUNDANT_STATE
+	"unnecessary_pipe_sync", // FINDING_UNNECESSARY_PIPE_SYNC
+	"unused_pipe_sync",      // FINDING_UNUSED_PIPE_SYNC
+	"unnecessary_load_sync", // FINDING_UNNECESSARY_LOAD_SYNC
+	"unnecessary_tile_sync", // FINDING_UNNECESSARY_TILE_SYNC
+	"extra_full_sync",       // FINDING_EXTRA_FULL_SYNC
+	"missing_pipe_sync",     // FINDING_MISSING_PIPE_SYNC
+	"stack_overflow",        // FINDING_STACK_OVERFLOW
+	"vertex_out_of_range",   // FINDING_VERTEX_OUT_OF_RANGE
+	"invalid_address",       // FINDING_INVALID_ADDRESS
+	"unknown_command",       // FINDING_UNKNOWN_COMMAND
+	"command_limit",         // FINDING_COMMAND_LIMIT
+};
+
+constexpr const char* const gFindingMessage[FINDING__COUNT] =
+{
+	"Sets state to the value it already has",                                // FINDING_REDUNDANT_STATE
+	"No primitive was drawn since the previous pipe sync",                   // FINDING_UNNECESSARY_PIPE_SYNC
+	"Pipe sync is followed by a primitive without any RDP state change",     // FINDING_UNUSED_PIPE_SYNC
+	"No primitive was drawn since the previous load sync",                   // FINDING_UNNECESSARY_LOAD_SYNC
+	"No primitive was drawn since the previous tile sync",                   // FINDING_UNNECESSARY_TILE_SYNC
+	"Full sync is not the only one in the display list",                     // FINDING_EXTRA_FULL_SYNC
+	"Changes RDP render state after a primitive without a pipe sync",        // FINDING_MISSING_PIPE_SYNC
+	"Display list call exceeds the micro-code's display list stack depth",   // FINDING_STACK_OVERFLOW
+	"Uses a vertex slot outside the buffer or not loaded by the list",       // FINDING_VERTEX_OUT_OF_RANGE
+	"Address does not resolve to data in the input file; command skipped",   // FINDING_INVALID_ADDRESS
+	"Not an F3DEX2 command; decoding of this display list stopped",          // FINDING_UNKNOWN_COMMAND
+	"Command limit reached, the display list may loop; decoding stopped",    // FINDING_COMMAND_LIMIT
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct ClassStats
+{
+	uint64_t count = 0;
+	uint64_t rspCycles = 0;
+	uint64_t rdpCycles = 0;
+};
+
+struct Finding
+{
+	uint32_t address;
+	uint32_t w0;
+	uint32_t w1;
+	FINDING type;
+	bool hasCommand;
+};
+
+struct DisplayListReport
+{
+	ClassStats classStats[GFX_CLASS__COUNT];
+	std::vector<Finding> findings;
+
+	uint64_t commandCount = 0;
+	uint64_t callCount = 0;
+	uint64_t branchCount = 0;
+	uint64_t vertexCount = 0;
+	uint64_t triangleCount = 0;
+	uint64_t rectangleCount = 0;
+	uint64_t rectanglePixelCount = 0;
+	uint64_t textureLoadBytes = 0;
+	uint64_t rspCycles = 0;
+	uint64_t rdpCycles = 0;
+
+	uint32_t rootAddress = 0;
+	uint32_t maxDepth = 0;
+};
+
+struct BaselineEntry
+{
+	uint32_t address;
+	uint64_t commandCount;
+	uint64_t vertexCount;
+	uint64_t syncCount;
+};
+
+struct DecoderState
+{
+	// Nothing is known about the render state when a display list is entered, so every tracked value carries a mask
+	// of the bits that have been set by the display list itself. Values outside the mask are never compared.
+	std::unordered_map<uint32_t, uint64_t> lastStateCommand;
+
+	uint32_t segment[16];
+
+	uint32_t otherMode[2];
+	uint32_t otherModeKnown[2];
+
+	uint32_t geometryMode;
+	uint32_t geometryModeKnown;
+
+	// One bit for each slot of the vertex buffer that a G_VTX in the display list has loaded.
+	uint32_t loadedVertexMask;
+
+	// Primitives drawn since the last sync of each kind; negative while it's not known whether a sync is needed.
+	int64_t primitivesSinceSync[SYNC__COUNT];
+
+	uint32_t pendingPipeSyncAddress;
+	bool pipeSyncPending;
+
+	uint32_t fullSyncCount;
+	uint8_t textureImageSize;
+};
+
+struct DecoderConfig
+{
+	const FileBuffer* pInput;
+
+	uint32_t baseAddress;
+	uint32_t segment[16];
+	uint64_t maxCommandCount;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const GfxCommandDesc* gCommandLookup[256] = {};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ParseNumber(const std::string& text, uint32_t& output)
+{
+	if(text.empty())
+	{
+		return false;
+	}
+
+	char* pEnd = nullptr;
+	const unsigned long long value = strtoull(text.c_str(), &pEnd, 0);
+
+	if(*pEnd != '\0' || value > UINT32_MAX)
+	{
+		return false;
+	}
+
+	output = uint32_t(value);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string EscapeJsonString(const std::string_view& text)
+{
+	std::string output;
+	output.reserve(text.size());
+
+	for(const char c : text)
+	{
+		switch(c)
+		{
+			case '"':  output += "\\\""; break;
+			case '\\': output += "\\\\"; break;
+			case '\t': output += "\\t"; break;
+
+			default:
+				if(uint8_t(c) >= 0x20)
+				{
+					output += c;
+				}
+				break;
+		}
+	}
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ResolveAddress(const DecoderConfig& config, const DecoderState& state, const uint32_t address, uint32_t& output)
+{
+	const uint32_t physAddr = GfxResolveSegmentAddress(state.segment, address);
+
+	if(physAddr < config.baseAddress || (physAddr & 0x7) != 0)
+	{
+		return false;
+	}
+
+	if(size_t(physAddr - config.baseAddress) + sizeof(uint64_t) > config.pInput->length)
+	{
+		return false;
+	}
+
+	output = physAddr;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ReadCommand(const DecoderConfig& config, const uint32_t physAddr, uint32_t& w0, uint32_t& w1)
+{
+	const uint8_t* const pData = config.pInput->data.get() + (physAddr - config.baseAddress);
+
+	// Display lists are always stored big-endian.
+	w0 = (uint32_t(pData[0]) << 24) | (uint32_t(pData[1]) << 16) | (uint32_t(pData[2]) << 8) | uint32_t(pData[3]);
+	w1 = (uint32_t(pData[4]) << 24) | (uint32_t(pData[5]) << 16) | (uint32_t(pData[6]) << 8) | uint32_t(pData[7]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void AddFinding(
+	DisplayListReport& report,
+	const FINDING type,
+	const uint32_t address,
+	const uint32_t w0,
+	const uint32_t w1,
+	const bool hasCommand = true)
+{
+	Finding finding;
+	finding.address = address;
+	finding.w0 = w0;
+	finding.w1 = w1;
+	finding.type = type;
+	finding.hasCommand = hasCommand;
+
+	report.findings.push_back(finding);
+
+	LOG_VERBOSE_FMT("  ^ %s: %s", gFindingName[type], gFindingMessage[type]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const char* GetFindingCommandName(const Finding& finding)
+{
+	if(!finding.hasCommand)
+	{
+		return "-";
+	}
+
+	const GfxCommandDesc* const pDesc = gCommandLookup[finding.w0 >> 24];
+	return pDesc ? pDesc->name : "???";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool UpdateMaskedState(uint32_t& value, uint32_t& knownMask, const uint32_t changeMask, const uint32_t newBits)
+{
+	// Returns true when the update changes nothing the display list has already set itself.
+	const bool redundant = ((knownMask & changeMask) == changeMask) && (((value ^ newBits) & changeMask) == 0);
+
+	value = (value & ~changeMask) | (newBits & changeMask);
+	knownMask |= changeMask;
+
+	return redundant;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool UpdateCommandState(DecoderState& state, const uint32_t key, const uint32_t w0, const uint32_t w1)
+{
+	const uint64_t command = (uint64_t(w0) << 32) | uint64_t(w1);
+
+	auto iter = state.lastStateCommand.find(key);
+	if(iter != state.lastStateCommand.end() && iter->second == command)
+	{
+		return true;
+	}
+
+	state.lastStateCommand[key] = command;
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool AreTriangleVerticesLoaded(const DecoderState& state, const uint32_t indices)
+{
+	static_assert(GFX_VTX_BUFFER_SIZE <= 32, "The loaded vertex mask needs a bit for every vertex buffer slot");
+
+	// Triangle commands store each of their three vertex indices doubled in its own byte of the low 24 bits.
+	for(int i = 0; i < 3; ++i)
+	{
+		const uint32_t index = ((indices >> (i * 8)) & 0xFF) / 2;
+
+		if(index >= GFX_VTX_BUFFER_SIZE || !(state.loadedVertexMask & (1u << index)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint32_t GetCycleType(const DecoderState& state)
+{
+	// Assume 1-cycle mode until the display list picks one.
+	if(((state.otherModeKnown[0] >> GFX_MDSFT_CYCLETYPE) & 0x3) != 0x3)
+	{
+		return GFX_CYC_1CYCLE;
+	}
+
+	return (state.otherMode[0] >> GFX_MDSFT_CYCLETYPE) & 0x3;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint64_t GetRectanglePixelCount(const DecoderState& state, const uint32_t w0, const uint32_t w1)
+{
+	const uint32_t cycleType = GetCycleType(state);
+	const bool inclusive = (cycleType == GFX_CYC_COPY || cycleType == GFX_CYC_FILL);
+
+	// Both rectangle commands store the lower-right corner in the first word and the upper-left one in the second,
+	// as 10.2 fixed point. Fill and copy modes draw the lower-right edges, the other modes don't.
+	const int32_t lrx = int32_t((w0 >> 12) & 0xFFF) >> 2;
+	const int32_t lry = int32_t(w0 & 0xFFF) >> 2;
+	const int32_t ulx = int32_t((w1 >> 12) & 0xFFF) >> 2;
+	const int32_t uly = int32_t(w1 & 0xFFF) >> 2;
+
+	const int32_t width = lrx - ulx + (inclusive ? 1 : 0);
+	const int32_t height = lry - uly + (inclusive ? 1 : 0);
+
+	return (width > 0 && height > 0) ? uint64_t(width) * uint64_t(height) : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint64_t GetRectangleRdpCycles(const DecoderState& state, const uint64_t pixelCount)
+{
+	uint64_t pixelsPer4Cycles;
+
+	switch(GetCycleType(state))
+	{
+		case GFX_CYC_2CYCLE: pixelsPer4Cycles = RDP_PIXELS_PER_4_CYCLES_2CYCLE; break;
+		case GFX_CYC_COPY:   pixelsPer4Cycles = RDP_PIXELS_PER_4_CYCLES_COPY;   break;
+		case GFX_CYC_FILL:   pixelsPer4Cycles = RDP_PIXELS_PER_4_CYCLES_FILL;   break;
+
+		default:
+			pixelsPer4Cycles = RDP_PIXELS_PER_4_CYCLES_1CYCLE;
+			break;
+	}
+
+	return ((pixelCount * 4) + (pixelsPer4Cycles - 1)) / pixelsPer4Cycles;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CheckSync(DecoderState& state, DisplayListReport& report, const SYNC sync, const uint32_t address, const uint32_t w0, const uint32_t w1)
+{
+	constexpr FINDING findings[SYNC__COUNT] =
+	{
+		FINDING_UNNECESSARY_PIPE_SYNC, // SYNC_PIPE
+		FINDING_UNNECESSARY_LOAD_SYNC, // SYNC_LOAD
+		FINDING_UNNECESSARY_TILE_SYNC, // SYNC_TILE
+	};
+
+	if(state.primitivesSinceSync[sync] == 0)
+	{
+		AddFinding(report, findings[sync], address, w0, w1);
+	}
+
+	state.primitivesSinceSync[sync] = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void OnPrimitive(DecoderState& state, DisplayListReport& report)
+{
+	// Once a primitive is drawn the display list itself needs a sync, whether or not it has issued one before.
+	for(int i = 0; i < SYNC__COUNT; ++i)
+	{
+		state.primitivesSinceSync[i] = (state.primitivesSinceSync[i] > 0) ? (state.primitivesSinceSync[i] + 1) : 1;
+	}
+
+	if(state.pipeSyncPending)
+	{
+		AddFinding(report, FINDING_UNUSED_PIPE_SYNC, state.pendingPipeSyncAddress, uint32_t(GFX_OP_RDPPIPESYNC) << 24, 0);
+		state.pipeSyncPending = false;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void OnRdpStateChange(DecoderState& state, DisplayListReport& report, const bool hazard, const uint32_t address, const uint32_t w0, const uint32_t w1)
+{
+	// Changing the render state while a primitive may still be in the pipeline corrupts the primitive.
+	if(hazard && state.primitivesSinceSync[SYNC_PIPE] > 0)
+	{
+		AddFinding(report, FINDING_MISSING_PIPE_SYNC, address, w0, w1);
+
+		// Only report the first change after each primitive.
+		state.primitivesSinceSync[SYNC_PIPE] = -1;
+	}
+
+	state.pipeSyncPending = false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void DecodeDisplayList(const DecoderConfig& config, const uint32_t rootAddress, DisplayListReport& report)
+{
+	DecoderState state = {};
+
+	memcpy(state.segment, config.segment, sizeof(state.segment));
+
+	for(int i = 0; i < SYNC__COUNT; ++i)
+	{
+		state.primitivesSinceSync[i] = -1;
+	}
+
+	report.rootAddress = rootAddress;
+
+	uint32_t pc;
+	if(!ResolveAddress(config, state, rootAddress, pc))
+	{
+		AddFinding(report, FINDING_INVALID_ADDRESS, rootAddress, 0, 0, false);
+		return;
+	}
+
+	std::vector<uint32_t> returnStack;
+
+	for(;;)
+	{
+		if(report.commandCount >= config.maxCommandCount)
+		{
+			AddFinding(report, FINDING_COMMAND_LIMIT, pc, 0, 0, false);
+			break;
+		}
+
+		const uint32_t address = pc;
+
+		uint32_t w0;
+		uint32_t w1;
+		ReadCommand(config, address, w0, w1);
+
+		pc += sizeof(uint64_t);
+
+		const uint8_t opcode = uint8_t(w0 >> 24);
+		const GfxCommandDesc* const pDesc = gCommandLookup[opcode];
+
+		if(!pDesc)
+		{
+			LOG_VERBOSE_FMT("%08" PRIX32 ": %*s%08" PRIX32 " %08" PRIX32 " ???", address, int(returnStack.size() * 2), "", w0, w1);
+			AddFinding(report, FINDING_UNKNOWN_COMMAND, address, w0, w1);
+			break;
+		}
+
+		LOG_VERBOSE_FMT("%08" PRIX32 ": %*s%08" PRIX32 " %08" PRIX32 " %s", address, int(returnStack.size() * 2), "", w0, w1, pDesc->name);
+
+		uint64_t rspCycles = pDesc->rspCycles;
+		uint64_t rdpCycles = pDesc->rdpCycles;
+
+		bool redundant = false;
+		bool endOfList = false;
+
+		switch(opcode)
+		{
+			case GFX_OP_DL:
+			{
+				uint32_t target;
+				if(!ResolveAddress(config, state, w1, target))
+				{
+					AddFinding(report, FINDING_INVALID_ADDRESS, address, w0, w1);
+					break;
+				}
+
+				if(((w0 >> 16) & 0xFF) == GFX_DL_PUSH)
+				{
+					++report.callCount;
+
+					if(returnStack.size() >= GFX_DL_STACK_DEPTH)
+					{
+						AddFinding(report, FINDING_STACK_OVERFLOW, address, w0, w1);
+					}
+
+					returnStack.push_back(pc);
+
+					report.maxDepth = (uint32_t(returnStack.size()) > report.maxDepth) ? uint32_t(returnStack.size()) : report.maxDepth;
+				}
+				else
+				{
+					// Without the push, the display list jumps to the target and never comes back.
+					++report.branchCount;
+				}
+
+				pc = target;
+				break;
+			}
+
+			case GFX_OP_ENDDL:
+				if(returnStack.empty())
+				{
+					endOfList = true;
+				}
+				else
+				{
+					pc = returnStack.back();
+					returnStack.pop_back();
+				}
+				break;
+
+			case GFX_OP_VTX:
+			{
+				// The command stores the vertex count and the doubled index of the slot just past the last one loaded.
+				const uint32_t vertexCount = (w0 >> 12) & 0xFF;
+				const uint32_t endIndex = (w0 & 0xFF) / 2;
+
+				if(endIndex > GFX_VTX_BUFFER_SIZE || vertexCount > endIndex)
+				{
+					AddFinding(report, FINDING_VERTEX_OUT_OF_RANGE, address, w0, w1);
+				}
+				else
+				{
+					for(uint32_t i = endIndex - vertexCount; i < endIndex; ++i)
+					{
+						state.loadedVertexMask |= 1u << i;
+					}
+				}
+
+				uint32_t perVertexCycles = RSP_CYCLES_PER_VERTEX;
+
+				if(state.geometryMode & state.geometryModeKnown & GFX_GEOMETRY_LIGHTING)
+				{
+					perVertexCycles += RSP_CYCLES_PER_LIT_VERTEX;
+
+					if(state.geometryMode & state.geometryModeKnown & GFX_GEOMETRY_TEXTURE_GEN)
+					{
+						perVertexCycles += RSP_CYCLES_PER_TEXGEN_VERTEX;
+					}
+				}
+
+				report.vertexCount += vertexCount;
+				rspCycles += uint64_t(vertexCount) * perVertexCycles;
+				break;
+			}
+
+			case GFX_OP_TRI1:
+				if(!AreTriangleVerticesLoaded(state, w0))
+				{
+					AddFinding(report, FINDING_VERTEX_OUT_OF_RANGE, address, w0, w1);
+				}
+
+				++report.triangleCount;
+				OnPrimitive(state, report);
+				break;
+
+			case GFX_OP_TRI2:
+			case GFX_OP_QUAD:
+				// Both words hold a triangle in the same layout.
+				if(!AreTriangleVerticesLoaded(state, w0) || !AreTriangleVerticesLoaded(state, w1))
+				{
+					AddFinding(report, FINDING_VERTEX_OUT_OF_RANGE, address, w0, w1);
+				}
+
+				report.triangleCount += 2;
+				OnPrimitive(state, report);
+				break;
+
+			case GFX_OP_FILLRECT:
+			case GFX_OP_TEXRECT:
+			case GFX_OP_TEXRECTFLIP:
+			{
+				const uint64_t pixelCount = GetRectanglePixelCount(state, w0, w1);
+
+				++report.rectangleCount;
+				report.rectanglePixelCount += pixelCount;
+				rdpCycles += GetRectangleRdpCycles(state, pixelCount);
+
+				OnPrimitive(state, report);
+				break;
+			}
+
+			case GFX_OP_GEOMETRYMODE:
+			{
+				// The first word holds the bits to keep and the second holds the bits to set.
+				const uint32_t changeMask = (~w0 & 0x00FFFFFF) | w1;
+				const uint32_t newBits = (state.geometryMode & w0 & 0x00FFFFFF) | w1;
+
+				redundant = UpdateMaskedState(state.geometryMode, state.geometryModeKnown, changeMask, newBits);
+				break;
+			}
+
+			case GFX_OP_MOVEWORD:
+				if(((w0 >> 16) & 0xFF) == GFX_MW_SEGMENT)
+				{
+					const uint32_t segmentIndex = ((w0 & 0xFFFF) >> 2) & 0xF;
+
+					redundant = (state.segment[segmentIndex] == w1);
+					state.segment[segmentIndex] = w1;
+				}
+				break;
+
+			case GFX_OP_SETOTHERMODE_L:
+			case GFX_OP_SETOTHERMODE_H:
+			{
+				const uint32_t index = (opcode == GFX_OP_SETOTHERMODE_H) ? 0 : 1;
+				const uint32_t length = (w0 & 0xFF) + 1;
+				const uint32_t shift = 32 - ((w0 >> 8) & 0xFF) - length;
+				const uint32_t changeMask = (length >= 32) ? 0xFFFFFFFF : (((1u << length) - 1) << shift);
+
+				redundant = UpdateMaskedState(state.otherMode[index], state.otherModeKnown[index], changeMask, w1);
+
+				OnRdpStateChange(state, report, !redundant, address, w0, w1);
+				break;
+			}
+
+			case GFX_OP_RDPSETOTHERMODE:
+			{
+				const bool highRedundant = UpdateMaskedState(state.otherMode[0], state.otherModeKnown[0], 0x00FFFFFF, w0);
+				const bool lowRedundant = UpdateMaskedState(state.otherMode[1], state.otherModeKnown[1], 0xFFFFFFFF, w1);
+
+				redundant = highRedundant && lowRedundant;
+
+				OnRdpStateChange(state, report, !redundant, address, w0, w1);
+				break;
+			}
+
+			case GFX_OP_SETCOMBINE:
+			case GFX_OP_SETZIMG:
+			case GFX_OP_SETCIMG:
+				redundant = UpdateCommandState(state, opcode, w0, w1);
+
+				OnRdpStateChange(state, report, !redundant, address, w0, w1);
+				break;
+
+			case GFX_OP_TEXTURE:
+				redundant = UpdateCommandState(state, opcode, w0, w1);
+				break;
+
+			case GFX_OP_SETTIMG:
+				redundant = UpdateCommandState(state, opcode, w0, w1);
+				state.textureImageSize = uint8_t((w0 >> 19) & 0x3);
+
+				OnRdpStateChange(state, report, false, address, w0, w1);
+				break;
+
+			case GFX_OP_SETTILE:
+			case GFX_OP_SETTILESIZE:
+				// Each of the eight tile descriptors is tracked on its own.
+				redundant = UpdateCommandState(state, (uint32_t(opcode) << 8) | ((w1 >> 24) & 0x7), w0, w1);
+
+				OnRdpStateChange(state, report, false, address, w0, w1);
+				break;
+
+			case GFX_OP_SETKEYGB:
+			case GFX_OP_SETKEYR:
+			case GFX_OP_SETCONVERT:
+			case GFX_OP_SETSCISSOR:
+			case GFX_OP_SETPRIMDEPTH:
+			case GFX_OP_SETFILLCOLOR:
+			case GFX_OP_SETFOGCOLOR:
+			case GFX_OP_SETBLENDCOLOR:
+			case GFX_OP_SETPRIMCOLOR:
+			case GFX_OP_SETENVCOLOR:
+				redundant = UpdateCommandState(state, opcode, w0, w1);
+
+				OnRdpStateChange(state, report, false, address, w0, w1);
+				break;
+
+			case GFX_OP_LOADBLOCK:
+			case GFX_OP_LOADTILE:
+			{
+				uint64_t texelCount;
+				uint64_t rowCount = 0;
+
+				if(opcode == GFX_OP_LOADBLOCK)
+				{
+					// Block loads store the texel count minus one in place of the lower-right S coordinate.
+					const uint32_t uls = (w0 >> 12) & 0xFFF;
+					const uint32_t lrs = (w1 >> 12) & 0xFFF;
+
+					texelCount = (lrs >= uls) ? (lrs - uls + 1) : 0;
+				}
+				else
+				{
+					const uint32_t uls = ((w0 >> 12) & 0xFFF) >> 2;
+					const uint32_t ult = (w0 & 0xFFF) >> 2;
+					const uint32_t lrs = ((w1 >> 12) & 0xFFF) >> 2;
+					const uint32_t lrt = (w1 & 0xFFF) >> 2;
+
+					rowCount = (lrt >= ult) ? (lrt - ult + 1) : 0;
+					texelCount = ((lrs >= uls) ? (lrs - uls + 1) : 0) * rowCount;
+				}
+
+				const uint64_t byteCount = (texelCount * (4u << state.textureImageSize)) / 8;
+
+				report.textureLoadBytes += byteCount;
+				rdpCycles += (byteCount / RDP_TMEM_BYTES_PER_CYCLE) + (rowCount * RDP_CYCLES_PER_LOADTILE_ROW);
+
+				// Loads overwrite the size of the tile they go through.
+				state.lastStateCommand.erase((uint32_t(GFX_OP_SETTILESIZE) << 8) | ((w1 >> 24) & 0x7));
+
+				OnRdpStateChange(state, report, false, address, w0, w1);
+				break;
+			}
+
+			case GFX_OP_LOADTLUT:
+			{
+				const uint64_t entryCount = ((w1 >> 14) & 0x3FF) + 1;
+
+				report.textureLoadBytes += entryCount * sizeof(uint16_t);
+				rdpCycles += entryCount * RDP_CYCLES_PER_TLUT_ENTRY;
+
+				OnRdpStateChange(state, report, false, address, w0, w1);
+				break;
+			}
+
+			case GFX_OP_RDPPIPESYNC:
+				CheckSync(state, report, SYNC_PIPE, address, w0, w1);
+
+				state.pipeSyncPending = true;
+				state.pendingPipeSyncAddress = address;
+				break;
+
+			case GFX_OP_RDPLOADSYNC:
+				CheckSync(state, report, SYNC_LOAD, address, w0, w1);
+				break;
+
+			case GFX_OP_RDPTILESYNC:
+				CheckSync(state, report, SYNC_TILE, address, w0, w1);
+				break;
+
+			case GFX_OP_RDPFULLSYNC:
+				if(++state.fullSyncCount > 1)
+				{
+					AddFinding(report, FINDING_EXTRA_FULL_SYNC, address, w0, w1);
+				}
+
+				// A full sync waits for the whole pipeline, so no other sync is needed right after it.
+				for(int i = 0; i < SYNC__COUNT; ++i)
+				{
+					state.primitivesSinceSync[i] = 0;
+				}
+				break;
+
+			default:
+				break;
+		}
+
+		if(redundant)
+		{
+			AddFinding(report, FINDING_REDUNDANT_STATE, address, w0, w1);
+		}
+
+		ClassStats& stats = report.classStats[pDesc->commandClass];
+
+		++stats.count;
+		stats.rspCycles += rspCycles;
+		stats.rdpCycles += rdpCycles;
+
+		++report.commandCount;
+		report.rspCycles += rspCycles;
+		report.rdpCycles += rdpCycles;
+
+		if(endOfList)
+		{
+			break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void PrintReport(const DisplayListReport& report)
+{
+	auto toMicroseconds = [](const uint64_t cycles)
+	{
+		return double(cycles) * 1000000.0 / double(RCP_CLOCK_RATE);
+	};
+
+	LOG_INFO_FMT("Display list 0x%08" PRIX32 ":", report.rootAddress);
+	LOG_INFO_FMT(
+		"  Commands:          %" PRIu64 " (%" PRIu64 " calls, %" PRIu64 " branches, max depth %" PRIu32 ")",
+		report.commandCount,
+		report.callCount,
+		report.branchCount,
+		report.maxDepth);
+	LOG_INFO_FMT("  Vertices:          %" PRIu64, report.vertexCount);
+	LOG_INFO_FMT("  Triangles:         %" PRIu64, report.triangleCount);
+	LOG_INFO_FMT("  Rectangles:        %" PRIu64 " (%" PRIu64 " pixels)", report.rectangleCount, report.rectanglePixelCount);
+	LOG_INFO_FMT("  Texture loads:     %" PRIu64 " bytes", report.textureLoadBytes);
+	LOG_INFO_FMT("  Estimated RSP:     %" PRIu64 " cycles (%.1f us)", report.rspCycles, toMicroseconds(report.rspCycles));
+	LOG_INFO_FMT("  Estimated RDP:     %" PRIu64 " cycles (%.1f us, excluding triangle fill)", report.rdpCycles, toMicroseconds(report.rdpCycles));
+	LOG_INFO("  Command classes:");
+
+	for(int i = 0; i < GFX_CLASS__COUNT; ++i)
+	{
+		const ClassStats& stats = report.classStats[i];
+
+		if(stats.count > 0)
+		{
+			LOG_INFO_FMT(
+				"    %-12s %8" PRIu64 " commands  %10" PRIu64 " RSP cycles  %10" PRIu64 " RDP cycles",
+				gGfxClassName[i],
+				stats.count,
+				stats.rspCycles,
+				stats.rdpCycles);
+		}
+	}
+
+	LOG_INFO_FMT("  Findings:          %zu", report.findings.size());
+
+	const size_t printCount = (gLogLevel == LogLevel::Verbose || report.findings.size() <= REPORT_MAX_FINDING_COUNT)
+		? report.findings.size()
+		: REPORT_MAX_FINDING_COUNT;
+
+	for(size_t i = 0; i < printCount; ++i)
+	{
+		const Finding& finding = report.findings[i];
+
+		LOG_INFO_FMT(
+			"    0x%08" PRIX32 " %-18s %s",
+			finding.address,
+			GetFindingCommandName(finding),
+			gFindingMessage[finding.type]);
+	}
+
+	if(printCount < report.findings.size())
+	{
+		LOG_INFO_FMT("    ... and %zu more (see the JSON report)", report.findings.size() - printCount);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string BuildJsonReport(const std::string_view& inputFilePath, const std::vector<DisplayListReport>& reports)
+{
+	std::string output;
+	char buffer[256];
+
+	snprintf(buffer, sizeof(buffer), "{\n\t\"version\": %d,\n\t\"input\": \"", REPORT_VERSION);
+	output += buffer;
+	output += EscapeJsonString(inputFilePath);
+	output += "\",\n\t\"displayLists\": [";
+
+	for(size_t reportIndex = 0; reportIndex < reports.size(); ++reportIndex)
+	{
+		const DisplayListReport& report = reports[reportIndex];
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"%s\n\t\t{\n\t\t\t\"address\": \"0x%08" PRIX32 "\",\n\t\t\t\"commandCount\": %" PRIu64 ",\n\t\t\t\"callCount\": %" PRIu64 ",\n\t\t\t\"branchCount\": %" PRIu64 ",\n\t\t\t\"maxDepth\": %" PRIu32 ",\n",
+			(reportIndex > 0) ? "," : "",
+			report.rootAddress,
+			report.commandCount,
+			report.callCount,
+			report.branchCount,
+			report.maxDepth);
+		output += buffer;
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"\t\t\t\"vertexCount\": %" PRIu64 ",\n\t\t\t\"triangleCount\": %" PRIu64 ",\n\t\t\t\"rectangleCount\": %" PRIu64 ",\n\t\t\t\"rectanglePixelCount\": %" PRIu64 ",\n",
+			report.vertexCount,
+			report.triangleCount,
+			report.rectangleCount,
+			report.rectanglePixelCount);
+		output += buffer;
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"\t\t\t\"textureLoadBytes\": %" PRIu64 ",\n\t\t\t\"rspCycles\": %" PRIu64 ",\n\t\t\t\"rdpCycles\": %" PRIu64 ",\n\t\t\t\"classes\": {",
+			report.textureLoadBytes,
+			report.rspCycles,
+			report.rdpCycles);
+		output += buffer;
+
+		for(int i = 0; i < GFX_CLASS__COUNT; ++i)
+		{
+			const ClassStats& stats = report.classStats[i];
+
+			snprintf(
+				buffer,
+				sizeof(buffer),
+				"%s\n\t\t\t\t\"%s\": { \"count\": %" PRIu64 ", \"rspCycles\": %" PRIu64 ", \"rdpCycles\": %" PRIu64 " }",
+				(i > 0) ? "," : "",
+				gGfxClassName[i],
+				stats.count,
+				stats.rspCycles,
+				stats.rdpCycles);
+			output += buffer;
+		}
+
+		output += "\n\t\t\t},\n\t\t\t\"findings\": [";
+
+		for(size_t i = 0; i < report.findings.size(); ++i)
+		{
+			const Finding& finding = report.findings[i];
+
+			snprintf(
+				buffer,
+				sizeof(buffer),
+				"%s\n\t\t\t\t{ \"address\": \"0x%08" PRIX32 "\", \"type\": \"%s\", \"command\": \"%s\", \"words\": \"%08" PRIX32 "%08" PRIX32 "\" }",
+				(i > 0) ? "," : "",
+				finding.address,
+				gFindingName[finding.type],
+				GetFindingCommandName(finding),
+				finding.w0,
+				finding.w1);
+			output += buffer;
+		}
+
+		output += report.findings.empty() ? "]\n\t\t}" : "\n\t\t\t]\n\t\t}";
+	}
+
+	output += reports.empty() ? "]\n}\n" : "\n\t]\n}\n";
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+BaselineEntry GetBaselineEntry(const DisplayListReport& report)
+{
+	BaselineEntry entry;
+	entry.address = report.rootAddress;
+	entry.commandCount = report.commandCount;
+	entry.vertexCount = report.vertexCount;
+	entry.syncCount = report.classStats[GFX_CLASS_SYNC].count;
+
+	return entry;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string BuildBaseline(const std::vector<DisplayListReport>& reports)
+{
+	std::string output;
+	char buffer[256];
+
+	// Only the counts are stored, one display list per line, so the baseline doesn't change with the cost model and
+	// stays easy to review when it's checked in.
+	snprintf(buffer, sizeof(buffer), "{\n\t\"version\": %d,\n\t\"displayLists\": [", BASELINE_VERSION);
+	output += buffer;
+
+	for(size_t i = 0; i < reports.size(); ++i)
+	{
+		const BaselineEntry entry = GetBaselineEntry(reports[i]);
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"%s\n\t\t{ \"address\": \"0x%08" PRIX32 "\", \"commandCount\": %" PRIu64 ", \"vertexCount\": %" PRIu64 ", \"syncCount\": %" PRIu64 " }",
+			(i > 0) ? "," : "",
+			entry.address,
+			entry.commandCount,
+			entry.vertexCount,
+			entry.syncCount);
+		output += buffer;
+	}
+
+	output += reports.empty() ? "]\n}\n" : "\n\t]\n}\n";
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ParseBaseline(const FileBuffer& file, std::vector<BaselineEntry>& output)
+{
+	const std::string text(reinterpret_cast<const char*>(file.data.get()), file.length);
+
+	int version = 0;
+	size_t lineStart = 0;
+
+	while(lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		if(lineEnd == std::string::npos)
+		{
+			lineEnd = text.size();
+		}
+
+		const std::string line = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
+		if(line.find("\"version\"") != std::string::npos)
+		{
+			if(sscanf(line.c_str(), " \"version\": %d", &version) != 1)
+			{
+				return false;
+			}
+		}
+		else if(line.find("\"address\"") != std::string::npos)
+		{
+			BaselineEntry entry;
+
+			const int fieldCount = sscanf(
+				line.c_str(),
+				" { \"address\": \"0x%" SCNx32 "\", \"commandCount\": %" SCNu64 ", \"vertexCount\": %" SCNu64 ", \"syncCount\": %" SCNu64,
+				&entry.address,
+				&entry.commandCount,
+				&entry.vertexCount,
+				&entry.syncCount);
+
+			if(fieldCount != 4)
+			{
+				return false;
+			}
+
+			output.push_back(entry);
+		}
+	}
+
+	if(version != BASELINE_VERSION)
+	{
+		LOG_ERROR_FMT("Baseline version %d is not supported (expected %d)", version, BASELINE_VERSION);
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t CompareWithBaseline(
+	const std::vector<DisplayListReport>& reports,
+	const std::vector<BaselineEntry>& baseline,
+	const uint32_t tolerancePercent)
+{
+	size_t regressionCount = 0;
+
+	for(const DisplayListReport& report : reports)
+	{
+		const BaselineEntry current = GetBaselineEntry(report);
+		const BaselineEntry* pBase = nullptr;
+
+		for(const BaselineEntry& entry : baseline)
+		{
+			if(entry.address == current.address)
+			{
+				pBase = &entry;
+				break;
+			}
+		}
+
+		if(!pBase)
+		{
+			LOG_WARN_FMT("Display list 0x%08" PRIX32 " is not in the baseline", current.address);
+			continue;
+		}
+
+		const struct
+		{
+			const char* name;
+			uint64_t base;
+			uint64_t current;
+		} counts[] =
+		{
+			{ "Command count", pBase->commandCount, current.commandCount },
+			{ "Vertex count",  pBase->vertexCount,  current.vertexCount  },
+			{ "Sync count",    pBase->syncCount,    current.syncCount    },
+		};
+
+		for(const auto& count : counts)
+		{
+			const uint64_t limit = count.base + ((count.base * tolerancePercent) / 100);
+
+			if(count.current > limit)
+			{
+				LOG_ERROR_FMT(
+					"Display list 0x%08" PRIX32 ": %s grew from %" PRIu64 " to %" PRIu64 " (tolerance %" PRIu32 "%%)",
+					current.address,
+					count.name,
+					count.base,
+					count.current,
+					tolerancePercent);
+
+				++regressionCount;
+			}
+			else if(count.current != count.base)
+			{
+				LOG_INFO_FMT(
+					"Display list 0x%08" PRIX32 ": %s changed from %" PRIu64 " to %" PRIu64,
+					current.address,
+					count.name,
+					count.base,
+					count.current);
+			}
+		}
+	}
+
+	return regressionCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool WriteTextFile(const std::string_view& filePath, const std::string& text)
+{
+	FileBuffer file;
+	file.data = std::make_unique<uint8_t[]>(text.size());
+	file.length = text.size();
+
+	memcpy(file.data.get(), text.data(), text.size());
+
+	return FileBuffer::Write(filePath, file);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ProcessInput(
+	const std::string_view& inputFilePath,
+	const std::string_view& outputFilePath,
+	DecoderConfig& config,
+	const std::vector<uint32_t>& rootAddresses,
+	std::vector<DisplayListReport>& reports,
+	size_t& findingCount)
+{
+	assert(inputFilePath.size() > 0);
+	assert(outputFilePath.size() > 0);
+
+	FileBuffer inputFile;
+
+	// Read the RAM dump or cooked asset containing the display lists.
+	if(!FileBuffer::Read(inputFile, inputFilePath))
+	{
+		LOG_ERROR_FMT("Failed to load input file: %s", inputFilePath.data());
+		return false;
+	}
+
+	config.pInput = &inputFile;
+
+	for(const GfxCommandDesc& desc : gGfxCommandDesc)
+	{
+		gCommandLookup[desc.opcode] = &desc;
+	}
+
+	reports.clear();
+	reports.resize(rootAddresses.size());
+
+	findingCount = 0;
+
+	for(size_t i = 0; i < rootAddresses.size(); ++i)
+	{
+		LOG_VERBOSE_FMT("Decoding display list 0x%08" PRIX32 " ...", rootAddresses[i]);
+
+		DecodeDisplayList(config, rootAddresses[i], reports[i]);
+		PrintReport(reports[i]);
+
+		findingCount += reports[i].findings.size();
+	}
+
+	config.pInput = nullptr;
+
+	LOG_VERBOSE("Generating report JSON ...");
+
+	const std::string json = BuildJsonReport(inputFilePath, reports);
+
+	// Write the report JSON to disk.
+	if(!WriteTextFile(outputFilePath, json))
+	{
+		LOG_ERROR_FMT("Failed to write output file: %s", outputFilePath.data());
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	// Set the program locale to the environment default.
+	setlocale(LC_ALL, "");
+
+#if defined(_WIN32)
+	// This enables tracking of global heap allocations. If any are leaked,
+	// they will show up in the Visual Studio output window on application exit.
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	cxxopts::Options options(
+#if defined(_WIN32)
+		"ubxdl.exe",
+#else
+		"ubxdl",
+#endif
+		"UltraBox display list analyzer (decodes F3DEX2 display lists and estimates their RSP and RDP cost)"
+	);
+
+	options
+		.custom_help("[options...]")
+		.positional_help("<input_file>")
+		.allow_unrecognised_options();
+
+	// Add the options.
+	options.add_options()
+		("h,help", "Display this help text")
+		("input_file", "File path of the RDRAM dump or cooked binary holding the display lists", cxxopts::value<std::string>(), "<input_file>")
+		("o,output", "File path where the report JSON will be written to (default = <input_file>.json)", cxxopts::value<std::string>(), "file")
+		("d,dl", "Segmented or virtual address of a display list to decode; may be repeated (default = start of the input file)", cxxopts::value<std::vector<std::string>>(), "address")
+		("b,base", "Physical address the input file is loaded at (default = 0, i.e. a full RDRAM dump)", cxxopts::value<std::string>(), "address")
+		("s,segment", "Initial segment table entry; may be repeated", cxxopts::value<std::vector<std::string>>(), "<index>=<address>")
+		("max-commands", "Maximum number of commands decoded per display list (default = 1000000)", cxxopts::value<std::string>(), "count")
+		("W,werror", "Exit with an error when any display list has findings")
+		("baseline", "File path of a baseline saved by an earlier run; exit with an error when the command, vertex or sync count of a display list grows past the tolerance", cxxopts::value<std::string>(), "file")
+		("save-baseline", "File path where the command, vertex and sync counts of every display list will be written as a new baseline", cxxopts::value<std::string>(), "file")
+		("tolerance", "Percentage a count may grow over the baseline before it's a regression (default = 0)", cxxopts::value<std::string>(), "percent")
+		("q,quiet", "Disable all logging exception errors")
+		("v,verbose", "Enable verbose logging and list every decoded command (overrides -q/--quiet)");
+
+	// Define which of the above arguments are positional.
+	options.parse_positional({ "input_file" });
+
+	// Parse the application's command line arguments.
+	cxxopts::ParseResult args = options.parse(argc, argv);
+
+	if(args.count("help"))
+	{
+		// Print the help text, then exit.
+		printf("%s\n", options.help({ "" }).c_str());
+		return APP_EXIT_SUCCESS;
+	}
+
+	// Get the logging options.
+	const bool quietLogging = (args.count("quiet") > 0);
+	const bool verboseLogging = (args.count("verbose") > 0);
+
+	// Show a warning if "-q" and "-v" have been used together.
+	if(quietLogging && verboseLogging)
+	{
+		LOG_WARN("Quiet logging and verbose logging are both enabled; verbose logging will be selected");
+	}
+
+	// Set the log level based on the selected logging options.
+	gLogLevel = verboseLogging
+		? LogLevel::Verbose
+		: quietLogging
+			? LogLevel::Quiet
+			: LogLevel::Normal;
+
+	// Check for the <input_file> argument.
+	if(args.count("input_file") == 0)
+	{
+		LOG_ERROR("Missing required argument: <input_file>");
+		return APP_EXIT_FAILURE;
+	}
+
+	// Get the input file path from the command line and make sure it's not empty.
+	const std::string inputFilePath = args["input_file"].as<std::string>();
+	if(inputFilePath.size() == 0)
+	{
+		LOG_ERROR("Input file path is empty");
+		return APP_EXIT_FAILURE;
+	}
+
+	std::string outputFilePath;
+	if(args.count("output"))
+	{
+		// Get the output file path from the command line and make sure it's not empty.
+		outputFilePath = args["output"].as<std::string>();
+		if(outputFilePath.size() == 0)
+		{
+			LOG_ERROR("Output file path is empty");
+			return APP_EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		// When no output file is explicitly supplied, write the report next to the input file.
+		outputFilePath = inputFilePath + ".json";
+	}
+
+	DecoderConfig config = {};
+	config.maxCommandCount = DEFAULT_MAX_COMMAND_COUNT;
+
+	if(args.count("base"))
+	{
+		const std::string text = args["base"].as<std::string>();
+		if(!ParseNumber(text, config.baseAddress))
+		{
+			LOG_ERROR_FMT("Invalid base address: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+
+		config.baseAddress &= 0x00FFFFFF;
+	}
+
+	if(args.count("max-commands"))
+	{
+		const std::string text = args["max-commands"].as<std::string>();
+
+		uint32_t maxCommandCount;
+		if(!ParseNumber(text, maxCommandCount) || maxCommandCount == 0)
+		{
+			LOG_ERROR_FMT("Invalid command count: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+
+		config.maxCommandCount = maxCommandCount;
+	}
+
+	if(args.count("segment"))
+	{
+		for(const std::string& text : args["segment"].as<std::vector<std::string>>())
+		{
+			const size_t separator = text.find('=');
+
+			uint32_t segmentIndex;
+			uint32_t segmentAddress;
+
+			if(separator == std::string::npos
+				|| !ParseNumber(text.substr(0, separator), segmentIndex)
+				|| !ParseNumber(text.substr(separator + 1), segmentAddress)
+				|| segmentIndex == 0
+				|| segmentIndex > 15)
+			{
+				LOG_ERROR_FMT("Invalid segment: %s", text.c_str());
+				return APP_EXIT_FAILURE;
+			}
+
+			config.segment[segmentIndex] = segmentAddress & 0x00FFFFFF;
+		}
+	}
+
+	uint32_t tolerancePercent = 0;
+
+	if(args.count("tolerance"))
+	{
+		const std::string text = args["tolerance"].as<std::string>();
+		if(!ParseNumber(text, tolerancePercent))
+		{
+			LOG_ERROR_FMT("Invalid tolerance: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	// Load the baseline up front so a bad path fails before any decoding is done.
+	std::vector<BaselineEntry> baseline;
+
+	if(args.count("baseline"))
+	{
+		const std::string baselineFilePath = args["baseline"].as<std::string>();
+
+		FileBuffer baselineFile;
+		if(!FileBuffer::Read(baselineFile, baselineFilePath))
+		{
+			LOG_ERROR_FMT("Failed to load baseline file: %s", baselineFilePath.c_str());
+			return APP_EXIT_FAILURE;
+		}
+
+		if(!ParseBaseline(baselineFile, baseline))
+		{
+			LOG_ERROR_FMT("Failed to parse baseline file: %s", baselineFilePath.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	std::vector<uint32_t> rootAddresses;
+	if(args.count("dl"))
+	{
+		for(const std::string& text : args["dl"].as<std::vector<std::string>>())
+		{
+			uint32_t address;
+			if(!ParseNumber(text, address))
+			{
+				LOG_ERROR_FMT("Invalid display list address: %s", text.c_str());
+				return APP_EXIT_FAILURE;
+			}
+
+			rootAddresses.push_back(address);
+		}
+	}
+	else
+	{
+		// Cooked display lists start at the beginning of the file.
+		rootAddresses.push_back(config.baseAddress);
+	}
+
+	LOG_INFO_FMT("UbxDl v%" PRIu32 ".%" PRIu32 ".%" PRIu32, APP_VERSION_MAJOR, APP_VERSION_MINOR, APP_VERSION_PATCH);
+
+	std::vector<DisplayListReport> reports;
+	size_t findingCount = 0;
+
+	// Decode the display lists and write out the report JSON.
+	if(!ProcessInput(inputFilePath, outputFilePath, config, rootAddresses, reports, findingCount))
+	{
+		return APP_EXIT_FAILURE;
+	}
+
+	if(args.count("save-baseline"))
+	{
+		const std::string baselineFilePath = args["save-baseline"].as<std::string>();
+
+		if(!WriteTextFile(baselineFilePath, BuildBaseline(reports)))
+		{
+			LOG_ERROR_FMT("Failed to write baseline file: %s", baselineFilePath.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	if(args.count("baseline"))
+	{
+		const size_t regressionCount = CompareWithBaseline(reports, baseline, tolerancePercent);
+
+		if(regressionCount > 0)
+		{
+			LOG_ERROR_FMT("Found %zu regression(s) against the baseline", regressionCount);
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	if(args.count("werror") && findingCount > 0)
+	{
+		LOG_ERROR_FMT("Found %zu issue(s) in the display lists", findingCount);
+		return APP_EXIT_FAILURE;
+	}
+
+	return APP_EXIT_SUCCESS;
+}
@@ -0,0 +1,1520 @@
+//
+// Copyright (c) 2023, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "../common/build.hpp"
+#include "../common/file_buffer.hpp"
+#include "../common/log.hpp"
+
+#include <assert.h>
+#include <locale.h>
+#include <inttypes.h>
+#include <memory.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#define CXXOPTS_NO_RTTI
+#include <cxxopts.hpp>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define APP_EXIT_SUCCESS 0
+#define APP_EXIT_FAILURE 1
+
+#define APP_VERSION_MAJOR 1
+#define APP_VERSION_MINOR 0
+#define APP_VERSION_PATCH 0
+
+// Bump this whenever the layout of the JSON report changes so CI scripts comparing reports can tell.
+#define REPORT_VERSION 1
+
+// Default number of objects and symbols listed in the text report.
+#define DEFAULT_TOP_COUNT 20
+
+// RDRAM as seen through KSEG0 and KSEG1, including the Expansion Pak.
+#define RDRAM_BASE_ADDRESS 0x80000000
+#define RDRAM_MAX_SIZE     0x00800000
+#define KSEG_ADDRESS_MASK  0xDFFFFFFF
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// ELF constants.
+#define ELF_SHT_SYMTAB   2
+#define ELF_SHT_NOBITS   8
+#define ELF_SHF_ALLOC    0x2
+#define ELF_STT_OBJECT   1
+#define ELF_STT_FUNC     2
+#define ELF_SHN_LORESERVE 0xFF00
+
+//----------------------------------------------------------------------------------------------------------------------
+
+enum DATA_KIND : uint8_t
+{
+	DATA_KIND_CODE,
+	DATA_KIND_RODATA,
+	DATA_KIND_DATA,
+	DATA_KIND_BSS,
+	DATA_KIND_FILL,
+
+	DATA_KIND__COUNT,
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+constexpr const char* const gDataKindName[DATA_KIND__COUNT] =
+{
+	"code",   // DATA_KIND_CODE
+	"rodata", // DATA_KIND_RODATA
+	"data",   // DATA_KIND_DATA
+	"bss",    // DATA_KIND_BSS
+	"fill",   // DATA_KIND_FILL
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Library containing the objects linked directly into the program rather than from an archive. This doesn't use the
+// program name so reports from differently named builds can still be compared.
+constexpr const char* const gProgramLibraryName = "program";
+
+// Module names used for bytes that don't come from an input file.
+constexpr const char* const gFillModuleName = "(fill)";
+constexpr const char* const gLinkerModuleName = "(linker)";
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct Usage
+{
+	uint64_t kindBytes[DATA_KIND__COUNT] = {};
+
+	uint64_t romBytes = 0;
+	uint64_t rdramBytes = 0;
+};
+
+struct InputSection
+{
+	uint32_t address;
+	uint32_t size;
+	uint32_t moduleIndex;
+
+	DATA_KIND kind;
+};
+
+struct OutputSection
+{
+	std::string name;
+	std::vector<InputSection> inputs;
+
+	uint32_t address;
+	uint32_t size;
+
+	bool inRom;
+	bool inRdram;
+	bool noBits;
+};
+
+struct Module
+{
+	// Libraries are named after their linker flag (e.g., "gultra" for "libgultra.a").
+	std::string library;
+	std::string object;
+
+	Usage usage;
+};
+
+struct Symbol
+{
+	std::string name;
+
+	uint32_t address;
+	uint32_t size;
+	uint32_t moduleIndex;
+
+	DATA_KIND kind;
+
+	bool inRom;
+	bool inRdram;
+};
+
+struct Program
+{
+	std::string elfFilePath;
+	std::string mapFilePath;
+
+	std::vector<OutputSection> sections;
+	std::vector<Module> modules;
+	std::vector<Symbol> symbols;
+
+	std::map<std::string, Usage> libraries;
+	std::unordered_map<std::string, uint32_t> moduleLookup;
+
+	Usage total;
+
+	// Overlays share address ranges, so this is the footprint of the largest overlay in each region plus everything
+	// resident rather than the sum of all sections.
+	uint64_t rdramFootprint = 0;
+};
+
+struct Budget
+{
+	std::string text;
+	std::string group;
+
+	uint64_t limit;
+	uint64_t used;
+
+	bool rom;
+};
+
+struct Delta
+{
+	std::string name;
+
+	int64_t romBytes;
+	int64_t rdramBytes;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ParseNumber(const std::string& text, uint32_t& output)
+{
+	if(text.empty())
+	{
+		return false;
+	}
+
+	char* pEnd = nullptr;
+	const unsigned long long value = strtoull(text.c_str(), &pEnd, 0);
+
+	if(*pEnd != '\0' || value > UINT32_MAX)
+	{
+		return false;
+	}
+
+	output = uint32_t(value);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ParseSize(const std::string& text, uint64_t& output)
+{
+	if(text.empty())
+	{
+		return false;
+	}
+
+	// Sizes accept the same K and M suffixes as the linker script.
+	uint64_t scale = 1;
+	std::string number = text;
+
+	switch(text.back())
+	{
+		case 'k': case 'K': scale = 1024;        number.pop_back(); break;
+		case 'm': case 'M': scale = 1024 * 1024; number.pop_back(); break;
+
+		default:
+			break;
+	}
+
+	uint32_t value;
+	if(!ParseNumber(number, value))
+	{
+		return false;
+	}
+
+	output = uint64_t(value) * scale;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string EscapeJsonString(const std::string_view& text)
+{
+	std::string output;
+	output.reserve(text.size());
+
+	for(const char c : text)
+	{
+		switch(c)
+		{
+			case '"':  output += "\\\""; break;
+			case '\\': output += "\\\\"; break;
+			case '\t': output += "\\t"; break;
+
+			default:
+				if(uint8_t(c) >= 0x20)
+				{
+					output += c;
+				}
+				break;
+		}
+	}
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint16_t ReadU16(const uint8_t* const pData)
+{
+	// The N64 toolchain only produces big-endian ELF files.
+	return uint16_t((uint32_t(pData[0]) << 8) | uint32_t(pData[1]));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint32_t ReadU32(const uint8_t* const pData)
+{
+	return (uint32_t(pData[0]) << 24) | (uint32_t(pData[1]) << 16) | (uint32_t(pData[2]) << 8) | uint32_t(pData[3]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string GetFileStem(const std::string_view& filePath)
+{
+	const size_t separator = filePath.find_last_of("/\\");
+	std::string_view fileName = (separator == std::string_view::npos) ? filePath : filePath.substr(separator + 1);
+
+	const size_t extension = fileName.rfind('.');
+	if(extension != std::string_view::npos && extension > 0)
+	{
+		fileName = fileName.substr(0, extension);
+	}
+
+	return std::string(fileName);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void AddUsage(Usage& output, const DATA_KIND kind, const uint64_t size, const bool inRom, const bool inRdram)
+{
+	output.kindBytes[kind] += size;
+	output.romBytes += inRom ? size : 0;
+	output.rdramBytes += inRdram ? size : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint32_t GetModuleIndex(Program& program, const std::string& library, const std::string& object)
+{
+	const std::string key = library + "(" + object + ")";
+
+	auto iter = program.moduleLookup.find(key);
+	if(iter != program.moduleLookup.end())
+	{
+		return iter->second;
+	}
+
+	const uint32_t index = uint32_t(program.modules.size());
+
+	Module module;
+	module.library = library;
+	module.object = object;
+
+	program.modules.push_back(module);
+	program.moduleLookup.emplace(key, index);
+
+	return index;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint32_t GetModuleIndexFromPath(Program& program, const std::string_view& filePath)
+{
+	// Archive members are listed as "path/to/libfoo.a(member.o)".
+	const size_t memberStart = filePath.rfind('(');
+
+	if(memberStart != std::string_view::npos && filePath.back() == ')')
+	{
+		const std::string_view archivePath = filePath.substr(0, memberStart);
+		const std::string_view member = filePath.substr(memberStart + 1, filePath.size() - memberStart - 2);
+
+		std::string library = GetFileStem(archivePath);
+		if(library.compare(0, 3, "lib") == 0 && library.size() > 3)
+		{
+			library.erase(0, 3);
+		}
+
+		return GetModuleIndex(program, library, std::string(member));
+	}
+
+	const size_t separator = filePath.find_last_of("/\\");
+	const std::string_view object = (separator == std::string_view::npos) ? filePath : filePath.substr(separator + 1);
+
+	return GetModuleIndex(program, gProgramLibraryName, std::string(object));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+DATA_KIND GetDataKind(const std::string_view& inputName, const OutputSection& outputSection)
+{
+	auto startsWith = [&inputName](const char* const prefix)
+	{
+		return inputName.compare(0, strlen(prefix), prefix) == 0;
+	};
+
+	if(startsWith(".text"))
+	{
+		return DATA_KIND_CODE;
+	}
+
+	if(startsWith(".rodata"))
+	{
+		return DATA_KIND_RODATA;
+	}
+
+	if(startsWith(".bss") || startsWith(".sbss") || startsWith(".scommon") || startsWith("COMMON"))
+	{
+		return DATA_KIND_BSS;
+	}
+
+	// Anything else takes after the section it was placed in, e.g. depth buffers in '.zbuffer'.
+	return outputSection.noBits ? DATA_KIND_BSS : DATA_KIND_DATA;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ReadElf(Program& program, std::vector<std::string>& sectionNames)
+{
+	FileBuffer elfFile;
+	if(!FileBuffer::Read(elfFile, program.elfFilePath))
+	{
+		LOG_ERROR_FMT("Failed to load ELF file: %s", program.elfFilePath.c_str());
+		return false;
+	}
+
+	const uint8_t* const pData = elfFile.data.get();
+	const size_t length = elfFile.length;
+
+	if(length < 0x34 || memcmp(pData, "\x7F" "ELF", 4) != 0 || pData[4] != 1 || pData[5] != 2)
+	{
+		LOG_ERROR_FMT("Not a 32-bit big-endian ELF file: %s", program.elfFilePath.c_str());
+		return false;
+	}
+
+	const uint32_t sectionHeaderOffset = ReadU32(pData + 0x20);
+	const uint16_t sectionHeaderSize = ReadU16(pData + 0x2E);
+	const uint16_t sectionHeaderCount = ReadU16(pData + 0x30);
+	const uint16_t sectionNameIndex = ReadU16(pData + 0x32);
+
+	if(sectionHeaderOffset + (size_t(sectionHeaderSize) * sectionHeaderCount) > length || sectionNameIndex >= sectionHeaderCount)
+	{
+		LOG_ERROR_FMT("ELF file section headers are out of bounds: %s", program.elfFilePath.c_str());
+		return false;
+	}
+
+	auto getSectionHeader = [&](const uint32_t index)
+	{
+		return pData + sectionHeaderOffset + (size_t(index) * sectionHeaderSize);
+	};
+
+	auto getString = [&](const uint32_t tableIndex, const uint32_t offset)
+	{
+		const uint32_t tableOffset = ReadU32(getSectionHeader(tableIndex) + 0x10);
+		const uint32_t tableSize = ReadU32(getSectionHeader(tableIndex) + 0x14);
+
+		if(offset >= tableSize || size_t(tableOffset) + tableSize > length)
+		{
+			return std::string();
+		}
+
+		const char* const pString = reinterpret_cast<const char*>(pData + tableOffset + offset);
+		return std::string(pString, strnlen(pString, tableSize - offset));
+	};
+
+	sectionNames.resize(sectionHeaderCount);
+
+	for(uint32_t i = 0; i < sectionHeaderCount; ++i)
+	{
+		const uint8_t* const pHeader = getSectionHeader(i);
+		const uint32_t type = ReadU32(pHeader + 0x04);
+		const uint32_t flags = ReadU32(pHeader + 0x08);
+
+		sectionNames[i] = getString(sectionNameIndex, ReadU32(pHeader));
+
+		// Only sections that take up space in the program matter here.
+		if(!(flags & ELF_SHF_ALLOC) || ReadU32(pHeader + 0x14) == 0)
+		{
+			continue;
+		}
+
+		OutputSection section;
+		section.name = sectionNames[i];
+		section.address = ReadU32(pHeader + 0x0C);
+		section.size = ReadU32(pHeader + 0x14);
+		section.noBits = (type == ELF_SHT_NOBITS);
+		section.inRom = !section.noBits;
+		section.inRdram = ((section.address & KSEG_ADDRESS_MASK) - RDRAM_BASE_ADDRESS) < RDRAM_MAX_SIZE;
+
+		program.sections.push_back(section);
+	}
+
+	// Gather the sized functions and data objects from the symbol table.
+	for(uint32_t i = 0; i < sectionHeaderCount; ++i)
+	{
+		const uint8_t* const pHeader = getSectionHeader(i);
+		if(ReadU32(pHeader + 0x04) != ELF_SHT_SYMTAB)
+		{
+			continue;
+		}
+
+		const uint32_t tableOffset = ReadU32(pHeader + 0x10);
+		const uint32_t tableSize = ReadU32(pHeader + 0x14);
+		const uint32_t stringTableIndex = ReadU32(pHeader + 0x18);
+		const uint32_t entrySize = ReadU32(pHeader + 0x24);
+
+		if(entrySize < 16 || size_t(tableOffset) + tableSize > length || stringTableIndex >= sectionHeaderCount)
+		{
+			continue;
+		}
+
+		for(uint32_t offset = tableOffset; offset + entrySize <= tableOffset + tableSize; offset += entrySize)
+		{
+			const uint8_t* const pEntry = pData + offset;
+			const uint8_t type = pEntry[12] & 0xF;
+			const uint16_t sectionIndex = ReadU16(pEntry + 14);
+
+			if((type != ELF_STT_OBJECT && type != ELF_STT_FUNC) || sectionIndex == 0 || sectionIndex >= ELF_SHN_LORESERVE)
+			{
+				continue;
+			}
+
+			Symbol symbol;
+			symbol.name = getString(stringTableIndex, ReadU32(pEntry));
+			symbol.address = ReadU32(pEntry + 4);
+			symbol.size = ReadU32(pEntry + 8);
+			symbol.moduleIndex = UINT32_MAX;
+			symbol.kind = (type == ELF_STT_FUNC) ? DATA_KIND_CODE : DATA_KIND_DATA;
+
+			if(symbol.size == 0 || symbol.name.empty())
+			{
+				continue;
+			}
+
+			// Remember which section the symbol came from until the map has been read.
+			symbol.inRom = false;
+			symbol.inRdram = false;
+			symbol.moduleIndex = sectionIndex;
+
+			program.symbols.push_back(symbol);
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::string_view> SplitWords(const std::string_view& line)
+{
+	std::vector<std::string_view> output;
+
+	size_t start = 0;
+	while(start < line.size())
+	{
+		start = line.find_first_not_of(" \t", start);
+		if(start == std::string_view::npos)
+		{
+			break;
+		}
+
+		size_t end = line.find_first_of(" \t", start);
+		if(end == std::string_view::npos)
+		{
+			end = line.size();
+		}
+
+		output.push_back(line.substr(start, end - start));
+		start = end;
+	}
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline bool IsHexNumber(const std::string_view& word)
+{
+	return word.size() > 2 && word[0] == '0' && word[1] == 'x';
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ReadMap(Program& program)
+{
+	FileBuffer mapFile;
+	if(!FileBuffer::Read(mapFile, program.mapFilePath))
+	{
+		LOG_ERROR_FMT("Failed to load map file: %s", program.mapFilePath.c_str());
+		return false;
+	}
+
+	const std::string_view text(reinterpret_cast<const char*>(mapFile.data.get()), mapFile.length);
+
+	std::vector<std::string_view> lines;
+	for(size_t start = 0; start < text.size();)
+	{
+		size_t end = text.find('\n', start);
+		if(end == std::string_view::npos)
+		{
+			end = text.size();
+		}
+
+		std::string_view line = text.substr(start, end - start);
+		if(!line.empty() && line.back() == '\r')
+		{
+			line.remove_suffix(1);
+		}
+
+		lines.push_back(line);
+		start = end + 1;
+	}
+
+	// Everything before the memory map lists archive members and discarded sections, neither of which take up space.
+	size_t lineIndex = 0;
+	while(lineIndex < lines.size() && lines[lineIndex].compare(0, 29, "Linker script and memory map") != 0)
+	{
+		++lineIndex;
+	}
+
+	if(lineIndex == lines.size())
+	{
+		LOG_ERROR_FMT("Map file has no memory map; was it written by GNU ld? %s", program.mapFilePath.c_str());
+		return false;
+	}
+
+	std::unordered_map<std::string, size_t> sectionLookup;
+	for(size_t i = 0; i < program.sections.size(); ++i)
+	{
+		sectionLookup.emplace(program.sections[i].name, i);
+	}
+
+	OutputSection* pCurrentSection = nullptr;
+
+	for(++lineIndex; lineIndex < lines.size(); ++lineIndex)
+	{
+		const std::string_view line = lines[lineIndex];
+		if(line.empty())
+		{
+			continue;
+		}
+
+		std::vector<std::string_view> words = SplitWords(line);
+		if(words.empty())
+		{
+			continue;
+		}
+
+		const bool outputSectionLine = (line[0] != ' ');
+		const bool inputSectionLine = (line.size() > 1 && line[0] == ' ' && line[1] != ' ');
+
+		if(!outputSectionLine && !inputSectionLine)
+		{
+			// Symbol assignments and data statements such as LONG().
+			continue;
+		}
+
+		// Names too long for their column push the address, size and file path onto the next line.
+		std::string_view pathLine = line;
+
+		if(words.size() == 1 && lineIndex + 1 < lines.size())
+		{
+			const std::vector<std::string_view> nextWords = SplitWords(lines[lineIndex + 1]);
+
+			if(nextWords.size() >= 2 && IsHexNumber(nextWords[0]) && IsHexNumber(nextWords[1]) && lines[lineIndex + 1][0] == ' ')
+			{
+				words.insert(words.end(), nextWords.begin(), nextWords.end());
+				pathLine = lines[++lineIndex];
+			}
+		}
+
+		if(words.size() < 3 || !IsHexNumber(words[1]) || !IsHexNumber(words[2]))
+		{
+			continue;
+		}
+
+		const std::string name(words[0]);
+		const uint32_t size = uint32_t(strtoul(std::string(words[2]).c_str(), nullptr, 16));
+
+		if(outputSectionLine)
+		{
+			auto iter = sectionLookup.find(name);
+			pCurrentSection = (iter != sectionLookup.end()) ? &program.sections[iter->second] : nullptr;
+			continue;
+		}
+
+		if(!pCurrentSection || size == 0 || (name[0] == '*' && name != "*fill*"))
+		{
+			continue;
+		}
+
+		InputSection input;
+		input.address = uint32_t(strtoul(std::string(words[1]).c_str(), nullptr, 16));
+		input.size = size;
+
+		if(name == "*fill*")
+		{
+			input.kind = DATA_KIND_FILL;
+			input.moduleIndex = GetModuleIndex(program, gFillModuleName, gFillModuleName);
+		}
+		else
+		{
+			if(words.size() < 4)
+			{
+				continue;
+			}
+
+			// File paths can contain spaces, so the rest of the line belongs to the path.
+			const std::string_view path = pathLine.substr(size_t(words[3].data() - pathLine.data()));
+
+			input.kind = GetDataKind(name, *pCurrentSection);
+			input.moduleIndex = GetModuleIndexFromPath(program, path);
+		}
+
+		pCurrentSection->inputs.push_back(input);
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void AttributeProgram(Program& program, const std::vector<std::string>& sectionNames)
+{
+	std::unordered_map<std::string, OutputSection*> sectionLookup;
+
+	for(OutputSection& section : program.sections)
+	{
+		std::sort(
+			section.inputs.begin(),
+			section.inputs.end(),
+			[](const InputSection& left, const InputSection& right) { return left.address < right.address; });
+
+		uint64_t attributedBytes = 0;
+
+		for(const InputSection& input : section.inputs)
+		{
+			AddUsage(program.modules[input.moduleIndex].usage, input.kind, input.size, section.inRom, section.inRdram);
+			attributedBytes += input.size;
+		}
+
+		// Whatever the map doesn't list came from the linker script itself, e.g. the ROM header.
+		if(attributedBytes < section.size)
+		{
+			const uint32_t moduleIndex = GetModuleIndex(program, gLinkerModuleName, gLinkerModuleName);
+
+			AddUsage(program.modules[moduleIndex].usage, DATA_KIND_DATA, section.size - attributedBytes, section.inRom, section.inRdram);
+		}
+
+		AddUsage(program.total, section.noBits ? DATA_KIND_BSS : DATA_KIND_DATA, section.size, section.inRom, section.inRdram);
+		sectionLookup.emplace(section.name, &section);
+	}
+
+	for(const Module& module : program.modules)
+	{
+		Usage& library = program.libraries[module.library];
+
+		for(int i = 0; i < DATA_KIND__COUNT; ++i)
+		{
+			library.kindBytes[i] += module.usage.kindBytes[i];
+		}
+
+		library.romBytes += module.usage.romBytes;
+		library.rdramBytes += module.usage.rdramBytes;
+	}
+
+	// Attribute each symbol to the input section it lies in.
+	std::vector<Symbol> symbols;
+	symbols.reserve(program.symbols.size());
+
+	for(Symbol& symbol : program.symbols)
+	{
+		auto iter = sectionLookup.find(sectionNames[symbol.moduleIndex]);
+		if(iter == sectionLookup.end())
+		{
+			continue;
+		}
+
+		const OutputSection& section = *iter->second;
+
+		auto input = std::upper_bound(
+			section.inputs.begin(),
+			section.inputs.end(),
+			symbol.address,
+			[](const uint32_t address, const InputSection& other) { return address < other.address; });
+
+		if(input != section.inputs.begin() && symbol.address < (input - 1)->address + (input - 1)->size)
+		{
+			--input;
+
+			symbol.moduleIndex = input->moduleIndex;
+			symbol.kind = input->kind;
+		}
+		else
+		{
+			symbol.moduleIndex = GetModuleIndex(program, gLinkerModuleName, gLinkerModuleName);
+		}
+
+		symbol.inRom = section.inRom;
+		symbol.inRdram = section.inRdram;
+
+		symbols.push_back(symbol);
+	}
+
+	program.symbols.swap(symbols);
+
+	// Find the RDRAM footprint from the union of the section address ranges so overlapping overlays count once.
+	std::vector<std::pair<uint32_t, uint32_t>> ranges;
+	for(const OutputSection& section : program.sections)
+	{
+		if(section.inRdram)
+		{
+			ranges.emplace_back(section.address, section.address + section.size);
+		}
+	}
+
+	std::sort(ranges.begin(), ranges.end());
+
+	uint32_t coveredEnd = 0;
+	for(const auto& range : ranges)
+	{
+		const uint32_t start = std::max(range.first, coveredEnd);
+		if(range.second > start)
+		{
+			program.rdramFootprint += range.second - start;
+			coveredEnd = range.second;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool LoadProgram(Program& program)
+{
+	LOG_VERBOSE_FMT("Reading %s ...", program.elfFilePath.c_str());
+
+	std::vector<std::string> sectionNames;
+	if(!ReadElf(program, sectionNames))
+	{
+		return false;
+	}
+
+	LOG_VERBOSE_FMT("Reading %s ...", program.mapFilePath.c_str());
+
+	if(!ReadMap(program))
+	{
+		return false;
+	}
+
+	AttributeProgram(program, sectionNames);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string GetModuleName(const Module& module)
+{
+	// Bytes the linker accounted for itself belong to a module with the same name as its library.
+	return (module.library == module.object) ? module.library : module.library + "(" + module.object + ")";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string GetSymbolKey(const Program& program, const Symbol& symbol)
+{
+	// Static symbols can share a name, so they're told apart by the object they're defined in.
+	return GetModuleName(program.modules[symbol.moduleIndex]) + ":" + symbol.name;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void GetDeltas(const std::map<std::string, Usage>& current, const std::map<std::string, Usage>& baseline, std::vector<Delta>& output)
+{
+	std::map<std::string, Delta> deltas;
+
+	for(const auto& entry : current)
+	{
+		Delta& delta = deltas[entry.first];
+		delta.name = entry.first;
+		delta.romBytes = int64_t(entry.second.romBytes);
+		delta.rdramBytes = int64_t(entry.second.rdramBytes);
+	}
+
+	for(const auto& entry : baseline)
+	{
+		auto iter = deltas.find(entry.first);
+		if(iter == deltas.end())
+		{
+			iter = deltas.emplace(entry.first, Delta { entry.first, 0, 0 }).first;
+		}
+
+		iter->second.romBytes -= int64_t(entry.second.romBytes);
+		iter->second.rdramBytes -= int64_t(entry.second.rdramBytes);
+	}
+
+	output.clear();
+
+	for(const auto& entry : deltas)
+	{
+		if(entry.second.romBytes != 0 || entry.second.rdramBytes != 0)
+		{
+			output.push_back(entry.second);
+		}
+	}
+
+	// Biggest changes first.
+	std::stable_sort(
+		output.begin(),
+		output.end(),
+		[](const Delta& left, const Delta& right)
+		{
+			return (llabs(left.romBytes) + llabs(left.rdramBytes)) > (llabs(right.romBytes) + llabs(right.rdramBytes));
+		});
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void GetUsageMaps(
+	const Program& program,
+	std::map<std::string, Usage>& sections,
+	std::map<std::string, Usage>& objects,
+	std::map<std::string, Usage>& symbols)
+{
+	for(const OutputSection& section : program.sections)
+	{
+		AddUsage(sections[section.name], section.noBits ? DATA_KIND_BSS : DATA_KIND_DATA, section.size, section.inRom, section.inRdram);
+	}
+
+	for(const Module& module : program.modules)
+	{
+		objects[GetModuleName(module)] = module.usage;
+	}
+
+	for(const Symbol& symbol : program.symbols)
+	{
+		AddUsage(symbols[GetSymbolKey(program, symbol)], symbol.kind, symbol.size, symbol.inRom, symbol.inRdram);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ResolveBudget(const Program& program, Budget& budget)
+{
+	if(budget.group.empty())
+	{
+		budget.used = budget.rom ? program.total.romBytes : program.rdramFootprint;
+		return true;
+	}
+
+	for(const OutputSection& section : program.sections)
+	{
+		if(section.name == budget.group)
+		{
+			budget.used = (budget.rom ? section.inRom : section.inRdram) ? section.size : 0;
+			return true;
+		}
+	}
+
+	auto library = program.libraries.find(budget.group);
+	if(library != program.libraries.end())
+	{
+		budget.used = budget.rom ? library->second.romBytes : library->second.rdramBytes;
+		return true;
+	}
+
+	for(const Module& module : program.modules)
+	{
+		if(module.object == budget.group)
+		{
+			budget.used = budget.rom ? module.usage.romBytes : module.usage.rdramBytes;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void PrintUsageRow(const char* const name, const Usage& usage)
+{
+	LOG_INFO_FMT(
+		"    %-32s %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %10" PRIu64 " %10" PRIu64,
+		name,
+		usage.kindBytes[DATA_KIND_CODE],
+		usage.kindBytes[DATA_KIND_RODATA],
+		usage.kindBytes[DATA_KIND_DATA],
+		usage.kindBytes[DATA_KIND_BSS],
+		usage.romBytes,
+		usage.rdramBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void PrintDeltas(const char* const title, const std::vector<Delta>& deltas, const size_t topCount)
+{
+	if(deltas.empty())
+	{
+		return;
+	}
+
+	LOG_INFO_FMT("  %s:", title);
+
+	for(size_t i = 0; i < deltas.size() && i < topCount; ++i)
+	{
+		LOG_INFO_FMT("    %-48s ROM %+10" PRId64 "  RDRAM %+10" PRId64, deltas[i].name.c_str(), deltas[i].romBytes, deltas[i].rdramBytes);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void PrintReport(const Program& program, const size_t topCount)
+{
+	LOG_INFO_FMT("Program: %s", program.elfFilePath.c_str());
+	LOG_INFO_FMT("  ROM:   %" PRIu64 " bytes", program.total.romBytes);
+	LOG_INFO_FMT("  RDRAM: %" PRIu64 " bytes (%" PRIu64 " with every overlay loaded)", program.rdramFootprint, program.total.rdramBytes);
+
+	LOG_INFO("  Sections:");
+	for(const OutputSection& section : program.sections)
+	{
+		LOG_INFO_FMT(
+			"    %-16s 0x%08" PRIX32 " %10" PRIu32 " bytes%s%s",
+			section.name.c_str(),
+			section.address,
+			section.size,
+			section.inRom ? " ROM" : "",
+			section.inRdram ? " RDRAM" : "");
+	}
+
+	LOG_INFO_FMT("  Libraries:%27s %9s %9s %9s %9s %10s %10s", "", "code", "rodata", "data", "bss", "ROM", "RDRAM");
+	for(const auto& library : program.libraries)
+	{
+		PrintUsageRow(library.first.c_str(), library.second);
+	}
+
+	std::vector<const Module*> modules;
+	for(const Module& module : program.modules)
+	{
+		modules.push_back(&module);
+	}
+
+	std::stable_sort(
+		modules.begin(),
+		modules.end(),
+		[](const Module* const pLeft, const Module* const pRight)
+		{
+			return std::max(pLeft->usage.romBytes, pLeft->usage.rdramBytes) > std::max(pRight->usage.romBytes, pRight->usage.rdramBytes);
+		});
+
+	LOG_INFO_FMT("  Largest objects:%21s %9s %9s %9s %9s %10s %10s", "", "code", "rodata", "data", "bss", "ROM", "RDRAM");
+	for(size_t i = 0; i < modules.size() && i < topCount; ++i)
+	{
+		PrintUsageRow(GetModuleName(*modules[i]).c_str(), modules[i]->usage);
+	}
+
+	std::vector<const Symbol*> symbols;
+	for(const Symbol& symbol : program.symbols)
+	{
+		symbols.push_back(&symbol);
+	}
+
+	std::stable_sort(
+		symbols.begin(),
+		symbols.end(),
+		[](const Symbol* const pLeft, const Symbol* const pRight) { return pLeft->size > pRight->size; });
+
+	LOG_INFO("  Largest symbols:");
+	for(size_t i = 0; i < symbols.size() && i < topCount; ++i)
+	{
+		const Symbol& symbol = *symbols[i];
+		const Module& module = program.modules[symbol.moduleIndex];
+
+		LOG_INFO_FMT(
+			"    %-32s %10" PRIu32 " %-6s %s",
+			symbol.name.c_str(),
+			symbol.size,
+			gDataKindName[symbol.kind],
+			GetModuleName(module).c_str());
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void AppendUsageJson(std::string& output, const Usage& usage)
+{
+	char buffer[256];
+
+	snprintf(
+		buffer,
+		sizeof(buffer),
+		"\"code\": %" PRIu64 ", \"rodata\": %" PRIu64 ", \"data\": %" PRIu64 ", \"bss\": %" PRIu64 ", \"fill\": %" PRIu64 ", \"rom\": %" PRIu64 ", \"rdram\": %" PRIu64,
+		usage.kindBytes[DATA_KIND_CODE],
+		usage.kindBytes[DATA_KIND_RODATA],
+		usage.kindBytes[DATA_KIND_DATA],
+		usage.kindBytes[DATA_KIND_BSS],
+		usage.kindBytes[DATA_KIND_FILL],
+		usage.romBytes,
+		usage.rdramBytes);
+
+	output += buffer;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void AppendDeltasJson(std::string& output, const char* const name, const std::vector<Delta>& deltas, const bool last)
+{
+	char buffer[128];
+
+	output += "\t\t\"";
+	output += name;
+	output += "\": [";
+
+	for(size_t i = 0; i < deltas.size(); ++i)
+	{
+		output += (i > 0) ? ",\n\t\t\t{ \"name\": \"" : "\n\t\t\t{ \"name\": \"";
+		output += EscapeJsonString(deltas[i].name);
+
+		snprintf(buffer, sizeof(buffer), "\", \"rom\": %" PRId64 ", \"rdram\": %" PRId64 " }", deltas[i].romBytes, deltas[i].rdramBytes);
+		output += buffer;
+	}
+
+	output += deltas.empty() ? "]" : "\n\t\t]";
+	output += last ? "\n" : ",\n";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string BuildJsonReport(
+	const Program& program,
+	const Program* const pBaseline,
+	const std::vector<Delta>* const pDeltas,
+	const std::vector<Budget>& budgets)
+{
+	std::string output;
+	char buffer[512];
+
+	snprintf(buffer, sizeof(buffer), "{\n\t\"version\": %d,\n\t\"elf\": \"", REPORT_VERSION);
+	output += buffer;
+	output += EscapeJsonString(program.elfFilePath);
+	output += "\",\n\t\"map\": \"";
+	output += EscapeJsonString(program.mapFilePath);
+
+	snprintf(buffer, sizeof(buffer), "\",\n\t\"rom\": %" PRIu64 ",\n\t\"rdram\": %" PRIu64 ",\n\t\"sections\": [", program.total.romBytes, program.rdramFootprint);
+	output += buffer;
+
+	for(size_t i = 0; i < program.sections.size(); ++i)
+	{
+		const OutputSection& section = program.sections[i];
+
+		output += (i > 0) ? ",\n\t\t{ \"name\": \"" : "\n\t\t{ \"name\": \"";
+		output += EscapeJsonString(section.name);
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"\", \"address\": \"0x%08" PRIX32 "\", \"size\": %" PRIu32 ", \"rom\": %s, \"rdram\": %s }",
+			section.address,
+			section.size,
+			section.inRom ? "true" : "false",
+			section.inRdram ? "true" : "false");
+		output += buffer;
+	}
+
+	output += "\n\t],\n\t\"libraries\": [";
+
+	bool first = true;
+	for(const auto& library : program.libraries)
+	{
+		output += first ? "\n\t\t{ \"name\": \"" : ",\n\t\t{ \"name\": \"";
+		output += EscapeJsonString(library.first);
+		output += "\", ";
+		AppendUsageJson(output, library.second);
+		output += " }";
+
+		first = false;
+	}
+
+	output += "\n\t],\n\t\"objects\": [";
+
+	for(size_t i = 0; i < program.modules.size(); ++i)
+	{
+		const Module& module = program.modules[i];
+
+		output += (i > 0) ? ",\n\t\t{ \"library\": \"" : "\n\t\t{ \"library\": \"";
+		output += EscapeJsonString(module.library);
+		output += "\", \"object\": \"";
+		output += EscapeJsonString(module.object);
+		output += "\", ";
+		AppendUsageJson(output, module.usage);
+		output += " }";
+	}
+
+	output += "\n\t],\n\t\"symbols\": [";
+
+	for(size_t i = 0; i < program.symbols.size(); ++i)
+	{
+		const Symbol& symbol = program.symbols[i];
+		const Module& module = program.modules[symbol.moduleIndex];
+
+		output += (i > 0) ? ",\n\t\t{ \"name\": \"" : "\n\t\t{ \"name\": \"";
+		output += EscapeJsonString(symbol.name);
+		output += "\", \"library\": \"";
+		output += EscapeJsonString(module.library);
+		output += "\", \"object\": \"";
+		output += EscapeJsonString(module.object);
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"\", \"kind\": \"%s\", \"address\": \"0x%08" PRIX32 "\", \"size\": %" PRIu32 ", \"rom\": %s, \"rdram\": %s }",
+			gDataKindName[symbol.kind],
+			symbol.address,
+			symbol.size,
+			symbol.inRom ? "true" : "false",
+			symbol.inRdram ? "true" : "false");
+		output += buffer;
+	}
+
+	output += "\n\t],\n\t\"budgets\": [";
+
+	for(size_t i = 0; i < budgets.size(); ++i)
+	{
+		const Budget& budget = budgets[i];
+
+		output += (i > 0) ? ",\n\t\t{ \"budget\": \"" : "\n\t\t{ \"budget\": \"";
+		output += EscapeJsonString(budget.text);
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"\", \"limit\": %" PRIu64 ", \"used\": %" PRIu64 ", \"exceeded\": %s }",
+			budget.limit,
+			budget.used,
+			(budget.used > budget.limit) ? "true" : "false");
+		output += buffer;
+	}
+
+	output += budgets.empty() ? "]" : "\n\t]";
+
+	if(pBaseline)
+	{
+		output += ",\n\t\"baseline\": {\n\t\t\"elf\": \"";
+		output += EscapeJsonString(pBaseline->elfFilePath);
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"\",\n\t\t\"rom\": %" PRId64 ",\n\t\t\"rdram\": %" PRId64 ",\n",
+			int64_t(program.total.romBytes) - int64_t(pBaseline->total.romBytes),
+			int64_t(program.rdramFootprint) - int64_t(pBaseline->rdramFootprint));
+		output += buffer;
+
+		AppendDeltasJson(output, "sections", pDeltas[0], false);
+		AppendDeltasJson(output, "libraries", pDeltas[1], false);
+		AppendDeltasJson(output, "objects", pDeltas[2], false);
+		AppendDeltasJson(output, "symbols", pDeltas[3], true);
+
+		output += "\t}";
+	}
+
+	output += "\n}\n";
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ProcessInput(
+	Program& program,
+	Program* const pBaseline,
+	const std::string_view& outputFilePath,
+	std::vector<Budget>& budgets,
+	const size_t topCount)
+{
+	assert(outputFilePath.size() > 0);
+
+	if(!LoadProgram(program) || (pBaseline && !LoadProgram(*pBaseline)))
+	{
+		return false;
+	}
+
+	PrintReport(program, topCount);
+
+	std::vector<Delta> deltas[4];
+
+	if(pBaseline)
+	{
+		std::map<std::string, Usage> current[3];
+		std::map<std::string, Usage> baseline[3];
+
+		GetUsageMaps(program, current[0], current[1], current[2]);
+		GetUsageMaps(*pBaseline, baseline[0], baseline[1], baseline[2]);
+
+		GetDeltas(current[0], baseline[0], deltas[0]);
+		GetDeltas(program.libraries, pBaseline->libraries, deltas[1]);
+		GetDeltas(current[1], baseline[1], deltas[2]);
+		GetDeltas(current[2], baseline[2], deltas[3]);
+
+		LOG_INFO_FMT("Changes from %s:", pBaseline->elfFilePath.c_str());
+		LOG_INFO_FMT("  ROM:   %+" PRId64 " bytes", int64_t(program.total.romBytes) - int64_t(pBaseline->total.romBytes));
+		LOG_INFO_FMT("  RDRAM: %+" PRId64 " bytes", int64_t(program.rdramFootprint) - int64_t(pBaseline->rdramFootprint));
+
+		PrintDeltas("Sections", deltas[0], topCount);
+		PrintDeltas("Libraries", deltas[1], topCount);
+		PrintDeltas("Objects", deltas[2], topCount);
+		PrintDeltas("Symbols", deltas[3], topCount);
+	}
+
+	bool budgetsMet = true;
+
+	for(Budget& budget : budgets)
+	{
+		if(!ResolveBudget(program, budget))
+		{
+			LOG_ERROR_FMT("Budget does not match any section, library or object: %s", budget.text.c_str());
+			return false;
+		}
+
+		if(budget.used > budget.limit)
+		{
+			LOG_ERROR_FMT("Budget exceeded: %s (%" PRIu64 " bytes used, %" PRIu64 " over)", budget.text.c_str(), budget.used, budget.used - budget.limit);
+			budgetsMet = false;
+		}
+		else
+		{
+			LOG_VERBOSE_FMT("Budget met: %s (%" PRIu64 " bytes used)", budget.text.c_str(), budget.used);
+		}
+	}
+
+	LOG_VERBOSE("Generating report JSON ...");
+
+	const std::string json = BuildJsonReport(program, pBaseline, pBaseline ? deltas : nullptr, budgets);
+
+	FileBuffer outputFile;
+	outputFile.data = std::make_unique<uint8_t[]>(json.size());
+	outputFile.length = json.size();
+
+	memcpy(outputFile.data.get(), json.data(), json.size());
+
+	// Write the report JSON to disk.
+	if(!FileBuffer::Write(outputFilePath, outputFile))
+	{
+		LOG_ERROR_FMT("Failed to write output file: %s", outputFilePath.data());
+		return false;
+	}
+
+	// The report is still written when a budget is exceeded so it can be inspected.
+	return budgetsMet;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string GetDefaultMapFilePath(const std::string& elfFilePath)
+{
+	// The linker writes the map next to the ELF with the extension swapped.
+	const size_t separator = elfFilePath.find_last_of("/\\");
+	const size_t extension = elfFilePath.rfind('.');
+
+	if(extension != std::string::npos && (separator == std::string::npos || extension > separator))
+	{
+		return elfFilePath.substr(0, extension) + ".map";
+	}
+
+	return elfFilePath + ".map";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	// Set the program locale to the environment default.
+	setlocale(LC_ALL, "");
+
+#if defined(_WIN32)
+	// This enables tracking of global heap allocations. If any are leaked,
+	// they will show up in the Visual Studio output window on application exit.
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	cxxopts::Options options(
+#if defined(_WIN32)
+		"ubxmap.exe",
+#else
+		"ubxmap",
+#endif
+		"UltraBox map analyzer (attributes the ROM and RDRAM used by a linked program to its symbols, objects and libraries)"
+	);
+
+	options
+		.custom_help("[options...]")
+		.positional_help("<input_file>")
+		.allow_unrecognised_options();
+
+	// Add the options.
+	options.add_options()
+		("h,help", "Display this help text")
+		("input_file", "File path of the linked ELF file", cxxopts::value<std::string>(), "<input_file>")
+		("o,output", "File path where the report JSON will be written to (default = <input_file>.map.json)", cxxopts::value<std::string>(), "file")
+		("m,map", "File path of the linker map (default = <input_file> with a '.map' extension)", cxxopts::value<std::string>(), "file")
+		("baseline", "File path of an ELF file from an earlier build to compare against", cxxopts::value<std::string>(), "file")
+		("baseline-map", "File path of the linker map of the baseline (default = <baseline> with a '.map' extension)", cxxopts::value<std::string>(), "file")
+		("B,budget", "Fail when the ROM or RDRAM used by the whole program, a section, a library or an object exceeds a size; may be repeated", cxxopts::value<std::vector<std::string>>(), "<rom|rdram>[:<name>]=<size>")
+		("n,top", "Number of largest objects and symbols to list (default = 20)", cxxopts::value<std::string>(), "count")
+		("q,quiet", "Disable all logging exception errors")
+		("v,verbose", "Enable verbose logging (overrides -q/--quiet)");
+
+	// Define which of the above arguments are positional.
+	options.parse_positional({ "input_file" });
+
+	// Parse the application's command line arguments.
+	cxxopts::ParseResult args = options.parse(argc, argv);
+
+	if(args.count("help"))
+	{
+		// Print the help text, then exit.
+		printf("%s\n", options.help({ "" }).c_str());
+		return APP_EXIT_SUCCESS;
+	}
+
+	// Get the logging options.
+	const bool quietLogging = (args.count("quiet") > 0);
+	const bool verboseLogging = (args.count("verbose") > 0);
+
+	// Show a warning if "-q" and "-v" have been used together.
+	if(quietLogging && verboseLogging)
+	{
+		LOG_WARN("Quiet logging and verbose logging are both enabled; verbose logging will be selected");
+	}
+
+	// Set the log level based on the selected logging options.
+	gLogLevel = verboseLogging
+		? LogLevel::Verbose
+		: quietLogging
+			? LogLevel::Quiet
+			: LogLevel::Normal;
+
+	// Check for the <input_file> argument.
+	if(args.count("input_file") == 0)
+	{
+		LOG_ERROR("Missing required argument: <input_file>");
+		return APP_EXIT_FAILURE;
+	}
+
+	Program program;
+
+	// Get the input file path from the command line and make sure it's not empty.
+	program.elfFilePath = args["input_file"].as<std::string>();
+	if(program.elfFilePath.size() == 0)
+	{
+		LOG_ERROR("Input file path is empty");
+		return APP_EXIT_FAILURE;
+	}
+
+	program.mapFilePath = args.count("map")
+		? args["map"].as<std::string>()
+		: GetDefaultMapFilePath(program.elfFilePath);
+
+	std::string outputFilePath;
+	if(args.count("output"))
+	{
+		// Get the output file path from the command line and make sure it's not empty.
+		outputFilePath = args["output"].as<std::string>();
+		if(outputFilePath.size() == 0)
+		{
+			LOG_ERROR("Output file path is empty");
+			return APP_EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		// When no output file is explicitly supplied, write the report next to the input file.
+		outputFilePath = program.elfFilePath + ".map.json";
+	}
+
+	Program baseline;
+	Program* pBaseline = nullptr;
+
+	if(args.count("baseline"))
+	{
+		baseline.elfFilePath = args["baseline"].as<std::string>();
+		baseline.mapFilePath = args.count("baseline-map")
+			? args["baseline-map"].as<std::string>()
+			: GetDefaultMapFilePath(baseline.elfFilePath);
+
+		pBaseline = &baseline;
+	}
+
+	std::vector<Budget> budgets;
+
+	if(args.count("budget"))
+	{
+		for(const std::string& text : args["budget"].as<std::vector<std::string>>())
+		{
+			const size_t separator = text.find('=');
+			const std::string target = text.substr(0, std::min(separator, text.size()));
+			const size_t groupSeparator = target.find(':');
+
+			Budget budget;
+			budget.text = text;
+			budget.used = 0;
+			budget.rom = (target.compare(0, groupSeparator, "rom") == 0);
+
+			if(groupSeparator != std::string::npos)
+			{
+				budget.group = target.substr(groupSeparator + 1);
+			}
+
+			if(separator == std::string::npos
+				|| !ParseSize(text.substr(separator + 1), budget.limit)
+				|| (!budget.rom && target.compare(0, groupSeparator, "rdram") != 0)
+				|| (groupSeparator != std::string::npos && budget.group.empty()))
+			{
+				LOG_ERROR_FMT("Invalid budget: %s", text.c_str());
+				return APP_EXIT_FAILURE;
+			}
+
+			budgets.push_back(budget);
+		}
+	}
+
+	uint32_t topCount = DEFAULT_TOP_COUNT;
+	if(args.count("top"))
+	{
+		const std::string text = args["top"].as<std::string>();
+		if(!ParseNumber(text, topCount))
+		{
+			LOG_ERROR_FMT("Invalid count: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	LOG_INFO_FMT("UbxMap v%" PRIu32 ".%" PRIu32 ".%" PRIu32, APP_VERSION_MAJOR, APP_VERSION_MINOR, APP_VERSION_PATCH);
+
+	// Analyze the program and write out the report JSON.
+	if(!ProcessInput(program, pBaseline, outputFilePath, budgets, topCount))
+	{
+		return APP_EXIT_FAILURE;
+	}
+
+	return APP_EXIT_SUCCESS;
+}
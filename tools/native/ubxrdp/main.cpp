@@ -0,0 +1,1655 @@
+//
+// Copyright (c) 2023, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "../common/build.hpp"
+#include "../common/file_buffer.hpp"
+#include "../common/gbi.hpp"
+#include "../common/log.hpp"
+
+#include <assert.h>
+#include <float.h>
+#include <locale.h>
+#include <inttypes.h>
+#include <math.h>
+#include <memory.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#define CXXOPTS_NO_RTTI
+#include <cxxopts.hpp>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define APP_EXIT_SUCCESS 0
+#define APP_EXIT_FAILURE 1
+
+#define APP_VERSION_MAJOR 1
+#define APP_VERSION_MINOR 0
+#define APP_VERSION_PATCH 0
+
+// Bump this whenever the layout of the JSON report changes so CI scripts comparing reports can tell.
+#define REPORT_VERSION 1
+
+// The RSP and RDP both run at this rate.
+#define RCP_CLOCK_RATE 62500000
+
+// Decoding stops after this many commands, which catches display lists that loop back on themselves.
+#define MAX_COMMAND_COUNT 1000000
+
+// Default number of primitives listed in the text report.
+#define DEFAULT_TOP_PRIMITIVE_COUNT 10
+
+// Scanlines are handed out to the rasterizer threads in interleaved bands of this many rows, which keeps the work
+// balanced when most of the geometry sits in one part of the screen.
+#define RASTER_BAND_HEIGHT 8
+
+// Frame size used until the display list sets a color image and scissor.
+#define DEFAULT_FRAME_WIDTH  320
+#define DEFAULT_FRAME_HEIGHT 240
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// RDP cost model, in RCP clock cycles. These are rough figures meant for comparing render modes against each other.
+#define RDP_CYCLES_PER_PRIMITIVE    10
+#define RDP_COMMAND_BYTES_PER_CYCLE 8
+#define RDP_CYCLES_PER_SPAN         6
+#define RDP_MEMORY_BYTES_PER_CYCLE  4
+#define RDP_TMEM_BYTES_PER_CYCLE    8
+#define RDP_CYCLES_PER_LOADTILE_ROW 4
+#define RDP_CYCLES_PER_TLUT_ENTRY   1
+
+// Size of each part of a triangle command as sent to the RDP.
+#define RDP_TRI_EDGE_BYTES  32
+#define RDP_TRI_SHADE_BYTES 64
+#define RDP_TRI_TEX_BYTES   64
+#define RDP_TRI_Z_BYTES     16
+#define RDP_TEXRECT_BYTES   16
+#define RDP_FILLRECT_BYTES  8
+
+// Bytes per Z buffer pixel.
+#define RDP_Z_PIXEL_SIZE 2
+
+//----------------------------------------------------------------------------------------------------------------------
+
+enum PRIM_TYPE : uint8_t
+{
+	PRIM_TYPE_TRIANGLE,
+	PRIM_TYPE_FILL_RECT,
+	PRIM_TYPE_TEX_RECT,
+
+	PRIM_TYPE__COUNT,
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+constexpr const char* const gPrimTypeName[PRIM_TYPE__COUNT] =
+{
+	"triangle",  // PRIM_TYPE_TRIANGLE
+	"fill_rect", // PRIM_TYPE_FILL_RECT
+	"tex_rect",  // PRIM_TYPE_TEX_RECT
+};
+
+constexpr const char* const gCycleTypeName[] =
+{
+	"1cycle", // GFX_CYC_1CYCLE
+	"2cycle", // GFX_CYC_2CYCLE
+	"copy",   // GFX_CYC_COPY
+	"fill",   // GFX_CYC_FILL
+};
+
+constexpr const char* const gTextureFilterName[] =
+{
+	"point",   // GFX_TF_POINT
+	"point",   // (unused)
+	"bilerp",  // GFX_TF_BILERP
+	"average", // GFX_TF_AVERAGE
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct Matrix
+{
+	float m[4][4];
+};
+
+struct Viewport
+{
+	float scale[3];
+	float translate[3];
+};
+
+struct ScreenVertex
+{
+	float x;
+	float y;
+	float z;
+
+	// Frustum planes the vertex is outside of, for trivially rejecting triangles.
+	uint8_t outsideMask;
+	bool valid;
+};
+
+struct RenderState
+{
+	int32_t scissor[4];
+
+	uint8_t cycleType;
+	uint8_t textureFilter;
+	uint8_t colorPixelSize;
+
+	bool zCompare;
+	bool zUpdate;
+	bool colorRead;
+	bool textured;
+
+	// Fill rectangles into the Z buffer are how frames clear depth.
+	bool depthClear;
+};
+
+struct Primitive
+{
+	// Triangles use all three vertices; rectangles store their corners in the first two.
+	float x[3];
+	float y[3];
+	float z[3];
+
+	RenderState state;
+
+	uint64_t textureLoadBytes;
+	uint64_t textureLoadCycles;
+
+	uint32_t address;
+	uint32_t commandBytes;
+
+	PRIM_TYPE type;
+};
+
+struct RasterStats
+{
+	uint64_t spanCount = 0;
+	uint64_t pixelCount = 0;
+	uint64_t depthPassCount = 0;
+	uint64_t colorBytes = 0;
+	uint64_t depthBytes = 0;
+};
+
+struct PrimitiveResult
+{
+	RasterStats raster;
+
+	uint64_t cycles = 0;
+	uint64_t memoryCycles = 0;
+	uint64_t pipelineCycles = 0;
+};
+
+struct Frame
+{
+	std::vector<Primitive> primitives;
+
+	uint64_t textureLoadCount = 0;
+	uint64_t textureLoadBytes = 0;
+	uint64_t syncCycles = 0;
+	uint64_t skippedTriangleCount = 0;
+	uint64_t culledTriangleCount = 0;
+
+	int32_t width = DEFAULT_FRAME_WIDTH;
+	int32_t height = DEFAULT_FRAME_HEIGHT;
+};
+
+struct SimConfig
+{
+	const FileBuffer* pInput;
+
+	uint32_t baseAddress;
+	uint32_t segment[16];
+
+	int32_t forceCycleType;
+	int32_t forceTextureFilter;
+};
+
+struct DecoderState
+{
+	uint32_t segment[16];
+
+	Matrix modelView;
+	Matrix projection;
+	Matrix modelViewProjection;
+	std::vector<Matrix> matrixStack;
+
+	Viewport viewport;
+	ScreenVertex vertex[GFX_VTX_BUFFER_SIZE];
+
+	RenderState renderState;
+
+	uint64_t pendingLoadBytes;
+	uint64_t pendingLoadCycles;
+
+	uint32_t geometryMode;
+	uint32_t otherModeH;
+	uint32_t otherModeL;
+	uint32_t colorImageAddress;
+	uint32_t depthImageAddress;
+
+	uint8_t textureImageSize;
+	bool textureEnabled;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const GfxCommandDesc* gCommandLookup[256] = {};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ParseNumber(const std::string& text, uint32_t& output)
+{
+	if(text.empty())
+	{
+		return false;
+	}
+
+	char* pEnd = nullptr;
+	const unsigned long long value = strtoull(text.c_str(), &pEnd, 0);
+
+	if(*pEnd != '\0' || value > UINT32_MAX)
+	{
+		return false;
+	}
+
+	output = uint32_t(value);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string EscapeJsonString(const std::string_view& text)
+{
+	std::string output;
+	output.reserve(text.size());
+
+	for(const char c : text)
+	{
+		switch(c)
+		{
+			case '"':  output += "\\\""; break;
+			case '\\': output += "\\\\"; break;
+			case '\t': output += "\\t"; break;
+
+			default:
+				if(uint8_t(c) >= 0x20)
+				{
+					output += c;
+				}
+				break;
+		}
+	}
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const uint8_t* GetData(const SimConfig& config, const DecoderState& state, const uint32_t address, const size_t size)
+{
+	const uint32_t physAddr = GfxResolveSegmentAddress(state.segment, address);
+
+	if(physAddr < config.baseAddress || size_t(physAddr - config.baseAddress) + size > config.pInput->length)
+	{
+		return nullptr;
+	}
+
+	return config.pInput->data.get() + (physAddr - config.baseAddress);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint16_t ReadU16(const uint8_t* const pData)
+{
+	// Everything in RDRAM is big-endian.
+	return uint16_t((uint32_t(pData[0]) << 8) | uint32_t(pData[1]));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint32_t ReadU32(const uint8_t* const pData)
+{
+	return (uint32_t(pData[0]) << 24) | (uint32_t(pData[1]) << 16) | (uint32_t(pData[2]) << 8) | uint32_t(pData[3]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SetIdentity(Matrix& output)
+{
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; ++j)
+		{
+			output.m[i][j] = (i == j) ? 1.0f : 0.0f;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Matrix Multiply(const Matrix& left, const Matrix& right)
+{
+	Matrix output;
+
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; ++j)
+		{
+			output.m[i][j] = (left.m[i][0] * right.m[0][j])
+				+ (left.m[i][1] * right.m[1][j])
+				+ (left.m[i][2] * right.m[2][j])
+				+ (left.m[i][3] * right.m[3][j]);
+		}
+	}
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ReadMatrix(const uint8_t* const pData, Matrix& output)
+{
+	// Fixed point matrices hold the integer halves of all sixteen elements followed by the fractional halves.
+	for(int i = 0; i < 4; ++i)
+	{
+		for(int j = 0; j < 4; ++j)
+		{
+			const size_t index = size_t((i * 4) + j) * sizeof(uint16_t);
+			const int32_t value = int32_t((uint32_t(ReadU16(pData + index)) << 16) | uint32_t(ReadU16(pData + 32 + index)));
+
+			output.m[i][j] = float(value) / 65536.0f;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ResetDecoderState(const SimConfig& config, DecoderState& state)
+{
+	state = DecoderState();
+
+	memcpy(state.segment, config.segment, sizeof(state.segment));
+
+	SetIdentity(state.modelView);
+	SetIdentity(state.projection);
+	SetIdentity(state.modelViewProjection);
+
+	// Full screen viewport until the display list loads its own.
+	for(int i = 0; i < 2; ++i)
+	{
+		const float extent = (i == 0) ? float(DEFAULT_FRAME_WIDTH) : float(DEFAULT_FRAME_HEIGHT);
+
+		state.viewport.scale[i] = extent * 0.5f;
+		state.viewport.translate[i] = extent * 0.5f;
+	}
+
+	state.viewport.scale[2] = 511.0f;
+	state.viewport.translate[2] = 511.0f;
+
+	state.renderState.scissor[2] = DEFAULT_FRAME_WIDTH;
+	state.renderState.scissor[3] = DEFAULT_FRAME_HEIGHT;
+	state.renderState.colorPixelSize = 2;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void UpdateRenderState(const SimConfig& config, DecoderState& state)
+{
+	RenderState& renderState = state.renderState;
+
+	renderState.cycleType = uint8_t((state.otherModeH >> GFX_MDSFT_CYCLETYPE) & 0x3);
+	renderState.textureFilter = uint8_t((state.otherModeH >> GFX_MDSFT_TEXTFILT) & 0x3);
+
+	if(config.forceCycleType >= 0 && renderState.cycleType <= GFX_CYC_2CYCLE)
+	{
+		renderState.cycleType = uint8_t(config.forceCycleType);
+	}
+
+	if(config.forceTextureFilter >= 0)
+	{
+		renderState.textureFilter = uint8_t(config.forceTextureFilter);
+	}
+
+	// Copy and fill modes bypass the blender and the depth test entirely.
+	const bool fullPipeline = (renderState.cycleType <= GFX_CYC_2CYCLE);
+
+	renderState.zCompare = fullPipeline && (state.otherModeL & GFX_RM_Z_CMP);
+	renderState.zUpdate = fullPipeline && (state.otherModeL & GFX_RM_Z_UPD);
+	renderState.colorRead = fullPipeline && (state.otherModeL & GFX_RM_IM_RD);
+	renderState.textured = state.textureEnabled;
+	renderState.depthClear = (state.colorImageAddress != 0 && state.colorImageAddress == state.depthImageAddress);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void LoadVertices(const uint8_t* const pData, const uint32_t first, const uint32_t count, DecoderState& state)
+{
+	for(uint32_t i = 0; i < count && first + i < GFX_VTX_BUFFER_SIZE; ++i)
+	{
+		const uint8_t* const pVertex = pData + (i * 16);
+		const float position[4] =
+		{
+			float(int16_t(ReadU16(pVertex + 0))),
+			float(int16_t(ReadU16(pVertex + 2))),
+			float(int16_t(ReadU16(pVertex + 4))),
+			1.0f,
+		};
+
+		float clip[4];
+		for(int j = 0; j < 4; ++j)
+		{
+			clip[j] = (position[0] * state.modelViewProjection.m[0][j])
+				+ (position[1] * state.modelViewProjection.m[1][j])
+				+ (position[2] * state.modelViewProjection.m[2][j])
+				+ (position[3] * state.modelViewProjection.m[3][j]);
+		}
+
+		ScreenVertex& vertex = state.vertex[first + i];
+
+		vertex.outsideMask = uint8_t(
+			((clip[0] < -clip[3]) ? 0x01 : 0)
+			| ((clip[0] > clip[3]) ? 0x02 : 0)
+			| ((clip[1] < -clip[3]) ? 0x04 : 0)
+			| ((clip[1] > clip[3]) ? 0x08 : 0)
+			| ((clip[2] > clip[3]) ? 0x10 : 0));
+
+		// There is no clipper; anything at or behind the eye is simply dropped along with its triangles.
+		vertex.valid = (clip[3] > 0.0f);
+
+		if(vertex.valid)
+		{
+			const float invW = 1.0f / clip[3];
+
+			vertex.x = state.viewport.translate[0] + (clip[0] * invW * state.viewport.scale[0]);
+			vertex.y = state.viewport.translate[1] - (clip[1] * invW * state.viewport.scale[1]);
+			vertex.z = state.viewport.translate[2] + (clip[2] * invW * state.viewport.scale[2]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void AddTriangle(
+	DecoderState& state,
+	Frame& frame,
+	const uint32_t address,
+	const uint32_t v0,
+	const uint32_t v1,
+	const uint32_t v2)
+{
+	if(v0 >= GFX_VTX_BUFFER_SIZE || v1 >= GFX_VTX_BUFFER_SIZE || v2 >= GFX_VTX_BUFFER_SIZE)
+	{
+		++frame.skippedTriangleCount;
+		return;
+	}
+
+	const ScreenVertex* const pVertex[3] = { &state.vertex[v0], &state.vertex[v1], &state.vertex[v2] };
+
+	if(!pVertex[0]->valid || !pVertex[1]->valid || !pVertex[2]->valid)
+	{
+		++frame.skippedTriangleCount;
+		return;
+	}
+
+	if(pVertex[0]->outsideMask & pVertex[1]->outsideMask & pVertex[2]->outsideMask)
+	{
+		++frame.culledTriangleCount;
+		return;
+	}
+
+	// Screen space Y points down, so front faces (counter-clockwise in clip space) have a negative area here.
+	const float area = ((pVertex[1]->x - pVertex[0]->x) * (pVertex[2]->y - pVertex[0]->y))
+		- ((pVertex[2]->x - pVertex[0]->x) * (pVertex[1]->y - pVertex[0]->y));
+
+	const uint32_t cullMask = (area < 0.0f) ? GFX_GEOMETRY_CULL_FRONT : GFX_GEOMETRY_CULL_BACK;
+
+	if(area == 0.0f || (state.geometryMode & cullMask))
+	{
+		++frame.culledTriangleCount;
+		return;
+	}
+
+	Primitive primitive;
+	primitive.type = PRIM_TYPE_TRIANGLE;
+	primitive.address = address;
+	primitive.state = state.renderState;
+
+	// The micro-code only sends the coefficients the RDP will actually use.
+	primitive.commandBytes = RDP_TRI_EDGE_BYTES
+		+ ((state.geometryMode & GFX_GEOMETRY_SHADE) ? RDP_TRI_SHADE_BYTES : 0)
+		+ (state.textureEnabled ? RDP_TRI_TEX_BYTES : 0)
+		+ ((state.geometryMode & GFX_GEOMETRY_ZBUFFER) ? RDP_TRI_Z_BYTES : 0);
+
+	if(!(state.geometryMode & GFX_GEOMETRY_ZBUFFER))
+	{
+		primitive.state.zCompare = false;
+		primitive.state.zUpdate = false;
+	}
+
+	for(int i = 0; i < 3; ++i)
+	{
+		primitive.x[i] = pVertex[i]->x;
+		primitive.y[i] = pVertex[i]->y;
+		primitive.z[i] = pVertex[i]->z;
+	}
+
+	primitive.textureLoadBytes = state.pendingLoadBytes;
+	primitive.textureLoadCycles = state.pendingLoadCycles;
+
+	state.pendingLoadBytes = 0;
+	state.pendingLoadCycles = 0;
+
+	frame.primitives.push_back(primitive);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void AddRectangle(DecoderState& state, Frame& frame, const PRIM_TYPE type, const uint32_t address, const uint32_t w0, const uint32_t w1)
+{
+	Primitive primitive;
+	primitive.type = type;
+	primitive.address = address;
+	primitive.state = state.renderState;
+	primitive.commandBytes = (type == PRIM_TYPE_TEX_RECT) ? RDP_TEXRECT_BYTES : RDP_FILLRECT_BYTES;
+
+	// Both rectangle commands store the lower-right corner in the first word and the upper-left one in the second,
+	// as 10.2 fixed point. Fill and copy modes draw the lower-right edges, the other modes don't.
+	const float inclusive = (primitive.state.cycleType >= GFX_CYC_COPY) ? 1.0f : 0.0f;
+
+	primitive.x[0] = float((w1 >> 12) & 0xFFF) / 4.0f;
+	primitive.y[0] = float(w1 & 0xFFF) / 4.0f;
+	primitive.x[1] = (float((w0 >> 12) & 0xFFF) / 4.0f) + inclusive;
+	primitive.y[1] = (float(w0 & 0xFFF) / 4.0f) + inclusive;
+
+	// Rectangles have no depth of their own.
+	primitive.state.zCompare = false;
+	primitive.state.zUpdate = false;
+
+	primitive.textureLoadBytes = state.pendingLoadBytes;
+	primitive.textureLoadCycles = state.pendingLoadCycles;
+
+	state.pendingLoadBytes = 0;
+	state.pendingLoadCycles = 0;
+
+	frame.primitives.push_back(primitive);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void AddTextureLoad(DecoderState& state, Frame& frame, const uint64_t byteCount, const uint64_t cycles)
+{
+	++frame.textureLoadCount;
+	frame.textureLoadBytes += byteCount;
+
+	// Loads are charged to the next primitive, since that's the one that waits on them.
+	state.pendingLoadBytes += byteCount;
+	state.pendingLoadCycles += cycles;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool DecodeFrame(const SimConfig& config, const uint32_t rootAddress, Frame& frame)
+{
+	DecoderState state;
+	ResetDecoderState(config, state);
+	UpdateRenderState(config, state);
+
+	std::vector<uint32_t> returnStack;
+
+	uint32_t pc = rootAddress;
+	uint32_t commandCount = 0;
+
+	for(;;)
+	{
+		if(++commandCount > MAX_COMMAND_COUNT)
+		{
+			LOG_WARN("Command limit reached; the display list may loop, so decoding stopped");
+			break;
+		}
+
+		const uint8_t* const pCommand = GetData(config, state, pc, sizeof(uint64_t));
+		if(!pCommand)
+		{
+			LOG_ERROR_FMT("Display list address does not resolve to data in the input file: 0x%08" PRIX32, pc);
+			return false;
+		}
+
+		const uint32_t address = GfxResolveSegmentAddress(state.segment, pc);
+		const uint32_t w0 = ReadU32(pCommand);
+		const uint32_t w1 = ReadU32(pCommand + 4);
+		const uint8_t opcode = uint8_t(w0 >> 24);
+
+		// Commands are read in place, so the program counter stays in whatever segment the list was called through.
+		pc += sizeof(uint64_t);
+
+		if(!gCommandLookup[opcode])
+		{
+			LOG_WARN_FMT("Unknown command at 0x%08" PRIX32 " (%08" PRIX32 " %08" PRIX32 "); decoding stopped", address, w0, w1);
+			break;
+		}
+
+		bool endOfList = false;
+
+		switch(opcode)
+		{
+			case GFX_OP_DL:
+				if(((w0 >> 16) & 0xFF) == GFX_DL_PUSH)
+				{
+					if(returnStack.size() >= GFX_DL_STACK_DEPTH)
+					{
+						LOG_WARN_FMT("Display list stack overflow at 0x%08" PRIX32, address);
+					}
+
+					returnStack.push_back(pc);
+				}
+
+				pc = w1;
+				break;
+
+			case GFX_OP_ENDDL:
+				if(returnStack.empty())
+				{
+					endOfList = true;
+				}
+				else
+				{
+					pc = returnStack.back();
+					returnStack.pop_back();
+				}
+				break;
+
+			case GFX_OP_MOVEWORD:
+				if(((w0 >> 16) & 0xFF) == GFX_MW_SEGMENT)
+				{
+					state.segment[((w0 & 0xFFFF) >> 2) & 0xF] = w1 & 0x00FFFFFF;
+				}
+				break;
+
+			case GFX_OP_MOVEMEM:
+				if((w0 & 0xFF) == GFX_MV_VIEWPORT)
+				{
+					const uint8_t* const pData = GetData(config, state, w1, 16);
+					if(pData)
+					{
+						// Viewports are stored in quarter pixels.
+						for(int i = 0; i < 3; ++i)
+						{
+							const float divisor = (i < 2) ? 4.0f : 1.0f;
+
+							state.viewport.scale[i] = float(int16_t(ReadU16(pData + (i * 2)))) / divisor;
+							state.viewport.translate[i] = float(int16_t(ReadU16(pData + 8 + (i * 2)))) / divisor;
+						}
+					}
+				}
+				break;
+
+			case GFX_OP_MTX:
+			{
+				const uint8_t* const pData = GetData(config, state, w1, 64);
+				if(!pData)
+				{
+					LOG_WARN_FMT("Matrix at 0x%08" PRIX32 " does not resolve to data in the input file", address);
+					break;
+				}
+
+				// The push flag is stored inverted in the command.
+				const uint32_t params = (w0 & 0xFF) ^ GFX_MTX_PUSH;
+
+				Matrix matrix;
+				ReadMatrix(pData, matrix);
+
+				Matrix& target = (params & GFX_MTX_PROJECTION) ? state.projection : state.modelView;
+
+				if(!(params & GFX_MTX_PROJECTION) && (params & GFX_MTX_PUSH))
+				{
+					state.matrixStack.push_back(state.modelView);
+				}
+
+				target = (params & GFX_MTX_LOAD) ? matrix : Multiply(matrix, target);
+
+				state.modelViewProjection = Multiply(state.modelView, state.projection);
+				break;
+			}
+
+			case GFX_OP_POPMTX:
+				for(uint32_t i = 0; i < w1 / 64 && !state.matrixStack.empty(); ++i)
+				{
+					state.modelView = state.matrixStack.back();
+					state.matrixStack.pop_back();
+				}
+
+				state.modelViewProjection = Multiply(state.modelView, state.projection);
+				break;
+
+			case GFX_OP_VTX:
+			{
+				const uint32_t count = (w0 >> 12) & 0xFF;
+				const uint32_t end = (w0 >> 1) & 0x7F;
+
+				const uint8_t* const pData = GetData(config, state, w1, count * 16);
+				if(!pData || end < count)
+				{
+					LOG_WARN_FMT("Vertices at 0x%08" PRIX32 " do not resolve to data in the input file", address);
+					break;
+				}
+
+				LoadVertices(pData, end - count, count, state);
+				break;
+			}
+
+			case GFX_OP_TRI1:
+				AddTriangle(state, frame, address, ((w0 >> 16) & 0xFF) / 2, ((w0 >> 8) & 0xFF) / 2, (w0 & 0xFF) / 2);
+				break;
+
+			case GFX_OP_TRI2:
+			case GFX_OP_QUAD:
+				AddTriangle(state, frame, address, ((w0 >> 16) & 0xFF) / 2, ((w0 >> 8) & 0xFF) / 2, (w0 & 0xFF) / 2);
+				AddTriangle(state, frame, address, ((w1 >> 16) & 0xFF) / 2, ((w1 >> 8) & 0xFF) / 2, (w1 & 0xFF) / 2);
+				break;
+
+			case GFX_OP_GEOMETRYMODE:
+				state.geometryMode = (state.geometryMode & (w0 & 0x00FFFFFF)) | w1;
+				break;
+
+			case GFX_OP_TEXTURE:
+				state.textureEnabled = (((w0 >> 1) & 0x7F) != 0);
+				UpdateRenderState(config, state);
+				break;
+
+			case GFX_OP_SETOTHERMODE_L:
+			case GFX_OP_SETOTHERMODE_H:
+			{
+				const uint32_t length = (w0 & 0xFF) + 1;
+				const uint32_t shift = 32 - ((w0 >> 8) & 0xFF) - length;
+				const uint32_t mask = (length >= 32) ? 0xFFFFFFFF : (((1u << length) - 1) << shift);
+
+				uint32_t& mode = (opcode == GFX_OP_SETOTHERMODE_H) ? state.otherModeH : state.otherModeL;
+				mode = (mode & ~mask) | (w1 & mask);
+
+				UpdateRenderState(config, state);
+				break;
+			}
+
+			case GFX_OP_RDPSETOTHERMODE:
+				state.otherModeH = w0 & 0x00FFFFFF;
+				state.otherModeL = w1;
+
+				UpdateRenderState(config, state);
+				break;
+
+			case GFX_OP_SETCIMG:
+			{
+				const int32_t width = int32_t(w0 & 0xFFF) + 1;
+
+				state.colorImageAddress = w1 & 0x00FFFFFF;
+				state.renderState.colorPixelSize = uint8_t((4u << ((w0 >> 19) & 0x3)) / 8);
+
+				frame.width = std::max(frame.width, width);
+
+				UpdateRenderState(config, state);
+				break;
+			}
+
+			case GFX_OP_SETZIMG:
+				state.depthImageAddress = w1 & 0x00FFFFFF;
+
+				UpdateRenderState(config, state);
+				break;
+
+			case GFX_OP_SETSCISSOR:
+			{
+				int32_t* const pScissor = state.renderState.scissor;
+
+				pScissor[0] = int32_t((w0 >> 12) & 0xFFF) >> 2;
+				pScissor[1] = int32_t(w0 & 0xFFF) >> 2;
+				pScissor[2] = int32_t((w1 >> 12) & 0xFFF) >> 2;
+				pScissor[3] = int32_t(w1 & 0xFFF) >> 2;
+
+				frame.height = std::max(frame.height, pScissor[3]);
+				break;
+			}
+
+			case GFX_OP_SETTIMG:
+				state.textureImageSize = uint8_t((w0 >> 19) & 0x3);
+				break;
+
+			case GFX_OP_LOADBLOCK:
+			{
+				// Block loads store the texel count minus one in place of the lower-right S coordinate.
+				const uint32_t uls = (w0 >> 12) & 0xFFF;
+				const uint32_t lrs = (w1 >> 12) & 0xFFF;
+				const uint64_t texelCount = (lrs >= uls) ? (lrs - uls + 1) : 0;
+				const uint64_t byteCount = (texelCount * (4u << state.textureImageSize)) / 8;
+
+				AddTextureLoad(state, frame, byteCount, byteCount / RDP_TMEM_BYTES_PER_CYCLE);
+				break;
+			}
+
+			case GFX_OP_LOADTILE:
+			{
+				const uint32_t uls = ((w0 >> 12) & 0xFFF) >> 2;
+				const uint32_t ult = (w0 & 0xFFF) >> 2;
+				const uint32_t lrs = ((w1 >> 12) & 0xFFF) >> 2;
+				const uint32_t lrt = (w1 & 0xFFF) >> 2;
+
+				const uint64_t rowCount = (lrt >= ult) ? (lrt - ult + 1) : 0;
+				const uint64_t texelCount = ((lrs >= uls) ? (lrs - uls + 1) : 0) * rowCount;
+				const uint64_t byteCount = (texelCount * (4u << state.textureImageSize)) / 8;
+
+				AddTextureLoad(state, frame, byteCount, (byteCount / RDP_TMEM_BYTES_PER_CYCLE) + (rowCount * RDP_CYCLES_PER_LOADTILE_ROW));
+				break;
+			}
+
+			case GFX_OP_LOADTLUT:
+			{
+				const uint64_t entryCount = ((w1 >> 14) & 0x3FF) + 1;
+
+				AddTextureLoad(state, frame, entryCount * sizeof(uint16_t), entryCount * RDP_CYCLES_PER_TLUT_ENTRY);
+				break;
+			}
+
+			case GFX_OP_FILLRECT:
+				AddRectangle(state, frame, PRIM_TYPE_FILL_RECT, address, w0, w1);
+				break;
+
+			case GFX_OP_TEXRECT:
+			case GFX_OP_TEXRECTFLIP:
+				AddRectangle(state, frame, PRIM_TYPE_TEX_RECT, address, w0, w1);
+				break;
+
+			case GFX_OP_RDPLOADSYNC:
+			case GFX_OP_RDPPIPESYNC:
+			case GFX_OP_RDPTILESYNC:
+			case GFX_OP_RDPFULLSYNC:
+				frame.syncCycles += gCommandLookup[opcode]->rdpCycles;
+				break;
+
+			default:
+				break;
+		}
+
+		if(endOfList)
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void RasterizeSpan(
+	const Primitive& primitive,
+	const int32_t y,
+	int32_t xStart,
+	int32_t xEnd,
+	const float zPlane[3],
+	float* const pDepthRow,
+	RasterStats& stats)
+{
+	const RenderState& state = primitive.state;
+
+	xStart = std::max(xStart, state.scissor[0]);
+	xEnd = std::min(xEnd, state.scissor[2]);
+
+	if(xStart >= xEnd)
+	{
+		return;
+	}
+
+	const uint64_t pixelCount = uint64_t(xEnd - xStart);
+
+	++stats.spanCount;
+	stats.pixelCount += pixelCount;
+
+	if(state.colorRead)
+	{
+		stats.colorBytes += pixelCount * state.colorPixelSize;
+	}
+
+	if(state.depthClear)
+	{
+		// Clearing depth writes the Z buffer through the color image.
+		for(int32_t x = xStart; x < xEnd; ++x)
+		{
+			pDepthRow[x] = FLT_MAX;
+		}
+
+		stats.depthPassCount += pixelCount;
+		stats.colorBytes += pixelCount * state.colorPixelSize;
+		return;
+	}
+
+	if(!state.zCompare)
+	{
+		stats.depthPassCount += pixelCount;
+		stats.colorBytes += pixelCount * state.colorPixelSize;
+
+		if(state.zUpdate)
+		{
+			for(int32_t x = xStart; x < xEnd; ++x)
+			{
+				pDepthRow[x] = (zPlane[0] * (float(x) + 0.5f)) + (zPlane[1] * (float(y) + 0.5f)) + zPlane[2];
+			}
+
+			stats.depthBytes += pixelCount * RDP_Z_PIXEL_SIZE;
+		}
+		return;
+	}
+
+	stats.depthBytes += pixelCount * RDP_Z_PIXEL_SIZE;
+
+	for(int32_t x = xStart; x < xEnd; ++x)
+	{
+		const float z = (zPlane[0] * (float(x) + 0.5f)) + (zPlane[1] * (float(y) + 0.5f)) + zPlane[2];
+
+		if(z <= pDepthRow[x])
+		{
+			++stats.depthPassCount;
+			stats.colorBytes += state.colorPixelSize;
+
+			if(state.zUpdate)
+			{
+				pDepthRow[x] = z;
+				stats.depthBytes += RDP_Z_PIXEL_SIZE;
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void RasterizeTriangle(
+	const Primitive& primitive,
+	const int32_t frameWidth,
+	const int32_t yMin,
+	const int32_t yMax,
+	const uint32_t threadIndex,
+	const uint32_t threadCount,
+	float* const pDepth,
+	RasterStats& stats)
+{
+	// Sort the vertices from top to bottom.
+	int order[3] = { 0, 1, 2 };
+	std::sort(order, order + 3, [&primitive](const int left, const int right) { return primitive.y[left] < primitive.y[right]; });
+
+	const float x0 = primitive.x[order[0]], y0 = primitive.y[order[0]];
+	const float x1 = primitive.x[order[1]], y1 = primitive.y[order[1]];
+	const float x2 = primitive.x[order[2]], y2 = primitive.y[order[2]];
+
+	// Depth is linear in screen space, so solve its plane equation once up front.
+	const float determinant = ((primitive.x[1] - primitive.x[0]) * (primitive.y[2] - primitive.y[0]))
+		- ((primitive.x[2] - primitive.x[0]) * (primitive.y[1] - primitive.y[0]));
+
+	float zPlane[3] = { 0.0f, 0.0f, primitive.z[0] };
+
+	if(determinant != 0.0f)
+	{
+		const float dz1 = primitive.z[1] - primitive.z[0];
+		const float dz2 = primitive.z[2] - primitive.z[0];
+
+		zPlane[0] = ((dz1 * (primitive.y[2] - primitive.y[0])) - (dz2 * (primitive.y[1] - primitive.y[0]))) / determinant;
+		zPlane[1] = ((dz2 * (primitive.x[1] - primitive.x[0])) - (dz1 * (primitive.x[2] - primitive.x[0]))) / determinant;
+		zPlane[2] = primitive.z[0] - (zPlane[0] * primitive.x[0]) - (zPlane[1] * primitive.y[0]);
+	}
+
+	const int32_t firstRow = std::max(yMin, int32_t(ceilf(y0 - 0.5f)));
+	const int32_t lastRow = std::min(yMax, int32_t(ceilf(y2 - 0.5f)));
+
+	for(int32_t y = firstRow; y < lastRow; ++y)
+	{
+		if(uint32_t(y / RASTER_BAND_HEIGHT) % threadCount != threadIndex)
+		{
+			continue;
+		}
+
+		const float sampleY = float(y) + 0.5f;
+
+		// Intersect the scanline with the long edge and whichever short edge spans it.
+		const float longX = x0 + ((x2 - x0) * (sampleY - y0) / (y2 - y0));
+		const float shortX = (sampleY < y1)
+			? x0 + ((x1 - x0) * (sampleY - y0) / (y1 - y0))
+			: x1 + ((x2 - x1) * (sampleY - y1) / (y2 - y1));
+
+		const float left = std::min(longX, shortX);
+		const float right = std::max(longX, shortX);
+
+		const int32_t xStart = std::max(0, int32_t(ceilf(left - 0.5f)));
+		const int32_t xEnd = std::min(frameWidth, int32_t(ceilf(right - 0.5f)));
+
+		RasterizeSpan(primitive, y, xStart, xEnd, zPlane, pDepth + (size_t(y) * size_t(frameWidth)), stats);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void RasterizeRectangle(
+	const Primitive& primitive,
+	const int32_t frameWidth,
+	const int32_t yMin,
+	const int32_t yMax,
+	const uint32_t threadIndex,
+	const uint32_t threadCount,
+	float* const pDepth,
+	RasterStats& stats)
+{
+	const float zPlane[3] = { 0.0f, 0.0f, 0.0f };
+
+	const int32_t firstRow = std::max(yMin, int32_t(primitive.y[0]));
+	const int32_t lastRow = std::min(yMax, int32_t(primitive.y[1]));
+	const int32_t xStart = std::max(0, int32_t(primitive.x[0]));
+	const int32_t xEnd = std::min(frameWidth, int32_t(primitive.x[1]));
+
+	for(int32_t y = firstRow; y < lastRow; ++y)
+	{
+		if(uint32_t(y / RASTER_BAND_HEIGHT) % threadCount != threadIndex)
+		{
+			continue;
+		}
+
+		RasterizeSpan(primitive, y, xStart, xEnd, zPlane, pDepth + (size_t(y) * size_t(frameWidth)), stats);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void RasterizeThread(
+	const Frame& frame,
+	const uint32_t threadIndex,
+	const uint32_t threadCount,
+	float* const pDepth,
+	RasterStats* const pStats)
+{
+	// Each thread owns every row of its bands, including the Z buffer, so no synchronization is needed. Primitives
+	// are still processed in submission order within a row, which is all the depth test cares about.
+	for(size_t i = 0; i < frame.primitives.size(); ++i)
+	{
+		const Primitive& primitive = frame.primitives[i];
+
+		const int32_t yMin = std::max(0, primitive.state.scissor[1]);
+		const int32_t yMax = std::min(frame.height, primitive.state.scissor[3]);
+
+		if(primitive.type == PRIM_TYPE_TRIANGLE)
+		{
+			RasterizeTriangle(primitive, frame.width, yMin, yMax, threadIndex, threadCount, pDepth, pStats[i]);
+		}
+		else
+		{
+			RasterizeRectangle(primitive, frame.width, yMin, yMax, threadIndex, threadCount, pDepth, pStats[i]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SimulateFrame(const Frame& frame, const uint32_t threadCount, std::vector<PrimitiveResult>& results)
+{
+	const size_t primitiveCount = frame.primitives.size();
+
+	std::vector<float> depth(size_t(frame.width) * size_t(frame.height), FLT_MAX);
+	std::vector<RasterStats> threadStats(primitiveCount * threadCount);
+	std::vector<std::thread> threads;
+
+	for(uint32_t i = 1; i < threadCount; ++i)
+	{
+		threads.emplace_back(RasterizeThread, std::cref(frame), i, threadCount, depth.data(), threadStats.data() + (i * primitiveCount));
+	}
+
+	RasterizeThread(frame, 0, threadCount, depth.data(), threadStats.data());
+
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	results.resize(primitiveCount);
+
+	for(size_t i = 0; i < primitiveCount; ++i)
+	{
+		const Primitive& primitive = frame.primitives[i];
+		PrimitiveResult& result = results[i];
+
+		for(uint32_t t = 0; t < threadCount; ++t)
+		{
+			const RasterStats& stats = threadStats[(t * primitiveCount) + i];
+
+			result.raster.spanCount += stats.spanCount;
+			result.raster.pixelCount += stats.pixelCount;
+			result.raster.depthPassCount += stats.depthPassCount;
+			result.raster.colorBytes += stats.colorBytes;
+			result.raster.depthBytes += stats.depthBytes;
+		}
+
+		uint64_t pixelCycles;
+		switch(primitive.state.cycleType)
+		{
+			case GFX_CYC_2CYCLE: pixelCycles = result.raster.pixelCount * 2;       break;
+			case GFX_CYC_COPY:
+			case GFX_CYC_FILL:   pixelCycles = (result.raster.pixelCount + 3) / 4; break;
+
+			default:
+				pixelCycles = result.raster.pixelCount;
+				break;
+		}
+
+		// The pipeline and the memory interface overlap, so whichever one is slower sets the pace.
+		result.pipelineCycles = pixelCycles + (result.raster.spanCount * RDP_CYCLES_PER_SPAN);
+		result.memoryCycles = (result.raster.colorBytes + result.raster.depthBytes) / RDP_MEMORY_BYTES_PER_CYCLE;
+		result.cycles = RDP_CYCLES_PER_PRIMITIVE
+			+ (primitive.commandBytes / RDP_COMMAND_BYTES_PER_CYCLE)
+			+ std::max(result.pipelineCycles, result.memoryCycles)
+			+ primitive.textureLoadCycles;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string DescribeRenderState(const RenderState& state)
+{
+	std::string output = gCycleTypeName[state.cycleType];
+
+	if(state.zCompare)
+	{
+		output += " zcmp";
+	}
+
+	if(state.zUpdate)
+	{
+		output += " zupd";
+	}
+
+	if(state.colorRead)
+	{
+		output += " blend";
+	}
+
+	if(state.textured)
+	{
+		output += " ";
+		output += gTextureFilterName[state.textureFilter];
+	}
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void PrintReport(const Frame& frame, const std::vector<PrimitiveResult>& results, const size_t topCount, const double simMilliseconds, const uint32_t threadCount)
+{
+	RasterStats totals;
+	uint64_t totalCycles = frame.syncCycles;
+	uint64_t memoryBoundCount = 0;
+
+	for(const PrimitiveResult& result : results)
+	{
+		totals.spanCount += result.raster.spanCount;
+		totals.pixelCount += result.raster.pixelCount;
+		totals.depthPassCount += result.raster.depthPassCount;
+		totals.colorBytes += result.raster.colorBytes;
+		totals.depthBytes += result.raster.depthBytes;
+		totalCycles += result.cycles;
+
+		if(result.memoryCycles > result.pipelineCycles)
+		{
+			++memoryBoundCount;
+		}
+	}
+
+	const double frameMicroseconds = double(totalCycles) * 1000000.0 / double(RCP_CLOCK_RATE);
+
+	LOG_INFO_FMT("Frame (%" PRId32 "x%" PRId32 "):", frame.width, frame.height);
+	LOG_INFO_FMT("  Primitives:        %zu (%" PRIu64 " triangles culled, %" PRIu64 " skipped by the near plane)", frame.primitives.size(), frame.culledTriangleCount, frame.skippedTriangleCount);
+	LOG_INFO_FMT("  Pixels:            %" PRIu64 " (%" PRIu64 " passed depth, %" PRIu64 " spans)", totals.pixelCount, totals.depthPassCount, totals.spanCount);
+	LOG_INFO_FMT("  Color traffic:     %" PRIu64 " bytes", totals.colorBytes);
+	LOG_INFO_FMT("  Depth traffic:     %" PRIu64 " bytes", totals.depthBytes);
+	LOG_INFO_FMT("  Texture loads:     %" PRIu64 " (%" PRIu64 " bytes)", frame.textureLoadCount, frame.textureLoadBytes);
+	LOG_INFO_FMT("  Memory bound:      %" PRIu64 " of %zu primitives", memoryBoundCount, results.size());
+	LOG_INFO_FMT("  Estimated RDP:     %" PRIu64 " cycles (%.1f us, %.1f%% of a 60 Hz frame)", totalCycles, frameMicroseconds, frameMicroseconds * 100.0 / (1000000.0 / 60.0));
+	LOG_INFO_FMT("  Simulated in %.2f ms on %" PRIu32 " thread(s)", simMilliseconds, threadCount);
+
+	std::vector<size_t> order(results.size());
+	for(size_t i = 0; i < order.size(); ++i)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&results](const size_t left, const size_t right) { return results[left].cycles > results[right].cycles; });
+
+	const size_t printCount = std::min(topCount, order.size());
+	if(printCount > 0)
+	{
+		LOG_INFO("  Most expensive primitives:");
+
+		for(size_t i = 0; i < printCount; ++i)
+		{
+			const Primitive& primitive = frame.primitives[order[i]];
+			const PrimitiveResult& result = results[order[i]];
+
+			LOG_INFO_FMT(
+				"    0x%08" PRIX32 " %-9s %-30s %8" PRIu64 " pixels %8" PRIu64 " cycles%s",
+				primitive.address,
+				gPrimTypeName[primitive.type],
+				DescribeRenderState(primitive.state).c_str(),
+				result.raster.pixelCount,
+				result.cycles,
+				(result.memoryCycles > result.pipelineCycles) ? " (memory bound)" : "");
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string BuildJsonReport(const std::string_view& inputFilePath, const Frame& frame, const std::vector<PrimitiveResult>& results)
+{
+	std::string output;
+	char buffer[512];
+
+	RasterStats totals;
+	uint64_t totalCycles = frame.syncCycles;
+
+	for(const PrimitiveResult& result : results)
+	{
+		totals.spanCount += result.raster.spanCount;
+		totals.pixelCount += result.raster.pixelCount;
+		totals.depthPassCount += result.raster.depthPassCount;
+		totals.colorBytes += result.raster.colorBytes;
+		totals.depthBytes += result.raster.depthBytes;
+		totalCycles += result.cycles;
+	}
+
+	snprintf(buffer, sizeof(buffer), "{\n\t\"version\": %d,\n\t\"input\": \"", REPORT_VERSION);
+	output += buffer;
+	output += EscapeJsonString(inputFilePath);
+
+	snprintf(
+		buffer,
+		sizeof(buffer),
+		"\",\n\t\"frame\": {\n\t\t\"width\": %" PRId32 ",\n\t\t\"height\": %" PRId32 ",\n\t\t\"primitiveCount\": %zu,\n\t\t\"culledTriangleCount\": %" PRIu64 ",\n\t\t\"skippedTriangleCount\": %" PRIu64 ",\n",
+		frame.width,
+		frame.height,
+		frame.primitives.size(),
+		frame.culledTriangleCount,
+		frame.skippedTriangleCount);
+	output += buffer;
+
+	snprintf(
+		buffer,
+		sizeof(buffer),
+		"\t\t\"spanCount\": %" PRIu64 ",\n\t\t\"pixelCount\": %" PRIu64 ",\n\t\t\"depthPassCount\": %" PRIu64 ",\n\t\t\"colorBytes\": %" PRIu64 ",\n\t\t\"depthBytes\": %" PRIu64 ",\n",
+		totals.spanCount,
+		totals.pixelCount,
+		totals.depthPassCount,
+		totals.colorBytes,
+		totals.depthBytes);
+	output += buffer;
+
+	snprintf(
+		buffer,
+		sizeof(buffer),
+		"\t\t\"textureLoadCount\": %" PRIu64 ",\n\t\t\"textureLoadBytes\": %" PRIu64 ",\n\t\t\"syncCycles\": %" PRIu64 ",\n\t\t\"cycles\": %" PRIu64 "\n\t},\n\t\"primitives\": [",
+		frame.textureLoadCount,
+		frame.textureLoadBytes,
+		frame.syncCycles,
+		totalCycles);
+	output += buffer;
+
+	for(size_t i = 0; i < results.size(); ++i)
+	{
+		const Primitive& primitive = frame.primitives[i];
+		const PrimitiveResult& result = results[i];
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			"%s\n\t\t{ \"address\": \"0x%08" PRIX32 "\", \"type\": \"%s\", \"mode\": \"%s\", \"spans\": %" PRIu64 ", \"pixels\": %" PRIu64 ", \"depthPass\": %" PRIu64,
+			(i > 0) ? "," : "",
+			primitive.address,
+			gPrimTypeName[primitive.type],
+			DescribeRenderState(primitive.state).c_str(),
+			result.raster.spanCount,
+			result.raster.pixelCount,
+			result.raster.depthPassCount);
+		output += buffer;
+
+		snprintf(
+			buffer,
+			sizeof(buffer),
+			", \"colorBytes\": %" PRIu64 ", \"depthBytes\": %" PRIu64 ", \"textureLoadBytes\": %" PRIu64 ", \"cycles\": %" PRIu64 ", \"memoryBound\": %s }",
+			result.raster.colorBytes,
+			result.raster.depthBytes,
+			primitive.textureLoadBytes,
+			result.cycles,
+			(result.memoryCycles > result.pipelineCycles) ? "true" : "false");
+		output += buffer;
+	}
+
+	output += results.empty() ? "]\n}\n" : "\n\t]\n}\n";
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ProcessInput(
+	const std::string_view& inputFilePath,
+	const std::string_view& outputFilePath,
+	SimConfig& config,
+	const uint32_t rootAddress,
+	const uint32_t threadCount,
+	const size_t topCount)
+{
+	assert(inputFilePath.size() > 0);
+	assert(outputFilePath.size() > 0);
+
+	FileBuffer inputFile;
+
+	// Read the RDRAM dump or cooked asset containing the display list.
+	if(!FileBuffer::Read(inputFile, inputFilePath))
+	{
+		LOG_ERROR_FMT("Failed to load input file: %s", inputFilePath.data());
+		return false;
+	}
+
+	config.pInput = &inputFile;
+
+	for(const GfxCommandDesc& desc : gGfxCommandDesc)
+	{
+		gCommandLookup[desc.opcode] = &desc;
+	}
+
+	LOG_VERBOSE_FMT("Decoding display list 0x%08" PRIX32 " ...", rootAddress);
+
+	Frame frame;
+	if(!DecodeFrame(config, rootAddress, frame))
+	{
+		return false;
+	}
+
+	config.pInput = nullptr;
+
+	LOG_VERBOSE_FMT("Rasterizing %zu primitives ...", frame.primitives.size());
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<PrimitiveResult> results;
+	SimulateFrame(frame, threadCount, results);
+
+	const auto endTime = std::chrono::steady_clock::now();
+	const double simMilliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+	PrintReport(frame, results, topCount, simMilliseconds, threadCount);
+
+	LOG_VERBOSE("Generating report JSON ...");
+
+	const std::string json = BuildJsonReport(inputFilePath, frame, results);
+
+	FileBuffer outputFile;
+	outputFile.data = std::make_unique<uint8_t[]>(json.size());
+	outputFile.length = json.size();
+
+	memcpy(outputFile.data.get(), json.data(), json.size());
+
+	// Write the report JSON to disk.
+	if(!FileBuffer::Write(outputFilePath, outputFile))
+	{
+		LOG_ERROR_FMT("Failed to write output file: %s", outputFilePath.data());
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	// Set the program locale to the environment default.
+	setlocale(LC_ALL, "");
+
+#if defined(_WIN32)
+	// This enables tracking of global heap allocations. If any are leaked,
+	// they will show up in the Visual Studio output window on application exit.
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	cxxopts::Options options(
+#if defined(_WIN32)
+		"ubxrdp.exe",
+#else
+		"ubxrdp",
+#endif
+		"UltraBox RDP simulator (replays a captured display list and estimates its fill-rate cost)"
+	);
+
+	options
+		.custom_help("[options...]")
+		.positional_help("<input_file>")
+		.allow_unrecognised_options();
+
+	// Add the options.
+	options.add_options()
+		("h,help", "Display this help text")
+		("input_file", "File path of the RDRAM dump or cooked binary holding the display list", cxxopts::value<std::string>(), "<input_file>")
+		("o,output", "File path where the report JSON will be written to (default = <input_file>.rdp.json)", cxxopts::value<std::string>(), "file")
+		("d,dl", "Segmented or virtual address of the frame's display list (default = start of the input file)", cxxopts::value<std::string>(), "address")
+		("b,base", "Physical address the input file is loaded at (default = 0, i.e. a full RDRAM dump)", cxxopts::value<std::string>(), "address")
+		("s,segment", "Initial segment table entry; may be repeated", cxxopts::value<std::vector<std::string>>(), "<index>=<address>")
+		("t,threads", "Number of rasterizer threads (default = number of CPU cores)", cxxopts::value<std::string>(), "count")
+		("n,top", "Number of most expensive primitives to list (default = 10)", cxxopts::value<std::string>(), "count")
+		("cycle-type", "Force every 1-cycle and 2-cycle primitive into one mode", cxxopts::value<std::string>(), "1cycle|2cycle")
+		("filter", "Force the texture filter of every primitive", cxxopts::value<std::string>(), "point|bilerp|average")
+		("q,quiet", "Disable all logging exception errors")
+		("v,verbose", "Enable verbose logging (overrides -q/--quiet)");
+
+	// Define which of the above arguments are positional.
+	options.parse_positional({ "input_file" });
+
+	// Parse the application's command line arguments.
+	cxxopts::ParseResult args = options.parse(argc, argv);
+
+	if(args.count("help"))
+	{
+		// Print the help text, then exit.
+		printf("%s\n", options.help({ "" }).c_str());
+		return APP_EXIT_SUCCESS;
+	}
+
+	// Get the logging options.
+	const bool quietLogging = (args.count("quiet") > 0);
+	const bool verboseLogging = (args.count("verbose") > 0);
+
+	// Show a warning if "-q" and "-v" have been used together.
+	if(quietLogging && verboseLogging)
+	{
+		LOG_WARN("Quiet logging and verbose logging are both enabled; verbose logging will be selected");
+	}
+
+	// Set the log level based on the selected logging options.
+	gLogLevel = verboseLogging
+		? LogLevel::Verbose
+		: quietLogging
+			? LogLevel::Quiet
+			: LogLevel::Normal;
+
+	// Check for the <input_file> argument.
+	if(args.count("input_file") == 0)
+	{
+		LOG_ERROR("Missing required argument: <input_file>");
+		return APP_EXIT_FAILURE;
+	}
+
+	// Get the input file path from the command line and make sure it's not empty.
+	const std::string inputFilePath = args["input_file"].as<std::string>();
+	if(inputFilePath.size() == 0)
+	{
+		LOG_ERROR("Input file path is empty");
+		return APP_EXIT_FAILURE;
+	}
+
+	std::string outputFilePath;
+	if(args.count("output"))
+	{
+		// Get the output file path from the command line and make sure it's not empty.
+		outputFilePath = args["output"].as<std::string>();
+		if(outputFilePath.size() == 0)
+		{
+			LOG_ERROR("Output file path is empty");
+			return APP_EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		// When no output file is explicitly supplied, write the report next to the input file. The suffix keeps it
+		// from clobbering the report ubxdl writes for the same capture.
+		outputFilePath = inputFilePath + ".rdp.json";
+	}
+
+	SimConfig config = {};
+	config.forceCycleType = -1;
+	config.forceTextureFilter = -1;
+
+	if(args.count("base"))
+	{
+		const std::string text = args["base"].as<std::string>();
+		if(!ParseNumber(text, config.baseAddress))
+		{
+			LOG_ERROR_FMT("Invalid base address: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+
+		config.baseAddress &= 0x00FFFFFF;
+	}
+
+	if(args.count("segment"))
+	{
+		for(const std::string& text : args["segment"].as<std::vector<std::string>>())
+		{
+			const size_t separator = text.find('=');
+
+			uint32_t segmentIndex;
+			uint32_t segmentAddress;
+
+			if(separator == std::string::npos
+				|| !ParseNumber(text.substr(0, separator), segmentIndex)
+				|| !ParseNumber(text.substr(separator + 1), segmentAddress)
+				|| segmentIndex == 0
+				|| segmentIndex > 15)
+			{
+				LOG_ERROR_FMT("Invalid segment: %s", text.c_str());
+				return APP_EXIT_FAILURE;
+			}
+
+			config.segment[segmentIndex] = segmentAddress & 0x00FFFFFF;
+		}
+	}
+
+	uint32_t rootAddress = config.baseAddress;
+	if(args.count("dl"))
+	{
+		const std::string text = args["dl"].as<std::string>();
+		if(!ParseNumber(text, rootAddress))
+		{
+			LOG_ERROR_FMT("Invalid display list address: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	if(args.count("threads"))
+	{
+		const std::string text = args["threads"].as<std::string>();
+		if(!ParseNumber(text, threadCount) || threadCount == 0)
+		{
+			LOG_ERROR_FMT("Invalid thread count: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	uint32_t topCount = DEFAULT_TOP_PRIMITIVE_COUNT;
+	if(args.count("top"))
+	{
+		const std::string text = args["top"].as<std::string>();
+		if(!ParseNumber(text, topCount))
+		{
+			LOG_ERROR_FMT("Invalid primitive count: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	if(args.count("cycle-type"))
+	{
+		const std::string text = args["cycle-type"].as<std::string>();
+
+		if(text == "1cycle")
+		{
+			config.forceCycleType = GFX_CYC_1CYCLE;
+		}
+		else if(text == "2cycle")
+		{
+			config.forceCycleType = GFX_CYC_2CYCLE;
+		}
+		else
+		{
+			LOG_ERROR_FMT("Invalid cycle type: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	if(args.count("filter"))
+	{
+		const std::string text = args["filter"].as<std::string>();
+
+		if(text == "point")
+		{
+			config.forceTextureFilter = GFX_TF_POINT;
+		}
+		else if(text == "bilerp")
+		{
+			config.forceTextureFilter = GFX_TF_BILERP;
+		}
+		else if(text == "average")
+		{
+			config.forceTextureFilter = GFX_TF_AVERAGE;
+		}
+		else
+		{
+			LOG_ERROR_FMT("Invalid texture filter: %s", text.c_str());
+			return APP_EXIT_FAILURE;
+		}
+	}
+
+	LOG_INFO_FMT("UbxRdp v%" PRIu32 ".%" PRIu32 ".%" PRIu32, APP_VERSION_MAJOR, APP_VERSION_MINOR, APP_VERSION_PATCH);
+
+	// Replay the display list and write out the report JSON.
+	if(!ProcessInput(inputFilePath, outputFilePath, config, rootAddress, threadCount, topCount))
+	{
+		return APP_EXIT_FAILURE;
+	}
+
+	return APP_EXIT_SUCCESS;
+}
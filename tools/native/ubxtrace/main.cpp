@@ -0,0 +1,654 @@
+//
+// Copyright (c) 2023, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "../common/build.hpp"
+#include "../common/file_buffer.hpp"
+#include "../common/log.hpp"
+
+#include <assert.h>
+#include <locale.h>
+#include <inttypes.h>
+#include <memory.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define CXXOPTS_NO_RTTI
+#include <cxxopts.hpp>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define APP_EXIT_SUCCESS 0
+#define APP_EXIT_FAILURE 1
+
+#define APP_VERSION_MAJOR 1
+#define APP_VERSION_MINOR 0
+#define APP_VERSION_PATCH 0
+
+// These must match the values in engine/ultra_box/debug/trace.c.
+#define TRACE_STREAM_VERSION 1
+#define TRACE_EVENT_HEX_LENGTH 24
+
+// Chrome trace viewers group everything by process; there is only ever the one.
+#define TRACE_PROCESS_ID 1
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// These must match UbxTraceEventType in engine/ultra_box/debug/trace.h.
+enum TraceEventType : uint8_t
+{
+	TRACE_EVENT_NONE,
+	TRACE_EVENT_FRAME,
+	TRACE_EVENT_ZONE_BEGIN,
+	TRACE_EVENT_ZONE_END,
+	TRACE_EVENT_COUNTER,
+	TRACE_EVENT_TASK_SUBMIT,
+	TRACE_EVENT_TASK_START,
+	TRACE_EVENT_TASK_COMPLETE,
+
+	TRACE_EVENT__COUNT,
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct TraceEvent
+{
+	uint64_t timestamp;
+	uint32_t value;
+	uint16_t threadId;
+	uint8_t id;
+	uint8_t type;
+};
+
+struct TraceStream
+{
+	std::vector<TraceEvent> events;
+	std::map<uint32_t, std::string> zoneNames;
+	std::map<uint32_t, std::string> counterNames;
+
+	uint64_t counterRate = 0;
+	uint64_t droppedCount = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Default names for the threads created by the engine (see engine/ultra_box/lowlevel/thread.h).
+static const std::map<uint32_t, std::string_view> gEngineThreadNames =
+{
+	{ 1, "Idle" },
+	{ 2, "Main" },
+	{ 3, "Loader" },
+	{ 4, "Job" },
+	{ 5, "Event" },
+	{ 6, "Scheduler" },
+	{ 7, "Audio" },
+	{ 8, "Trace" },
+	{ 9, "Serial" },
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ParseHex(const std::string_view& text, const size_t offset, const size_t digitCount, uint32_t& output)
+{
+	output = 0;
+
+	for(size_t i = 0; i < digitCount; ++i)
+	{
+		const char c = text[offset + i];
+
+		uint32_t digit;
+		if(c >= '0' && c <= '9')
+		{
+			digit = uint32_t(c - '0');
+		}
+		else if(c >= 'a' && c <= 'f')
+		{
+			digit = uint32_t(c - 'a' + 10);
+		}
+		else if(c >= 'A' && c <= 'F')
+		{
+			digit = uint32_t(c - 'A' + 10);
+		}
+		else
+		{
+			return false;
+		}
+
+		output = (output << 4) | digit;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string EscapeJsonString(const std::string_view& text)
+{
+	std::string output;
+	output.reserve(text.size());
+
+	for(const char c : text)
+	{
+		switch(c)
+		{
+			case '"':  output += "\\\""; break;
+			case '\\': output += "\\\\"; break;
+			case '\t': output += "\\t"; break;
+
+			default:
+				if(uint8_t(c) >= 0x20)
+				{
+					output += c;
+				}
+				break;
+		}
+	}
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ParseStream(const std::string_view& text, TraceStream& stream)
+{
+	bool foundHeader = false;
+
+	uint32_t lastTimestamp = 0;
+	uint64_t timestamp = 0;
+
+	size_t lineNumber = 0;
+	size_t lineStart = 0;
+
+	while(lineStart < text.size())
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		if(lineEnd == std::string_view::npos)
+		{
+			lineEnd = text.size();
+		}
+
+		std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+
+		lineStart = lineEnd + 1;
+		++lineNumber;
+
+		if(!line.empty() && line.back() == '\r')
+		{
+			line.remove_suffix(1);
+		}
+
+		// The trace records share the ISViewer output with everything else the game prints, and emulators and
+		// capture tools tend to prefix each line with their own information, so only look at what's after the tag.
+		const size_t tagOffset = line.find("@ubx");
+		if(tagOffset == std::string_view::npos || line.size() < tagOffset + 6)
+		{
+			continue;
+		}
+
+		const char recordType = line[tagOffset + 4];
+		const std::string_view payload = line.substr(tagOffset + 6);
+
+		switch(recordType)
+		{
+			case 'h':
+			{
+				uint32_t version = 0;
+				unsigned long long counterRate = 0;
+
+				if(sscanf(std::string(payload).c_str(), "%" SCNu32 " %llu", &version, &counterRate) != 2)
+				{
+					LOG_ERROR_FMT("Line %zu: Malformed stream header", lineNumber);
+					return false;
+				}
+
+				if(version != TRACE_STREAM_VERSION)
+				{
+					LOG_ERROR_FMT("Line %zu: Unsupported stream version: %" PRIu32, lineNumber, version);
+					return false;
+				}
+
+				if(foundHeader && counterRate != stream.counterRate)
+				{
+					LOG_WARN_FMT("Line %zu: Stream header changed the counter rate; using the latest one", lineNumber);
+				}
+
+				foundHeader = true;
+				stream.counterRate = uint64_t(counterRate);
+				break;
+			}
+
+			case 'n':
+			{
+				char kind = '\0';
+				uint32_t id = 0;
+				int nameOffset = 0;
+
+				const std::string payloadString(payload);
+
+				if(sscanf(payloadString.c_str(), "%c %" SCNu32 " %n", &kind, &id, &nameOffset) != 2 || nameOffset == 0)
+				{
+					LOG_WARN_FMT("Line %zu: Malformed name record", lineNumber);
+					break;
+				}
+
+				const std::string name = payloadString.substr(size_t(nameOffset));
+
+				switch(kind)
+				{
+					case 'z': stream.zoneNames[id] = name; break;
+					case 'c': stream.counterNames[id] = name; break;
+
+					default:
+						LOG_WARN_FMT("Line %zu: Unknown name record kind: '%c'", lineNumber, kind);
+						break;
+				}
+				break;
+			}
+
+			case 'd':
+			{
+				stream.droppedCount += strtoull(std::string(payload).c_str(), nullptr, 10);
+				break;
+			}
+
+			case 't':
+			{
+				if(payload.size() % TRACE_EVENT_HEX_LENGTH != 0)
+				{
+					// A partial line is most likely the tail end of a capture that was cut off.
+					LOG_WARN_FMT("Line %zu: Event record has a trailing partial event", lineNumber);
+				}
+
+				for(size_t offset = 0; offset + TRACE_EVENT_HEX_LENGTH <= payload.size(); offset += TRACE_EVENT_HEX_LENGTH)
+				{
+					uint32_t rawTimestamp;
+					uint32_t value;
+					uint32_t threadId;
+					uint32_t id;
+					uint32_t type;
+
+					if(!ParseHex(payload, offset + 0, 8, rawTimestamp)
+						|| !ParseHex(payload, offset + 8, 8, value)
+						|| !ParseHex(payload, offset + 16, 4, threadId)
+						|| !ParseHex(payload, offset + 20, 2, id)
+						|| !ParseHex(payload, offset + 22, 2, type))
+					{
+						LOG_WARN_FMT("Line %zu: Event record contains invalid hex data", lineNumber);
+						break;
+					}
+
+					if(type == TRACE_EVENT_NONE || type >= TRACE_EVENT__COUNT)
+					{
+						LOG_WARN_FMT("Line %zu: Skipping event with unknown type: %" PRIu32, lineNumber, type);
+						continue;
+					}
+
+					// The CPU counter is only 32 bits and wraps roughly every 90 seconds. Events can also be slightly
+					// out of order when a thread is preempted while recording one, so accumulate signed deltas.
+					if(stream.events.empty())
+					{
+						timestamp = 0;
+					}
+					else
+					{
+						timestamp += int64_t(int32_t(rawTimestamp - lastTimestamp));
+					}
+
+					lastTimestamp = rawTimestamp;
+
+					TraceEvent event;
+					event.timestamp = timestamp;
+					event.value = value;
+					event.threadId = uint16_t(threadId);
+					event.id = uint8_t(id);
+					event.type = uint8_t(type);
+
+					stream.events.push_back(event);
+				}
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	if(!foundHeader)
+	{
+		LOG_ERROR("No stream header found in the input file");
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string BuildChromeTrace(const TraceStream& stream)
+{
+	// Event timestamps are unwrapped relative to the first event, but they may dip slightly below it.
+	int64_t baseTimestamp = 0;
+	for(const TraceEvent& event : stream.events)
+	{
+		baseTimestamp = (int64_t(event.timestamp) < baseTimestamp) ? int64_t(event.timestamp) : baseTimestamp;
+	}
+
+	auto toMicroseconds = [&stream, baseTimestamp](const uint64_t timestamp)
+	{
+		return double(int64_t(timestamp) - baseTimestamp) * 1000000.0 / double(stream.counterRate);
+	};
+
+	auto getZoneName = [&stream](const uint32_t id)
+	{
+		auto iter = stream.zoneNames.find(id);
+		return (iter != stream.zoneNames.end()) ? EscapeJsonString(iter->second) : "Zone " + std::to_string(id);
+	};
+
+	auto getCounterName = [&stream](const uint32_t id)
+	{
+		auto iter = stream.counterNames.find(id);
+		return (iter != stream.counterNames.end()) ? EscapeJsonString(iter->second) : "Counter " + std::to_string(id);
+	};
+
+	auto getTaskName = [](const uint32_t taskType)
+	{
+		// Task types are the M_*TASK values from sptask.h.
+		switch(taskType)
+		{
+			case 1: return std::string("GfxTask");
+			case 2: return std::string("AudioTask");
+
+			default:
+				return "Task " + std::to_string(taskType);
+		}
+	};
+
+	std::string output = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	std::map<uint32_t, bool> seenThreads;
+	std::map<uint32_t, uint8_t> runningTasks;
+
+	bool firstEvent = true;
+	char buffer[256];
+
+	auto appendEvent = [&output, &firstEvent](const std::string& eventJson)
+	{
+		if(!firstEvent)
+		{
+			output += ",\n";
+		}
+
+		output += eventJson;
+		firstEvent = false;
+	};
+
+	for(const TraceEvent& event : stream.events)
+	{
+		const double ts = toMicroseconds(event.timestamp);
+		seenThreads[event.threadId] = true;
+
+		switch(event.type)
+		{
+			case TRACE_EVENT_FRAME:
+				snprintf(buffer, sizeof(buffer), "\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":%d,\"tid\":%" PRIu16 "}", ts, TRACE_PROCESS_ID, event.threadId);
+				appendEvent("{\"name\":\"Frame\"," + std::string(buffer));
+				break;
+
+			case TRACE_EVENT_ZONE_BEGIN:
+			case TRACE_EVENT_ZONE_END:
+				snprintf(
+					buffer,
+					sizeof(buffer),
+					"\",\"cat\":\"cpu\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%" PRIu16 "}",
+					(event.type == TRACE_EVENT_ZONE_BEGIN) ? 'B' : 'E',
+					ts,
+					TRACE_PROCESS_ID,
+					event.threadId);
+				appendEvent("{\"name\":\"" + getZoneName(event.id) + std::string(buffer));
+				break;
+
+			case TRACE_EVENT_COUNTER:
+				snprintf(buffer, sizeof(buffer), "\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"args\":{\"value\":%" PRIu32 "}}", ts, TRACE_PROCESS_ID, event.value);
+				appendEvent("{\"name\":\"" + getCounterName(event.id) + std::string(buffer));
+				break;
+
+			case TRACE_EVENT_TASK_SUBMIT:
+			case TRACE_EVENT_TASK_START:
+			case TRACE_EVENT_TASK_COMPLETE:
+			{
+				// Each task gets an async slice for the time it spent queued followed by one for the time it spent
+				// on the RCP. Tasks that were yielded start more than once, but only the first start is meaningful.
+				const std::string taskName = getTaskName(event.id);
+				const uint8_t prevState = runningTasks[event.value];
+
+				auto appendAsync = [&](const char* const suffix, const char phase)
+				{
+					snprintf(
+						buffer,
+						sizeof(buffer),
+						"\",\"cat\":\"rcp\",\"ph\":\"%c\",\"id\":\"0x%08" PRIX32 "\",\"ts\":%.3f,\"pid\":%d,\"tid\":%" PRIu16 "}",
+						phase,
+						event.value,
+						ts,
+						TRACE_PROCESS_ID,
+						event.threadId);
+					appendEvent("{\"name\":\"" + taskName + suffix + std::string(buffer));
+				};
+
+				if(event.type == TRACE_EVENT_TASK_SUBMIT)
+				{
+					appendAsync(" (queued)", 'b');
+					runningTasks[event.value] = TRACE_EVENT_TASK_SUBMIT;
+				}
+				else if(event.type == TRACE_EVENT_TASK_START && prevState == TRACE_EVENT_TASK_SUBMIT)
+				{
+					appendAsync(" (queued)", 'e');
+					appendAsync("", 'b');
+					runningTasks[event.value] = TRACE_EVENT_TASK_START;
+				}
+				else if(event.type == TRACE_EVENT_TASK_COMPLETE && prevState == TRACE_EVENT_TASK_START)
+				{
+					appendAsync("", 'e');
+					runningTasks[event.value] = TRACE_EVENT_NONE;
+				}
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	// Label the engine threads so they're easy to pick out in the viewer.
+	for(const auto& kv : seenThreads)
+	{
+		auto iter = gEngineThreadNames.find(kv.first);
+		const std::string threadName = (iter != gEngineThreadNames.end())
+			? std::string(iter->second)
+			: "Thread " + std::to_string(kv.first);
+
+		snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%" PRIu32 ",\"args\":{\"name\":\"", TRACE_PROCESS_ID, kv.first);
+		appendEvent(std::string(buffer) + threadName + "\"}}");
+	}
+
+	output += "\n]}\n";
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ProcessTrace(const std::string_view& inputFilePath, const std::string_view& outputFilePath)
+{
+	assert(inputFilePath.size() > 0);
+	assert(outputFilePath.size() > 0);
+
+	FileBuffer inputFile;
+
+	// Read the captured ISViewer output.
+	if(!FileBuffer::Read(inputFile, inputFilePath))
+	{
+		LOG_ERROR_FMT("Failed to load input file: %s", inputFilePath.data());
+		return false;
+	}
+
+	TraceStream stream;
+
+	LOG_VERBOSE("Parsing trace stream ...");
+
+	if(!ParseStream(std::string_view(reinterpret_cast<char*>(inputFile.data.get()), inputFile.length), stream))
+	{
+		return false;
+	}
+
+	LOG_INFO_FMT("Decoded %zu trace events", stream.events.size());
+
+	if(stream.droppedCount > 0)
+	{
+		LOG_WARN_FMT("The device dropped %" PRIu64 " events because the trace ring was full", stream.droppedCount);
+	}
+
+	LOG_VERBOSE("Generating Chrome trace JSON ...");
+
+	const std::string json = BuildChromeTrace(stream);
+
+	FileBuffer outputFile;
+	outputFile.data = std::make_unique<uint8_t[]>(json.size());
+	outputFile.length = json.size();
+
+	memcpy(outputFile.data.get(), json.data(), json.size());
+
+	// Write the trace JSON to disk.
+	if(!FileBuffer::Write(outputFilePath, outputFile))
+	{
+		LOG_ERROR_FMT("Failed to write output file: %s", outputFilePath.data());
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	// Set the program locale to the environment default.
+	setlocale(LC_ALL, "");
+
+#if defined(_WIN32)
+	// This enables tracking of global heap allocations. If any are leaked,
+	// they will show up in the Visual Studio output window on application exit.
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	cxxopts::Options options(
+#if defined(_WIN32)
+		"ubxtrace.exe",
+#else
+		"ubxtrace",
+#endif
+		"UltraBox trace decoder (converts captured ISViewer trace output to Chrome/Perfetto trace JSON)"
+	);
+
+	options
+		.custom_help("[options...]")
+		.positional_help("<input_file>")
+		.allow_unrecognised_options();
+
+	// Add the options.
+	options.add_options()
+		("h,help", "Display this help text")
+		("input_file", "File path of the captured ISViewer output", cxxopts::value<std::string>(), "<input_file>")
+		("o,output", "File path where the trace JSON will be written to (default = <input_file>.json)", cxxopts::value<std::string>(), "file")
+		("q,quiet", "Disable all logging exception errors")
+		("v,verbose", "Enable verbose logging (overrides -q/--quiet)");
+
+	// Define which of the above arguments are positional.
+	options.parse_positional({ "input_file" });
+
+	// Parse the application's command line arguments.
+	cxxopts::ParseResult args = options.parse(argc, argv);
+
+	if(args.count("help"))
+	{
+		// Print the help text, then exit.
+		printf("%s\n", options.help({ "" }).c_str());
+		return APP_EXIT_SUCCESS;
+	}
+
+	// Get the logging options.
+	const bool quietLogging = (args.count("quiet") > 0);
+	const bool verboseLogging = (args.count("verbose") > 0);
+
+	// Show a warning if "-q" and "-v" have been used together.
+	if(quietLogging && verboseLogging)
+	{
+		LOG_WARN("Quiet logging and verbose logging are both enabled; verbose logging will be selected");
+	}
+
+	// Set the log level based on the selected logging options.
+	gLogLevel = verboseLogging
+		? LogLevel::Verbose
+		: quietLogging
+			? LogLevel::Quiet
+			: LogLevel::Normal;
+
+	// Check for the <input_file> argument.
+	if(args.count("input_file") == 0)
+	{
+		LOG_ERROR("Missing required argument: <input_file>");
+		return APP_EXIT_FAILURE;
+	}
+
+	// Get the input file path from the command line and make sure it's not empty.
+	const std::string inputFilePath = args["input_file"].as<std::string>();
+	if(inputFilePath.size() == 0)
+	{
+		LOG_ERROR("Input file path is empty");
+		return APP_EXIT_FAILURE;
+	}
+
+	std::string outputFilePath;
+	if(args.count("output"))
+	{
+		// Get the output file path from the command line and make sure it's not empty.
+		outputFilePath = args["output"].as<std::string>();
+		if(outputFilePath.size() == 0)
+		{
+			LOG_ERROR("Output file path is empty");
+			return APP_EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		// When no output file is explicitly supplied, write the trace next to the input file.
+		outputFilePath = inputFilePath + ".json";
+	}
+
+	LOG_INFO_FMT("UbxTrace v%" PRIu32 ".%" PRIu32 ".%" PRIu32, APP_VERSION_MAJOR, APP_VERSION_MINOR, APP_VERSION_PATCH);
+
+	// Decode the trace stream and write out the trace JSON.
+	if(!ProcessTrace(inputFilePath, outputFilePath))
+	{
+		return APP_EXIT_FAILURE;
+	}
+
+	return APP_EXIT_SUCCESS;
+}